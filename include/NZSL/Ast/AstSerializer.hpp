@@ -91,10 +91,10 @@ namespace nzsl::Ast
 			virtual void Node(StatementPtr& node) = 0;
 
 			virtual void SerializeModule(Module& module) = 0;
-			virtual void SharedString(std::shared_ptr<const std::string>& val) = 0;
 
 			inline void SizeT(std::size_t& val);
 
+			virtual void SourceFile(SourceFileId& val) = 0;
 			inline void SourceLoc(SourceLocation& sourceLoc);
 
 			virtual void Type(ExpressionType& type) = 0;
@@ -141,7 +141,7 @@ namespace nzsl::Ast
 			void Node(ExpressionPtr& node) override;
 			void Node(StatementPtr& node) override;
 			void SerializeModule(Module& module) override;
-			void SharedString(std::shared_ptr<const std::string>& val) override;
+			void SourceFile(SourceFileId& val) override;
 			void Type(ExpressionType& type) override;
 			void Value(bool& val) override;
 			void Value(double& val) override;
@@ -168,7 +168,7 @@ namespace nzsl::Ast
 			void Value(std::uint32_t& val) override;
 			void Value(std::uint64_t& val) override;
 
-			std::unordered_map<std::string, std::uint32_t> m_stringIndices;
+			std::unordered_map<SourceFileId, std::uint32_t> m_sourceFileIndices;
 			AbstractSerializer& m_serializer;
 	};
 
@@ -179,16 +179,19 @@ namespace nzsl::Ast
 			~ShaderAstDeserializer() = default;
 
 			ModulePtr Deserialize();
+			Module::Metadata DeserializeMetadata();
 
 		private:
 			using SerializerBase::Serialize;
 
+			void DeserializeHeader();
+
 			bool IsVersionGreaterOrEqual(std::uint32_t version) const override;
 			bool IsWriting() const override;
 			void Node(ExpressionPtr& node) override;
 			void Node(StatementPtr& node) override;
 			void SerializeModule(Module& module) override;
-			void SharedString(std::shared_ptr<const std::string>& val) override;
+			void SourceFile(SourceFileId& val) override;
 			void Type(ExpressionType& type) override;
 			void Value(bool& val) override;
 			void Value(double& val) override;
@@ -215,13 +218,14 @@ namespace nzsl::Ast
 			void Value(std::uint32_t& val) override;
 			void Value(std::uint64_t& val) override;
 
-			std::vector<std::shared_ptr<const std::string>> m_strings;
+			std::vector<SourceFileId> m_sourceFiles;
 			AbstractDeserializer& m_deserializer;
 			std::uint32_t m_version;
 	};
 	
 	NZSL_API void SerializeShader(AbstractSerializer& serializer, const Module& shader);
 	NZSL_API ModulePtr DeserializeShader(AbstractDeserializer& deserializer);
+	NZSL_API Module::Metadata DeserializeShaderMetadata(AbstractDeserializer& deserializer);
 }
 
 #include <NZSL/Ast/AstSerializer.inl>
@@ -213,7 +213,7 @@ namespace nzsl::Ast
 
 	inline void SerializerBase::SourceLoc(SourceLocation& sourceLoc)
 	{
-		SharedString(sourceLoc.file);
+		SourceFile(sourceLoc.fileId);
 		Value(sourceLoc.endColumn);
 		Value(sourceLoc.endLine);
 		Value(sourceLoc.startColumn);
@@ -11,6 +11,9 @@
 #include <NZSL/Ast/ExpressionValue.hpp>
 #include <NZSL/Ast/ExpressionVisitor.hpp>
 #include <NZSL/Ast/StatementVisitor.hpp>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace nzsl::Ast
@@ -34,6 +37,9 @@ namespace nzsl::Ast
 		protected:
 			inline ExpressionPtr CloneExpression(const ExpressionPtr& expr);
 			inline StatementPtr CloneStatement(const StatementPtr& statement);
+			// Clones a child of an input node, the child is taken from the input tree instead of being copied when consuming input
+			inline ExpressionPtr CloneInputExpression(ExpressionPtr& expr);
+			inline StatementPtr CloneInputStatement(StatementPtr& statement);
 
 			virtual ExpressionPtr CloneExpression(Expression& expr);
 			virtual StatementPtr CloneStatement(Statement& statement);
@@ -94,9 +100,19 @@ namespace nzsl::Ast
 			ExpressionPtr PopExpression();
 			StatementPtr PopStatement();
 
+			template<typename T> std::unique_ptr<T> ReuseOrAllocate(T& node);
+
+			// When consuming input, nodes cloned through CloneInputExpression/CloneInputStatement are taken from the input tree and reused instead of being copied
+			// (the input tree is left in an unspecified state and should only be destroyed afterwards)
+			inline void SetInputConsumption(bool consumeInput);
+
 		private:
 			std::vector<ExpressionPtr> m_expressionStack;
 			std::vector<StatementPtr>  m_statementStack;
+			ExpressionPtr* m_expressionOwner = nullptr;
+			StatementPtr* m_statementOwner = nullptr;
+			bool m_consumeChildren = true;
+			bool m_consumeInput = false;
 	};
 
 	template<typename T> ExpressionValue<T> Clone(const ExpressionValue<T>& attribute);
@@ -41,6 +41,72 @@ namespace nzsl::Ast
 		return CloneStatement(*statement);
 	}
 
+	inline ExpressionPtr Cloner::CloneInputExpression(ExpressionPtr& expr)
+	{
+		if (!expr)
+			return nullptr;
+
+		// Only take nodes from a parent which was itself taken from the input tree
+		if (!m_consumeInput || !m_consumeChildren)
+			return CloneExpression(*expr);
+
+		m_expressionOwner = &expr;
+		ExpressionPtr clone = CloneExpression(*expr);
+		m_expressionOwner = nullptr;
+		m_consumeChildren = true;
+
+		return clone;
+	}
+
+	inline StatementPtr Cloner::CloneInputStatement(StatementPtr& statement)
+	{
+		if (!statement)
+			return nullptr;
+
+		if (!m_consumeInput || !m_consumeChildren)
+			return CloneStatement(*statement);
+
+		m_statementOwner = &statement;
+		StatementPtr clone = CloneStatement(*statement);
+		m_statementOwner = nullptr;
+		m_consumeChildren = true;
+
+		return clone;
+	}
+
+	template<typename T>
+	std::unique_ptr<T> Cloner::ReuseOrAllocate(T& node)
+	{
+		// Owners are only valid until the next node is visited
+		std::unique_ptr<T> clone;
+		if constexpr (std::is_base_of_v<Expression, T>)
+		{
+			ExpressionPtr* owner = std::exchange(m_expressionOwner, nullptr);
+			if (owner && owner->get() == &node)
+				clone.reset(static_cast<T*>(owner->release()));
+		}
+		else
+		{
+			static_assert(std::is_base_of_v<Statement, T>);
+
+			StatementPtr* owner = std::exchange(m_statementOwner, nullptr);
+			if (owner && owner->get() == &node)
+				clone.reset(static_cast<T*>(owner->release()));
+		}
+
+		// A copied node may still be read from the input tree afterwards, its children have to be copied as well
+		m_consumeChildren = (clone != nullptr);
+		if (!clone)
+			clone = std::make_unique<T>();
+
+		return clone;
+	}
+
+	inline void Cloner::SetInputConsumption(bool consumeInput)
+	{
+		m_consumeInput = consumeInput;
+		m_consumeChildren = true;
+	}
 
 	template<typename T>
 	ExpressionValue<T> Clone(const ExpressionValue<T>& attribute)
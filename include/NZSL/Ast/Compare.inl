@@ -281,7 +281,7 @@ namespace nzsl::Ast
 		if (!Compare(lhs.startLine, rhs.startLine, params))
 			return false;
 
-		if (!Compare(lhs.file, rhs.file, params))
+		if (!Compare(lhs.fileId, rhs.fileId, params))
 			return false;
 
 		return true;
@@ -30,6 +30,9 @@ namespace nzsl::Ast
 			ModulePtr Process(const Module& shaderModule, const Options& options);
 			inline StatementPtr Process(Statement& statement);
 			inline StatementPtr Process(Statement& statement, const Options& options);
+			// Propagates constants directly in the module tree, reusing its nodes instead of cloning them
+			inline void ProcessInPlace(Module& shaderModule);
+			void ProcessInPlace(Module& shaderModule, const Options& options);
 
 			ConstantPropagationVisitor& operator=(const ConstantPropagationVisitor&) = delete;
 			ConstantPropagationVisitor& operator=(ConstantPropagationVisitor&&) = delete;
@@ -29,6 +29,11 @@ namespace nzsl::Ast
 		return CloneStatement(statement);
 	}
 
+	inline void ConstantPropagationVisitor::ProcessInPlace(Module& shaderModule)
+	{
+		ProcessInPlace(shaderModule, {});
+	}
+
 	inline ExpressionPtr PropagateConstants(Expression& ast)
 	{
 		ConstantPropagationVisitor optimize;
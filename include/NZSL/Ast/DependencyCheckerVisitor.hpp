@@ -9,8 +9,10 @@
 
 #include <NazaraUtils/Bitset.hpp>
 #include <NZSL/Config.hpp>
+#include <NZSL/Ast/Option.hpp>
 #include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace nzsl::Ast
 {
@@ -42,6 +44,7 @@ namespace nzsl::Ast
 			struct Config
 			{
 				ShaderStageTypeFlags usedShaderStages;
+				std::unordered_set<OptionHash> specializationConstantOptions; //< options the sanitizer kept as specialization constants
 			};
 
 			struct UsageSet
@@ -70,6 +73,7 @@ namespace nzsl::Ast
 			void Visit(DeclareConstStatement& node) override;
 			void Visit(DeclareExternalStatement& node) override;
 			void Visit(DeclareFunctionStatement& node) override;
+			void Visit(DeclareOptionStatement& node) override;
 			void Visit(DeclareStructStatement& node) override;
 			void Visit(DeclareVariableStatement& node) override;
 
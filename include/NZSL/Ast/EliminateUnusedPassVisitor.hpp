@@ -25,6 +25,9 @@ namespace nzsl::Ast
 
 			ModulePtr Process(const Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet);
 			StatementPtr Process(Statement& statement, const DependencyCheckerVisitor::UsageSet& usageSet);
+			// Replaces unused declarations by NoOp directly in the module tree instead of cloning it
+			void ProcessInPlace(Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet);
+			void ProcessInPlace(StatementPtr& statement, const DependencyCheckerVisitor::UsageSet& usageSet);
 
 			EliminateUnusedPassVisitor& operator=(const EliminateUnusedPassVisitor&) = delete;
 			EliminateUnusedPassVisitor& operator=(EliminateUnusedPassVisitor&&) = delete;
@@ -38,6 +41,8 @@ namespace nzsl::Ast
 			StatementPtr Clone(DeclareStructStatement& node) override;
 			StatementPtr Clone(DeclareVariableStatement& node) override;
 
+			void EliminateInPlace(StatementPtr& statement);
+
 			bool IsAliasUsed(std::size_t aliasIndex) const;
 			bool IsConstantUsed(std::size_t constantIndex) const;
 			bool IsFunctionUsed(std::size_t funcIndex) const;
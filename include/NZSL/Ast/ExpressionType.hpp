@@ -12,6 +12,7 @@
 #include <NZSL/Ast/Enums.hpp>
 #include <NZSL/Ast/ExpressionValue.hpp>
 #include <NZSL/Lang/SourceLocation.hpp>
+#include <memory>
 #include <string>
 #include <variant>
 #include <vector>
@@ -31,14 +32,14 @@ namespace nzsl::Ast
 	struct NZSL_API BaseArrayType
 	{
 		BaseArrayType() = default;
-		BaseArrayType(const BaseArrayType& array);
+		BaseArrayType(const BaseArrayType&) = default;
 		BaseArrayType(BaseArrayType&&) noexcept = default;
 		~BaseArrayType() = default;
 
-		BaseArrayType& operator=(const BaseArrayType& array);
+		BaseArrayType& operator=(const BaseArrayType&) = default;
 		BaseArrayType& operator=(BaseArrayType&&) noexcept = default;
 
-		std::unique_ptr<ContainedType> containedType;
+		std::shared_ptr<const ContainedType> containedType; //< shared between copies, see ContainedType
 		bool isWrapped = false;
 
 		bool operator==(const BaseArrayType& rhs) const;
@@ -48,15 +49,15 @@ namespace nzsl::Ast
 	struct NZSL_API AliasType
 	{
 		AliasType() = default;
-		AliasType(const AliasType& alias);
+		AliasType(const AliasType&) = default;
 		AliasType(AliasType&&) noexcept = default;
 		~AliasType() = default;
 
-		AliasType& operator=(const AliasType& alias);
+		AliasType& operator=(const AliasType&) = default;
 		AliasType& operator=(AliasType&&) noexcept = default;
 
 		std::size_t aliasIndex;
-		std::unique_ptr<ContainedType> targetType;
+		std::shared_ptr<const ContainedType> targetType; //< shared between copies, see ContainedType
 
 		bool operator==(const AliasType& rhs) const;
 		inline bool operator!=(const AliasType& rhs) const;
@@ -121,13 +122,13 @@ namespace nzsl::Ast
 	struct NZSL_API MethodType
 	{
 		MethodType() = default;
-		MethodType(const MethodType& methodType);
+		MethodType(const MethodType&) = default;
 		MethodType(MethodType&&) noexcept = default;
 
-		MethodType& operator=(const MethodType& methodType);
+		MethodType& operator=(const MethodType&) = default;
 		MethodType& operator=(MethodType&&) noexcept = default;
 
-		std::unique_ptr<ContainedType> objectType;
+		std::shared_ptr<const ContainedType> objectType; //< shared between copies, see ContainedType
 		std::size_t methodIndex;
 
 		bool operator==(const MethodType& rhs) const;
@@ -231,6 +232,9 @@ namespace nzsl::Ast
 
 	using ExpressionType = std::variant<NoType, AliasType, ArrayType, DynArrayType, FunctionType, IntrinsicFunctionType, MatrixType, MethodType, ModuleType, NamedExternalBlockType, PrimitiveType, PushConstantType, SamplerType, StorageType, StructType, TextureType, Type, UniformType, VectorType>;
 
+	// Contained types are shared: copying an ArrayType, DynArrayType, AliasType or MethodType copies the pointer, not the inner type
+	// (copies are cheap and compare in O(1) when they point to the same inner type, other types are compared structurally).
+	// They are immutable, build them before sharing them (e.g. std::make_shared<const ContainedType>(ContainedType{ ... })) and assign a new one to change the inner type of a copy.
 	struct ContainedType
 	{
 		ExpressionType type;
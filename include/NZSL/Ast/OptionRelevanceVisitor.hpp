@@ -0,0 +1,133 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_OPTIONRELEVANCEVISITOR_HPP
+#define NZSL_AST_OPTIONRELEVANCEVISITOR_HPP
+
+#include <NazaraUtils/Bitset.hpp>
+#include <NZSL/Config.hpp>
+#include <NZSL/Enums.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	// Finds which options each entry point depends on (through conditions, constants, types or values), any other option cannot change its generated code
+	// Meant to be run on a partially sanitized module, where options are not resolved yet (unresolved identifiers are matched by name)
+	class NZSL_API OptionRelevanceVisitor : public RecursiveVisitor
+	{
+		public:
+			struct EntryPoint;
+			struct Result;
+
+			OptionRelevanceVisitor() = default;
+			OptionRelevanceVisitor(const OptionRelevanceVisitor&) = delete;
+			OptionRelevanceVisitor(OptionRelevanceVisitor&&) = delete;
+			~OptionRelevanceVisitor() = default;
+
+			Result Analyze(const Module& shaderModule);
+
+			OptionRelevanceVisitor& operator=(const OptionRelevanceVisitor&) = delete;
+			OptionRelevanceVisitor& operator=(OptionRelevanceVisitor&&) = delete;
+
+			struct EntryPoint
+			{
+				std::string functionName;
+				Nz::Bitset<> relevantOptions; //< indices in Result::options
+				std::optional<ShaderStageType> stage; //< unset if the stage isn't resolved, the entry point is then relevant to every stage
+			};
+
+			struct Result
+			{
+				inline Nz::Bitset<> GetRelevantOptions(ShaderStageTypeFlags shaderStages) const;
+
+				std::vector<EntryPoint> entryPoints;
+				std::vector<std::string> options; //< options declared by the module and its imported modules
+				Nz::Bitset<> referencedOptions; //< options referenced anywhere, relevant when unused declarations are not eliminated
+			};
+
+		private:
+			struct UsageSet;
+
+			std::size_t BeginDeclaration(const std::string& name, std::unordered_map<std::size_t, std::size_t>& declarationByIndex, const std::optional<std::size_t>& index);
+			UsageSet& GetContextUsageSet();
+			void RegisterType(UsageSet& usageSet, const ExpressionType& exprType);
+			void Resolve(const UsageSet& usageSet, Nz::Bitset<>& visitedDeclarations, Nz::Bitset<>& relevantOptions) const;
+			void ResolveDeclaration(std::size_t declarationId, Nz::Bitset<>& visitedDeclarations, Nz::Bitset<>& relevantOptions) const;
+			template<typename T> void VisitValue(const ExpressionValue<T>& value);
+
+			using RecursiveVisitor::Visit;
+
+			void Visit(AliasValueExpression& node) override;
+			void Visit(CastExpression& node) override;
+			void Visit(ConditionalExpression& node) override;
+			void Visit(ConstantExpression& node) override;
+			void Visit(FunctionExpression& node) override;
+			void Visit(IdentifierExpression& node) override;
+			void Visit(StructTypeExpression& node) override;
+			void Visit(VariableValueExpression& node) override;
+
+			void Visit(ConditionalStatement& node) override;
+			void Visit(DeclareAliasStatement& node) override;
+			void Visit(DeclareConstStatement& node) override;
+			void Visit(DeclareExternalStatement& node) override;
+			void Visit(DeclareFunctionStatement& node) override;
+			void Visit(DeclareOptionStatement& node) override;
+			void Visit(DeclareStructStatement& node) override;
+			void Visit(DeclareVariableStatement& node) override;
+			void Visit(ForStatement& node) override;
+			void Visit(ForEachStatement& node) override;
+			void Visit(WhileStatement& node) override;
+
+			struct UsageSet
+			{
+				Nz::Bitset<> usedAliases;
+				Nz::Bitset<> usedConstants;
+				Nz::Bitset<> usedFunctions;
+				Nz::Bitset<> usedStructs;
+				Nz::Bitset<> usedVariables;
+				std::unordered_set<std::string> usedIdentifiers;
+			};
+
+			struct Declaration
+			{
+				std::optional<std::size_t> optionIndex;
+				UsageSet usageSet;
+			};
+
+			struct PendingEntryPoint
+			{
+				std::size_t declarationId;
+				std::string functionName;
+				std::optional<ShaderStageType> stage;
+			};
+
+			std::optional<std::size_t> m_currentDeclarationId;
+			std::unordered_map<std::size_t, std::size_t> m_declarationByAlias;
+			std::unordered_map<std::size_t, std::size_t> m_declarationByConstant;
+			std::unordered_map<std::size_t, std::size_t> m_declarationByFunction;
+			std::unordered_map<std::size_t, std::size_t> m_declarationByStruct;
+			std::unordered_map<std::size_t, std::size_t> m_declarationByVariable;
+			std::unordered_multimap<std::string, std::size_t> m_declarationsByName;
+			std::vector<Declaration> m_declarations;
+			std::vector<PendingEntryPoint> m_entryPoints;
+			std::vector<std::string> m_options;
+			std::vector<UsageSet> m_rootConditions;
+			UsageSet m_globalUsage;
+			UsageSet* m_conditionUsage;
+	};
+
+	inline OptionRelevanceVisitor::Result AnalyzeOptionRelevance(const Module& shaderModule);
+}
+
+#include <NZSL/Ast/OptionRelevanceVisitor.inl>
+
+#endif // NZSL_AST_OPTIONRELEVANCEVISITOR_HPP
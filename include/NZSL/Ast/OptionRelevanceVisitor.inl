@@ -0,0 +1,24 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+namespace nzsl::Ast
+{
+	inline Nz::Bitset<> OptionRelevanceVisitor::Result::GetRelevantOptions(ShaderStageTypeFlags shaderStages) const
+	{
+		Nz::Bitset<> relevantOptions;
+		for (const EntryPoint& entryPoint : entryPoints)
+		{
+			if (!entryPoint.stage || (shaderStages & *entryPoint.stage))
+				relevantOptions |= entryPoint.relevantOptions;
+		}
+
+		return relevantOptions;
+	}
+
+	inline OptionRelevanceVisitor::Result AnalyzeOptionRelevance(const Module& shaderModule)
+	{
+		OptionRelevanceVisitor visitor;
+		return visitor.Analyze(shaderModule);
+	}
+}
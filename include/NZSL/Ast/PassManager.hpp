@@ -0,0 +1,117 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_PASSMANAGER_HPP
+#define NZSL_AST_PASSMANAGER_HPP
+
+#include <NazaraUtils/Flags.hpp>
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/DependencyCheckerVisitor.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	enum class PassAnalysis
+	{
+		Dependencies,
+
+		Max = Dependencies
+	};
+
+	constexpr bool EnableEnumAsNzFlags(PassAnalysis) { return true; }
+
+	using PassAnalysisFlags = Nz::Flags<PassAnalysis>;
+
+	// Runs a chain of passes over a module, the module is only copied by passes which need a new tree and analyses are kept until a pass invalidates them
+	class NZSL_API PassManager
+	{
+		public:
+			class Context;
+			class Pass;
+
+			PassManager() = default;
+			PassManager(const PassManager&) = delete;
+			PassManager(PassManager&&) noexcept = default;
+			~PassManager() = default;
+
+			template<typename T, typename... Args> T& AddPass(Args&&... args);
+
+			ModulePtr Run(const Module& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig) const;
+			// The root node of the module is modified in place if the caller holds the only reference to it, otherwise it is copied as with the overload above
+			ModulePtr Run(ModulePtr&& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig) const;
+
+			PassManager& operator=(const PassManager&) = delete;
+			PassManager& operator=(PassManager&&) noexcept = default;
+
+			class NZSL_API Context
+			{
+				friend PassManager;
+
+				public:
+					// ownedModule (if any) is modified in place by passes, it must be the only reference to the module
+					inline Context(const Module& shaderModule, ModulePtr ownedModule, const DependencyCheckerVisitor::Config& dependencyConfig);
+
+					const DependencyCheckerVisitor::UsageSet& GetDependencies();
+					inline const Module& GetModule() const;
+					inline Module* GetOwnedModule();
+
+					inline void SetModule(ModulePtr shaderModule);
+
+				private:
+					inline void Invalidate(PassAnalysisFlags analyses);
+					inline ModulePtr ReleaseModule();
+
+					std::optional<DependencyCheckerVisitor::UsageSet> m_dependencies;
+					const DependencyCheckerVisitor::Config& m_dependencyConfig;
+					const Module* m_module;
+					ModulePtr m_ownedModule;
+			};
+
+			class NZSL_API Pass
+			{
+				public:
+					Pass() = default;
+					Pass(const Pass&) = delete;
+					Pass(Pass&&) = delete;
+					virtual ~Pass();
+
+					// Returns the analyses which are no longer valid after the pass
+					virtual PassAnalysisFlags Run(Context& context) const = 0;
+
+					Pass& operator=(const Pass&) = delete;
+					Pass& operator=(Pass&&) = delete;
+			};
+
+		private:
+			ModulePtr Run(Context& context) const;
+
+			std::vector<std::unique_ptr<Pass>> m_passes;
+	};
+
+	class NZSL_API ConstantPropagationPass : public PassManager::Pass
+	{
+		public:
+			PassAnalysisFlags Run(PassManager::Context& context) const override;
+	};
+
+	class NZSL_API UnusedEliminationPass : public PassManager::Pass
+	{
+		public:
+			PassAnalysisFlags Run(PassManager::Context& context) const override;
+	};
+
+	NZSL_API const PassManager& GetOptimizationPasses();
+
+	inline ModulePtr Optimize(const Module& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig);
+	inline ModulePtr Optimize(ModulePtr&& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig);
+}
+
+#include <NZSL/Ast/PassManager.inl>
+
+#endif // NZSL_AST_PASSMANAGER_HPP
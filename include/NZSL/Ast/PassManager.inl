@@ -0,0 +1,67 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <cassert>
+
+namespace nzsl::Ast
+{
+	template<typename T, typename... Args>
+	T& PassManager::AddPass(Args&&... args)
+	{
+		static_assert(std::is_base_of_v<Pass, T>);
+
+		auto passPtr = std::make_unique<T>(std::forward<Args>(args)...);
+		T& pass = *passPtr;
+		m_passes.push_back(std::move(passPtr));
+
+		return pass;
+	}
+
+	inline PassManager::Context::Context(const Module& shaderModule, ModulePtr ownedModule, const DependencyCheckerVisitor::Config& dependencyConfig) :
+	m_dependencyConfig(dependencyConfig),
+	m_module(&shaderModule),
+	m_ownedModule(std::move(ownedModule))
+	{
+		assert(!m_ownedModule || m_ownedModule.get() == m_module);
+		assert(!m_ownedModule || m_ownedModule.use_count() == 1);
+	}
+
+	inline const Module& PassManager::Context::GetModule() const
+	{
+		return *m_module;
+	}
+
+	inline Module* PassManager::Context::GetOwnedModule()
+	{
+		return m_ownedModule.get();
+	}
+
+	inline void PassManager::Context::SetModule(ModulePtr shaderModule)
+	{
+		assert(shaderModule);
+		m_ownedModule = std::move(shaderModule);
+		m_module = m_ownedModule.get();
+	}
+
+	inline void PassManager::Context::Invalidate(PassAnalysisFlags analyses)
+	{
+		if (analyses & PassAnalysis::Dependencies)
+			m_dependencies.reset();
+	}
+
+	inline ModulePtr PassManager::Context::ReleaseModule()
+	{
+		return std::move(m_ownedModule);
+	}
+
+	inline ModulePtr Optimize(const Module& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig)
+	{
+		return GetOptimizationPasses().Run(shaderModule, dependencyConfig);
+	}
+
+	inline ModulePtr Optimize(ModulePtr&& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig)
+	{
+		return GetOptimizationPasses().Run(std::move(shaderModule), dependencyConfig);
+	}
+}
@@ -11,21 +11,27 @@
 #include <NZSL/Config.hpp>
 #include <NZSL/ModuleResolver.hpp>
 #include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/ConstantValue.hpp>
 #include <NZSL/Ast/Module.hpp>
 #include <NZSL/Ast/Option.hpp>
 #include <NZSL/Ast/Types.hpp>
+#include <NZSL/Lang/Symbol.hpp>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 namespace nzsl::Ast
 {
+	class SanitizedModuleCache;
+
 	class NZSL_API SanitizeVisitor final : Cloner
 	{
 		friend class AstTypeExpressionVisitor;
 
 		public:
+			struct ModuleRegistrations; //< what was registered while sanitizing a module, opaque outside of the sanitizer
 			struct Options;
 
 			SanitizeVisitor() = default;
@@ -35,6 +41,13 @@ namespace nzsl::Ast
 
 			inline ModulePtr Sanitize(const Module& module, std::string* error = nullptr);
 			ModulePtr Sanitize(const Module& module, const Options& options, std::string* error = nullptr);
+			// Consumes the module root node, nodes which are kept as-is are moved to the sanitized module instead of being copied (imported modules are left untouched)
+			inline ModulePtr Sanitize(Module&& module, std::string* error = nullptr);
+			ModulePtr Sanitize(Module&& module, const Options& options, std::string* error = nullptr);
+			// Resumes the sanitization of a module sanitized with partialSanitization (and the same options), using the given option values
+			// Conditionals and const_select depending on options are folded and only what they left unresolved is resolved, expressions typed by the partial sanitization are copied without being validated again
+			inline ModulePtr Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, std::string* error = nullptr);
+			ModulePtr Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, const Options& options, std::string* error = nullptr);
 
 			SanitizeVisitor& operator=(const SanitizeVisitor&) = delete;
 			SanitizeVisitor& operator=(SanitizeVisitor&&) = delete;
@@ -43,7 +56,9 @@ namespace nzsl::Ast
 			{
 				std::function<bool(std::string& identifier, IdentifierScope identifierScope)> identifierSanitizer; //< ignored when performing partial sanitization
 				std::shared_ptr<ModuleResolver> moduleResolver;
+				std::shared_ptr<SanitizedModuleCache> moduleCache; //< shared between sanitizations to avoid sanitizing the same imported modules again, ignored when using an identifier sanitizer, specialization constants or partial sanitization
 				std::unordered_map<OptionHash, ConstantValue> optionValues;
+				std::unordered_set<OptionHash> specializationConstantOptions; //< scalar options kept as specialization constants (their value in optionValues becomes their default value), they can only be used in runtime expressions
 				bool forceAutoBindingResolve = false;
 				bool makeVariableNameUnique = false;
 				bool partialSanitization = false;
@@ -65,6 +80,7 @@ namespace nzsl::Ast
 		private:
 			enum class IdentifierCategory;
 			enum class ValidationResult;
+			struct BuiltinEnvironment;
 			struct Environment;
 			struct FunctionData;
 			struct Identifier;
@@ -75,6 +91,7 @@ namespace nzsl::Ast
 			struct Scope;
 
 			using Cloner::CloneExpression;
+			ExpressionPtr CloneExpression(Expression& expr) override;
 			ExpressionValue<ExpressionType> CloneType(const ExpressionValue<ExpressionType>& exprType) override;
 
 			ExpressionPtr Clone(AccessIdentifierExpression& node) override;
@@ -119,12 +136,16 @@ namespace nzsl::Ast
 			template<typename F> const IdentifierData* FindIdentifier(std::string_view identifierName, F&& functor) const;
 			const IdentifierData* FindIdentifier(const Environment& environment, std::string_view identifierName) const;
 			template<typename F> const IdentifierData* FindIdentifier(const Environment& environment, std::string_view identifierName, F&& functor) const;
+			template<typename F> const IdentifierData* FindIdentifier(const Environment& environment, Symbol identifierName, F&& functor) const;
 
+			std::shared_ptr<const BuiltinEnvironment> GetBuiltinEnvironment();
 			const ExpressionType* GetExpressionType(Expression& expr) const;
 			const ExpressionType& GetExpressionTypeSecure(Expression& expr) const;
 
 			ExpressionPtr HandleIdentifier(const IdentifierData* identifierData, const SourceLocation& sourceLocation);
 
+			ModulePtr ImportCachedModule(const Module& cachedModule, const ModuleRegistrations& registrations, const SourceLocation& sourceLocation);
+
 			bool IsFeatureEnabled(ModuleFeature feature) const;
 			bool IsIdentifierAvailable(std::string_view identifier, bool allowReserved = true) const;
 
@@ -141,18 +162,24 @@ namespace nzsl::Ast
 			void PreregisterIndices(const Module& module);
 			void PropagateFunctionRequirements(FunctionData& callingFunction, std::size_t calledFuncIndex, Nz::Bitset<>& seen);
 
-			void RegisterBuiltin();
+			void RegisterBuiltin(BuiltinEnvironment& builtins);
+			void RegisterBuiltinConstants();
 
 			std::size_t RegisterAlias(std::string name, std::optional<Identifier> aliasData, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
 			std::size_t RegisterConstant(std::string name, std::optional<ConstantValue> value, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
+			void RegisterExternalBinding(std::uint32_t bindingSet, std::uint32_t bindingIndex, std::uint32_t bindingCount, const SourceLocation& sourceLocation);
 			std::size_t RegisterExternalBlock(std::string name, std::size_t externalBlockIndex, const SourceLocation& sourceLocation);
+			// Checks the external variable name, push constant uniqueness and binding collisions (targetType is null when it's unresolved)
+			void RegisterExternalVariable(const std::string& internalName, const DeclareExternalStatement::ExternalVar& extVar, const ExpressionType* targetType);
 			std::size_t RegisterFunction(std::string name, std::optional<FunctionData> funcData, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
-			std::size_t RegisterIntrinsic(std::string name, IntrinsicType type);
+			void RegisterIdentifier(Identifier identifier);
+			std::size_t RegisterIntrinsic(BuiltinEnvironment& builtins, std::string name, IntrinsicType type);
 			std::size_t RegisterModule(std::string moduleIdentifier, std::size_t moduleIndex);
 			void RegisterReservedName(std::string name);
+			void RegisterResolvedExpression(Expression& expr);
 			std::size_t RegisterStruct(std::string name, std::optional<StructDescription*> description, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
-			std::size_t RegisterType(std::string name, std::optional<ExpressionType> expressionType, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
-			std::size_t RegisterType(std::string name, std::optional<PartialType> partialType, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
+			std::size_t RegisterType(BuiltinEnvironment& builtins, std::string name, std::optional<ExpressionType> expressionType, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
+			std::size_t RegisterType(BuiltinEnvironment& builtins, std::string name, std::optional<PartialType> partialType, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
 			void RegisterUnresolved(std::string name);
 			std::size_t RegisterVariable(std::string name, std::optional<ExpressionType> type, std::optional<std::size_t> index, const SourceLocation& sourceLocation);
 
@@ -162,9 +189,11 @@ namespace nzsl::Ast
 			ExpressionType ResolveType(const ExpressionType& exprType, bool resolveAlias, const SourceLocation& sourceLocation);
 			std::optional<ExpressionType> ResolveTypeExpr(const ExpressionValue<ExpressionType>& exprTypeValue, bool resolveAlias, const SourceLocation& sourceLocation);
 
-			MultiStatementPtr SanitizeInternal(MultiStatement& rootNode, std::string* error);
+			ModulePtr SanitizeInternal(const Module& module, bool consumeInput, bool keepResolvedExpressions, const Options& options, std::string* error);
+			MultiStatementPtr SanitizeInternal(MultiStatement& rootNode, bool consumeInput, std::string* error);
 			bool SanitizeIdentifier(std::string& identifier, IdentifierScope identifierScope);
 
+			Stringifier BuildStringifier(const SourceLocation& sourceLocation) const;
 			std::string ToString(const ExpressionType& exprType, const SourceLocation& sourceLocation) const;
 			std::string ToString(const NamedPartialType& partialType, const SourceLocation& sourceLocation) const;
 			template<typename... Args> std::string ToString(const std::variant<Args...>& value, const SourceLocation& sourceLocation) const;
@@ -236,7 +265,7 @@ namespace nzsl::Ast
 
 			struct Identifier
 			{
-				std::string name;
+				Symbol name;
 				IdentifierData target;
 			};
 
@@ -246,6 +275,10 @@ namespace nzsl::Ast
 
 	inline ModulePtr Sanitize(const Module& module, std::string* error = nullptr);
 	inline ModulePtr Sanitize(const Module& module, const SanitizeVisitor::Options& options, std::string* error = nullptr);
+	inline ModulePtr Sanitize(Module&& module, std::string* error = nullptr);
+	inline ModulePtr Sanitize(Module&& module, const SanitizeVisitor::Options& options, std::string* error = nullptr);
+	inline ModulePtr Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, std::string* error = nullptr);
+	inline ModulePtr Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, const SanitizeVisitor::Options& options, std::string* error = nullptr);
 }
 
 #include <NZSL/Ast/SanitizeVisitor.inl>
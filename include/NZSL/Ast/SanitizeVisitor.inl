@@ -9,6 +9,16 @@ namespace nzsl::Ast
 		return Sanitize(module, {}, error);
 	}
 
+	inline ModulePtr SanitizeVisitor::Sanitize(Module&& module, std::string* error)
+	{
+		return Sanitize(std::move(module), {}, error);
+	}
+
+	inline ModulePtr SanitizeVisitor::Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, std::string* error)
+	{
+		return Specialize(module, optionValues, {}, error);
+	}
+
 	inline ModulePtr Sanitize(const Module& module, std::string* error)
 	{
 		SanitizeVisitor sanitizer;
@@ -20,4 +30,28 @@ namespace nzsl::Ast
 		SanitizeVisitor sanitizer;
 		return sanitizer.Sanitize(module, options, error);
 	}
+
+	inline ModulePtr Sanitize(Module&& module, std::string* error)
+	{
+		SanitizeVisitor sanitizer;
+		return sanitizer.Sanitize(std::move(module), error);
+	}
+
+	inline ModulePtr Sanitize(Module&& module, const SanitizeVisitor::Options& options, std::string* error)
+	{
+		SanitizeVisitor sanitizer;
+		return sanitizer.Sanitize(std::move(module), options, error);
+	}
+
+	inline ModulePtr Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, std::string* error)
+	{
+		SanitizeVisitor sanitizer;
+		return sanitizer.Specialize(module, optionValues, error);
+	}
+
+	inline ModulePtr Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, const SanitizeVisitor::Options& options, std::string* error)
+	{
+		SanitizeVisitor sanitizer;
+		return sanitizer.Specialize(module, optionValues, options, error);
+	}
 }
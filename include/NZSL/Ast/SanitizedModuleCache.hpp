@@ -0,0 +1,88 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_AST_SANITIZEDMODULECACHE_HPP
+#define NZSL_AST_SANITIZEDMODULECACHE_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/ModuleResolver.hpp>
+#include <NZSL/Ast/ConstantValue.hpp>
+#include <NZSL/Ast/Enums.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <NZSL/Ast/Option.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nzsl::Ast
+{
+	// Keeps imported modules as sanitized by SanitizeVisitor so they don't have to be resolved again by every shader importing them
+	class NZSL_API SanitizedModuleCache
+	{
+		public:
+			struct CachedModule;
+			struct Key;
+
+			SanitizedModuleCache() = default;
+			// Entries of a module are invalidated as soon as the resolver signals it has been updated
+			explicit SanitizedModuleCache(ModuleResolver& moduleResolver);
+			SanitizedModuleCache(const SanitizedModuleCache&) = delete;
+			SanitizedModuleCache(SanitizedModuleCache&&) = delete;
+			~SanitizedModuleCache() = default;
+
+			void Clear();
+
+			CachedModule Find(const Module& module, const Key& key) const;
+
+			std::size_t GetEntryCount() const;
+
+			void Invalidate(const std::string& moduleName);
+
+			// Entries are tied to the module instance and expire once it's destroyed (e.g. when the resolver replaces an updated module)
+			void Register(const ModulePtr& module, Key key, CachedModule cachedModule);
+
+			SanitizedModuleCache& operator=(const SanitizedModuleCache&) = delete;
+			SanitizedModuleCache& operator=(SanitizedModuleCache&&) = delete;
+
+			struct CachedModule
+			{
+				ModulePtr sanitizedModule;
+				std::shared_ptr<const SanitizeVisitor::ModuleRegistrations> registrations; //< what the sanitizer registered for this module, so it can be imported again without being sanitized
+			};
+
+			struct Key
+			{
+				std::unordered_map<OptionHash, ConstantValue> optionValues;
+				std::vector<ModuleFeature> enabledFeatures;
+				std::uint64_t sanitizeFlags;
+
+				inline bool operator==(const Key& rhs) const;
+				inline bool operator!=(const Key& rhs) const;
+			};
+
+		private:
+			struct Entry
+			{
+				Key key;
+				std::weak_ptr<Module> module; //< doesn't keep the module alive, an expired entry can't match another module allocated at the same address
+				CachedModule cachedModule;
+			};
+
+			void RemoveExpiredEntries();
+
+			NazaraSlot(ModuleResolver, OnModuleUpdated, m_onModuleUpdated);
+
+			std::unordered_map<std::string, std::vector<Entry>> m_entriesByModuleName;
+			mutable std::mutex m_mutex;
+	};
+}
+
+#include <NZSL/Ast/SanitizedModuleCache.inl>
+
+#endif // NZSL_AST_SANITIZEDMODULECACHE_HPP
@@ -0,0 +1,17 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl::Ast
+{
+	inline bool SanitizedModuleCache::Key::operator==(const Key& rhs) const
+	{
+		return sanitizeFlags == rhs.sanitizeFlags && enabledFeatures == rhs.enabledFeatures && optionValues == rhs.optionValues;
+	}
+
+	inline bool SanitizedModuleCache::Key::operator!=(const Key& rhs) const
+	{
+		return !operator==(rhs);
+	}
+}
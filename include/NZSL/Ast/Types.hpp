@@ -30,7 +30,7 @@ namespace nzsl::Ast
 	{
 		std::vector<TypeParameterCategory> parameters;
 		std::vector<TypeParameterCategory> optParameters;
-		std::function<ExpressionType(const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation)> buildFunc;
+		std::function<ExpressionType(const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation, const Stringifier& stringifier)> buildFunc; //< stringifier names types in errors
 	};
 
 }
@@ -9,11 +9,18 @@
 
 #include <NazaraUtils/MovablePtr.hpp>
 #include <NZSL/Config.hpp>
+#include <NZSL/IncrementalParser.hpp>
 #include <NZSL/ModuleResolver.hpp>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace nzsl
 {
@@ -27,8 +34,14 @@ namespace nzsl
 			FilesystemModuleResolver(FilesystemModuleResolver&&) noexcept = delete;
 			~FilesystemModuleResolver();
 
+			// Only records which module each file (or archive entry) provides, modules are parsed on their first Resolve
+			// Watched files are indexed again when they change, or reloaded if their module was already resolved
+			void IndexDirectory(const std::filesystem::path& realPath, bool watchDirectory = false);
+			void IndexFile(const std::filesystem::path& realPath);
+
 			void RegisterArchive(const Archive& archive);
-			void RegisterDirectory(const std::filesystem::path& realPath, bool watchDirectory = false);
+			// Files are read and parsed by workerCount threads (0 for one per hardware thread) and registered in directory order
+			void RegisterDirectory(const std::filesystem::path& realPath, bool watchDirectory = false, unsigned int workerCount = 1);
 			void RegisterFile(const std::filesystem::path& realPath);
 			void RegisterModule(std::string_view moduleSource);
 			void RegisterModule(Ast::ModulePtr module);
@@ -42,7 +55,25 @@ namespace nzsl
 			static constexpr const char* BinaryModuleExtension = ".nzslb";
 			static constexpr const char* ModuleExtension = ".nzsl";
 
+			// Triggered when a watched source file is updated, with the declarations which changed since its previous version
+			// Like OnModuleUpdated, it's triggered once the resolver lock is released so that callbacks can resolve modules
+			NazaraSignal(OnModuleDeclarationsUpdated, FilesystemModuleResolver* /*resolver*/, const std::string& /*moduleName*/, const std::vector<std::string>& /*declarations*/);
+
 		private:
+			struct LazyModule;
+			struct LoadedFile;
+			struct PendingSignals;
+
+			// IndexModule, PublishLoadedFile and PublishModule expect m_moduleLock to be held, the signals they queue are triggered once it's released
+			void IndexModule(std::string moduleName, LazyModule lazyModule, PendingSignals& signals);
+			bool IsInIndexOnlyDirectory(const std::filesystem::path& canonicalPath) const;
+			LoadedFile LoadFile(const std::filesystem::path& realPath, bool reuseRegisteredModule = false);
+			void PublishLoadedFile(LoadedFile&& loadedFile, PendingSignals& signals);
+			void PublishModule(Ast::ModulePtr module, PendingSignals& signals);
+			void RegisterLoadedFile(LoadedFile&& loadedFile);
+			void TriggerSignals(const PendingSignals& signals);
+			void WatchDirectory(const std::filesystem::path& realPath);
+
 			void OnFileAdded(std::string_view directory, std::string_view filename);
 			void OnFileRemoved(std::string_view directory, std::string_view filename);
 			void OnFileMoved(std::string_view directory, std::string_view filename, std::string_view oldFilename);
@@ -50,9 +81,38 @@ namespace nzsl
 
 			static bool CheckExtension(std::string_view filename);
 
-			std::recursive_mutex m_moduleLock;
+			struct LazyModule
+			{
+				std::filesystem::path filePath;
+				std::shared_ptr<const Archive> archive;
+				std::size_t archiveModuleIndex = 0;
+			};
+
+			struct LoadedFile
+			{
+				Ast::ModulePtr module;
+				std::optional<std::vector<std::string>> changedDeclarations;
+				std::string canonicalPath;
+				std::string releasedModuleName; //< previous version handed over to the parser by the resolver, published again by PublishLoadedFile
+				std::vector<Ast::ModulePtr> archiveModules;
+				bool isIncrementallyParsed = false;
+			};
+
+			struct PendingSignals
+			{
+				std::vector<std::string> updatedModules;
+				std::vector<std::pair<std::string, std::vector<std::string>>> updatedDeclarations;
+			};
+
+			std::condition_variable m_moduleLoadedCondition;
+			std::mutex m_moduleLock;
 			std::unordered_map<std::string, std::string> m_moduleByFilepath;
+			std::unordered_map<std::string, IncrementalParser> m_parserByFilepath;
+			std::unordered_map<std::string, LazyModule> m_lazyModules;
 			std::unordered_map<std::string, Ast::ModulePtr> m_modules;
+			std::unordered_set<std::string> m_loadingModules; //< modules being loaded or reparsed outside of the lock, Resolve waits for them
+			std::unordered_set<std::string> m_unresolvedModules; //< incrementally parsed modules which Resolve never returned, only the resolver and their parser reference them
+			std::vector<std::filesystem::path> m_indexOnlyDirectories; //< watched directories registered through IndexDirectory
 			Nz::MovablePtr<void> m_fileWatcher;
 	};
 }
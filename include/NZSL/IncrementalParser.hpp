@@ -0,0 +1,72 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_INCREMENTALPARSER_HPP
+#define NZSL_INCREMENTALPARSER_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Lexer.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nzsl
+{
+	// Parses successive versions of a source file, only reparsing the root statements whose tokens changed since the previous version
+	// Unchanged statements are copied from the previous module, unless its owner hands it over to the parser
+	class NZSL_API IncrementalParser
+	{
+		public:
+			struct Result;
+
+			IncrementalParser() = default;
+			IncrementalParser(const IncrementalParser&) = delete;
+			IncrementalParser(IncrementalParser&&) noexcept = default;
+			~IncrementalParser() = default;
+
+			inline const Ast::ModulePtr& GetModule() const;
+
+			Result Parse(std::string_view source, const std::string& filePath = std::string{});
+			// previousModule has to be the last parsed module, nothing else may use it as its unchanged statements are moved to the new module
+			// (it's left untouched if parsing fails)
+			Result Parse(Ast::ModulePtr&& previousModule, std::string_view source, const std::string& filePath = std::string{});
+
+			void Reset();
+
+			IncrementalParser& operator=(const IncrementalParser&) = delete;
+			IncrementalParser& operator=(IncrementalParser&&) noexcept = default;
+
+			struct Result
+			{
+				Ast::ModulePtr module;
+				std::vector<std::string> changedDeclarations; //< declarations added, modified or removed since the previous version (every declaration on a full reparse)
+				bool fullReparse;
+			};
+
+		private:
+			struct RootChunk
+			{
+				std::size_t firstToken;
+				std::size_t tokenCount;
+				std::size_t hash;
+			};
+
+			Result ParseInternal(std::string_view source, const std::string& filePath, bool movePreviousStatements);
+
+			static bool SplitRootStatements(const std::vector<Token>& tokens, std::size_t& headerTokenCount, std::vector<RootChunk>& chunks);
+
+			Ast::ModulePtr m_module;
+			std::size_t m_headerTokenCount = 0; //< zero when the previous version cannot be reused
+			std::vector<char> m_source;
+			std::vector<RootChunk> m_chunks;
+			std::vector<Token> m_tokens;
+	};
+}
+
+#include <NZSL/IncrementalParser.inl>
+
+#endif // NZSL_INCREMENTALPARSER_HPP
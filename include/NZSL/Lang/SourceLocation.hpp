@@ -8,21 +8,32 @@
 #define NZSL_LANG_SOURCELOCATION_HPP
 
 #include <NZSL/Config.hpp>
-#include <memory>
-#include <string>
+#include <cstdint>
+#include <string_view>
 
 namespace nzsl
 {
+	using SourceFileId = std::uint32_t;
+
+	constexpr SourceFileId InvalidSourceFileId = 0;
+
+	// Source files are registered once per process, registering the same path twice returns the same id
+	NZSL_API SourceFileId RegisterSourceFile(std::string_view filePath);
+	NZSL_API std::string_view GetSourceFilePath(SourceFileId fileId);
+
 	struct SourceLocation
 	{
 		inline SourceLocation();
-		inline SourceLocation(unsigned int line, unsigned int column, std::shared_ptr<const std::string> file);
-		inline SourceLocation(unsigned int line, unsigned int startColumn, unsigned int endColumn, std::shared_ptr<const std::string> file);
-		inline SourceLocation(unsigned int startLine, unsigned int endLine, unsigned int startColumn, unsigned int endColumn, std::shared_ptr<const std::string> file);
+		inline SourceLocation(unsigned int line, unsigned int column, SourceFileId file);
+		inline SourceLocation(unsigned int line, unsigned int startColumn, unsigned int endColumn, SourceFileId file);
+		inline SourceLocation(unsigned int startLine, unsigned int endLine, unsigned int startColumn, unsigned int endColumn, SourceFileId file);
 
 		inline void ExtendToLeft(const SourceLocation& leftLocation);
 		inline void ExtendToRight(const SourceLocation& rightLocation);
 
+		inline std::string_view GetFilePath() const;
+
+		inline bool HasFile() const;
 		inline bool IsValid() const;
 
 		bool operator==(const SourceLocation& other) const;
@@ -30,7 +41,7 @@ namespace nzsl
 
 		static inline SourceLocation BuildFromTo(const SourceLocation& leftSource, const SourceLocation& rightSource);
 
-		std::shared_ptr<const std::string> file; //< Since the same file will be used for every node, prevent storing X time the same path
+		SourceFileId fileId; //< InvalidSourceFileId if the location isn't attached to a file
 		std::uint32_t endColumn;
 		std::uint32_t endLine;
 		std::uint32_t startColumn;
@@ -7,6 +7,7 @@
 namespace nzsl
 {
 	inline SourceLocation::SourceLocation() :
+	fileId(InvalidSourceFileId),
 	endColumn(0),
 	endLine(0),
 	startColumn(0),
@@ -14,8 +15,8 @@ namespace nzsl
 	{
 	}
 
-	inline SourceLocation::SourceLocation(unsigned int Line, unsigned int Column, std::shared_ptr<const std::string> File) :
-	file(std::move(File)),
+	inline SourceLocation::SourceLocation(unsigned int Line, unsigned int Column, SourceFileId File) :
+	fileId(File),
 	endColumn(Column),
 	endLine(Line),
 	startColumn(Column),
@@ -23,8 +24,8 @@ namespace nzsl
 	{
 	}
 
-	inline SourceLocation::SourceLocation(unsigned int Line, unsigned int StartColumn, unsigned int EndColumn, std::shared_ptr<const std::string> File) :
-	file(std::move(File)),
+	inline SourceLocation::SourceLocation(unsigned int Line, unsigned int StartColumn, unsigned int EndColumn, SourceFileId File) :
+	fileId(File),
 	endColumn(EndColumn),
 	endLine(Line),
 	startColumn(StartColumn),
@@ -32,8 +33,8 @@ namespace nzsl
 	{
 	}
 
-	inline SourceLocation::SourceLocation(unsigned int StartLine, unsigned int EndLine, unsigned int StartColumn, unsigned int EndColumn, std::shared_ptr<const std::string> File) :
-	file(std::move(File)),
+	inline SourceLocation::SourceLocation(unsigned int StartLine, unsigned int EndLine, unsigned int StartColumn, unsigned int EndColumn, SourceFileId File) :
+	fileId(File),
 	endColumn(EndColumn),
 	endLine(EndLine),
 	startColumn(StartColumn),
@@ -43,7 +44,7 @@ namespace nzsl
 
 	inline void SourceLocation::ExtendToLeft(const SourceLocation& leftLocation)
 	{
-		assert(file == leftLocation.file);
+		assert(fileId == leftLocation.fileId);
 		assert(leftLocation.startLine <= endLine);
 		startLine = leftLocation.startLine;
 		assert(leftLocation.startLine < endLine || leftLocation.startColumn <= endColumn);
@@ -52,7 +53,7 @@ namespace nzsl
 
 	inline void SourceLocation::ExtendToRight(const SourceLocation& rightLocation)
 	{
-		assert(file == rightLocation.file);
+		assert(fileId == rightLocation.fileId);
 		assert(rightLocation.endLine >= startLine);
 		endLine = rightLocation.endLine;
 		assert(rightLocation.endLine > startLine || rightLocation.endColumn >= startColumn);
@@ -61,12 +62,12 @@ namespace nzsl
 
 	inline SourceLocation SourceLocation::BuildFromTo(const SourceLocation& leftSource, const SourceLocation& rightSource)
 	{
-		assert(leftSource.file == rightSource.file);
+		assert(leftSource.fileId == rightSource.fileId);
 		assert(leftSource.startLine <= rightSource.endLine);
 		assert(leftSource.startLine < rightSource.endLine || leftSource.startColumn <= rightSource.endColumn);
 
 		SourceLocation sourceLoc;
-		sourceLoc.file = leftSource.file;
+		sourceLoc.fileId = leftSource.fileId;
 		sourceLoc.startLine = leftSource.startLine;
 		sourceLoc.startColumn = leftSource.startColumn;
 		sourceLoc.endLine = rightSource.endLine;
@@ -75,6 +76,16 @@ namespace nzsl
 		return sourceLoc;
 	}
 
+	inline std::string_view SourceLocation::GetFilePath() const
+	{
+		return GetSourceFilePath(fileId);
+	}
+
+	inline bool SourceLocation::HasFile() const
+	{
+		return fileId != InvalidSourceFileId;
+	}
+
 	inline bool SourceLocation::IsValid() const
 	{
 		return startLine != 0 || endLine != 0 || endColumn != 0 || startColumn != 0;
@@ -82,7 +93,7 @@ namespace nzsl
 
 	inline bool SourceLocation::operator==(const SourceLocation& other) const
 	{
-		return file == other.file && endColumn == other.endColumn && endLine == other.endLine && startColumn == other.startColumn && startLine == other.startLine;
+		return fileId == other.fileId && endColumn == other.endColumn && endLine == other.endLine && startColumn == other.startColumn && startLine == other.startLine;
 	}
 
 	inline bool SourceLocation::operator!=(const SourceLocation& other) const
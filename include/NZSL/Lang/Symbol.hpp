@@ -0,0 +1,56 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_LANG_SYMBOL_HPP
+#define NZSL_LANG_SYMBOL_HPP
+
+#include <NZSL/Config.hpp>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace nzsl
+{
+	// Interned identifier, every distinct name is stored once per process and symbols with the same name share the same id
+	// Only used for the identifiers in scope of the sanitizer, tokens reference the source and AST nodes and writers keep plain names
+	// Interned names are never released, the table grows with the number of distinct identifiers seen by the process
+	// Each thread keeps a cache of the symbols it already looked up, only the first lookup of a name by a thread takes the table lock
+	class NZSL_API Symbol
+	{
+		public:
+			Symbol() = default;
+			explicit Symbol(std::string_view name);
+			Symbol(const Symbol&) = default;
+			~Symbol() = default;
+
+			inline std::uint32_t GetId() const;
+			inline std::string_view GetName() const;
+
+			inline bool IsValid() const;
+
+			Symbol& operator=(const Symbol&) = default;
+
+			inline bool operator==(const Symbol& symbol) const;
+			inline bool operator!=(const Symbol& symbol) const;
+
+			// Returns an invalid symbol if name was never interned (and doesn't intern it)
+			static Symbol Find(std::string_view name);
+			// Returns an invalid symbol if no name was interned with this id
+			static Symbol FromId(std::uint32_t id);
+
+			static constexpr std::uint32_t InvalidId = 0xFFFFFFFF;
+
+		private:
+			inline Symbol(std::uint32_t id, std::string_view name);
+
+			std::string_view m_name; //< points to the symbol table storage, valid until the end of the process
+			std::uint32_t m_id = InvalidId;
+	};
+}
+
+#include <NZSL/Lang/Symbol.inl>
+
+#endif // NZSL_LANG_SYMBOL_HPP
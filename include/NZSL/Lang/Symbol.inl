@@ -0,0 +1,49 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+namespace nzsl
+{
+	inline Symbol::Symbol(std::uint32_t id, std::string_view name) :
+	m_name(name),
+	m_id(id)
+	{
+	}
+
+	inline std::uint32_t Symbol::GetId() const
+	{
+		return m_id;
+	}
+
+	inline std::string_view Symbol::GetName() const
+	{
+		return m_name;
+	}
+
+	inline bool Symbol::IsValid() const
+	{
+		return m_id != InvalidId;
+	}
+
+	inline bool Symbol::operator==(const Symbol& symbol) const
+	{
+		return m_id == symbol.m_id;
+	}
+
+	inline bool Symbol::operator!=(const Symbol& symbol) const
+	{
+		return !operator==(symbol);
+	}
+}
+
+namespace std
+{
+	template<>
+	struct hash<nzsl::Symbol>
+	{
+		std::size_t operator()(const nzsl::Symbol& symbol) const
+		{
+			return symbol.GetId();
+		}
+	};
+}
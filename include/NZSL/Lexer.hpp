@@ -12,6 +12,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -24,18 +25,62 @@ namespace nzsl
 #include <NZSL/Lang/TokenList.hpp>
 	};
 
+	// Identifiers and string literals reference the lexed source buffer, which has to outlive the tokens
 	struct Token
+	{
+		SourceLocation location;
+		TokenType type;
+		std::variant<double, long long, std::string_view> data;
+	};
+
+	// Token owning its identifier or string literal, which can be stored independently of the source
+	// Unlike Token, string literals are stored unescaped
+	struct OwningToken
 	{
 		SourceLocation location;
 		TokenType type;
 		std::variant<double, long long, std::string> data;
 	};
 
+	// Pull-based tokenizer, str has to outlive the lexer and every token it returns
+	class NZSL_API Lexer
+	{
+		public:
+			Lexer(std::string_view str, const std::string& filePath = std::string{});
+			Lexer(const Lexer&) = delete;
+			Lexer(Lexer&&) noexcept = default;
+			~Lexer() = default;
+
+			// Returns EndOfStream once the end of the source is reached (and on every subsequent call)
+			Token Next();
+
+			Lexer& operator=(const Lexer&) = delete;
+			Lexer& operator=(Lexer&&) noexcept = default;
+
+		private:
+			std::size_t m_currentPos;
+			std::size_t m_lineStartPos;
+			std::string m_literalTemp;
+			std::string_view m_source;
+			std::uint32_t m_currentLine;
+			SourceFileId m_currentFile;
+	};
+
 	NZSL_API std::string EscapeString(std::string_view str, bool quote = true);
+	NZSL_API std::string UnescapeString(std::string_view str);
+
+	NZSL_API OwningToken ToOwningToken(const Token& token);
+	// The returned token references the owning token data, string literals stay unescaped
+	NZSL_API Token ToToken(const OwningToken& token);
 
+	// Identifier and string literal tokens reference str instead of copying it, str has to outlive the returned tokens
 	NZSL_API std::vector<Token> Tokenize(std::string_view str, const std::string& filePath = std::string{});
+	// Copies identifiers and string literals into the tokens, for callers which can't keep the source alive
+	NZSL_API std::vector<OwningToken> TokenizeOwning(std::string_view str, const std::string& filePath = std::string{});
+
 	NZSL_API const char* ToString(TokenType tokenType);
 	NZSL_API std::string ToString(const std::vector<Token>& tokens, bool pretty = true);
+	NZSL_API std::string ToString(const std::vector<OwningToken>& tokens, bool pretty = true);
 }
 
 #include <NZSL/Lexer.inl>
@@ -11,6 +11,7 @@
 #include <NZSL/Enums.hpp>
 #include <NZSL/Lexer.hpp>
 #include <NZSL/Ast/Module.hpp>
+#include <deque>
 #include <filesystem>
 #include <optional>
 
@@ -22,7 +23,9 @@ namespace nzsl
 			inline Parser();
 			~Parser() = default;
 
-			Ast::ModulePtr Parse(const std::vector<Token>& tokens);
+			Ast::ModulePtr Parse(const std::vector<Token>& tokens, std::vector<std::size_t>* rootStatementEnds = nullptr);
+			Ast::ModulePtr Parse(const std::vector<OwningToken>& tokens);
+			Ast::ModulePtr Parse(Lexer& lexer);
 
 			static std::string_view ToString(Ast::AttributeType attributeType);
 			static std::string_view ToString(Ast::BuiltinEntry builtinEntry);
@@ -48,7 +51,9 @@ namespace nzsl
 			const Token& ExpectNot(const Token& token, TokenType type);
 			const Token& Expect(TokenType type);
 			const Token& Peek(std::size_t advance = 0);
+			void ReleaseConsumedTokens();
 
+			Ast::ModulePtr ParseModule();
 			std::vector<Attribute> ParseAttributes();
 			void ParseModuleStatement(std::vector<Attribute> attributes);
 			void ParseVariableDeclaration(std::string& name, Ast::ExpressionValue<Ast::ExpressionType>& type, Ast::ExpressionPtr& initialValue, SourceLocation& sourceLocation);
@@ -94,7 +99,7 @@ namespace nzsl
 			Ast::ExpressionPtr ParsePrimaryExpression();
 			Ast::ExpressionPtr ParseStringExpression();
 
-			const std::string& ParseIdentifierAsName(SourceLocation* sourceLocation);
+			std::string ParseIdentifierAsName(SourceLocation* sourceLocation);
 			std::string ParseModuleName(SourceLocation* sourceLocation);
 			Ast::ExpressionPtr ParseType();
 
@@ -108,10 +113,13 @@ namespace nzsl
 
 			struct Context
 			{
-				std::size_t tokenCount;
+				std::deque<Token> tokenBuffer; //< tokens pulled from the lexer and not released yet
+				std::size_t tokenCount = 0;
 				std::size_t tokenIndex = 0;
 				Ast::ModulePtr module;
-				const Token* tokens;
+				Lexer* lexer = nullptr;
+				const Token* tokens = nullptr;
+				std::vector<std::size_t>* rootStatementEnds = nullptr; //< token index following each root statement
 				bool parsingImportedModule = false;
 			};
 
@@ -120,6 +128,7 @@ namespace nzsl
 
 	inline Ast::ModulePtr Parse(std::string_view source, const std::string& filePath = std::string{});
 	inline Ast::ModulePtr Parse(const std::vector<Token>& tokens);
+	inline Ast::ModulePtr Parse(const std::vector<OwningToken>& tokens);
 	NZSL_API Ast::ModulePtr ParseFromFile(const std::filesystem::path& sourcePath);
 }
 
@@ -12,7 +12,10 @@ namespace nzsl
 
 	inline Ast::ModulePtr Parse(std::string_view source, const std::string& filePath)
 	{
-		return Parse(Tokenize(source, filePath));
+		Lexer lexer(source, filePath);
+
+		Parser parser;
+		return parser.Parse(lexer);
 	}
 
 	inline Ast::ModulePtr Parse(const std::vector<Token>& tokens)
@@ -20,4 +23,10 @@ namespace nzsl
 		Parser parser;
 		return parser.Parse(tokens);
 	}
+
+	inline Ast::ModulePtr Parse(const std::vector<OwningToken>& tokens)
+	{
+		Parser parser;
+		return parser.Parse(tokens);
+	}
 }
@@ -0,0 +1,102 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_PERMUTATIONCOMPILER_HPP
+#define NZSL_PERMUTATIONCOMPILER_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/GlslWriter.hpp>
+#include <NZSL/ShaderWriter.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/Ast/ConstantValue.hpp>
+#include <NZSL/Ast/Module.hpp>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nzsl
+{
+	// Compiles every combination of an option matrix for a set of targets, identical outputs are only stored once
+	class NZSL_API PermutationCompiler
+	{
+		public:
+			struct Blob;
+			struct OptionValues;
+			struct Output;
+			struct Parameters;
+			struct Target;
+			struct Variant;
+
+			enum class Backend
+			{
+				GLSL,
+				SPIRV
+			};
+
+			PermutationCompiler() = default;
+			PermutationCompiler(const PermutationCompiler&) = delete;
+			PermutationCompiler(PermutationCompiler&&) = delete;
+			~PermutationCompiler() = default;
+
+			Output Compile(const Ast::Module& module, const Parameters& parameters);
+
+			PermutationCompiler& operator=(const PermutationCompiler&) = delete;
+			PermutationCompiler& operator=(PermutationCompiler&&) = delete;
+
+			static inline std::size_t GetCombinationCount(const std::vector<OptionValues>& optionMatrix);
+
+			struct Blob
+			{
+				std::uint64_t hash;
+				std::vector<std::uint8_t> data; //< GLSL code or SPIR-V words
+			};
+
+			struct OptionValues
+			{
+				std::string optionName;
+				std::vector<Ast::ConstantValue> values;
+			};
+
+			struct Parameters
+			{
+				ShaderWriter::States states; //< optionValues are used for options which are not part of the matrix
+				std::vector<OptionValues> optionMatrix;
+				std::vector<Target> targets;
+				unsigned int workerCount = 0; //< 0 for one per hardware thread
+				bool pruneIrrelevantOptions = false; //< combinations only differing by options which can't affect a target are compiled once for it
+				bool mapGlslBindings = false; //< GLSL targets use a binding mapping covering the externals of every combination instead of their own parameters
+			};
+
+			struct Target
+			{
+				Backend backend;
+				std::optional<ShaderStageType> shaderStage; //< GLSL only, a SPIR-V module holds every entry point
+				GlslWriter::Environment glslEnv;
+				GlslWriter::Parameters glslParameters;
+				SpirvWriter::Environment spirvEnv;
+			};
+
+			struct Variant
+			{
+				std::size_t blobIndex;
+				std::size_t targetIndex;
+				std::vector<std::size_t> optionValueIndices; //< index in OptionValues::values of each option of the matrix
+			};
+
+			struct Output
+			{
+				std::size_t generatedVariantCount; //< variants which were actually compiled, others are known to match one of them
+				GlslWriter::Parameters glslParameters; //< binding mapping used by GLSL targets when mapGlslBindings is set
+				std::vector<Blob> blobs;
+				std::vector<Variant> variants; //< ordered by combination then by target, the last option of the matrix varying first
+			};
+	};
+}
+
+#include <NZSL/PermutationCompiler.inl>
+
+#endif // NZSL_PERMUTATIONCOMPILER_HPP
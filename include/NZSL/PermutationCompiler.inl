@@ -0,0 +1,15 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+namespace nzsl
+{
+	inline std::size_t PermutationCompiler::GetCombinationCount(const std::vector<OptionValues>& optionMatrix)
+	{
+		std::size_t combinationCount = 1;
+		for (const OptionValues& optionValues : optionMatrix)
+			combinationCount *= optionValues.values.size();
+
+		return combinationCount;
+	}
+}
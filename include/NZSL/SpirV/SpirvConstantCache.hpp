@@ -24,6 +24,7 @@ namespace nzsl
 {
 	class FieldOffsets;
 	class SpirvSection;
+	class SpirvTypeCache;
 	class SpirvWriter;
 
 	class NZSL_API SpirvConstantCache
@@ -141,6 +142,13 @@ namespace nzsl
 
 			using AnyConstant = std::variant<ConstantBool, ConstantComposite, ConstantScalar>;
 
+			struct SpecConstant
+			{
+				std::string debugName;
+				ConstantPtr defaultValue; //< scalar constant
+				std::uint32_t specId;
+			};
+
 			struct Variable
 			{
 				std::optional<std::size_t> funcId; //< For inputs/outputs
@@ -206,6 +214,7 @@ namespace nzsl
 
 			std::uint32_t Register(std::string debugString);
 			std::uint32_t Register(Constant c);
+			std::uint32_t Register(SpecConstant c);
 			std::uint32_t Register(Type t);
 			std::uint32_t Register(Variable v);
 			
@@ -227,6 +236,7 @@ namespace nzsl
 			std::size_t RegisterArrayField(FieldOffsets& fieldOffsets, const Void& type, std::size_t arrayLength) const;
 
 			void SetStructCallback(StructCallback callback);
+			void SetTypeCache(std::shared_ptr<SpirvTypeCache> typeCache);
 
 			void Write(SpirvSection& annotations, SpirvSection& constants, SpirvSection& debugInfos, DebugLevel debugInfo);
 
@@ -236,6 +246,7 @@ namespace nzsl
 			static TypePtr GetIndexedType(const Type& typeHolder, std::int32_t index = -1);
 
 		private:
+			struct AnyHasher;
 			struct DepRegisterer;
 			struct LayoutVisitor;
 			struct Eq;
@@ -244,7 +255,7 @@ namespace nzsl
 
 			template<typename T> static Type BuildSingleType();
 
-			void Write(const AnyConstant& constant, std::uint32_t resultId, SpirvSection& constants);
+			void Write(const AnyConstant& constant, std::uint32_t resultId, SpirvSection& constants, bool isSpecConstant);
 			void Write(const AnyType& type, std::uint32_t resultId, SpirvSection& annotations, SpirvSection& constants, SpirvSection& debugInfos, DebugLevel debugInfo);
 
 			void WriteStruct(const Structure& structData, std::uint32_t resultId, SpirvSection& annotations, SpirvSection& constants, SpirvSection& debugInfos, DebugLevel debugInfo);
@@ -7,6 +7,7 @@
 #ifndef NZSL_SPIRV_SPIRVDECODER_HPP
 #define NZSL_SPIRV_SPIRVDECODER_HPP
 
+#include <NazaraUtils/FunctionRef.hpp>
 #include <NZSL/Config.hpp>
 #include <NZSL/SpirV/SpirvData.hpp>
 #include <functional>
@@ -31,11 +32,17 @@ namespace nzsl
 		protected:
 			struct SpirvHeader;
 
+			using OperandCallback = Nz::FunctionRef<void(const SpirvOperand& operand, const std::uint32_t* words, std::size_t wordCount)>;
+
+			inline void ForEachOperand(const SpirvInstruction& instruction, const OperandCallback& callback);
+			void ForEachOperand(const SpirvOperand* operands, std::size_t minOperandCount, const OperandCallback& callback);
+
 			inline const std::uint32_t* GetCurrentPtr() const;
 
 			virtual bool HandleHeader(const SpirvHeader& header);
 			virtual bool HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount) = 0;
 
+			void ReadOperand(const SpirvOperand& operand, const OperandCallback& callback);
 			std::string ReadString();
 			std::uint32_t ReadWord();
 
@@ -50,8 +57,11 @@ namespace nzsl
 			};
 
 		private:
+			void SkipString();
+
 			const std::uint32_t* m_currentCodepoint;
 			const std::uint32_t* m_codepointEnd;
+			const std::uint32_t* m_instructionEnd;
 	};
 }
 
@@ -5,6 +5,11 @@
 
 namespace nzsl
 {
+	inline void SpirvDecoder::ForEachOperand(const SpirvInstruction& instruction, const OperandCallback& callback)
+	{
+		ForEachOperand(instruction.operands, instruction.minOperandCount, callback);
+	}
+
 	inline const std::uint32_t* SpirvDecoder::GetCurrentPtr() const
 	{
 		return m_currentCodepoint;
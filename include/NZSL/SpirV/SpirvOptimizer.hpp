@@ -0,0 +1,58 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_SPIRV_SPIRVOPTIMIZER_HPP
+#define NZSL_SPIRV_SPIRVOPTIMIZER_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/SpirV/SpirvDecoder.hpp>
+#include <vector>
+
+namespace nzsl
+{
+	// Lightweight binary optimizer, working on module-level ids only (function bodies are kept as-is)
+	class NZSL_API SpirvOptimizer : SpirvDecoder
+	{
+		public:
+			struct Settings;
+
+			inline SpirvOptimizer();
+			SpirvOptimizer(const SpirvOptimizer&) = default;
+			SpirvOptimizer(SpirvOptimizer&&) = default;
+			~SpirvOptimizer() = default;
+
+			inline std::vector<std::uint32_t> Optimize(const std::vector<std::uint32_t>& codepoints);
+			inline std::vector<std::uint32_t> Optimize(const std::uint32_t* codepoints, std::size_t count);
+			inline std::vector<std::uint32_t> Optimize(const std::vector<std::uint32_t>& codepoints, const Settings& settings);
+			std::vector<std::uint32_t> Optimize(const std::uint32_t* codepoints, std::size_t count, const Settings& settings);
+
+			SpirvOptimizer& operator=(const SpirvOptimizer&) = default;
+			SpirvOptimizer& operator=(SpirvOptimizer&&) = default;
+
+			struct Settings
+			{
+				bool compactIds = true; //< renumber ids so they're dense, minimizing the bound
+				bool mergeDuplicates = true; //< merge identical undecorated types and constants
+				bool removeUnused = true; //< remove unreferenced types, constants and strings along with their names and decorations
+			};
+
+		private:
+			struct Instruction;
+
+			bool HandleHeader(const SpirvHeader& header) override;
+			bool HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount) override;
+
+			void MergeDuplicates(std::vector<std::uint32_t>& remappedIds);
+			void RemoveUnused(const std::vector<std::uint32_t>& remappedIds);
+
+			struct State;
+			State* m_currentState;
+	};
+}
+
+#include <NZSL/SpirV/SpirvOptimizer.inl>
+
+#endif // NZSL_SPIRV_SPIRVOPTIMIZER_HPP
@@ -42,7 +42,7 @@ namespace nzsl
 		private:
 			bool HandleHeader(const SpirvHeader& header) override;
 			bool HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount) override;
-			void PrintOperand(std::ostream& instructionStream, const SpirvOperand* operand);
+			static void PrintOperand(std::ostream& instructionStream, const SpirvOperand& operand, const std::uint32_t* words, std::size_t wordCount);
 
 			enum class ExtensionSet
 			{
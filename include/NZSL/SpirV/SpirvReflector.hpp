@@ -0,0 +1,164 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_SPIRV_SPIRVREFLECTOR_HPP
+#define NZSL_SPIRV_SPIRVREFLECTOR_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Ast/Enums.hpp>
+#include <NZSL/Math/Vector.hpp>
+#include <NZSL/SpirV/SpirvDecoder.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nzsl
+{
+	// Extracts the interface of a SPIR-V module (bindings, push constants, entry points) without its source
+	class NZSL_API SpirvReflector : SpirvDecoder
+	{
+		public:
+			struct Reflection;
+
+			inline SpirvReflector();
+			SpirvReflector(const SpirvReflector&) = default;
+			SpirvReflector(SpirvReflector&&) = default;
+			~SpirvReflector() = default;
+
+			inline Reflection Reflect(const std::vector<std::uint32_t>& codepoints);
+			Reflection Reflect(const std::uint32_t* codepoints, std::size_t count);
+
+			SpirvReflector& operator=(const SpirvReflector&) = default;
+			SpirvReflector& operator=(SpirvReflector&&) = default;
+
+			enum class BindingType
+			{
+				CombinedImageSampler,
+				Sampler,
+				SampledImage,
+				StorageBuffer,
+				StorageImage,
+				UniformBuffer,
+				Unknown
+			};
+
+			struct BlockMember
+			{
+				std::string name;
+				std::uint32_t offset;
+				std::uint32_t size;
+			};
+
+			struct Binding
+			{
+				std::string name;
+				std::uint32_t id;
+				std::uint32_t bindingIndex;
+				std::uint32_t bindingSet;
+				std::uint32_t arraySize; //< 1 if not an array, 0 for runtime arrays
+				std::uint32_t size; //< block size in bytes, 0 for non-buffer bindings
+				BindingType type;
+			};
+
+			struct PushConstantBlock
+			{
+				std::string name;
+				std::vector<BlockMember> members;
+				std::uint32_t id;
+				std::uint32_t size;
+			};
+
+			struct InterfaceVariable
+			{
+				std::string name;
+				std::optional<Ast::PrimitiveType> componentType; //< not set for composite types (structs, arrays, matrices)
+				std::optional<SpirvBuiltIn> builtin;
+				std::optional<std::uint32_t> location;
+				std::uint32_t componentCount;
+				std::uint32_t id;
+			};
+
+			struct EntryPoint
+			{
+				std::string name;
+				std::optional<Vector3u32> localSize;
+				std::vector<InterfaceVariable> inputs;
+				std::vector<InterfaceVariable> outputs;
+				std::vector<SpirvExecutionMode> executionModes;
+				std::uint32_t id;
+				SpirvExecutionModel executionModel;
+			};
+
+			struct Reflection
+			{
+				std::vector<Binding> bindings;
+				std::vector<EntryPoint> entryPoints;
+				std::vector<PushConstantBlock> pushConstantBlocks;
+			};
+
+		private:
+			static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFF;
+
+			struct IdInfo
+			{
+				const std::uint32_t* instruction = nullptr; //< type or constant declaration
+				const std::uint32_t* nameInstruction = nullptr;
+				std::optional<SpirvBuiltIn> builtin;
+				std::optional<std::uint32_t> location;
+				std::uint32_t arrayStride = 0;
+				std::uint32_t bindingIndex = 0;
+				std::uint32_t bindingSet = 0;
+				std::uint32_t firstMember = InvalidIndex;
+				bool isBufferBlock = false;
+			};
+
+			struct MemberInfo
+			{
+				const std::uint32_t* nameInstruction = nullptr;
+				std::uint32_t index;
+				std::uint32_t matrixStride = 0;
+				std::uint32_t nextMember;
+				std::uint32_t offset = InvalidIndex;
+				bool isRowMajor = false;
+			};
+
+			bool HandleHeader(const SpirvHeader& header) override;
+			bool HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount) override;
+
+			void RegisterInterfaceVariable(std::uint32_t variableId, std::uint32_t typeId, SpirvStorageClass storageClass);
+			void RegisterResourceVariable(std::uint32_t variableId, std::uint32_t typeId, SpirvStorageClass storageClass);
+
+			std::uint32_t ComputeTypeSize(std::uint32_t typeId, const MemberInfo* memberInfo) const;
+			EntryPoint& GetEntryPoint(std::uint32_t entryPointId);
+			IdInfo& GetIdInfo(std::uint32_t id);
+			const IdInfo& GetIdInfo(std::uint32_t id) const;
+			const std::uint32_t* GetInstruction(std::uint32_t id, std::size_t minWordCount) const;
+			MemberInfo& GetMemberInfo(std::uint32_t structId, std::uint32_t memberIndex);
+			const MemberInfo* FindMemberInfo(std::uint32_t structId, std::uint32_t memberIndex) const;
+			std::string GetName(std::uint32_t id) const;
+			Vector3u32 ResolveConstantVector(const std::uint32_t* constantIds) const;
+			std::uint32_t ResolveConstantValue(std::uint32_t constantId) const;
+
+			struct EntryPointInterface
+			{
+				const std::uint32_t* begin;
+				const std::uint32_t* end;
+			};
+
+			// Scratch data, kept between calls so reflecting many modules doesn't reallocate it
+			std::vector<EntryPointInterface> m_entryPointInterfaces;
+			std::vector<IdInfo> m_ids;
+			std::vector<MemberInfo> m_members;
+			std::vector<const std::uint32_t*> m_localSizeIdInstructions;
+			const std::uint32_t* m_codepointEnd;
+			Reflection* m_reflection;
+			std::uint32_t m_workgroupSizeId;
+	};
+}
+
+#include <NZSL/SpirV/SpirvReflector.inl>
+
+#endif // NZSL_SPIRV_SPIRVREFLECTOR_HPP
@@ -0,0 +1,19 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl
+{
+	inline SpirvReflector::SpirvReflector() :
+	m_codepointEnd(nullptr),
+	m_reflection(nullptr),
+	m_workgroupSizeId(0)
+	{
+	}
+
+	inline auto SpirvReflector::Reflect(const std::vector<std::uint32_t>& codepoints) -> Reflection
+	{
+		return Reflect(codepoints.data(), codepoints.size());
+	}
+}
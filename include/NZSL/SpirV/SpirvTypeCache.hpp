@@ -0,0 +1,86 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#pragma once
+
+#ifndef NZSL_SPIRV_SPIRVTYPECACHE_HPP
+#define NZSL_SPIRV_SPIRVTYPECACHE_HPP
+
+#include <NZSL/Config.hpp>
+#include <NZSL/Enums.hpp>
+#include <NZSL/Ast/ConstantValue.hpp>
+#include <NZSL/Ast/ExpressionType.hpp>
+#include <NZSL/SpirV/SpirvConstantCache.hpp>
+#include <array>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace nzsl
+{
+	// Keeps SPIR-V type and constant descriptions built by SpirvConstantCache so successive generations (stages, permutations) don't have to build them again
+	// Only descriptions which don't depend on the module (struct-free types and single constants) are kept, ids are still assigned by each generation
+	class NZSL_API SpirvTypeCache
+	{
+		friend SpirvConstantCache;
+
+		public:
+			SpirvTypeCache() = default;
+			SpirvTypeCache(const SpirvTypeCache&) = delete;
+			SpirvTypeCache(SpirvTypeCache&&) = delete;
+			~SpirvTypeCache() = default;
+
+			void Clear();
+
+			std::size_t GetEntryCount() const;
+
+			SpirvTypeCache& operator=(const SpirvTypeCache&) = delete;
+			SpirvTypeCache& operator=(SpirvTypeCache&&) = delete;
+
+		private:
+			struct ConstantKey
+			{
+				std::size_t valueIndex;
+				std::array<std::uint64_t, 4> components; //< bitwise, so 0.0 and -0.0 are different constants
+
+				inline bool operator==(const ConstantKey& rhs) const;
+			};
+
+			struct ConstantKeyHasher
+			{
+				std::size_t operator()(const ConstantKey& key) const;
+			};
+
+			struct TypeKey
+			{
+				Ast::ExpressionType type;
+				std::optional<StructLayout> blockLayout; //< only set for arrays, as it changes their stride
+				std::size_t hash;
+
+				inline bool operator==(const TypeKey& rhs) const;
+			};
+
+			struct TypeKeyHasher
+			{
+				inline std::size_t operator()(const TypeKey& key) const;
+			};
+
+			SpirvConstantCache::ConstantPtr FindConstant(const ConstantKey& key) const;
+			SpirvConstantCache::TypePtr FindType(const TypeKey& key) const;
+
+			void RegisterConstant(ConstantKey key, SpirvConstantCache::ConstantPtr constant);
+			void RegisterType(TypeKey key, SpirvConstantCache::TypePtr type);
+
+			static std::optional<ConstantKey> BuildConstantKey(const Ast::ConstantSingleValue& value);
+			static std::optional<TypeKey> BuildTypeKey(const Ast::ExpressionType& type, const std::optional<StructLayout>& blockLayout);
+
+			std::unordered_map<ConstantKey, SpirvConstantCache::ConstantPtr, ConstantKeyHasher> m_constants;
+			std::unordered_map<TypeKey, SpirvConstantCache::TypePtr, TypeKeyHasher> m_types;
+			mutable std::shared_mutex m_mutex;
+	};
+}
+
+#include <NZSL/SpirV/SpirvTypeCache.inl>
+
+#endif // NZSL_SPIRV_SPIRVTYPECACHE_HPP
@@ -0,0 +1,22 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+
+namespace nzsl
+{
+	inline bool SpirvTypeCache::ConstantKey::operator==(const ConstantKey& rhs) const
+	{
+		return valueIndex == rhs.valueIndex && components == rhs.components;
+	}
+
+	inline bool SpirvTypeCache::TypeKey::operator==(const TypeKey& rhs) const
+	{
+		return hash == rhs.hash && blockLayout == rhs.blockLayout && type == rhs.type;
+	}
+
+	inline std::size_t SpirvTypeCache::TypeKeyHasher::operator()(const TypeKey& key) const
+	{
+		return key.hash;
+	}
+}
@@ -13,10 +13,13 @@
 #include <NZSL/Ast/Module.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <NZSL/SpirV/SpirvConstantCache.hpp>
+#include <NZSL/SpirV/SpirvTypeCache.hpp>
 #include <NZSL/SpirV/SpirvVariable.hpp>
+#include <initializer_list>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace nzsl
 {
@@ -40,8 +43,10 @@ namespace nzsl
 			~SpirvWriter() = default;
 
 			std::vector<std::uint32_t> Generate(const Ast::Module& module, const States& states = {});
+			void Generate(const Ast::Module& module, std::vector<std::uint32_t>& output, const States& states = {}); //< appends the SPIR-V words to output, allowing its storage to be reused
 
 			const SpirvVariable& GetConstantVariable(std::size_t constIndex) const;
+			inline const std::unordered_map<std::string, std::uint32_t>& GetSpecializationConstantIds() const; //< option name to SpecId of the specialization constants of the last generated module
 
 			bool IsVersionGreaterOrEqual(std::uint32_t spvMajor, std::uint32_t spvMinor) const;
 
@@ -51,6 +56,9 @@ namespace nzsl
 			{
 				std::uint32_t spvMajorVersion = 1;
 				std::uint32_t spvMinorVersion = 0;
+				std::shared_ptr<SpirvTypeCache> typeCache; //< shared between generations to avoid building the same types and constants again
+				std::unordered_set<Ast::OptionHash> specializationConstantOptions; //< options emitted as specialization constants, their SpecId is their hash (see Ast::HashOption)
+				bool optimizeBinary = false; //< run SpirvOptimizer on the generated module (removes unused and duplicate types/constants and compacts ids)
 			};
 			
 			static std::pair<std::uint32_t, std::uint32_t> GetMaximumSupportedVersion(std::uint32_t vkMajorVersion, std::uint32_t vkMinorVersion);
@@ -74,7 +82,8 @@ namespace nzsl
 			std::uint32_t GetFunctionTypeId(const Ast::DeclareFunctionStatement& functionNode);
 			std::uint32_t GetPointerTypeId(const SpirvConstantCache::TypePtr& typePtr, SpirvStorageClass storageClass) const;
 			std::uint32_t GetPointerTypeId(const Ast::ExpressionType& type, SpirvStorageClass storageClass) const;
-			std::uint32_t GetSourceFileId(const std::shared_ptr<const std::string>& filepathPtr);
+			std::uint32_t GetSourceFileId(SourceFileId sourceFileId);
+			std::optional<std::uint32_t> GetSpecConstantId(std::size_t constIndex) const;
 			std::uint32_t GetTypeId(const SpirvConstantCache::Type& type) const;
 			std::uint32_t GetTypeId(const Ast::ExpressionType& type) const;
 
@@ -87,7 +96,7 @@ namespace nzsl
 			std::uint32_t RegisterSingleConstant(const Ast::ConstantSingleValue& value);
 			std::uint32_t RegisterType(Ast::ExpressionType type);
 
-			static void MergeSections(std::vector<std::uint32_t>& output, const SpirvSection& from);
+			static void MergeSections(std::vector<std::uint32_t>& output, std::initializer_list<const SpirvSection*> sections);
 
 			struct Context
 			{
@@ -99,6 +108,7 @@ namespace nzsl
 			Context m_context;
 			Environment m_environment;
 			State* m_currentState;
+			std::unordered_map<std::string, std::uint32_t> m_specializationConstantIds;
 	};
 }
 
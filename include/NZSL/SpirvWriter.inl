@@ -5,4 +5,8 @@
 
 namespace nzsl
 {
+	inline const std::unordered_map<std::string, std::uint32_t>& SpirvWriter::GetSpecializationConstantIds() const
+	{
+		return m_specializationConstantIds;
+	}
 }
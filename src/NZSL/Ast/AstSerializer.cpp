@@ -585,21 +585,22 @@ namespace nzsl::Ast
 		module.rootNode->Visit(visitor);
 	}
 
-	void ShaderAstSerializer::SharedString(std::shared_ptr<const std::string>& val)
+	void ShaderAstSerializer::SourceFile(SourceFileId& val)
 	{
-		bool hasValue = (val != nullptr);
+		bool hasValue = (val != InvalidSourceFileId);
 		Value(hasValue);
 
 		if (hasValue)
 		{
-			auto it = m_stringIndices.find(*val);
-			bool newString = (it == m_stringIndices.end());
+			auto it = m_sourceFileIndices.find(val);
+			bool newString = (it == m_sourceFileIndices.end());
 			Value(newString);
 
 			if (newString)
 			{
-				Value(const_cast<std::string&>(*val)); //< won't be used for writing
-				m_stringIndices.emplace(*val, Nz::SafeCast<std::uint32_t>(m_stringIndices.size()));
+				std::string filePath(GetSourceFilePath(val));
+				Value(filePath);
+				m_sourceFileIndices.emplace(val, Nz::SafeCast<std::uint32_t>(m_sourceFileIndices.size()));
 			}
 			else
 				Value(it->second); //< string index
@@ -876,6 +877,27 @@ namespace nzsl::Ast
 	}
 
 	ModulePtr ShaderAstDeserializer::Deserialize()
+	{
+		DeserializeHeader();
+
+		ModulePtr module = std::make_shared<Module>();
+		SerializeModule(*module);
+
+		return module;
+	}
+
+	Module::Metadata ShaderAstDeserializer::DeserializeMetadata()
+	{
+		DeserializeHeader();
+
+		// Metadata come first in the module, no need to read further
+		Module::Metadata metadata;
+		Metadata(metadata);
+
+		return metadata;
+	}
+
+	void ShaderAstDeserializer::DeserializeHeader()
 	{
 		std::uint32_t magicNumber = 0;
 		m_version = 0;
@@ -886,11 +908,6 @@ namespace nzsl::Ast
 		m_deserializer.Deserialize(m_version);
 		if (m_version > s_shaderAstCurrentVersion)
 			throw std::runtime_error(fmt::format("unsupported module version {0} (max supported version: {1})", m_version, s_shaderAstCurrentVersion));
-
-		ModulePtr module = std::make_shared<Module>();
-		SerializeModule(*module);
-
-		return module;
 	}
 
 	bool ShaderAstDeserializer::IsVersionGreaterOrEqual(std::uint32_t version) const
@@ -978,7 +995,7 @@ namespace nzsl::Ast
 		module = Module(std::move(metadata), std::move(rootNode), std::move(importedModules));
 	}
 
-	void ShaderAstDeserializer::SharedString(std::shared_ptr<const std::string>& val)
+	void ShaderAstDeserializer::SourceFile(SourceFileId& val)
 	{
 		bool hasValue;
 		Value(hasValue);
@@ -993,16 +1010,16 @@ namespace nzsl::Ast
 				std::string newStr;
 				Value(newStr);
 
-				val = std::make_shared<const std::string>(std::move(newStr));
-				m_strings.emplace_back(val);
+				val = RegisterSourceFile(newStr);
+				m_sourceFiles.push_back(val);
 			}
 			else
 			{
 				std::uint32_t strIndex;
 				Value(strIndex);
 
-				assert(strIndex < m_strings.size());
-				val = m_strings[strIndex];
+				assert(strIndex < m_sourceFiles.size());
+				val = m_sourceFiles[strIndex];
 			}
 		}
 	}
@@ -1111,8 +1128,7 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 
 				ArrayType arrayType;
 				arrayType.length = length;
-				arrayType.containedType = std::make_unique<ContainedType>();
-				arrayType.containedType->type = std::move(containedType);
+				arrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ std::move(containedType) });
 
 				if (IsVersionGreaterOrEqual(8))
 					Value(arrayType.isWrapped);
@@ -1163,8 +1179,7 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 				SizeT(methodIndex);
 
 				MethodType methodType;
-				methodType.objectType = std::make_unique<ContainedType>();
-				methodType.objectType->type = std::move(objectType);
+				methodType.objectType = std::make_shared<const ContainedType>(ContainedType{ std::move(objectType) });
 				methodType.methodIndex = methodIndex;
 
 				type = std::move(methodType);
@@ -1180,8 +1195,7 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 
 				AliasType aliasType;
 				aliasType.aliasIndex = aliasIndex;
-				aliasType.targetType = std::make_unique<ContainedType>();
-				aliasType.targetType->type = std::move(containedType);
+				aliasType.targetType = std::make_shared<const ContainedType>(ContainedType{ std::move(containedType) });
 
 				type = std::move(aliasType);
 				break;
@@ -1211,8 +1225,7 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 				Type(containedType);
 
 				DynArrayType arrayType;
-				arrayType.containedType = std::make_unique<ContainedType>();
-				arrayType.containedType->type = std::move(containedType);
+				arrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ std::move(containedType) });
 
 				type = std::move(arrayType);
 				break;
@@ -1442,4 +1455,10 @@ NAZARA_WARNING_POP()
 		ShaderAstDeserializer astDeserializer(deserializer);
 		return astDeserializer.Deserialize();
 	}
+
+	Module::Metadata DeserializeShaderMetadata(AbstractDeserializer& deserializer)
+	{
+		ShaderAstDeserializer astDeserializer(deserializer);
+		return astDeserializer.DeserializeMetadata();
+	}
 }
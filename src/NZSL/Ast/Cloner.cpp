@@ -51,18 +51,19 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(BranchStatement& node)
 	{
-		auto clone = std::make_unique<BranchStatement>();
-		clone->condStatements.reserve(node.condStatements.size());
+		auto clone = ReuseOrAllocate(node);
+		clone->condStatements.resize(node.condStatements.size());
 		clone->isConst = node.isConst;
 
-		for (auto& cond : node.condStatements)
+		for (std::size_t i = 0; i < node.condStatements.size(); ++i)
 		{
-			auto& condStatement = clone->condStatements.emplace_back();
-			condStatement.condition = CloneExpression(cond.condition);
-			condStatement.statement = CloneStatement(cond.statement);
+			auto& cond = node.condStatements[i];
+			auto& condStatement = clone->condStatements[i];
+			condStatement.condition = CloneInputExpression(cond.condition);
+			condStatement.statement = CloneInputStatement(cond.statement);
 		}
 
-		clone->elseStatement = CloneStatement(node.elseStatement);
+		clone->elseStatement = CloneInputStatement(node.elseStatement);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -71,7 +72,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(BreakStatement& node)
 	{
-		auto clone = std::make_unique<BreakStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->sourceLocation = node.sourceLocation;
 
 		return clone;
@@ -79,9 +80,9 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ConditionalStatement& node)
 	{
-		auto clone = std::make_unique<ConditionalStatement>();
-		clone->condition = CloneExpression(node.condition);
-		clone->statement = CloneStatement(node.statement);
+		auto clone = ReuseOrAllocate(node);
+		clone->condition = CloneInputExpression(node.condition);
+		clone->statement = CloneInputStatement(node.statement);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -90,7 +91,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ContinueStatement& node)
 	{
-		auto clone = std::make_unique<ContinueStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->sourceLocation = node.sourceLocation;
 
 		return clone;
@@ -98,10 +99,10 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareAliasStatement& node)
 	{
-		auto clone = std::make_unique<DeclareAliasStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->aliasIndex = node.aliasIndex;
 		clone->name = node.name;
-		clone->expression = CloneExpression(node.expression);
+		clone->expression = CloneInputExpression(node.expression);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -110,12 +111,12 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareConstStatement& node)
 	{
-		auto clone = std::make_unique<DeclareConstStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->constIndex = node.constIndex;
 		clone->isExported = Clone(node.isExported);
 		clone->name = node.name;
 		clone->type = Clone(node.type);
-		clone->expression = CloneExpression(node.expression);
+		clone->expression = CloneInputExpression(node.expression);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -124,16 +125,17 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareExternalStatement& node)
 	{
-		auto clone = std::make_unique<DeclareExternalStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->autoBinding = Clone(node.autoBinding);
 		clone->bindingSet = Clone(node.bindingSet);
 		clone->name = node.name;
 		clone->tag = node.tag;
 
-		clone->externalVars.reserve(node.externalVars.size());
-		for (const auto& var : node.externalVars)
+		clone->externalVars.resize(node.externalVars.size());
+		for (std::size_t i = 0; i < node.externalVars.size(); ++i)
 		{
-			auto& cloneVar = clone->externalVars.emplace_back();
+			const auto& var = node.externalVars[i];
+			auto& cloneVar = clone->externalVars[i];
 			cloneVar.name = var.name;
 			cloneVar.varIndex = var.varIndex;
 			cloneVar.type = Clone(var.type);
@@ -151,7 +153,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareFunctionStatement& node)
 	{
-		auto clone = std::make_unique<DeclareFunctionStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->depthWrite = Clone(node.depthWrite);
 		clone->earlyFragmentTests = Clone(node.earlyFragmentTests);
 		clone->entryStage = Clone(node.entryStage);
@@ -161,10 +163,11 @@ namespace nzsl::Ast
 		clone->returnType = Clone(node.returnType);
 		clone->workgroupSize = Clone(node.workgroupSize);
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
 		{
-			auto& cloneParam = clone->parameters.emplace_back();
+			auto& parameter = node.parameters[i];
+			auto& cloneParam = clone->parameters[i];
 			cloneParam.name = parameter.name;
 			cloneParam.type = Clone(parameter.type);
 			cloneParam.varIndex = parameter.varIndex;
@@ -172,9 +175,9 @@ namespace nzsl::Ast
 			cloneParam.sourceLocation = parameter.sourceLocation;
 		}
 
-		clone->statements.reserve(node.statements.size());
-		for (auto& statement : node.statements)
-			clone->statements.push_back(CloneStatement(statement));
+		clone->statements.resize(node.statements.size());
+		for (std::size_t i = 0; i < node.statements.size(); ++i)
+			clone->statements[i] = CloneInputStatement(node.statements[i]);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -183,8 +186,8 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareOptionStatement& node)
 	{
-		auto clone = std::make_unique<DeclareOptionStatement>();
-		clone->defaultValue = CloneExpression(node.defaultValue);
+		auto clone = ReuseOrAllocate(node);
+		clone->defaultValue = CloneInputExpression(node.defaultValue);
 		clone->optIndex = node.optIndex;
 		clone->optName = node.optName;
 		clone->optType = Clone(node.optType);
@@ -196,7 +199,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareStructStatement& node)
 	{
-		auto clone = std::make_unique<DeclareStructStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->isExported = Clone(node.isExported);
 		clone->structIndex = node.structIndex;
 
@@ -204,10 +207,11 @@ namespace nzsl::Ast
 		clone->description.name = node.description.name;
 		clone->description.tag = node.description.tag;
 
-		clone->description.members.reserve(node.description.members.size());
-		for (const auto& member : node.description.members)
+		clone->description.members.resize(node.description.members.size());
+		for (std::size_t i = 0; i < node.description.members.size(); ++i)
 		{
-			auto& cloneMember = clone->description.members.emplace_back();
+			const auto& member = node.description.members[i];
+			auto& cloneMember = clone->description.members[i];
 			cloneMember.name = member.name;
 			cloneMember.originalName = member.originalName;
 			cloneMember.type = Clone(member.type);
@@ -227,8 +231,8 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DeclareVariableStatement& node)
 	{
-		auto clone = std::make_unique<DeclareVariableStatement>();
-		clone->initialExpression = CloneExpression(node.initialExpression);
+		auto clone = ReuseOrAllocate(node);
+		clone->initialExpression = CloneInputExpression(node.initialExpression);
 		clone->varIndex = node.varIndex;
 		clone->varName = node.varName;
 		clone->varType = Clone(node.varType);
@@ -240,7 +244,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(DiscardStatement& node)
 	{
-		auto clone = std::make_unique<DiscardStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->sourceLocation = node.sourceLocation;
 
 		return clone;
@@ -248,8 +252,8 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ExpressionStatement& node)
 	{
-		auto clone = std::make_unique<ExpressionStatement>();
-		clone->expression = CloneExpression(node.expression);
+		auto clone = ReuseOrAllocate(node);
+		clone->expression = CloneInputExpression(node.expression);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -258,11 +262,11 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ForStatement& node)
 	{
-		auto clone = std::make_unique<ForStatement>();
-		clone->fromExpr = CloneExpression(node.fromExpr);
-		clone->stepExpr = CloneExpression(node.stepExpr);
-		clone->toExpr = CloneExpression(node.toExpr);
-		clone->statement = CloneStatement(node.statement);
+		auto clone = ReuseOrAllocate(node);
+		clone->fromExpr = CloneInputExpression(node.fromExpr);
+		clone->stepExpr = CloneInputExpression(node.stepExpr);
+		clone->toExpr = CloneInputExpression(node.toExpr);
+		clone->statement = CloneInputStatement(node.statement);
 		clone->unroll = Clone(node.unroll);
 		clone->varIndex = node.varIndex;
 		clone->varName = node.varName;
@@ -274,9 +278,9 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ForEachStatement& node)
 	{
-		auto clone = std::make_unique<ForEachStatement>();
-		clone->expression = CloneExpression(node.expression);
-		clone->statement = CloneStatement(node.statement);
+		auto clone = ReuseOrAllocate(node);
+		clone->expression = CloneInputExpression(node.expression);
+		clone->statement = CloneInputStatement(node.statement);
 		clone->unroll = Clone(node.unroll);
 		clone->varIndex = node.varIndex;
 		clone->varName = node.varName;
@@ -288,7 +292,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ImportStatement& node)
 	{
-		auto clone = std::make_unique<ImportStatement>();
+		auto clone = ReuseOrAllocate(node);
 		clone->identifiers = node.identifiers;
 		clone->moduleName = node.moduleName;
 		clone->moduleIdentifier = node.moduleIdentifier;
@@ -300,10 +304,10 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(MultiStatement& node)
 	{
-		auto clone = std::make_unique<MultiStatement>();
-		clone->statements.reserve(node.statements.size());
-		for (auto& statement : node.statements)
-			clone->statements.push_back(CloneStatement(statement));
+		auto clone = ReuseOrAllocate(node);
+		clone->statements.resize(node.statements.size());
+		for (std::size_t i = 0; i < node.statements.size(); ++i)
+			clone->statements[i] = CloneInputStatement(node.statements[i]);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -312,7 +316,7 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(NoOpStatement& node)
 	{
-		auto clone = std::make_unique<NoOpStatement>();
+		auto clone = ReuseOrAllocate(node);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -321,8 +325,8 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ReturnStatement& node)
 	{
-		auto clone = std::make_unique<ReturnStatement>();
-		clone->returnExpr = CloneExpression(node.returnExpr);
+		auto clone = ReuseOrAllocate(node);
+		clone->returnExpr = CloneInputExpression(node.returnExpr);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -331,8 +335,8 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(ScopedStatement& node)
 	{
-		auto clone = std::make_unique<ScopedStatement>();
-		clone->statement = CloneStatement(node.statement);
+		auto clone = ReuseOrAllocate(node);
+		clone->statement = CloneInputStatement(node.statement);
 
 		clone->sourceLocation = node.sourceLocation;
 
@@ -341,9 +345,9 @@ namespace nzsl::Ast
 
 	StatementPtr Cloner::Clone(WhileStatement& node)
 	{
-		auto clone = std::make_unique<WhileStatement>();
-		clone->condition = CloneExpression(node.condition);
-		clone->body = CloneStatement(node.body);
+		auto clone = ReuseOrAllocate(node);
+		clone->condition = CloneInputExpression(node.condition);
+		clone->body = CloneInputStatement(node.body);
 		clone->unroll = Clone(node.unroll);
 
 		clone->sourceLocation = node.sourceLocation;
@@ -353,9 +357,9 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AccessIdentifierExpression& node)
 	{
-		auto clone = std::make_unique<AccessIdentifierExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->identifiers = node.identifiers;
-		clone->expr = CloneExpression(node.expr);
+		clone->expr = CloneInputExpression(node.expr);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -365,12 +369,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AccessIndexExpression& node)
 	{
-		auto clone = std::make_unique<AccessIndexExpression>();
-		clone->expr = CloneExpression(node.expr);
+		auto clone = ReuseOrAllocate(node);
+		clone->expr = CloneInputExpression(node.expr);
 
-		clone->indices.reserve(node.indices.size());
-		for (auto& parameter : node.indices)
-			clone->indices.push_back(CloneExpression(parameter));
+		clone->indices.resize(node.indices.size());
+		for (std::size_t i = 0; i < node.indices.size(); ++i)
+			clone->indices[i] = CloneInputExpression(node.indices[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -380,7 +384,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AliasValueExpression& node)
 	{
-		auto clone = std::make_unique<AliasValueExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->aliasId = node.aliasId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -391,10 +395,10 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(AssignExpression& node)
 	{
-		auto clone = std::make_unique<AssignExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->op = node.op;
-		clone->left = CloneExpression(node.left);
-		clone->right = CloneExpression(node.right);
+		clone->left = CloneInputExpression(node.left);
+		clone->right = CloneInputExpression(node.right);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -404,10 +408,10 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(BinaryExpression& node)
 	{
-		auto clone = std::make_unique<BinaryExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->op = node.op;
-		clone->left = CloneExpression(node.left);
-		clone->right = CloneExpression(node.right);
+		clone->left = CloneInputExpression(node.left);
+		clone->right = CloneInputExpression(node.right);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -417,14 +421,15 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(CallFunctionExpression& node)
 	{
-		auto clone = std::make_unique<CallFunctionExpression>();
-		clone->targetFunction = CloneExpression(node.targetFunction);
+		auto clone = ReuseOrAllocate(node);
+		clone->targetFunction = CloneInputExpression(node.targetFunction);
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
 		{
-			auto& cloneParameter = clone->parameters.emplace_back();
-			cloneParameter.expr = CloneExpression(parameter.expr);
+			auto& parameter = node.parameters[i];
+			auto& cloneParameter = clone->parameters[i];
+			cloneParameter.expr = CloneInputExpression(parameter.expr);
 			cloneParameter.semantic = parameter.semantic;
 		}
 
@@ -436,14 +441,14 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(CallMethodExpression& node)
 	{
-		auto clone = std::make_unique<CallMethodExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->methodName = node.methodName;
 
-		clone->object = CloneExpression(node.object);
+		clone->object = CloneInputExpression(node.object);
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
-			clone->parameters.push_back(CloneExpression(parameter));
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
+			clone->parameters[i] = CloneInputExpression(node.parameters[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -453,12 +458,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(CastExpression& node)
 	{
-		auto clone = std::make_unique<CastExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->targetType = Clone(node.targetType);
 
-		clone->expressions.reserve(node.expressions.size());
-		for (const auto& exprPtr : node.expressions)
-			clone->expressions.push_back(CloneExpression(exprPtr));
+		clone->expressions.resize(node.expressions.size());
+		for (std::size_t i = 0; i < node.expressions.size(); ++i)
+			clone->expressions[i] = CloneInputExpression(node.expressions[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -468,10 +473,10 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConditionalExpression& node)
 	{
-		auto clone = std::make_unique<ConditionalExpression>();
-		clone->condition = CloneExpression(node.condition);
-		clone->falsePath = CloneExpression(node.falsePath);
-		clone->truePath = CloneExpression(node.truePath);
+		auto clone = ReuseOrAllocate(node);
+		clone->condition = CloneInputExpression(node.condition);
+		clone->falsePath = CloneInputExpression(node.falsePath);
+		clone->truePath = CloneInputExpression(node.truePath);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -481,7 +486,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConstantExpression& node)
 	{
-		auto clone = std::make_unique<ConstantExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->constantId = node.constantId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -492,7 +497,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConstantArrayValueExpression& node)
 	{
-		auto clone = std::make_unique<ConstantArrayValueExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->values = node.values;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -503,7 +508,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ConstantValueExpression& node)
 	{
-		auto clone = std::make_unique<ConstantValueExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->value = node.value;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -514,7 +519,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(FunctionExpression& node)
 	{
-		auto clone = std::make_unique<FunctionExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->funcId = node.funcId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -525,7 +530,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(IdentifierExpression& node)
 	{
-		auto clone = std::make_unique<IdentifierExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->identifier = node.identifier;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -536,12 +541,12 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(IntrinsicExpression& node)
 	{
-		auto clone = std::make_unique<IntrinsicExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->intrinsic = node.intrinsic;
 
-		clone->parameters.reserve(node.parameters.size());
-		for (auto& parameter : node.parameters)
-			clone->parameters.push_back(CloneExpression(parameter));
+		clone->parameters.resize(node.parameters.size());
+		for (std::size_t i = 0; i < node.parameters.size(); ++i)
+			clone->parameters[i] = CloneInputExpression(node.parameters[i]);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -551,7 +556,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(IntrinsicFunctionExpression& node)
 	{
-		auto clone = std::make_unique<IntrinsicFunctionExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->intrinsicId = node.intrinsicId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -562,7 +567,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(ModuleExpression& node)
 	{
-		auto clone = std::make_unique<ModuleExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->moduleId = node.moduleId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -573,7 +578,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(NamedExternalBlockExpression& node)
 	{
-		auto clone = std::make_unique<NamedExternalBlockExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->externalBlockId = node.externalBlockId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -584,7 +589,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(StructTypeExpression& node)
 	{
-		auto clone = std::make_unique<StructTypeExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->structTypeId = node.structTypeId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -595,10 +600,10 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(SwizzleExpression& node)
 	{
-		auto clone = std::make_unique<SwizzleExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->componentCount = node.componentCount;
 		clone->components = node.components;
-		clone->expression = CloneExpression(node.expression);
+		clone->expression = CloneInputExpression(node.expression);
 
 		clone->cachedExpressionType = node.cachedExpressionType;
 		clone->sourceLocation = node.sourceLocation;
@@ -608,7 +613,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(TypeExpression& node)
 	{
-		auto clone = std::make_unique<TypeExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->typeId = node.typeId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -619,7 +624,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(VariableValueExpression& node)
 	{
-		auto clone = std::make_unique<VariableValueExpression>();
+		auto clone = ReuseOrAllocate(node);
 		clone->variableId = node.variableId;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
@@ -630,8 +635,8 @@ namespace nzsl::Ast
 
 	ExpressionPtr Cloner::Clone(UnaryExpression& node)
 	{
-		auto clone = std::make_unique<UnaryExpression>();
-		clone->expression = CloneExpression(node.expression);
+		auto clone = ReuseOrAllocate(node);
+		clone->expression = CloneInputExpression(node.expression);
 		clone->op = node.op;
 
 		clone->cachedExpressionType = node.cachedExpressionType;
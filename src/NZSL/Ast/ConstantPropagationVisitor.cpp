@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in Config.hpp
 
 #include <NZSL/Ast/ConstantPropagationVisitor.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/TypeTraits.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Lang/Errors.hpp>
@@ -420,11 +421,22 @@ namespace nzsl::Ast
 
 		return std::make_shared<Module>(shaderModule.metadata, std::move(rootNode), shaderModule.importedModules);
 	}
+
+	void ConstantPropagationVisitor::ProcessInPlace(Module& shaderModule, const Options& options)
+	{
+		m_options = options;
+
+		SetInputConsumption(true);
+		NAZARA_DEFER({ SetInputConsumption(false); });
+
+		for (StatementPtr& statement : shaderModule.rootNode->statements)
+			statement = CloneInputStatement(statement);
+	}
 	
 	ExpressionPtr ConstantPropagationVisitor::Clone(BinaryExpression& node)
 	{
-		auto lhs = CloneExpression(node.left);
-		auto rhs = CloneExpression(node.right);
+		auto lhs = CloneInputExpression(node.left);
+		auto rhs = CloneInputExpression(node.right);
 
 		if (lhs->GetType() == NodeType::ConstantValueExpression && rhs->GetType() == NodeType::ConstantValueExpression)
 		{
@@ -484,8 +496,8 @@ namespace nzsl::Ast
 		std::size_t expressionCount = node.expressions.size();
 		expressions.reserve(expressionCount);
 
-		for (const auto& expression : node.expressions)
-			expressions.push_back(CloneExpression(expression));
+		for (auto& expression : node.expressions)
+			expressions.push_back(CloneInputExpression(expression));
 
 		const ExpressionType& targetType = node.targetType.GetResultingValue();
 		
@@ -655,7 +667,7 @@ namespace nzsl::Ast
 		bool continuePropagation = true;
 		for (auto& condStatement : node.condStatements)
 		{
-			auto cond = CloneExpression(condStatement.condition);
+			auto cond = CloneInputExpression(condStatement.condition);
 
 			if (continuePropagation && cond->GetType() == NodeType::ConstantValueExpression)
 			{
@@ -679,12 +691,12 @@ namespace nzsl::Ast
 				if (statements.empty())
 				{
 					// First condition is true, dismiss the branch
-					return Unscope(Cloner::Clone(*condStatement.statement));
+					return Unscope(CloneInputStatement(condStatement.statement));
 				}
 				else
 				{
 					// Some condition after the first one is true, make it the else statement and stop there
-					elseStatement = CloneStatement(condStatement.statement);
+					elseStatement = CloneInputStatement(condStatement.statement);
 					break;
 				}
 			}
@@ -692,7 +704,7 @@ namespace nzsl::Ast
 			{
 				auto& c = statements.emplace_back();
 				c.condition = std::move(cond);
-				c.statement = CloneStatement(condStatement.statement);
+				c.statement = CloneInputStatement(condStatement.statement);
 			}
 		}
 
@@ -700,13 +712,13 @@ namespace nzsl::Ast
 		{
 			// All conditions have been removed, replace by else statement or no-op
 			if (node.elseStatement)
-				return Unscope(Cloner::Clone(*node.elseStatement));
+				return Unscope(CloneInputStatement(node.elseStatement));
 			else
 				return ShaderBuilder::NoOp();
 		}
 
 		if (!elseStatement)
-			elseStatement = CloneStatement(node.elseStatement);
+			elseStatement = CloneInputStatement(node.elseStatement);
 
 		auto branchStatement = ShaderBuilder::Branch(std::move(statements), std::move(elseStatement));
 		branchStatement->sourceLocation = node.sourceLocation;
@@ -716,7 +728,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr ConstantPropagationVisitor::Clone(ConditionalExpression& node)
 	{
-		auto cond = CloneExpression(node.condition);
+		auto cond = CloneInputExpression(node.condition);
 		if (cond->GetType() != NodeType::ConstantValueExpression)
 			throw std::runtime_error("conditional expression condition must be a constant expression");
 
@@ -730,9 +742,9 @@ namespace nzsl::Ast
 
 		bool cValue = std::get<bool>(constant.value);
 		if (cValue)
-			return Cloner::Clone(*node.truePath);
+			return CloneInputExpression(node.truePath);
 		else
-			return Cloner::Clone(*node.falsePath);
+			return CloneInputExpression(node.falsePath);
 	}
 
 	ExpressionPtr ConstantPropagationVisitor::Clone(ConstantExpression& node)
@@ -772,8 +784,8 @@ namespace nzsl::Ast
 		std::size_t parameterCount = node.parameters.size();
 		parameters.reserve(parameterCount);
 
-		for (const auto& parameter : node.parameters)
-			parameters.push_back(CloneExpression(parameter));
+		for (auto& parameter : node.parameters)
+			parameters.push_back(CloneInputExpression(parameter));
 
 		switch (node.intrinsic)
 		{
@@ -858,7 +870,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr ConstantPropagationVisitor::Clone(SwizzleExpression& node)
 	{
-		auto expr = CloneExpression(node.expression);
+		auto expr = CloneInputExpression(node.expression);
 
 		if (expr->GetType() == NodeType::ConstantValueExpression)
 		{
@@ -913,7 +925,7 @@ namespace nzsl::Ast
 
 	ExpressionPtr ConstantPropagationVisitor::Clone(UnaryExpression& node)
 	{
-		auto expr = CloneExpression(node.expression);
+		auto expr = CloneInputExpression(node.expression);
 
 		if (expr->GetType() == NodeType::ConstantValueExpression)
 		{
@@ -955,7 +967,7 @@ namespace nzsl::Ast
 
 	StatementPtr ConstantPropagationVisitor::Clone(ConditionalStatement& node)
 	{
-		auto cond = CloneExpression(node.condition);
+		auto cond = CloneInputExpression(node.condition);
 		if (cond->GetType() != NodeType::ConstantValueExpression)
 			throw std::runtime_error("conditional expression condition must be a constant expression");
 
@@ -968,10 +980,16 @@ namespace nzsl::Ast
 			throw std::runtime_error("conditional expression condition must resolve to a boolean");
 
 		bool cValue = std::get<bool>(constant.value);
-		if (cValue)
-			return Cloner::Clone(node);
-		else
+		if (!cValue)
 			return ShaderBuilder::NoOp();
+
+		auto clone = std::make_unique<ConditionalStatement>();
+		clone->condition = std::move(cond);
+		clone->statement = CloneInputStatement(node.statement);
+
+		clone->sourceLocation = node.sourceLocation;
+
+		return clone;
 	}
 
 	template<typename TargetType>
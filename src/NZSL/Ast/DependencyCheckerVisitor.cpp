@@ -186,6 +186,29 @@ namespace nzsl::Ast
 		m_currentFunctionIndex = {};
 	}
 
+	void DependencyCheckerVisitor::Visit(DeclareOptionStatement& node)
+	{
+		// Specialization constants are part of the module interface and are always kept,
+		// other options are left as-is (they're not referenced as constants after sanitization)
+		if (!node.optIndex || m_config.specializationConstantOptions.count(HashOption(node.optName.data())) == 0)
+		{
+			RecursiveVisitor::Visit(node);
+			return;
+		}
+
+		assert(m_constantUsages.find(*node.optIndex) == m_constantUsages.end());
+		UsageSet& usageSet = m_constantUsages[*node.optIndex];
+
+		if (node.optType.HasValue() && node.optType.IsResultingValue())
+			RegisterType(usageSet, node.optType.GetResultingValue());
+
+		MarkConstantAsUsed(*node.optIndex);
+
+		m_currentConstantIndex = *node.optIndex;
+		RecursiveVisitor::Visit(node);
+		m_currentConstantIndex = {};
+	}
+
 	void DependencyCheckerVisitor::Visit(DeclareStructStatement& node)
 	{
 		assert(node.structIndex);
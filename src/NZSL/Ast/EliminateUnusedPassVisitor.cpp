@@ -35,6 +35,161 @@ namespace nzsl::Ast
 		return Clone(statement);
 	}
 
+	void EliminateUnusedPassVisitor::ProcessInPlace(Module& shaderModule, const DependencyCheckerVisitor::UsageSet& usageSet)
+	{
+		Context context{
+			usageSet
+		};
+
+		m_context = &context;
+		Nz::CallOnExit onExit([this]()
+		{
+			m_context = nullptr;
+		});
+
+		for (StatementPtr& statement : shaderModule.rootNode->statements)
+			EliminateInPlace(statement);
+	}
+
+	void EliminateUnusedPassVisitor::ProcessInPlace(StatementPtr& statement, const DependencyCheckerVisitor::UsageSet& usageSet)
+	{
+		Context context{
+			usageSet
+		};
+
+		m_context = &context;
+		Nz::CallOnExit onExit([this]()
+		{
+			m_context = nullptr;
+		});
+
+		EliminateInPlace(statement);
+	}
+
+	void EliminateUnusedPassVisitor::EliminateInPlace(StatementPtr& statement)
+	{
+		// Mirrors the Clone overrides below
+		switch (statement->GetType())
+		{
+			case NodeType::BranchStatement:
+			{
+				auto& branchStatement = static_cast<BranchStatement&>(*statement);
+				for (auto& condStatement : branchStatement.condStatements)
+					EliminateInPlace(condStatement.statement);
+
+				if (branchStatement.elseStatement)
+					EliminateInPlace(branchStatement.elseStatement);
+
+				break;
+			}
+
+			case NodeType::ConditionalStatement:
+				EliminateInPlace(static_cast<ConditionalStatement&>(*statement).statement);
+				break;
+
+			case NodeType::DeclareAliasStatement:
+			{
+				auto& aliasStatement = static_cast<DeclareAliasStatement&>(*statement);
+				assert(aliasStatement.aliasIndex);
+				if (!IsAliasUsed(*aliasStatement.aliasIndex))
+					statement = ShaderBuilder::NoOp();
+
+				break;
+			}
+
+			case NodeType::DeclareConstStatement:
+			{
+				auto& constStatement = static_cast<DeclareConstStatement&>(*statement);
+				assert(constStatement.constIndex);
+				if (!IsConstantUsed(*constStatement.constIndex))
+					statement = ShaderBuilder::NoOp();
+
+				break;
+			}
+
+			case NodeType::DeclareExternalStatement:
+			{
+				auto& externalStatement = static_cast<DeclareExternalStatement&>(*statement);
+				for (auto it = externalStatement.externalVars.begin(); it != externalStatement.externalVars.end(); )
+				{
+					assert(it->varIndex);
+					if (!IsVariableUsed(*it->varIndex))
+						it = externalStatement.externalVars.erase(it);
+					else
+						++it;
+				}
+
+				if (externalStatement.externalVars.empty())
+					statement = ShaderBuilder::NoOp();
+
+				break;
+			}
+
+			case NodeType::DeclareFunctionStatement:
+			{
+				auto& functionStatement = static_cast<DeclareFunctionStatement&>(*statement);
+				assert(functionStatement.funcIndex);
+				if (!IsFunctionUsed(*functionStatement.funcIndex))
+				{
+					statement = ShaderBuilder::NoOp();
+					break;
+				}
+
+				for (StatementPtr& functionBodyStatement : functionStatement.statements)
+					EliminateInPlace(functionBodyStatement);
+
+				break;
+			}
+
+			case NodeType::DeclareStructStatement:
+			{
+				auto& structStatement = static_cast<DeclareStructStatement&>(*statement);
+				assert(structStatement.structIndex);
+				if (!IsStructUsed(*structStatement.structIndex))
+					statement = ShaderBuilder::NoOp();
+
+				break;
+			}
+
+			case NodeType::DeclareVariableStatement:
+			{
+				auto& variableStatement = static_cast<DeclareVariableStatement&>(*statement);
+				assert(variableStatement.varIndex);
+				if (!IsVariableUsed(*variableStatement.varIndex))
+					statement = ShaderBuilder::NoOp();
+
+				break;
+			}
+
+			case NodeType::ForEachStatement:
+				EliminateInPlace(static_cast<ForEachStatement&>(*statement).statement);
+				break;
+
+			case NodeType::ForStatement:
+				EliminateInPlace(static_cast<ForStatement&>(*statement).statement);
+				break;
+
+			case NodeType::MultiStatement:
+			{
+				for (StatementPtr& childStatement : static_cast<MultiStatement&>(*statement).statements)
+					EliminateInPlace(childStatement);
+
+				break;
+			}
+
+			case NodeType::ScopedStatement:
+				EliminateInPlace(static_cast<ScopedStatement&>(*statement).statement);
+				break;
+
+			case NodeType::WhileStatement:
+				EliminateInPlace(static_cast<WhileStatement&>(*statement).body);
+				break;
+
+			default:
+				break;
+		}
+	}
+
 	StatementPtr EliminateUnusedPassVisitor::Clone(DeclareAliasStatement& node)
 	{
 		assert(node.aliasIndex);
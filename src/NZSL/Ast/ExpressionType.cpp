@@ -12,23 +12,6 @@
 
 namespace nzsl::Ast
 {
-	AliasType::AliasType(const AliasType& alias) :
-	aliasIndex(alias.aliasIndex)
-	{
-		assert(alias.targetType);
-		targetType = std::make_unique<ContainedType>(*alias.targetType);
-	}
-
-	AliasType& AliasType::operator=(const AliasType& alias)
-	{
-		aliasIndex = alias.aliasIndex;
-
-		assert(alias.targetType);
-		targetType = std::make_unique<ContainedType>(*alias.targetType);
-
-		return *this;
-	}
-
 	bool AliasType::operator==(const AliasType& rhs) const
 	{
 		assert(targetType);
@@ -37,28 +20,13 @@ namespace nzsl::Ast
 		if (aliasIndex != rhs.aliasIndex)
 			return false;
 
-		if (targetType->type != rhs.targetType->type)
+		if (targetType != rhs.targetType && targetType->type != rhs.targetType->type)
 			return false;
 
 		return true;
 	}
 
 
-	BaseArrayType::BaseArrayType(const BaseArrayType& array)
-	{
-		assert(array.containedType);
-		containedType = std::make_unique<ContainedType>(*array.containedType);
-	}
-
-	BaseArrayType& BaseArrayType::operator=(const BaseArrayType& array)
-	{
-		assert(array.containedType);
-
-		containedType = std::make_unique<ContainedType>(*array.containedType);
-
-		return *this;
-	}
-
 	bool BaseArrayType::operator==(const BaseArrayType& rhs) const
 	{
 		assert(containedType);
@@ -67,35 +35,18 @@ namespace nzsl::Ast
 		if (isWrapped != rhs.isWrapped)
 			return false;
 
-		if (containedType->type != rhs.containedType->type)
+		if (containedType != rhs.containedType && containedType->type != rhs.containedType->type)
 			return false;
 
 		return true;
 	}
 
 
-	MethodType::MethodType(const MethodType& methodType) :
-	methodIndex(methodType.methodIndex)
-	{
-		assert(methodType.objectType);
-		objectType = std::make_unique<ContainedType>(*methodType.objectType);
-	}
-
-	MethodType& MethodType::operator=(const MethodType& methodType)
-	{
-		assert(methodType.objectType);
-
-		methodIndex = methodType.methodIndex;
-		objectType = std::make_unique<ContainedType>(*methodType.objectType);
-
-		return *this;
-	}
-
 	bool MethodType::operator==(const MethodType& rhs) const
 	{
 		assert(objectType);
 		assert(rhs.objectType);
-		return objectType->type == rhs.objectType->type && methodIndex == rhs.methodIndex;
+		return methodIndex == rhs.methodIndex && (objectType == rhs.objectType || objectType->type == rhs.objectType->type);
 	}
 	
 	using StructTypes = Nz::TypeList<ArrayType, DynArrayType, MatrixType, PrimitiveType, StructType, VectorType>;
@@ -4,6 +4,7 @@
 
 #include <NZSL/Ast/IndexRemapperVisitor.hpp>
 #include <NazaraUtils/Algorithm.hpp>
+#include <NZSL/Ast/ReflectVisitor.hpp>
 #include <unordered_map>
 
 namespace nzsl::Ast
@@ -40,6 +41,18 @@ namespace nzsl::Ast
 		context.options = &options;
 		m_context = &context;
 
+		// Generate new indices before cloning, as some identifiers can be used before their declaration (such as functions called by a previous function)
+		ReflectVisitor::Callbacks callbacks;
+		callbacks.onAliasIndex    = [&](const std::string& /*name*/, std::size_t index, const SourceLocation& /*sourceLocation*/) { UniqueInsert(context.newAliasIndices, index, options.aliasIndexGenerator(index)); };
+		callbacks.onConstIndex    = [&](const std::string& /*name*/, std::size_t index, const SourceLocation& /*sourceLocation*/) { UniqueInsert(context.newConstIndices, index, options.constIndexGenerator(index)); };
+		callbacks.onFunctionIndex = [&](const std::string& /*name*/, std::size_t index, const SourceLocation& /*sourceLocation*/) { UniqueInsert(context.newFuncIndices, index, options.funcIndexGenerator(index)); };
+		callbacks.onOptionIndex   = [&](const std::string& /*name*/, std::size_t index, const SourceLocation& /*sourceLocation*/) { UniqueInsert(context.newConstIndices, index, options.constIndexGenerator(index)); };
+		callbacks.onStructIndex   = [&](const std::string& /*name*/, std::size_t index, const SourceLocation& /*sourceLocation*/) { UniqueInsert(context.newStructIndices, index, options.structIndexGenerator(index)); };
+		callbacks.onVariableIndex = [&](const std::string& /*name*/, std::size_t index, const SourceLocation& /*sourceLocation*/) { UniqueInsert(context.newVarIndices, index, options.varIndexGenerator(index)); };
+
+		ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(statement, callbacks);
+
 		return Cloner::Clone(statement);
 	}
 
@@ -57,11 +70,7 @@ namespace nzsl::Ast
 		DeclareAliasStatementPtr clone = Nz::StaticUniquePointerCast<DeclareAliasStatement>(Cloner::Clone(node));
 
 		if (clone->aliasIndex)
-		{
-			std::size_t newAliasIndex = m_context->options->aliasIndexGenerator(*clone->aliasIndex);
-			UniqueInsert(m_context->newAliasIndices, *clone->aliasIndex, newAliasIndex);
-			clone->aliasIndex = newAliasIndex;
-		}
+			clone->aliasIndex = Nz::Retrieve(m_context->newAliasIndices, *clone->aliasIndex);
 		else if (m_context->options->forceIndexGeneration)
 			clone->aliasIndex = m_context->options->aliasIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -73,11 +82,7 @@ namespace nzsl::Ast
 		DeclareConstStatementPtr clone = Nz::StaticUniquePointerCast<DeclareConstStatement>(Cloner::Clone(node));
 
 		if (clone->constIndex)
-		{
-			std::size_t newConstIndex = m_context->options->constIndexGenerator(*clone->constIndex);
-			UniqueInsert(m_context->newConstIndices, *clone->constIndex, newConstIndex);
-			clone->constIndex = newConstIndex;
-		}
+			clone->constIndex = Nz::Retrieve(m_context->newConstIndices, *clone->constIndex);
 		else if (m_context->options->forceIndexGeneration)
 			clone->constIndex = m_context->options->constIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -91,13 +96,11 @@ namespace nzsl::Ast
 		for (auto& extVar : clone->externalVars)
 		{
 			if (extVar.varIndex)
-			{
-				std::size_t newVarIndex = m_context->options->varIndexGenerator(*extVar.varIndex);
-				UniqueInsert(m_context->newVarIndices, *extVar.varIndex, newVarIndex);
-				extVar.varIndex = newVarIndex;
-			}
+				extVar.varIndex = Nz::Retrieve(m_context->newVarIndices, *extVar.varIndex);
 			else if (m_context->options->forceIndexGeneration)
 				extVar.varIndex = m_context->options->varIndexGenerator(std::numeric_limits<std::size_t>::max());
+
+			HandleType(extVar.type);
 		}
 
 		return clone;
@@ -105,24 +108,10 @@ namespace nzsl::Ast
 
 	StatementPtr IndexRemapperVisitor::Clone(DeclareFunctionStatement& node)
 	{
-		// We have to handle parameters before handling the function statements
-		for (auto& parameter : node.parameters)
-		{
-			if (parameter.varIndex)
-			{
-				std::size_t newVarIndex = m_context->options->varIndexGenerator(*parameter.varIndex);
-				UniqueInsert(m_context->newVarIndices, *parameter.varIndex, newVarIndex);
-			}
-		}
-
 		DeclareFunctionStatementPtr clone = Nz::StaticUniquePointerCast<DeclareFunctionStatement>(Cloner::Clone(node));
 
 		if (clone->funcIndex)
-		{
-			std::size_t newFuncIndex = m_context->options->funcIndexGenerator(*clone->funcIndex);
-			UniqueInsert(m_context->newFuncIndices, *clone->funcIndex, newFuncIndex);
-			clone->funcIndex = newFuncIndex;
-		}
+			clone->funcIndex = Nz::Retrieve(m_context->newFuncIndices, *clone->funcIndex);
 		else if (m_context->options->forceIndexGeneration)
 			clone->funcIndex = m_context->options->funcIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -131,11 +120,7 @@ namespace nzsl::Ast
 			for (auto& parameter : clone->parameters)
 			{
 				if (parameter.varIndex)
-				{
-					auto it = m_context->newVarIndices.find(*parameter.varIndex);
-					if (it != m_context->newVarIndices.end())
-						parameter.varIndex = it->second;
-				}
+					parameter.varIndex = Nz::Retrieve(m_context->newVarIndices, *parameter.varIndex);
 				else if (m_context->options->forceIndexGeneration)
 					parameter.varIndex = m_context->options->varIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -154,11 +139,7 @@ namespace nzsl::Ast
 		DeclareOptionStatementPtr clone = Nz::StaticUniquePointerCast<DeclareOptionStatement>(Cloner::Clone(node));
 
 		if (clone->optIndex)
-		{
-			std::size_t newConstIndex = m_context->options->constIndexGenerator(*clone->optIndex);
-			UniqueInsert(m_context->newConstIndices, *clone->optIndex, newConstIndex);
-			clone->optIndex = newConstIndex;
-		}
+			clone->optIndex = Nz::Retrieve(m_context->newConstIndices, *clone->optIndex);
 		else if (m_context->options->forceIndexGeneration)
 			clone->optIndex = m_context->options->constIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -170,11 +151,7 @@ namespace nzsl::Ast
 		DeclareStructStatementPtr clone = Nz::StaticUniquePointerCast<DeclareStructStatement>(Cloner::Clone(node));
 
 		if (clone->structIndex)
-		{
-			std::size_t newStructIndex = m_context->options->structIndexGenerator(*clone->structIndex);
-			UniqueInsert(m_context->newStructIndices, *clone->structIndex, newStructIndex);
-			clone->structIndex = newStructIndex;
-		}
+			clone->structIndex = Nz::Retrieve(m_context->newStructIndices, *clone->structIndex);
 		else if (m_context->options->forceIndexGeneration)
 			clone->structIndex = m_context->options->structIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -189,11 +166,7 @@ namespace nzsl::Ast
 		DeclareVariableStatementPtr clone = Nz::StaticUniquePointerCast<DeclareVariableStatement>(Cloner::Clone(node));
 
 		if (clone->varIndex)
-		{
-			std::size_t newVarIndex = m_context->options->varIndexGenerator(*clone->varIndex);
-			UniqueInsert(m_context->newVarIndices, *clone->varIndex, newVarIndex);
-			clone->varIndex = newVarIndex;
-		}
+			clone->varIndex = Nz::Retrieve(m_context->newVarIndices, *clone->varIndex);
 		else if (m_context->options->forceIndexGeneration)
 			clone->varIndex = m_context->options->varIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -207,11 +180,7 @@ namespace nzsl::Ast
 		// We have to handle the for each var index before its content
 		std::optional<std::size_t> varIndex = node.varIndex;
 		if (varIndex)
-		{
-			std::size_t newVarIndex = m_context->options->varIndexGenerator(*varIndex);
-			UniqueInsert(m_context->newVarIndices, *varIndex, newVarIndex);
-			varIndex = newVarIndex;
-		}
+			varIndex = Nz::Retrieve(m_context->newVarIndices, *varIndex);
 		else if (m_context->options->forceIndexGeneration)
 			varIndex = m_context->options->varIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -226,11 +195,7 @@ namespace nzsl::Ast
 		// We have to handle the for each var index before its content
 		std::optional<std::size_t> varIndex = node.varIndex;
 		if (varIndex)
-		{
-			std::size_t newVarIndex = m_context->options->varIndexGenerator(*varIndex);
-			UniqueInsert(m_context->newVarIndices, *varIndex, newVarIndex);
-			varIndex = newVarIndex;
-		}
+			varIndex = Nz::Retrieve(m_context->newVarIndices, *varIndex);
 		else if (m_context->options->forceIndexGeneration)
 			varIndex = m_context->options->varIndexGenerator(std::numeric_limits<std::size_t>::max());
 
@@ -320,8 +285,7 @@ namespace nzsl::Ast
 
 			AliasType remappedAliasType;
 			remappedAliasType.aliasIndex = it->second;
-			remappedAliasType.targetType = std::make_unique<ContainedType>();
-			remappedAliasType.targetType->type = RemapType(aliasType.targetType->type);
+			remappedAliasType.targetType = std::make_shared<const ContainedType>(ContainedType{ RemapType(aliasType.targetType->type) });
 
 			return remappedAliasType;
 		}
@@ -330,8 +294,7 @@ namespace nzsl::Ast
 			const ArrayType& arrayType = std::get<ArrayType>(exprType);
 
 			ArrayType remappedArrayType;
-			remappedArrayType.containedType = std::make_unique<ContainedType>();
-			remappedArrayType.containedType->type = RemapType(arrayType.containedType->type);
+			remappedArrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ RemapType(arrayType.containedType->type) });
 			remappedArrayType.length = arrayType.length;
 
 			return remappedArrayType;
@@ -341,8 +304,7 @@ namespace nzsl::Ast
 			const DynArrayType& arrayType = std::get<DynArrayType>(exprType);
 
 			DynArrayType remappedArrayType;
-			remappedArrayType.containedType = std::make_unique<ContainedType>();
-			remappedArrayType.containedType->type = RemapType(arrayType.containedType->type);
+			remappedArrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ RemapType(arrayType.containedType->type) });
 
 			return remappedArrayType;
 		}
@@ -360,8 +322,7 @@ namespace nzsl::Ast
 
 			MethodType remappedMethodType;
 			remappedMethodType.methodIndex = methodType.methodIndex;
-			remappedMethodType.objectType = std::make_unique<ContainedType>();
-			remappedMethodType.objectType->type = RemapType(methodType.objectType->type);
+			remappedMethodType.objectType = std::make_shared<const ContainedType>(ContainedType{ RemapType(methodType.objectType->type) });
 
 			return remappedMethodType;
 		}
@@ -0,0 +1,367 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/OptionRelevanceVisitor.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+
+namespace nzsl::Ast
+{
+	auto OptionRelevanceVisitor::Analyze(const Module& shaderModule) -> Result
+	{
+		m_conditionUsage = nullptr;
+		NAZARA_DEFER({
+			m_currentDeclarationId.reset();
+			m_declarationByAlias.clear();
+			m_declarationByConstant.clear();
+			m_declarationByFunction.clear();
+			m_declarationByStruct.clear();
+			m_declarationByVariable.clear();
+			m_declarationsByName.clear();
+			m_declarations.clear();
+			m_entryPoints.clear();
+			m_options.clear();
+			m_rootConditions.clear();
+			m_globalUsage = UsageSet{};
+		});
+
+		for (const auto& importedModule : shaderModule.importedModules)
+			importedModule.module->rootNode->Visit(*this);
+
+		shaderModule.rootNode->Visit(*this);
+
+		Result result;
+		result.entryPoints.reserve(m_entryPoints.size());
+		for (const PendingEntryPoint& pendingEntryPoint : m_entryPoints)
+		{
+			auto& entryPoint = result.entryPoints.emplace_back();
+			entryPoint.functionName = pendingEntryPoint.functionName;
+			entryPoint.stage = pendingEntryPoint.stage;
+
+			Nz::Bitset<> visitedDeclarations;
+			Resolve(m_globalUsage, visitedDeclarations, entryPoint.relevantOptions);
+			ResolveDeclaration(pendingEntryPoint.declarationId, visitedDeclarations, entryPoint.relevantOptions);
+		}
+
+		Nz::Bitset<> visitedDeclarations;
+		Resolve(m_globalUsage, visitedDeclarations, result.referencedOptions);
+		for (std::size_t declarationId = 0; declarationId < m_declarations.size(); ++declarationId)
+		{
+			// Options are only relevant if something references them
+			if (!m_declarations[declarationId].optionIndex)
+				ResolveDeclaration(declarationId, visitedDeclarations, result.referencedOptions);
+		}
+
+		result.options = std::move(m_options);
+
+		return result;
+	}
+
+	std::size_t OptionRelevanceVisitor::BeginDeclaration(const std::string& name, std::unordered_map<std::size_t, std::size_t>& declarationByIndex, const std::optional<std::size_t>& index)
+	{
+		std::size_t declarationId = m_declarations.size();
+		Declaration& declaration = m_declarations.emplace_back();
+
+		// A declaration under a [cond] depends on the options of its condition
+		if (!m_currentDeclarationId)
+		{
+			for (const UsageSet& conditionUsage : m_rootConditions)
+			{
+				declaration.usageSet.usedAliases |= conditionUsage.usedAliases;
+				declaration.usageSet.usedConstants |= conditionUsage.usedConstants;
+				declaration.usageSet.usedFunctions |= conditionUsage.usedFunctions;
+				declaration.usageSet.usedStructs |= conditionUsage.usedStructs;
+				declaration.usageSet.usedVariables |= conditionUsage.usedVariables;
+				declaration.usageSet.usedIdentifiers.insert(conditionUsage.usedIdentifiers.begin(), conditionUsage.usedIdentifiers.end());
+			}
+		}
+
+		if (index)
+			declarationByIndex.emplace(*index, declarationId);
+
+		if (!name.empty())
+			m_declarationsByName.emplace(name, declarationId);
+
+		return declarationId;
+	}
+
+	auto OptionRelevanceVisitor::GetContextUsageSet() -> UsageSet&
+	{
+		if (m_currentDeclarationId)
+			return m_declarations[*m_currentDeclarationId].usageSet;
+		else if (m_conditionUsage)
+			return *m_conditionUsage;
+		else
+			return m_globalUsage;
+	}
+
+	void OptionRelevanceVisitor::RegisterType(UsageSet& usageSet, const ExpressionType& exprType)
+	{
+		std::visit([&](auto&& arg)
+		{
+			using T = std::decay_t<decltype(arg)>;
+
+			if constexpr (std::is_same_v<T, AliasType>)
+				usageSet.usedAliases.UnboundedSet(arg.aliasIndex);
+			else if constexpr (std::is_base_of_v<BaseArrayType, T>)
+				RegisterType(usageSet, arg.containedType->type);
+			else if constexpr (std::is_same_v<T, StructType>)
+				usageSet.usedStructs.UnboundedSet(arg.structIndex);
+			else if constexpr (std::is_same_v<T, StorageType> || std::is_same_v<T, UniformType> || std::is_same_v<T, PushConstantType>)
+				usageSet.usedStructs.UnboundedSet(arg.containedType.structIndex);
+
+		}, exprType);
+	}
+
+	void OptionRelevanceVisitor::Resolve(const UsageSet& usageSet, Nz::Bitset<>& visitedDeclarations, Nz::Bitset<>& relevantOptions) const
+	{
+		auto ResolveIndices = [&](const Nz::Bitset<>& indices, const std::unordered_map<std::size_t, std::size_t>& declarationByIndex)
+		{
+			// Unknown indices are local variables or builtin constants
+			for (std::size_t index : indices.IterBits())
+			{
+				auto it = declarationByIndex.find(index);
+				if (it != declarationByIndex.end())
+					ResolveDeclaration(it->second, visitedDeclarations, relevantOptions);
+			}
+		};
+
+		ResolveIndices(usageSet.usedAliases, m_declarationByAlias);
+		ResolveIndices(usageSet.usedConstants, m_declarationByConstant);
+		ResolveIndices(usageSet.usedFunctions, m_declarationByFunction);
+		ResolveIndices(usageSet.usedStructs, m_declarationByStruct);
+		ResolveIndices(usageSet.usedVariables, m_declarationByVariable);
+
+		// Identifiers which couldn't be resolved may refer to any declaration with that name
+		for (const std::string& identifier : usageSet.usedIdentifiers)
+		{
+			auto range = m_declarationsByName.equal_range(identifier);
+			for (auto it = range.first; it != range.second; ++it)
+				ResolveDeclaration(it->second, visitedDeclarations, relevantOptions);
+		}
+	}
+
+	void OptionRelevanceVisitor::ResolveDeclaration(std::size_t declarationId, Nz::Bitset<>& visitedDeclarations, Nz::Bitset<>& relevantOptions) const
+	{
+		if (visitedDeclarations.UnboundedTest(declarationId))
+			return;
+
+		visitedDeclarations.UnboundedSet(declarationId);
+
+		const Declaration& declaration = m_declarations[declarationId];
+		if (declaration.optionIndex)
+			relevantOptions.UnboundedSet(*declaration.optionIndex);
+
+		Resolve(declaration.usageSet, visitedDeclarations, relevantOptions);
+	}
+
+	template<typename T>
+	void OptionRelevanceVisitor::VisitValue(const ExpressionValue<T>& value)
+	{
+		if (value.IsExpression())
+			value.GetExpression()->Visit(*this);
+		else if constexpr (std::is_same_v<T, ExpressionType>)
+		{
+			if (value.IsResultingValue())
+				RegisterType(GetContextUsageSet(), value.GetResultingValue());
+		}
+	}
+
+	void OptionRelevanceVisitor::Visit(AliasValueExpression& node)
+	{
+		GetContextUsageSet().usedAliases.UnboundedSet(node.aliasId);
+	}
+
+	void OptionRelevanceVisitor::Visit(CastExpression& node)
+	{
+		VisitValue(node.targetType);
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionRelevanceVisitor::Visit(ConditionalExpression& node)
+	{
+		node.condition->Visit(*this);
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionRelevanceVisitor::Visit(ConstantExpression& node)
+	{
+		GetContextUsageSet().usedConstants.UnboundedSet(node.constantId);
+	}
+
+	void OptionRelevanceVisitor::Visit(FunctionExpression& node)
+	{
+		GetContextUsageSet().usedFunctions.UnboundedSet(node.funcId);
+	}
+
+	void OptionRelevanceVisitor::Visit(IdentifierExpression& node)
+	{
+		GetContextUsageSet().usedIdentifiers.insert(node.identifier);
+	}
+
+	void OptionRelevanceVisitor::Visit(StructTypeExpression& node)
+	{
+		GetContextUsageSet().usedStructs.UnboundedSet(node.structTypeId);
+	}
+
+	void OptionRelevanceVisitor::Visit(VariableValueExpression& node)
+	{
+		GetContextUsageSet().usedVariables.UnboundedSet(node.variableId);
+	}
+
+	void OptionRelevanceVisitor::Visit(ConditionalStatement& node)
+	{
+		if (m_currentDeclarationId)
+		{
+			node.condition->Visit(*this);
+			node.statement->Visit(*this);
+			return;
+		}
+
+		// Root [cond], the condition becomes a dependency of the declarations it guards
+		UsageSet& conditionUsage = m_rootConditions.emplace_back();
+
+		UsageSet* previousConditionUsage = m_conditionUsage;
+		m_conditionUsage = &conditionUsage;
+		node.condition->Visit(*this);
+		m_conditionUsage = previousConditionUsage;
+
+		node.statement->Visit(*this);
+
+		m_rootConditions.pop_back();
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareAliasStatement& node)
+	{
+		std::optional<std::size_t> previousDeclarationId = m_currentDeclarationId;
+		m_currentDeclarationId = BeginDeclaration(node.name, m_declarationByAlias, node.aliasIndex);
+
+		RecursiveVisitor::Visit(node);
+
+		m_currentDeclarationId = previousDeclarationId;
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareConstStatement& node)
+	{
+		std::optional<std::size_t> previousDeclarationId = m_currentDeclarationId;
+		std::size_t declarationId = BeginDeclaration(node.name, m_declarationByConstant, node.constIndex);
+
+		// Local constants are part of their function
+		if (previousDeclarationId && node.constIndex)
+			GetContextUsageSet().usedConstants.UnboundedSet(*node.constIndex);
+
+		m_currentDeclarationId = declarationId;
+
+		VisitValue(node.type);
+		RecursiveVisitor::Visit(node);
+
+		m_currentDeclarationId = previousDeclarationId;
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareExternalStatement& node)
+	{
+		std::optional<std::size_t> previousDeclarationId = m_currentDeclarationId;
+
+		for (auto& externalVar : node.externalVars)
+		{
+			m_currentDeclarationId = BeginDeclaration(externalVar.name, m_declarationByVariable, externalVar.varIndex);
+
+			// Block attributes apply to every variable
+			VisitValue(node.bindingSet);
+			VisitValue(node.autoBinding);
+
+			VisitValue(externalVar.bindingIndex);
+			VisitValue(externalVar.bindingSet);
+			VisitValue(externalVar.type);
+		}
+
+		m_currentDeclarationId = previousDeclarationId;
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareFunctionStatement& node)
+	{
+		std::optional<std::size_t> previousDeclarationId = m_currentDeclarationId;
+		m_currentDeclarationId = BeginDeclaration(node.name, m_declarationByFunction, node.funcIndex);
+
+		if (node.entryStage.HasValue())
+		{
+			auto& entryPoint = m_entryPoints.emplace_back();
+			entryPoint.declarationId = *m_currentDeclarationId;
+			entryPoint.functionName = node.name;
+
+			// An unresolved stage may end up being any stage
+			if (node.entryStage.IsResultingValue())
+				entryPoint.stage = node.entryStage.GetResultingValue();
+			else
+				VisitValue(node.entryStage);
+		}
+
+		for (auto& parameter : node.parameters)
+			VisitValue(parameter.type);
+
+		VisitValue(node.depthWrite);
+		VisitValue(node.returnType);
+		VisitValue(node.workgroupSize);
+		VisitValue(node.earlyFragmentTests);
+
+		RecursiveVisitor::Visit(node);
+
+		m_currentDeclarationId = previousDeclarationId;
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareOptionStatement& node)
+	{
+		std::optional<std::size_t> previousDeclarationId = m_currentDeclarationId;
+		m_currentDeclarationId = BeginDeclaration(node.optName, m_declarationByConstant, node.optIndex);
+
+		m_declarations[*m_currentDeclarationId].optionIndex = m_options.size();
+		m_options.push_back(node.optName);
+
+		VisitValue(node.optType);
+		RecursiveVisitor::Visit(node);
+
+		m_currentDeclarationId = previousDeclarationId;
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareStructStatement& node)
+	{
+		std::optional<std::size_t> previousDeclarationId = m_currentDeclarationId;
+		m_currentDeclarationId = BeginDeclaration(node.description.name, m_declarationByStruct, node.structIndex);
+
+		VisitValue(node.description.layout);
+		for (auto& member : node.description.members)
+		{
+			VisitValue(member.builtin);
+			VisitValue(member.cond);
+			VisitValue(member.interp);
+			VisitValue(member.locationIndex);
+			VisitValue(member.type);
+		}
+
+		m_currentDeclarationId = previousDeclarationId;
+	}
+
+	void OptionRelevanceVisitor::Visit(DeclareVariableStatement& node)
+	{
+		VisitValue(node.varType);
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionRelevanceVisitor::Visit(ForStatement& node)
+	{
+		VisitValue(node.unroll);
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionRelevanceVisitor::Visit(ForEachStatement& node)
+	{
+		VisitValue(node.unroll);
+		RecursiveVisitor::Visit(node);
+	}
+
+	void OptionRelevanceVisitor::Visit(WhileStatement& node)
+	{
+		VisitValue(node.unroll);
+		RecursiveVisitor::Visit(node);
+	}
+}
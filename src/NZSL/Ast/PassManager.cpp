@@ -0,0 +1,104 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/PassManager.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
+#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <cassert>
+
+namespace nzsl::Ast
+{
+	ModulePtr PassManager::Run(const Module& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig) const
+	{
+		Context context(shaderModule, nullptr, dependencyConfig);
+		return Run(context);
+	}
+
+	ModulePtr PassManager::Run(ModulePtr&& shaderModule, const DependencyCheckerVisitor::Config& dependencyConfig) const
+	{
+		assert(shaderModule);
+		const Module& moduleRef = *shaderModule;
+
+		// Passes can only work in place on a module no one else references
+		if (shaderModule.use_count() != 1)
+			return Run(moduleRef, dependencyConfig);
+
+		Context context(moduleRef, std::move(shaderModule), dependencyConfig);
+		return Run(context);
+	}
+
+	ModulePtr PassManager::Run(Context& context) const
+	{
+		for (const auto& passPtr : m_passes)
+			context.Invalidate(passPtr->Run(context));
+
+		// Passes which didn't need to rewrite the tree leave it untouched, clone it so we always return a module the caller owns
+		if (!context.GetOwnedModule())
+		{
+			const Module& shaderModule = context.GetModule();
+			return std::make_shared<Module>(shaderModule.metadata, Nz::StaticUniquePointerCast<MultiStatement>(Clone(*shaderModule.rootNode)), shaderModule.importedModules);
+		}
+
+		return context.ReleaseModule();
+	}
+
+	const DependencyCheckerVisitor::UsageSet& PassManager::Context::GetDependencies()
+	{
+		if (!m_dependencies)
+		{
+			DependencyCheckerVisitor dependencyVisitor;
+			for (const auto& importedModule : m_module->importedModules)
+				dependencyVisitor.Register(*importedModule.module->rootNode, m_dependencyConfig);
+
+			dependencyVisitor.Register(*m_module->rootNode, m_dependencyConfig);
+			dependencyVisitor.Resolve();
+
+			m_dependencies = dependencyVisitor.GetUsage();
+		}
+
+		return *m_dependencies;
+	}
+
+	PassManager::Pass::~Pass() = default;
+
+	PassAnalysisFlags ConstantPropagationPass::Run(PassManager::Context& context) const
+	{
+		ConstantPropagationVisitor visitor;
+		if (Module* ownedModule = context.GetOwnedModule())
+			visitor.ProcessInPlace(*ownedModule);
+		else
+			context.SetModule(visitor.Process(context.GetModule()));
+
+		return PassAnalysis::Dependencies;
+	}
+
+	PassAnalysisFlags UnusedEliminationPass::Run(PassManager::Context& context) const
+	{
+		const DependencyCheckerVisitor::UsageSet& usageSet = context.GetDependencies();
+
+		EliminateUnusedPassVisitor visitor;
+		if (Module* ownedModule = context.GetOwnedModule())
+			visitor.ProcessInPlace(*ownedModule, usageSet);
+		else
+			context.SetModule(visitor.Process(context.GetModule(), usageSet));
+
+		// Removed declarations were unused, remaining usage stays valid
+		return {};
+	}
+
+	const PassManager& GetOptimizationPasses()
+	{
+		static PassManager passManager = []
+		{
+			PassManager passes;
+			passes.AddPass<ConstantPropagationPass>();
+			passes.AddPass<UnusedEliminationPass>();
+
+			return passes;
+		}();
+
+		return passManager;
+	}
+}
@@ -14,13 +14,18 @@
 #include <NZSL/Ast/ExportVisitor.hpp>
 #include <NZSL/Ast/ExpressionType.hpp>
 #include <NZSL/Ast/IndexRemapperVisitor.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <NZSL/Ast/ReflectVisitor.hpp>
+#include <NZSL/Ast/SanitizedModuleCache.hpp>
 #include <NZSL/Ast/Utils.hpp>
 #include <NZSL/Lang/Errors.hpp>
 #include <NZSL/Lang/LangData.hpp>
 #include <fmt/format.h>
 #include <frozen/unordered_map.h>
 #include <tsl/ordered_map.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
 #include <unordered_set>
@@ -45,6 +50,220 @@ namespace nzsl::Ast
 
 			using type = T;
 		};
+
+		constexpr std::uint64_t BuildBindingKey(std::uint32_t bindingSet, std::uint32_t bindingIndex)
+		{
+			return std::uint64_t(bindingSet) << 32 | bindingIndex;
+		}
+
+		// Goes through an expression resolved by a previous sanitization to report what it depends on, without resolving it again
+		class ResolvedExpressionVisitor : public RecursiveVisitor
+		{
+			public:
+				struct Callbacks
+				{
+					std::function<void(AccessIndexExpression& node)> onAccessIndex;
+					std::function<void(std::size_t funcIndex)> onFunctionCall;
+				};
+
+				void Process(Expression& expr, const Callbacks& callbacks)
+				{
+					m_callbacks = &callbacks;
+					expr.Visit(*this);
+				}
+
+			private:
+				using RecursiveVisitor::Visit;
+
+				void Visit(AccessIndexExpression& node) override
+				{
+					if (m_callbacks->onAccessIndex)
+						m_callbacks->onAccessIndex(node);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(CallFunctionExpression& node) override
+				{
+					if (m_callbacks->onFunctionCall && node.targetFunction->GetType() == NodeType::FunctionExpression)
+						m_callbacks->onFunctionCall(static_cast<FunctionExpression&>(*node.targetFunction).funcId);
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				const Callbacks* m_callbacks;
+		};
+
+		// Field names can be changed by the identifier sanitizer, accesses by name have to be resolved again to use the new names
+		class FieldIdentifierAccessFinder : public RecursiveVisitor
+		{
+			public:
+				bool Find(Expression& expr)
+				{
+					m_found = false;
+					expr.Visit(*this);
+
+					return m_found;
+				}
+
+			private:
+				using RecursiveVisitor::Visit;
+
+				void Visit(AccessIdentifierExpression& node) override
+				{
+					// Methods (Sample, Size, ...) are the only identifier accesses which are not fields
+					if (!node.cachedExpressionType || !IsMethodType(*node.cachedExpressionType))
+					{
+						m_found = true;
+						return;
+					}
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				bool m_found;
+		};
+
+		class SpecializationConstantFinder : public RecursiveVisitor
+		{
+			public:
+				SpecializationConstantFinder(const std::unordered_map<std::size_t, ExpressionType>& specializationConstantTypes) :
+				m_specializationConstantTypes(specializationConstantTypes),
+				m_found(false)
+				{
+				}
+
+				bool Find(Expression& expr)
+				{
+					m_found = false;
+					expr.Visit(*this);
+
+					return m_found;
+				}
+
+			private:
+				using RecursiveVisitor::Visit;
+
+				void Visit(ConstantExpression& node) override
+				{
+					if (m_specializationConstantTypes.find(node.constantId) != m_specializationConstantTypes.end())
+						m_found = true;
+				}
+
+				const std::unordered_map<std::size_t, ExpressionType>& m_specializationConstantTypes;
+				bool m_found;
+		};
+
+		class CachedDeclarationFinder : public RecursiveVisitor
+		{
+			public:
+				void Find(Statement& statement)
+				{
+					statement.Visit(*this);
+				}
+
+				std::unordered_map<std::size_t, DeclareFunctionStatement*> functions;
+				std::unordered_map<std::size_t, DeclareStructStatement*> structs;
+				std::vector<DeclareExternalStatement*> externals;
+
+			private:
+				using RecursiveVisitor::Visit;
+
+				void Visit(DeclareExternalStatement& node) override
+				{
+					externals.push_back(&node);
+				}
+
+				void Visit(DeclareFunctionStatement& node) override
+				{
+					// Function bodies cannot declare anything registered at module level
+					if (node.funcIndex)
+						functions.emplace(*node.funcIndex, &node);
+				}
+
+				void Visit(DeclareStructStatement& node) override
+				{
+					if (node.structIndex)
+						structs.emplace(*node.structIndex, &node);
+				}
+		};
+
+		class OptionDeclarationFinder : public RecursiveVisitor
+		{
+			public:
+				void Find(Statement& statement)
+				{
+					statement.Visit(*this);
+				}
+
+				std::unordered_set<OptionHash> declaredOptions;
+				bool hasImports = false;
+
+			private:
+				using RecursiveVisitor::Visit;
+
+				void Visit(DeclareOptionStatement& node) override
+				{
+					declaredOptions.insert(HashOption(node.optName.data()));
+
+					RecursiveVisitor::Visit(node);
+				}
+
+				void Visit(ImportStatement& /*node*/) override
+				{
+					hasImports = true;
+				}
+		};
+
+		SanitizedModuleCache::Key BuildModuleCacheKey(const SanitizeVisitor::Options& options, const Module& importedModule, const Module::Metadata& importingMetadata)
+		{
+			SanitizedModuleCache::Key key;
+			key.enabledFeatures = importingMetadata.enabledFeatures; //< feature checks are done against the importing module
+
+			// Only the options declared by the module can change its sanitization, values of options of the importing module don't
+			OptionDeclarationFinder optionFinder;
+			optionFinder.Find(*importedModule.rootNode);
+
+			if (optionFinder.hasImports)
+				key.optionValues = options.optionValues; //< options of the modules it imports aren't known yet
+			else
+			{
+				for (const auto& [optionHash, optionValue] : options.optionValues)
+				{
+					if (optionFinder.declaredOptions.count(optionHash) != 0)
+						key.optionValues.emplace(optionHash, optionValue);
+				}
+			}
+
+			std::uint64_t flagIndex = 0;
+			auto AddFlag = [&](bool value)
+			{
+				if (value)
+					key.sanitizeFlags |= std::uint64_t(1) << flagIndex;
+
+				flagIndex++;
+			};
+
+			key.sanitizeFlags = 0;
+			AddFlag(options.forceAutoBindingResolve);
+			AddFlag(options.makeVariableNameUnique);
+			AddFlag(options.partialSanitization);
+			AddFlag(options.reduceLoopsToWhile);
+			AddFlag(options.removeAliases);
+			AddFlag(options.removeCompoundAssignments);
+			AddFlag(options.removeConstArraySize);
+			AddFlag(options.removeMatrixBinaryAddSub);
+			AddFlag(options.removeMatrixCast);
+			AddFlag(options.removeOptionDeclaration);
+			AddFlag(options.removeScalarSwizzling);
+			AddFlag(options.removeSingleConstDeclaration);
+			AddFlag(options.splitMultipleBranches);
+			AddFlag(options.splitWrappedArrayAssignation);
+			AddFlag(options.splitWrappedStructAssignation);
+			AddFlag(options.useIdentifierAccessesForStructs);
+
+			return key;
+		}
 	}
 
 	template<typename T>
@@ -122,6 +341,15 @@ namespace nzsl::Ast
 			return it->second;
 		}
 
+		const T& Retrieve(std::size_t index, const SourceLocation& sourceLocation) const
+		{
+			auto it = values.find(index);
+			if (it == values.end())
+				throw AstInvalidIndexError{ sourceLocation, index };
+
+			return it->second;
+		}
+
 		T* TryRetrieve(std::size_t index, const SourceLocation& sourceLocation)
 		{
 			auto it = values.find(index);
@@ -144,10 +372,14 @@ namespace nzsl::Ast
 
 	struct SanitizeVisitor::Environment
 	{
+		static constexpr std::size_t InvalidIdentifierIndex = std::numeric_limits<std::size_t>::max();
+
 		std::shared_ptr<Environment> parentEnv;
 		std::string moduleId;
+		std::unordered_map<Symbol, std::size_t> lastIdentifierByName; //< index of the innermost identifier with this name
 		std::vector<PendingFunction> pendingFunctions;
 		std::vector<Identifier> identifiersInScope;
+		std::vector<std::size_t> shadowedIdentifiers; //< for each identifier in scope, index of the previous identifier with the same name (or InvalidIdentifierIndex)
 		std::vector<Scope> scopes;
 	};
 
@@ -164,7 +396,8 @@ namespace nzsl::Ast
 	struct SanitizeVisitor::PendingFunction
 	{
 		DeclareFunctionStatement* cloneNode;
-		const DeclareFunctionStatement* node;
+		DeclareFunctionStatement* node; //< null when consuming input
+		std::vector<StatementPtr> inputStatements; //< function body taken from the input node when consuming it
 	};
 
 	struct SanitizeVisitor::NamedPartialType
@@ -173,6 +406,13 @@ namespace nzsl::Ast
 		PartialType type;
 	};
 
+	struct SanitizeVisitor::BuiltinEnvironment
+	{
+		std::shared_ptr<Environment> environment;
+		IdentifierList<IntrinsicType> intrinsics;
+		IdentifierList<std::variant<ExpressionType, NamedPartialType>> types;
+	};
+
 	struct SanitizeVisitor::Context
 	{
 		struct ModuleData
@@ -197,6 +437,7 @@ namespace nzsl::Ast
 		static constexpr std::size_t ModuleIdSentinel =  std::numeric_limits<std::size_t>::max();
 
 		std::array<DeclareFunctionStatement*, ShaderStageTypeCount> entryFunctions = {};
+		std::shared_ptr<const BuiltinEnvironment> builtins;
 		std::shared_ptr<Environment> globalEnv;
 		std::shared_ptr<Environment> currentEnv;
 		std::shared_ptr<Environment> moduleEnv;
@@ -204,105 +445,134 @@ namespace nzsl::Ast
 		std::unordered_map<std::uint64_t, UsedExternalData> usedBindingIndexes;
 		std::unordered_map<std::string, UsedExternalData> declaredExternalVar;
 		std::unordered_map<OptionHash, std::string> declaredOptions;
+		std::unordered_map<std::size_t /*constIndex*/, ExpressionType> specializationConstantTypes;
 		std::vector<ModuleData> modules;
 		std::vector<NamedExternalBlockData> namedExternalBlocks;
 		std::vector<StatementPtr>* currentStatementList = nullptr;
 		IdentifierList<ConstantValue> constantValues;
 		IdentifierList<FunctionData> functions;
 		IdentifierList<Identifier> aliases;
-		IdentifierList<IntrinsicType> intrinsics;
 		IdentifierList<std::size_t> moduleIndices;
 		IdentifierList<std::size_t> namedExternalBlockIndices;
 		IdentifierList<StructDescription*> structs;
-		IdentifierList<std::variant<ExpressionType, NamedPartialType>> types;
 		IdentifierList<ExpressionType> variableTypes;
 		ModulePtr currentModule;
 		Options options;
 		SourceLocation pushConstantLocation;
 		FunctionData* currentFunction = nullptr;
 		bool allowUnknownIdentifiers = false;
+		bool consumeInput = false; //< input nodes are moved to the output instead of being copied
 		bool inLoop = false;
+		bool keepResolvedExpressions = false; //< expressions typed by a previous (partial) sanitization are copied without being resolved and validated again
 		unsigned int currentConditionalIndex = 0;
 		unsigned int nextConditionalIndex = 1;
 	};
 
-	ModulePtr SanitizeVisitor::Sanitize(const Module& module, const Options& options, std::string* error)
+	struct SanitizeVisitor::ModuleRegistrations
 	{
-		ModulePtr clone = std::make_shared<Module>(module.metadata);
-
-		Context currentContext;
-		currentContext.options = options;
-		currentContext.currentModule = clone;
+		// Indices are the ones of the sanitization which cached the module, other registrations (structs, external variables, entry points) are retrieved from the module statements
+		std::vector<Identifier> identifiers;
+		std::vector<std::pair<std::size_t, Identifier>> aliases;
+		std::vector<std::pair<std::size_t, ConstantValue>> constants;
+		std::vector<std::pair<std::size_t, FunctionData>> functions;
+		std::vector<std::pair<OptionHash, std::string>> declaredOptions;
+		bool hasAutoBindings = false; //< automatic binding indices depend on the bindings declared before the import
+	};
 
-		m_context = &currentContext;
-		NAZARA_DEFER({ m_context = nullptr; });
+	ModulePtr SanitizeVisitor::Sanitize(const Module& module, const Options& options, std::string* error)
+	{
+		return SanitizeInternal(module, false, false, options, error);
+	}
 
-		PreregisterIndices(module);
+	ModulePtr SanitizeVisitor::Sanitize(Module&& module, const Options& options, std::string* error)
+	{
+		return SanitizeInternal(module, true, false, options, error);
+	}
 
-		// Register global env
-		m_context->globalEnv = std::make_shared<Environment>();
-		m_context->currentEnv = m_context->globalEnv;
-		RegisterBuiltin();
+	ModulePtr SanitizeVisitor::Specialize(const Module& module, const std::unordered_map<OptionHash, ConstantValue>& optionValues, const Options& options, std::string* error)
+	{
+		// Conditionals and const_select get folded now that options have a value, declarations are registered again with their existing indices
+		// and only the expressions the partial sanitization couldn't resolve go through resolution and validation
+		Options specializeOptions = options;
+		specializeOptions.optionValues = optionValues;
+		specializeOptions.partialSanitization = false;
 
-		m_context->moduleEnv = std::make_shared<Environment>();
-		m_context->moduleEnv->moduleId = clone->metadata->moduleName;
-		m_context->moduleEnv->parentEnv = m_context->globalEnv;
+		return SanitizeInternal(module, false, true, specializeOptions, error);
+	}
+	
+	ExpressionPtr SanitizeVisitor::CloneExpression(Expression& expr)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
 
-		for (std::size_t moduleId = 0; moduleId < module.importedModules.size(); ++moduleId)
+		// Expressions are only typed once all of their children are, such an expression doesn't depend on options
+		if (m_context && m_context->keepResolvedExpressions && expr.cachedExpressionType.has_value() && !FieldIdentifierAccessFinder{}.Find(expr))
 		{
-			const auto& importedModule = module.importedModules[moduleId];
-			if (!importedModule.module)
-				throw std::runtime_error("unexpected invalid imported module");
-
-			if (!importedModule.module->importedModules.empty())
-				throw std::runtime_error("imported modules cannot have imported modules themselves");
+			RegisterResolvedExpression(expr);
+			return Ast::Clone(expr);
+		}
 
-			auto& cloneImportedModule = clone->importedModules.emplace_back();
-			cloneImportedModule.identifier = importedModule.identifier;
-			cloneImportedModule.module = std::make_shared<Module>(importedModule.module->metadata);
+		return Cloner::CloneExpression(expr);
+	}
 
-			auto importedModuleEnv = std::make_shared<Environment>();
-			importedModuleEnv->moduleId = cloneImportedModule.module->metadata->moduleName;
-			importedModuleEnv->parentEnv = m_context->globalEnv;
+	void SanitizeVisitor::RegisterResolvedExpression(Expression& expr)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
 
-			m_context->currentEnv = importedModuleEnv;
+		if (!m_context->currentFunction)
+			return;
 
-			cloneImportedModule.module->rootNode = SanitizeInternal(*importedModule.module->rootNode, error);
-			if (!cloneImportedModule.module->rootNode)
-				return {};
+		// Called functions and builtins of accessed fields are checked against the stages calling this function
+		FunctionData& funcData = *m_context->currentFunction;
 
-			m_context->moduleByName[cloneImportedModule.module->metadata->moduleName] = moduleId;
-			auto& moduleData = m_context->modules.emplace_back();
-			moduleData.environment = std::move(importedModuleEnv);
-			moduleData.moduleName = cloneImportedModule.identifier;
+		auto RegisterFieldBuiltin = [&](const StructDescription::StructMember& field, const SourceLocation& sourceLocation)
+		{
+			if (field.builtin.HasValue() && field.builtin.IsResultingValue())
+				funcData.usedBuiltins.emplace(field.builtin.GetResultingValue(), sourceLocation);
+		};
 
-			m_context->currentEnv = m_context->globalEnv;
-			RegisterModule(cloneImportedModule.identifier, moduleId);
-		}
+		auto IsFieldEnabled = [](const StructDescription::StructMember& field)
+		{
+			return !field.cond.HasValue() || !field.cond.IsResultingValue() || field.cond.GetResultingValue();
+		};
 
-		m_context->currentEnv = m_context->moduleEnv;
+		ResolvedExpressionVisitor::Callbacks callbacks;
+		callbacks.onAccessIndex = [&](AccessIndexExpression& node)
+		{
+			const ExpressionType* exprType = GetExpressionType(*node.expr);
+			if (!exprType || !IsStructAddressible(*exprType) || node.indices.size() != 1 || node.indices.front()->GetType() != NodeType::ConstantValueExpression)
+				return;
 
-		clone->rootNode = SanitizeInternal(*module.rootNode, error);
-		if (!clone->rootNode)
-			return {};
+			const ConstantSingleValue& indexValue = static_cast<ConstantValueExpression&>(*node.indices.front()).value;
+			if (!std::holds_alternative<std::int32_t>(indexValue))
+				return;
 
-		// Remove unused statements of imported modules
-		for (std::size_t moduleId = 0; moduleId < clone->importedModules.size(); ++moduleId)
-		{
-			auto& moduleData = m_context->modules[moduleId];
-			auto& importedModule = clone->importedModules[moduleId];
+			std::size_t structIndex = ResolveStructIndex(*exprType, node.sourceLocation);
+			const StructDescription* s = m_context->structs.Retrieve(structIndex, node.sourceLocation);
 
-			if (moduleData.dependenciesVisitor)
+			// field indices don't count disabled fields
+			std::int32_t fieldIndex = std::get<std::int32_t>(indexValue);
+			for (const auto& field : s->members)
 			{
-				moduleData.dependenciesVisitor->Resolve(true); //< allow unknown identifiers since we may be referencing other modules
+				if (!IsFieldEnabled(field))
+					continue;
 
-				importedModule.module = EliminateUnusedPass(*importedModule.module, moduleData.dependenciesVisitor->GetUsage());
+				if (fieldIndex-- == 0)
+				{
+					RegisterFieldBuiltin(field, node.sourceLocation);
+					break;
+				}
 			}
-		}
+		};
 
-		return clone;
+		callbacks.onFunctionCall = [&](std::size_t funcIndex)
+		{
+			funcData.calledFunctions.UnboundedSet(funcIndex);
+		};
+
+		ResolvedExpressionVisitor visitor;
+		visitor.Process(expr, callbacks);
 	}
-	
+
 	ExpressionValue<ExpressionType> SanitizeVisitor::CloneType(const ExpressionValue<ExpressionType>& exprType)
 	{
 		if (!exprType.HasValue())
@@ -348,8 +618,7 @@ namespace nzsl::Ast
 				else
 					throw CompilerUnknownMethodError{ identifierEntry.sourceLocation, ToString(resolvedType, indexedExpr->sourceLocation), identifierEntry.identifier };
 
-				methodType.objectType = std::make_unique<ContainedType>();
-				methodType.objectType->type = resolvedType;
+				methodType.objectType = std::make_shared<const ContainedType>(ContainedType{ resolvedType });
 
 				// TODO: Add a MethodExpression?
 				auto identifierExpr = std::make_unique<AccessIdentifierExpression>();
@@ -370,8 +639,7 @@ namespace nzsl::Ast
 				else
 					throw CompilerUnknownMethodError{ identifierEntry.sourceLocation, ToString(resolvedType, indexedExpr->sourceLocation), identifierEntry.identifier };
 
-				methodType.objectType = std::make_unique<ContainedType>();
-				methodType.objectType->type = resolvedType;
+				methodType.objectType = std::make_shared<const ContainedType>(ContainedType{ resolvedType });
 
 				// TODO: Add a MethodExpression?
 				auto identifierExpr = std::make_unique<AccessIdentifierExpression>();
@@ -391,8 +659,7 @@ namespace nzsl::Ast
 
 					MethodType methodType;
 					methodType.methodIndex = 0; //< FIXME
-					methodType.objectType = std::make_unique<ContainedType>();
-					methodType.objectType->type = resolvedType;
+					methodType.objectType = std::make_shared<const ContainedType>(ContainedType{ resolvedType });
 
 					identifierExpr->cachedExpressionType = std::move(methodType);
 					indexedExpr = std::move(identifierExpr);
@@ -674,8 +941,7 @@ namespace nzsl::Ast
 
 		AliasType aliasType;
 		aliasType.aliasIndex = node.aliasId;
-		aliasType.targetType = std::make_unique<ContainedType>();
-		aliasType.targetType->type = *targetExpr->cachedExpressionType;
+		aliasType.targetType = std::make_shared<const ContainedType>(ContainedType{ *targetExpr->cachedExpressionType });
 
 		auto clone = Nz::StaticUniquePointerCast<AliasValueExpression>(Cloner::Clone(node));
 		clone->cachedExpressionType = std::move(aliasType);
@@ -886,7 +1152,7 @@ namespace nzsl::Ast
 			for (const auto& parameter : node.parameters)
 				parameters.push_back(CloneExpression(parameter.expr));
 
-			auto intrinsic = ShaderBuilder::Intrinsic(m_context->intrinsics.Retrieve(targetIntrinsicId, node.sourceLocation), std::move(parameters));
+			auto intrinsic = ShaderBuilder::Intrinsic(m_context->builtins->intrinsics.Retrieve(targetIntrinsicId, node.sourceLocation), std::move(parameters));
 			intrinsic->sourceLocation = node.sourceLocation;
 			Validate(*intrinsic);
 
@@ -1118,12 +1384,30 @@ namespace nzsl::Ast
 
 	ExpressionPtr SanitizeVisitor::Clone(ConditionalExpression& node)
 	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
 		MandatoryExpr(node.condition, node.sourceLocation);
 		MandatoryExpr(node.truePath, node.sourceLocation);
 		MandatoryExpr(node.falsePath, node.sourceLocation);
 
 		ExpressionPtr cloneCondition = Cloner::Clone(*node.condition);
 
+		// Specialization constants values are only known when the pipeline is created, select the value at runtime
+		if (!m_context->specializationConstantTypes.empty() && SpecializationConstantFinder(m_context->specializationConstantTypes).Find(*cloneCondition))
+		{
+			std::vector<ExpressionPtr> parameters;
+			parameters.push_back(std::move(cloneCondition));
+			parameters.push_back(CloneExpression(node.truePath));
+			parameters.push_back(CloneExpression(node.falsePath));
+
+			auto selectExpr = ShaderBuilder::Intrinsic(IntrinsicType::Select, std::move(parameters));
+			selectExpr->sourceLocation = node.sourceLocation;
+
+			Validate(*selectExpr);
+
+			return selectExpr;
+		}
+
 		std::optional<ConstantValue> conditionValue = ComputeConstantValue(*cloneCondition);
 		if (!conditionValue.has_value())
 		{
@@ -1147,6 +1431,15 @@ namespace nzsl::Ast
 		const ConstantValue* value = m_context->constantValues.TryRetrieve(node.constantId, node.sourceLocation);
 		if (!value)
 		{
+			// Specialization constants only get their value when the pipeline is created
+			if (auto it = m_context->specializationConstantTypes.find(node.constantId); it != m_context->specializationConstantTypes.end())
+			{
+				auto constantExpr = Cloner::Clone(node);
+				constantExpr->cachedExpressionType = it->second;
+
+				return constantExpr;
+			}
+
 			if (!m_context->options.partialSanitization)
 				throw AstInvalidConstantIndexError{ node.sourceLocation, node.constantId };
 
@@ -1507,26 +1800,6 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 				hasAutoBinding.reset(); //< Unresolved value
 		}
 
-		auto BuildBindingKey = [](std::uint32_t bindingSet, std::uint32_t bindingIndex)
-		{
-			return std::uint64_t(bindingSet) << 32 | bindingIndex;
-		};
-
-		auto RegisterBinding = [&](std::uint32_t count, std::uint32_t bindingSet, std::uint32_t bindingIndex, const Context::UsedExternalData& usedBindingData, const SourceLocation& sourceLoc)
-		{
-			for (std::uint32_t i = 0; i < count; ++i)
-			{
-				std::uint64_t bindingKey = BuildBindingKey(bindingSet, bindingIndex + i);
-				if (auto it = m_context->usedBindingIndexes.find(bindingKey); it != m_context->usedBindingIndexes.end())
-				{
-					if (it->second.conditionalStatementIndex == m_context->currentConditionalIndex || usedBindingData.conditionalStatementIndex == m_context->currentConditionalIndex)
-						throw CompilerExtBindingAlreadyUsedError{ sourceLoc, bindingSet, bindingIndex };
-				}
-
-				m_context->usedBindingIndexes.emplace(bindingKey, usedBindingData);
-			}
-		};
-
 		std::optional<std::size_t> namedExternalBlockIndex;
 		std::shared_ptr<Environment> previousEnv;
 		if (!clone->name.empty())
@@ -1556,22 +1829,12 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 				SanitizeIdentifier(fullName, IdentifierScope::ExternalVariable);
 			}
 
-			std::string& internalName = (!clone->name.empty()) ? fullName : extVar.name;
-
-			Context::UsedExternalData usedBindingData;
-			usedBindingData.conditionalStatementIndex = m_context->currentConditionalIndex;
-
-			if (auto it = m_context->declaredExternalVar.find(internalName); it != m_context->declaredExternalVar.end())
-			{
-				if (it->second.conditionalStatementIndex == m_context->currentConditionalIndex || usedBindingData.conditionalStatementIndex == m_context->currentConditionalIndex)
-					throw CompilerExtAlreadyDeclaredError{ extVar.sourceLocation, extVar.name };
-			}
-
-			m_context->declaredExternalVar.emplace(internalName, usedBindingData);
+			const std::string& internalName = (!clone->name.empty()) ? fullName : extVar.name;
 
 			std::optional<ExpressionType> resolvedType = ResolveTypeExpr(extVar.type, false, node.sourceLocation);
 			if (!resolvedType.has_value())
 			{
+				RegisterExternalVariable(internalName, extVar, nullptr);
 				RegisterUnresolved(extVar.name);
 				hasUnresolved = true;
 				continue;
@@ -1601,11 +1864,6 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 
 			if (IsPushConstantType(targetType))
 			{
-				if (m_context->pushConstantLocation.IsValid())
-					throw CompilerMultiplePushConstantError{ extVar.sourceLocation };
-
-				m_context->pushConstantLocation = extVar.sourceLocation;
-
 				if (extVar.bindingSet.HasValue())
 					throw CompilerUnexpectedAttributeOnPushConstantError{ extVar.sourceLocation, Ast::AttributeType::Set };
 				else if (extVar.bindingIndex.HasValue())
@@ -1638,14 +1896,7 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 
 			ValidateConcreteType(varType, extVar.sourceLocation);
 
-			if (extVar.bindingSet.IsResultingValue() && extVar.bindingIndex.IsResultingValue())
-			{
-				std::uint32_t bindingSet = extVar.bindingSet.GetResultingValue();
-				std::uint32_t bindingIndex = extVar.bindingIndex.GetResultingValue();
-
-				std::uint32_t arraySize = (IsArrayType(targetType)) ? std::get<ArrayType>(targetType).length : 1;
-				RegisterBinding(arraySize, bindingSet, bindingIndex, usedBindingData, extVar.sourceLocation);
-			}
+			RegisterExternalVariable(internalName, extVar, &targetType);
 
 			extVar.type = std::move(resolvedType).value();
 			extVar.varIndex = RegisterVariable(extVar.name, std::move(varType), extVar.varIndex, extVar.sourceLocation);
@@ -1690,11 +1941,8 @@ NAZARA_WARNING_GCC_DISABLE("-Wmaybe-uninitialized")
 				while (!SearchFreeBindingRange(bindingIndex))
 					bindingIndex++;
 
-				Context::UsedExternalData usedBindingData;
-				usedBindingData.conditionalStatementIndex = m_context->currentConditionalIndex;
-
 				extVar.bindingIndex = bindingIndex;
-				RegisterBinding(arraySize, bindingSet, bindingIndex, usedBindingData, extVar.sourceLocation);
+				RegisterExternalBinding(bindingSet, bindingIndex, arraySize, extVar.sourceLocation);
 			}
 		}
 
@@ -1762,7 +2010,7 @@ NAZARA_WARNING_POP()
 				if (m_context->entryFunctions[Nz::UnderlyingCast(stageType)])
 					throw CompilerEntryPointAlreadyDefinedError{ clone->sourceLocation, stageType };
 
-				m_context->entryFunctions[Nz::UnderlyingCast(stageType)] = &node;
+				m_context->entryFunctions[Nz::UnderlyingCast(stageType)] = clone.get();
 			}
 
 			if (clone->parameters.size() > 1)
@@ -1810,7 +2058,12 @@ NAZARA_WARNING_POP()
 		// Function content is resolved in a second pass
 		auto& pendingFunc = m_context->currentEnv->pendingFunctions.emplace_back();
 		pendingFunc.cloneNode = clone.get();
-		pendingFunc.node = &node;
+
+		// The input node may be freed before functions are resolved when consuming input, take its body instead
+		if (m_context->consumeInput)
+			pendingFunc.inputStatements = std::move(node.statements);
+		else
+			pendingFunc.node = &node;
 
 		FunctionData funcData;
 		funcData.node = clone.get(); //< update function node
@@ -1825,6 +2078,8 @@ NAZARA_WARNING_POP()
 
 	StatementPtr SanitizeVisitor::Clone(DeclareOptionStatement& node)
 	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
 		if (m_context->currentFunction)
 			throw CompilerOptionDeclarationInsideFunctionError{ node.sourceLocation };
 
@@ -1870,26 +2125,71 @@ NAZARA_WARNING_POP()
 		else
 			m_context->declaredOptions.emplace(optionHash, clone->optName);
 
-		if (auto optionValueIt = m_context->options.optionValues.find(optionHash); optionValueIt != m_context->options.optionValues.end())
-			clone->optIndex = RegisterConstant(clone->optName, optionValueIt->second, node.optIndex, node.sourceLocation);
-		else
+		if (m_context->options.specializationConstantOptions.count(optionHash) != 0)
 		{
-			if (m_context->options.partialSanitization)
+			if (!IsPrimitiveType(targetType) || std::get<PrimitiveType>(targetType) == PrimitiveType::String)
+				throw CompilerOptionSpecializationUnexpectedTypeError{ node.sourceLocation, clone->optName, ToString(resolvedType, node.sourceLocation) };
+
+			// The option value (if any) is used as the specialization constant default value
+			ConstantValue defaultValue;
+			if (auto optionValueIt = m_context->options.optionValues.find(optionHash); optionValueIt != m_context->options.optionValues.end())
 			{
-				// Partial sanitization, we cannot give a value to this option
-				clone->optIndex = RegisterConstant(clone->optName, std::nullopt, clone->optIndex, node.sourceLocation);
+				defaultValue = optionValueIt->second;
+
+				ExpressionType valueType = GetConstantType(defaultValue);
+				if (valueType != targetType)
+					throw CompilerVarDeclarationTypeUnmatchingError{ node.sourceLocation, ToString(targetType, node.sourceLocation), ToString(valueType, node.sourceLocation) };
 			}
-			else
+			else if (clone->defaultValue)
 			{
-				if (!clone->defaultValue)
-					throw CompilerMissingOptionValueError{ node.sourceLocation, clone->optName };
+				std::optional<ConstantValue> value = ComputeConstantValue(*clone->defaultValue);
+				if (!value)
+				{
+					clone->optIndex = RegisterConstant(clone->optName, std::nullopt, clone->optIndex, node.sourceLocation);
+					return clone; //< unresolved
+				}
 
-				clone->optIndex = RegisterConstant(clone->optName, ComputeConstantValue(*clone->defaultValue), node.optIndex, node.sourceLocation);
+				defaultValue = std::move(*value);
 			}
-		}
+			else
+				throw CompilerMissingOptionValueError{ node.sourceLocation, clone->optName };
 
-		if (m_context->options.removeOptionDeclaration)
-			return ShaderBuilder::NoOp();
+			clone->defaultValue = std::visit([&](auto&& arg) -> ExpressionPtr
+			{
+				using T = std::decay_t<decltype(arg)>;
+
+				if constexpr (GetVectorInnerType<T>::IsVector)
+					throw AstInternalError{ node.sourceLocation, "unexpected array value" };
+				else
+					return ShaderBuilder::ConstantValue(arg, node.sourceLocation);
+			}, defaultValue);
+
+			clone->optIndex = RegisterConstant(clone->optName, std::nullopt, node.optIndex, node.sourceLocation);
+			m_context->specializationConstantTypes.emplace(*clone->optIndex, targetType);
+
+			return clone; //< kept even when removing option declarations, as writers need it to declare the specialization constant
+		}
+
+		if (auto optionValueIt = m_context->options.optionValues.find(optionHash); optionValueIt != m_context->options.optionValues.end())
+			clone->optIndex = RegisterConstant(clone->optName, optionValueIt->second, node.optIndex, node.sourceLocation);
+		else
+		{
+			if (m_context->options.partialSanitization)
+			{
+				// Partial sanitization, we cannot give a value to this option
+				clone->optIndex = RegisterConstant(clone->optName, std::nullopt, clone->optIndex, node.sourceLocation);
+			}
+			else
+			{
+				if (!clone->defaultValue)
+					throw CompilerMissingOptionValueError{ node.sourceLocation, clone->optName };
+
+				clone->optIndex = RegisterConstant(clone->optName, ComputeConstantValue(*clone->defaultValue), node.optIndex, node.sourceLocation);
+			}
+		}
+
+		if (m_context->options.removeOptionDeclaration)
+			return ShaderBuilder::NoOp();
 
 		return clone;
 	}
@@ -2515,6 +2815,8 @@ NAZARA_WARNING_POP()
 
 	StatementPtr SanitizeVisitor::Clone(ImportStatement& node)
 	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
 		tsl::ordered_map<std::string, std::vector<std::string>> importedSymbols;
 		bool importEverythingElse = false;
 		for (const auto& entry : node.identifiers)
@@ -2615,22 +2917,119 @@ NAZARA_WARNING_POP()
 			auto previousEnv = m_context->currentEnv;
 			m_context->currentEnv = moduleEnvironment;
 
-			ModulePtr sanitizedModule = std::make_shared<Module>(targetModule->metadata);
+			// Imported modules are stored sanitized in the cache, importing them again only requires to give them new indices and to register their identifiers
+			std::shared_ptr<SanitizedModuleCache> moduleCache;
+			if (!m_context->options.identifierSanitizer && !m_context->options.partialSanitization && m_context->options.specializationConstantOptions.empty())
+				moduleCache = m_context->options.moduleCache;
+
+			std::optional<SanitizedModuleCache::Key> cacheKey;
+			SanitizedModuleCache::CachedModule cachedModule;
+			if (moduleCache)
+			{
+				cacheKey = BuildModuleCacheKey(m_context->options, *targetModule, *m_context->currentModule->metadata);
+				cachedModule = moduleCache->Find(*targetModule, *cacheKey);
+			}
+
+			const ModuleRegistrations* cachedRegistrations = cachedModule.registrations.get();
+			if (cachedRegistrations && cachedRegistrations->hasAutoBindings && !m_context->usedBindingIndexes.empty())
+				cachedRegistrations = nullptr;
+
+			ModulePtr sanitizedModule;
+			if (cachedRegistrations)
+				sanitizedModule = ImportCachedModule(*cachedModule.sanitizedModule, *cachedRegistrations, node.sourceLocation);
+			else
+			{
+				std::size_t previousModuleCount = m_context->modules.size();
+				std::size_t previousNamedExternalBlockCount = m_context->namedExternalBlocks.size();
+				bool hadUsedBindings = !m_context->usedBindingIndexes.empty();
+
+				// Indices available before the import are the ones the module can register
+				Nz::Bitset<std::uint64_t> previousAliasIndices;
+				Nz::Bitset<std::uint64_t> previousConstIndices;
+				Nz::Bitset<std::uint64_t> previousFuncIndices;
+				std::unordered_map<OptionHash, std::string> previousDeclaredOptions;
+				if (moduleCache)
+				{
+					previousAliasIndices = m_context->aliases.availableIndices;
+					previousConstIndices = m_context->constantValues.availableIndices;
+					previousFuncIndices = m_context->functions.availableIndices;
+					previousDeclaredOptions = m_context->declaredOptions;
+				}
+
+				sanitizedModule = std::make_shared<Module>(targetModule->metadata);
+
+				// Remap already used indices 
+				IndexRemapperVisitor::Options indexCallbacks;
+				indexCallbacks.aliasIndexGenerator  = [this](std::size_t /*previousIndex*/) { return m_context->aliases.RegisterNewIndex(true); };
+				indexCallbacks.constIndexGenerator  = [this](std::size_t /*previousIndex*/) { return m_context->constantValues.RegisterNewIndex(true); };
+				indexCallbacks.funcIndexGenerator   = [this](std::size_t /*previousIndex*/) { return m_context->functions.RegisterNewIndex(true); };
+				indexCallbacks.structIndexGenerator = [this](std::size_t /*previousIndex*/) { return m_context->structs.RegisterNewIndex(true); };
+				indexCallbacks.varIndexGenerator    = [this](std::size_t /*previousIndex*/) { return m_context->variableTypes.RegisterNewIndex(true); };
+
+				sanitizedModule->rootNode = Nz::StaticUniquePointerCast<MultiStatement>(RemapIndices(*targetModule->rootNode, indexCallbacks));
+
+				// The remapped tree is only used as the sanitization input, let it be consumed
+				std::string error;
+				sanitizedModule->rootNode = SanitizeInternal(*sanitizedModule->rootNode, true, &error);
+				if (!sanitizedModule->rootNode)
+					throw CompilerModuleCompilationFailedError{ node.sourceLocation, node.moduleName, error };
+
+				// Modules importing other modules or declaring named external blocks reference indices that aren't part of their registrations
+				if (moduleCache && m_context->modules.size() == previousModuleCount && m_context->namedExternalBlocks.size() == previousNamedExternalBlockCount)
+				{
+					auto IsModuleIndex = [](const Nz::Bitset<std::uint64_t>& previousIndices, std::size_t index)
+					{
+						return index >= previousIndices.GetSize() || previousIndices.Test(index);
+					};
+
+					auto registrations = std::make_shared<ModuleRegistrations>();
+					registrations->identifiers = moduleEnvironment->identifiersInScope;
+
+					for (const auto& [aliasIndex, alias] : m_context->aliases.values)
+					{
+						if (IsModuleIndex(previousAliasIndices, aliasIndex))
+							registrations->aliases.emplace_back(aliasIndex, alias);
+					}
+
+					for (const auto& [constIndex, value] : m_context->constantValues.values)
+					{
+						if (IsModuleIndex(previousConstIndices, constIndex))
+							registrations->constants.emplace_back(constIndex, value);
+					}
+
+					for (const auto& [funcIndex, funcData] : m_context->functions.values)
+					{
+						if (IsModuleIndex(previousFuncIndices, funcIndex))
+							registrations->functions.emplace_back(funcIndex, funcData);
+					}
 
-			// Remap already used indices 
-			IndexRemapperVisitor::Options indexCallbacks;
-			indexCallbacks.aliasIndexGenerator  = [this](std::size_t /*previousIndex*/) { return m_context->aliases.RegisterNewIndex(true); };
-			indexCallbacks.constIndexGenerator  = [this](std::size_t /*previousIndex*/) { return m_context->constantValues.RegisterNewIndex(true); };
-			indexCallbacks.funcIndexGenerator   = [this](std::size_t /*previousIndex*/) { return m_context->functions.RegisterNewIndex(true); };
-			indexCallbacks.structIndexGenerator = [this](std::size_t /*previousIndex*/) { return m_context->structs.RegisterNewIndex(true); };
-			indexCallbacks.varIndexGenerator    = [this](std::size_t /*previousIndex*/) { return m_context->variableTypes.RegisterNewIndex(true); };
+					for (const auto& [optionHash, optionName] : m_context->declaredOptions)
+					{
+						if (previousDeclaredOptions.find(optionHash) == previousDeclaredOptions.end())
+							registrations->declaredOptions.emplace_back(optionHash, optionName);
+					}
 
-			sanitizedModule->rootNode = Nz::StaticUniquePointerCast<MultiStatement>(RemapIndices(*targetModule->rootNode, indexCallbacks));
+					ReflectVisitor::Callbacks reflectCallbacks;
+					reflectCallbacks.onExternalDeclaration = [&](const DeclareExternalStatement& extDecl)
+					{
+						if (extDecl.autoBinding.HasValue())
+							registrations->hasAutoBindings = true;
+					};
+
+					ReflectVisitor reflectVisitor;
+					reflectVisitor.Reflect(*targetModule->rootNode, reflectCallbacks);
+
+					// The sanitized module isn't modified once imported, it can be shared with the cache
+					if (!registrations->hasAutoBindings || !hadUsedBindings)
+					{
+						SanitizedModuleCache::CachedModule moduleToCache;
+						moduleToCache.sanitizedModule = sanitizedModule;
+						moduleToCache.registrations = std::move(registrations);
 
-			std::string error;
-			sanitizedModule->rootNode = SanitizeInternal(*sanitizedModule->rootNode, &error);
-			if (!sanitizedModule->rootNode)
-				throw CompilerModuleCompilationFailedError{ node.sourceLocation, node.moduleName, error };
+						moduleCache->Register(targetModule, std::move(*cacheKey), std::move(moduleToCache));
+					}
+				}
+			}
 
 			moduleIndex = m_context->modules.size();
 
@@ -2834,14 +3233,26 @@ NAZARA_WARNING_POP()
 
 	StatementPtr SanitizeVisitor::Clone(MultiStatement& node)
 	{
-		auto clone = std::make_unique<MultiStatement>();
-		clone->statements.reserve(node.statements.size());
+		auto clone = ReuseOrAllocate(node);
+		clone->sourceLocation = node.sourceLocation;
+
+		// A node taken from the input is its own clone, move its statements out before filling it
+		std::vector<StatementPtr> inputStatements;
+		if (clone.get() == &node)
+			inputStatements = std::exchange(node.statements, {});
+
+		std::vector<StatementPtr>& statements = (clone.get() == &node) ? inputStatements : node.statements;
+		clone->statements.reserve(statements.size());
 
 		std::vector<StatementPtr>* previousList = m_context->currentStatementList;
 		m_context->currentStatementList = &clone->statements;
 
-		for (auto& statement : node.statements)
-			clone->statements.push_back(Cloner::Clone(MandatoryStatement(statement, node.sourceLocation)));
+		for (auto& statement : statements)
+		{
+			MandatoryStatement(statement, node.sourceLocation);
+
+			clone->statements.push_back(CloneInputStatement(statement));
+		}
 
 		m_context->currentStatementList = previousList;
 
@@ -2919,25 +3330,62 @@ NAZARA_WARNING_POP()
 	template<typename F>
 	auto SanitizeVisitor::FindIdentifier(const Environment& environment, std::string_view identifierName, F&& functor) const -> const IdentifierData*
 	{
-		auto it = std::find_if(environment.identifiersInScope.rbegin(), environment.identifiersInScope.rend(), [&](const Identifier& identifier)
+		// Identifiers in scope are interned, a name which was never interned can't be one of them
+		Symbol identifierSymbol = Symbol::Find(identifierName);
+		if (!identifierSymbol.IsValid())
+			return nullptr;
+
+		return FindIdentifier(environment, identifierSymbol, std::forward<F>(functor));
+	}
+
+	template<typename F>
+	auto SanitizeVisitor::FindIdentifier(const Environment& environment, Symbol identifierName, F&& functor) const -> const IdentifierData*
+	{
+		// Walk identifiers with this name from the innermost one
+		if (auto it = environment.lastIdentifierByName.find(identifierName); it != environment.lastIdentifierByName.end())
 		{
-			if (identifier.name == identifierName)
+			for (std::size_t identifierIndex = it->second; identifierIndex != Environment::InvalidIdentifierIndex; identifierIndex = environment.shadowedIdentifiers[identifierIndex])
 			{
+				const Identifier& identifier = environment.identifiersInScope[identifierIndex];
 				if (functor(identifier.target))
-					return true;
+					return &identifier.target;
 			}
+		}
 
-			return false;
-		});
-		if (it == environment.identifiersInScope.rend())
+		if (environment.parentEnv)
+			return FindIdentifier(*environment.parentEnv, identifierName, std::forward<F>(functor));
+		else
+			return nullptr;
+	}
+
+	auto SanitizeVisitor::GetBuiltinEnvironment() -> std::shared_ptr<const BuiltinEnvironment>
+	{
+		// Builtins only depend on enabled features, build them once per feature set and share them between sanitizations
+		std::uint64_t featureMask = 0;
+		for (ModuleFeature feature : m_context->currentModule->metadata->enabledFeatures)
+			featureMask |= std::uint64_t(1) << static_cast<std::uint64_t>(feature);
+
+		static std::mutex s_builtinMutex;
+		static std::unordered_map<std::uint64_t, std::shared_ptr<const BuiltinEnvironment>> s_builtinEnvironments;
+
+		std::lock_guard lock(s_builtinMutex);
+
+		std::shared_ptr<const BuiltinEnvironment>& builtinEnvironment = s_builtinEnvironments[featureMask];
+		if (!builtinEnvironment)
 		{
-			if (environment.parentEnv)
-				return FindIdentifier(*environment.parentEnv, identifierName, std::forward<F>(functor));
-			else
-				return nullptr;
+			auto builtins = std::make_shared<BuiltinEnvironment>();
+			builtins->environment = std::make_shared<Environment>();
+
+			auto previousEnv = m_context->currentEnv;
+			m_context->currentEnv = builtins->environment;
+			NAZARA_DEFER({ m_context->currentEnv = std::move(previousEnv); });
+
+			RegisterBuiltin(*builtins);
+
+			builtinEnvironment = std::move(builtins);
 		}
 
-		return &it->target;
+		return builtinEnvironment;
 	}
 
 	const ExpressionType* SanitizeVisitor::GetExpressionType(Expression& expr) const
@@ -3008,7 +3456,7 @@ NAZARA_WARNING_POP()
 
 			case IdentifierCategory::Intrinsic:
 			{
-				IntrinsicType intrinsicType = m_context->intrinsics.Retrieve(identifierData->index, sourceLocation);
+				IntrinsicType intrinsicType = m_context->builtins->intrinsics.Retrieve(identifierData->index, sourceLocation);
 
 				// Replace IdentifierExpression by IntrinsicFunctionExpression
 				auto intrinsicExpr = std::make_unique<IntrinsicFunctionExpression>();
@@ -3072,6 +3520,148 @@ NAZARA_WARNING_POP()
 		throw AstInternalError{ sourceLocation, "unhandled identifier category" };
 	}
 
+	ModulePtr SanitizeVisitor::ImportCachedModule(const Module& cachedModule, const ModuleRegistrations& registrations, const SourceLocation& sourceLocation)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		// The cached module has already been sanitized, it only needs indices of this sanitization
+		std::unordered_map<std::size_t, std::size_t> aliasIndices;
+		std::unordered_map<std::size_t, std::size_t> constIndices;
+		std::unordered_map<std::size_t, std::size_t> funcIndices;
+		std::unordered_map<std::size_t, std::size_t> structIndices;
+		std::unordered_map<std::size_t, std::size_t> varIndices;
+
+		IndexRemapperVisitor::Options indexCallbacks;
+		indexCallbacks.aliasIndexGenerator  = [&](std::size_t previousIndex) { return aliasIndices[previousIndex] = m_context->aliases.RegisterNewIndex(true); };
+		indexCallbacks.constIndexGenerator  = [&](std::size_t previousIndex) { return constIndices[previousIndex] = m_context->constantValues.RegisterNewIndex(true); };
+		indexCallbacks.funcIndexGenerator   = [&](std::size_t previousIndex) { return funcIndices[previousIndex] = m_context->functions.RegisterNewIndex(true); };
+		indexCallbacks.structIndexGenerator = [&](std::size_t previousIndex) { return structIndices[previousIndex] = m_context->structs.RegisterNewIndex(true); };
+		indexCallbacks.varIndexGenerator    = [&](std::size_t previousIndex) { return varIndices[previousIndex] = m_context->variableTypes.RegisterNewIndex(true); };
+
+		ModulePtr sanitizedModule = std::make_shared<Module>(cachedModule.metadata);
+		sanitizedModule->rootNode = Nz::StaticUniquePointerCast<MultiStatement>(RemapIndices(*cachedModule.rootNode, indexCallbacks));
+
+		// Some declarations may have been removed from the module (options, aliases and constants), they still need an index
+		for (const auto& [aliasIndex, alias] : registrations.aliases)
+		{
+			if (aliasIndices.find(aliasIndex) == aliasIndices.end())
+				aliasIndices.emplace(aliasIndex, m_context->aliases.RegisterNewIndex(true));
+		}
+
+		for (const auto& [constIndex, value] : registrations.constants)
+		{
+			if (constIndices.find(constIndex) == constIndices.end())
+				constIndices.emplace(constIndex, m_context->constantValues.RegisterNewIndex(true));
+		}
+
+		auto RemapIdentifier = [&](IdentifierData target)
+		{
+			// Identifiers may target something which doesn't belong to the module (builtins)
+			auto Remap = [&](const std::unordered_map<std::size_t, std::size_t>& indices)
+			{
+				if (auto it = indices.find(target.index); it != indices.end())
+					target.index = it->second;
+			};
+
+			switch (target.category)
+			{
+				case IdentifierCategory::Alias:    Remap(aliasIndices); break;
+				case IdentifierCategory::Constant: Remap(constIndices); break;
+				case IdentifierCategory::Function: Remap(funcIndices); break;
+				case IdentifierCategory::Struct:   Remap(structIndices); break;
+				case IdentifierCategory::Variable: Remap(varIndices); break;
+
+				case IdentifierCategory::ExternalBlock:
+				case IdentifierCategory::Module:
+					throw AstInternalError{ sourceLocation, "unexpected identifier category in cached module" };
+
+				case IdentifierCategory::Intrinsic:
+				case IdentifierCategory::ReservedName:
+				case IdentifierCategory::Type:
+				case IdentifierCategory::Unresolved:
+					break;
+			}
+
+			return target;
+		};
+
+		for (const auto& [aliasIndex, alias] : registrations.aliases)
+			m_context->aliases.Register(Identifier{ alias.name, RemapIdentifier(alias.target) }, Nz::Retrieve(aliasIndices, aliasIndex), sourceLocation);
+
+		for (const auto& [constIndex, value] : registrations.constants)
+			m_context->constantValues.Register(value, Nz::Retrieve(constIndices, constIndex), sourceLocation);
+
+		for (const auto& [optionHash, optionName] : registrations.declaredOptions)
+		{
+			if (auto it = m_context->declaredOptions.find(optionHash); it != m_context->declaredOptions.end())
+			{
+				if (it->second != optionName)
+					throw CompilerOptionHashCollisionError{ sourceLocation, optionName, it->second };
+			}
+			else
+				m_context->declaredOptions.emplace(optionHash, optionName);
+		}
+
+		CachedDeclarationFinder declarations;
+		declarations.Find(*sanitizedModule->rootNode);
+
+		for (auto&& [structIndex, structDecl] : declarations.structs)
+			m_context->structs.Register(&structDecl->description, structIndex, structDecl->sourceLocation);
+
+		for (const auto& [funcIndex, funcData] : registrations.functions)
+		{
+			auto RemapFunctions = [&](const Nz::Bitset<>& functions)
+			{
+				Nz::Bitset<> remappedFunctions;
+				for (std::size_t i : functions.IterBits())
+				{
+					if (auto it = funcIndices.find(i); it != funcIndices.end())
+						remappedFunctions.UnboundedSet(it->second);
+				}
+
+				return remappedFunctions;
+			};
+
+			std::size_t newFuncIndex = Nz::Retrieve(funcIndices, funcIndex);
+
+			FunctionData remappedFuncData;
+			remappedFuncData.usedBuiltins = funcData.usedBuiltins;
+			remappedFuncData.requiredShaderStage = funcData.requiredShaderStage;
+			remappedFuncData.calledByStages = funcData.calledByStages;
+			remappedFuncData.calledFunctions = RemapFunctions(funcData.calledFunctions);
+			remappedFuncData.calledByFunctions = RemapFunctions(funcData.calledByFunctions);
+			remappedFuncData.node = Nz::Retrieve(declarations.functions, newFuncIndex);
+
+			if (remappedFuncData.node->entryStage.IsResultingValue())
+			{
+				ShaderStageType stageType = remappedFuncData.node->entryStage.GetResultingValue();
+				if (m_context->entryFunctions[Nz::UnderlyingCast(stageType)])
+					throw CompilerEntryPointAlreadyDefinedError{ remappedFuncData.node->sourceLocation, stageType };
+
+				m_context->entryFunctions[Nz::UnderlyingCast(stageType)] = remappedFuncData.node;
+			}
+
+			m_context->functions.Register(std::move(remappedFuncData), newFuncIndex, sourceLocation);
+		}
+
+		// Externals are registered with the same checks as when they're declared
+		for (const DeclareExternalStatement* externalDecl : declarations.externals)
+		{
+			for (const auto& extVar : externalDecl->externalVars)
+			{
+				const ExpressionType& targetType = ResolveAlias(extVar.type.GetResultingValue());
+				RegisterExternalVariable(extVar.name, extVar, &targetType);
+
+				m_context->variableTypes.Register(targetType, *extVar.varIndex, extVar.sourceLocation);
+			}
+		}
+
+		for (const Identifier& identifier : registrations.identifiers)
+			RegisterIdentifier({ identifier.name, RemapIdentifier(identifier.target) });
+
+		return sanitizedModule;
+	}
+
 	bool SanitizeVisitor::IsFeatureEnabled(ModuleFeature feature) const
 	{
 		const std::vector<ModuleFeature>& enabledFeatures = m_context->currentModule->metadata->enabledFeatures;
@@ -3094,10 +3684,25 @@ NAZARA_WARNING_POP()
 
 	void SanitizeVisitor::PopScope()
 	{
-		assert(!m_context->currentEnv->scopes.empty());
-		auto& scope = m_context->currentEnv->scopes.back();
-		m_context->currentEnv->identifiersInScope.resize(scope.previousSize);
-		m_context->currentEnv->scopes.pop_back();
+		Environment& environment = *m_context->currentEnv;
+
+		assert(!environment.scopes.empty());
+		auto& scope = environment.scopes.back();
+
+		// Restore identifiers shadowed by the ones going out of scope
+		for (std::size_t identifierIndex = environment.identifiersInScope.size(); identifierIndex-- > scope.previousSize;)
+		{
+			Symbol identifierName = environment.identifiersInScope[identifierIndex].name;
+			std::size_t shadowedIndex = environment.shadowedIdentifiers[identifierIndex];
+			if (shadowedIndex != Environment::InvalidIdentifierIndex)
+				environment.lastIdentifierByName[identifierName] = shadowedIndex;
+			else
+				environment.lastIdentifierByName.erase(identifierName);
+		}
+
+		environment.identifiersInScope.resize(scope.previousSize);
+		environment.shadowedIdentifiers.resize(scope.previousSize);
+		environment.scopes.pop_back();
 	}
 
 	ExpressionPtr SanitizeVisitor::CacheResult(ExpressionPtr expression)
@@ -3293,23 +3898,23 @@ NAZARA_WARNING_POP()
 			PropagateFunctionRequirements(callingFunction, i, seen);
 	}
 
-	void SanitizeVisitor::RegisterBuiltin()
+	void SanitizeVisitor::RegisterBuiltin(BuiltinEnvironment& builtins)
 	{
 		// Primitive types
-		RegisterType("bool", PrimitiveType::Boolean, std::nullopt, {});
-		RegisterType("f32",  PrimitiveType::Float32, std::nullopt, {});
-		RegisterType("i32",  PrimitiveType::Int32,   std::nullopt, {});
-		RegisterType("u32",  PrimitiveType::UInt32,  std::nullopt, {});
+		RegisterType(builtins, "bool", PrimitiveType::Boolean, std::nullopt, {});
+		RegisterType(builtins, "f32",  PrimitiveType::Float32, std::nullopt, {});
+		RegisterType(builtins, "i32",  PrimitiveType::Int32,   std::nullopt, {});
+		RegisterType(builtins, "u32",  PrimitiveType::UInt32,  std::nullopt, {});
 
 		if (IsFeatureEnabled(ModuleFeature::Float64))
-			RegisterType("f64", PrimitiveType::Float64, std::nullopt, {});
+			RegisterType(builtins, "f64", PrimitiveType::Float64, std::nullopt, {});
 
 		// Partial types
 
 		// Array
-		RegisterType("array", PartialType {
+		RegisterType(builtins, "array", PartialType {
 			{ TypeParameterCategory::FullType }, { TypeParameterCategory::ConstantValue },
-			[=](const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation) -> ExpressionType
+			[](const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation, const Stringifier& stringifier) -> ExpressionType
 			{
 				assert(parameterCount >= 1 && parameterCount <= 2);
 				
@@ -3337,14 +3942,13 @@ NAZARA_WARNING_POP()
 							throw CompilerArrayLengthError{ sourceLocation, Ast::ToString(lengthValue) };
 					}
 					else
-						throw CompilerArrayLengthError{ sourceLocation, ToString(GetConstantType(length), sourceLocation) };
+						throw CompilerArrayLengthError{ sourceLocation, Ast::ToString(GetConstantType(length), stringifier) };
 				}
 				else
 					lengthValue = 0;
 				
 				ArrayType arrayType;
-				arrayType.containedType = std::make_unique<ContainedType>();
-				arrayType.containedType->type = exprType;
+				arrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ exprType });
 				arrayType.length = lengthValue;
 
 				return arrayType;
@@ -3352,9 +3956,9 @@ NAZARA_WARNING_POP()
 		}, std::nullopt, {});
 
 		// Dynamic array
-		RegisterType("dyn_array", PartialType {
+		RegisterType(builtins, "dyn_array", PartialType {
 			{ TypeParameterCategory::FullType }, {},
-			[=](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/) -> ExpressionType
+			[](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/, const Stringifier& /*stringifier*/) -> ExpressionType
 			{
 				assert(parameterCount == 1);
 				assert(std::holds_alternative<ExpressionType>(parameters[0]));
@@ -3362,8 +3966,7 @@ NAZARA_WARNING_POP()
 				const ExpressionType& exprType = std::get<ExpressionType>(parameters[0]);
 
 				DynArrayType arrayType;
-				arrayType.containedType = std::make_unique<ContainedType>();
-				arrayType.containedType->type = exprType;
+				arrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ exprType });
 
 				return arrayType;
 			}
@@ -3380,9 +3983,9 @@ NAZARA_WARNING_POP()
 				else
 					name = "mat" + std::to_string(columnCount) + "x" + std::to_string(rowCount);
 
-				RegisterType(std::move(name), PartialType{
+				RegisterType(builtins, std::move(name), PartialType{
 					{ TypeParameterCategory::PrimitiveType }, {},
-					[=](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& sourceLocation) -> ExpressionType
+					[columnCount, rowCount](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& sourceLocation, const Stringifier& /*stringifier*/) -> ExpressionType
 					{
 						assert(parameterCount == 1);
 						assert(std::holds_alternative<ExpressionType>(*parameters));
@@ -3405,9 +4008,9 @@ NAZARA_WARNING_POP()
 		// vecX
 		for (std::size_t componentCount = 2; componentCount <= 4; ++componentCount)
 		{
-			RegisterType("vec" + std::to_string(componentCount), PartialType {
+			RegisterType(builtins, "vec" + std::to_string(componentCount), PartialType {
 				{ TypeParameterCategory::PrimitiveType }, {},
-				[=](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/) -> ExpressionType
+				[componentCount](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/, const Stringifier& /*stringifier*/) -> ExpressionType
 				{
 					assert(parameterCount == 1);
 					assert(std::holds_alternative<ExpressionType>(*parameters));
@@ -3509,9 +4112,9 @@ NAZARA_WARNING_POP()
 			if (sampler.requiredFeature.has_value() && !IsFeatureEnabled(*sampler.requiredFeature))
 				continue;
 
-			RegisterType(std::string(sampler.typeName), PartialType {
+			RegisterType(builtins, std::string(sampler.typeName), PartialType {
 				{ TypeParameterCategory::PrimitiveType }, {},
-				[=](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& sourceLocation) -> ExpressionType
+				[sampler](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& sourceLocation, const Stringifier& stringifier) -> ExpressionType
 				{
 					assert(parameterCount == 1);
 					assert(std::holds_alternative<ExpressionType>(*parameters));
@@ -3523,7 +4126,7 @@ NAZARA_WARNING_POP()
 
 					// TODO: Add support for integer samplers
 					if (primitiveType != PrimitiveType::Float32)
-						throw CompilerSamplerUnexpectedTypeError{ sourceLocation, ToString(exprType, sourceLocation) };
+						throw CompilerSamplerUnexpectedTypeError{ sourceLocation, Ast::ToString(exprType, stringifier) };
 
 					return SamplerType {
 						sampler.imageType, primitiveType, sampler.depthSampler
@@ -3580,9 +4183,9 @@ NAZARA_WARNING_POP()
 			if (texture.requiredFeature.has_value() && !IsFeatureEnabled(*texture.requiredFeature))
 				continue;
 
-			RegisterType(std::string(texture.typeName), PartialType {
+			RegisterType(builtins, std::string(texture.typeName), PartialType {
 				{ TypeParameterCategory::PrimitiveType, TypeParameterCategory::ConstantValue }, { TypeParameterCategory::ConstantValue },
-				[=](const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation) -> ExpressionType
+				[texture](const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation, const Stringifier& stringifier) -> ExpressionType
 				{
 					assert(std::holds_alternative<ExpressionType>(parameters[0]));
 					const ExpressionType& exprType = std::get<ExpressionType>(parameters[0]);
@@ -3592,7 +4195,7 @@ NAZARA_WARNING_POP()
 
 					// TODO: Add support for integer textures
 					if (primitiveType != PrimitiveType::Float32)
-						throw CompilerTextureUnexpectedTypeError{ sourceLocation, ToString(exprType, sourceLocation) };
+						throw CompilerTextureUnexpectedTypeError{ sourceLocation, Ast::ToString(exprType, stringifier) };
 
 					assert(std::holds_alternative<ConstantValue>(parameters[1]));
 					const ConstantValue& accessValue = std::get<ConstantValue>(parameters[1]);
@@ -3624,9 +4227,9 @@ NAZARA_WARNING_POP()
 		}
 
 		// storage
-		RegisterType("storage", PartialType {
+		RegisterType(builtins, "storage", PartialType {
 			{ TypeParameterCategory::StructType }, { TypeParameterCategory::ConstantValue },
-			[=](const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation) -> ExpressionType
+			[](const TypeParameter* parameters, std::size_t parameterCount, const SourceLocation& sourceLocation, const Stringifier& /*stringifier*/) -> ExpressionType
 			{
 				assert(parameterCount >= 1);
 				assert(std::holds_alternative<ExpressionType>(*parameters));
@@ -3654,9 +4257,9 @@ NAZARA_WARNING_POP()
 		}, std::nullopt, {});
 		
 		// uniform
-		RegisterType("uniform", PartialType {
+		RegisterType(builtins, "uniform", PartialType {
 			{ TypeParameterCategory::StructType }, {},
-			[=](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/) -> ExpressionType
+			[](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/, const Stringifier& /*stringifier*/) -> ExpressionType
 			{
 				assert(parameterCount == 1);
 				assert(std::holds_alternative<ExpressionType>(*parameters));
@@ -3672,9 +4275,9 @@ NAZARA_WARNING_POP()
 		}, std::nullopt, {});
 
 		// push constant
-		RegisterType("push_constant", PartialType {
+		RegisterType(builtins, "push_constant", PartialType {
 			{ TypeParameterCategory::StructType }, {},
-			[=](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/) -> ExpressionType
+			[](const TypeParameter* parameters, [[maybe_unused]] std::size_t parameterCount, const SourceLocation& /*sourceLocation*/, const Stringifier& /*stringifier*/) -> ExpressionType
 			{
 				assert(parameterCount == 1);
 				assert(std::holds_alternative<ExpressionType>(*parameters));
@@ -3693,10 +4296,13 @@ NAZARA_WARNING_POP()
 		for (const auto& [intrinsic, data] : LangData::s_intrinsicData)
 		{
 			if (!data.functionName.empty())
-				RegisterIntrinsic(std::string(data.functionName), intrinsic);
+				RegisterIntrinsic(builtins, std::string(data.functionName), intrinsic);
 		}
+	}
 
-		// Constants
+	void SanitizeVisitor::RegisterBuiltinConstants()
+	{
+		// Constants are registered in each sanitization as they share their indices with the module constants
 		RegisterConstant("readonly", Nz::SafeCast<std::uint32_t>(AccessPolicy::ReadOnly), std::nullopt, {});
 		RegisterConstant("readwrite", Nz::SafeCast<std::uint32_t>(AccessPolicy::ReadWrite), std::nullopt, {});
 		RegisterConstant("writeonly", Nz::SafeCast<std::uint32_t>(AccessPolicy::WriteOnly), std::nullopt, {});
@@ -3729,8 +4335,8 @@ NAZARA_WARNING_POP()
 
 		if (!unresolved)
 		{
-			m_context->currentEnv->identifiersInScope.push_back({
-				std::move(name),
+			RegisterIdentifier({
+				Symbol(name),
 				{
 					aliasIndex,
 					IdentifierCategory::Alias,
@@ -3760,8 +4366,8 @@ NAZARA_WARNING_POP()
 		else
 			constantIndex = m_context->constantValues.RegisterNewIndex(true);
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				constantIndex,
 				IdentifierCategory::Constant,
@@ -3779,8 +4385,8 @@ NAZARA_WARNING_POP()
 
 		std::size_t index = m_context->namedExternalBlockIndices.Register(externalBlockIndex, std::nullopt, {});
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				index,
 				IdentifierCategory::ExternalBlock,
@@ -3791,6 +4397,55 @@ NAZARA_WARNING_POP()
 		return index;
 	}
 	
+	void SanitizeVisitor::RegisterExternalBinding(std::uint32_t bindingSet, std::uint32_t bindingIndex, std::uint32_t bindingCount, const SourceLocation& sourceLocation)
+	{
+		Context::UsedExternalData usedBindingData;
+		usedBindingData.conditionalStatementIndex = m_context->currentConditionalIndex;
+
+		for (std::uint32_t i = 0; i < bindingCount; ++i)
+		{
+			std::uint64_t bindingKey = BuildBindingKey(bindingSet, bindingIndex + i);
+			if (auto it = m_context->usedBindingIndexes.find(bindingKey); it != m_context->usedBindingIndexes.end())
+			{
+				if (it->second.conditionalStatementIndex == m_context->currentConditionalIndex || usedBindingData.conditionalStatementIndex == m_context->currentConditionalIndex)
+					throw CompilerExtBindingAlreadyUsedError{ sourceLocation, bindingSet, bindingIndex };
+			}
+
+			m_context->usedBindingIndexes.emplace(bindingKey, usedBindingData);
+		}
+	}
+
+	void SanitizeVisitor::RegisterExternalVariable(const std::string& internalName, const DeclareExternalStatement::ExternalVar& extVar, const ExpressionType* targetType)
+	{
+		Context::UsedExternalData usedExternalData;
+		usedExternalData.conditionalStatementIndex = m_context->currentConditionalIndex;
+
+		if (auto it = m_context->declaredExternalVar.find(internalName); it != m_context->declaredExternalVar.end())
+		{
+			if (it->second.conditionalStatementIndex == m_context->currentConditionalIndex || usedExternalData.conditionalStatementIndex == m_context->currentConditionalIndex)
+				throw CompilerExtAlreadyDeclaredError{ extVar.sourceLocation, extVar.name };
+		}
+
+		m_context->declaredExternalVar.emplace(internalName, usedExternalData);
+
+		// Unresolved type (partial sanitization), its binding can't be known yet
+		if (!targetType)
+			return;
+
+		if (IsPushConstantType(*targetType))
+		{
+			if (m_context->pushConstantLocation.IsValid())
+				throw CompilerMultiplePushConstantError{ extVar.sourceLocation };
+
+			m_context->pushConstantLocation = extVar.sourceLocation;
+		}
+		else if (extVar.bindingSet.IsResultingValue() && extVar.bindingIndex.IsResultingValue())
+		{
+			std::uint32_t arraySize = (IsArrayType(*targetType)) ? std::get<ArrayType>(*targetType).length : 1;
+			RegisterExternalBinding(extVar.bindingSet.GetResultingValue(), extVar.bindingIndex.GetResultingValue(), arraySize, extVar.sourceLocation);
+		}
+	}
+
 	std::size_t SanitizeVisitor::RegisterFunction(std::string name, std::optional<FunctionData> funcData, std::optional<std::size_t> index, const SourceLocation& sourceLocation)
 	{
 		if (auto* identifier = FindIdentifier(name))
@@ -3831,8 +4486,8 @@ NAZARA_WARNING_POP()
 		else
 			functionIndex = m_context->functions.RegisterNewIndex(true);
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				functionIndex,
 				IdentifierCategory::Function,
@@ -3843,15 +4498,32 @@ NAZARA_WARNING_POP()
 		return functionIndex;
 	}
 
-	std::size_t SanitizeVisitor::RegisterIntrinsic(std::string name, IntrinsicType type)
+	void SanitizeVisitor::RegisterIdentifier(Identifier identifier)
+	{
+		Environment& environment = *m_context->currentEnv;
+
+		std::size_t identifierIndex = environment.identifiersInScope.size();
+		auto [it, inserted] = environment.lastIdentifierByName.try_emplace(identifier.name, identifierIndex);
+		if (inserted)
+			environment.shadowedIdentifiers.push_back(Environment::InvalidIdentifierIndex);
+		else
+		{
+			environment.shadowedIdentifiers.push_back(it->second);
+			it->second = identifierIndex;
+		}
+
+		environment.identifiersInScope.push_back(std::move(identifier));
+	}
+
+	std::size_t SanitizeVisitor::RegisterIntrinsic(BuiltinEnvironment& builtins, std::string name, IntrinsicType type)
 	{
 		if (!IsIdentifierAvailable(name))
 			throw CompilerIdentifierAlreadyUsedError{ {}, name };
 
-		std::size_t intrinsicIndex = m_context->intrinsics.Register(std::move(type), std::nullopt, {});
+		std::size_t intrinsicIndex = builtins.intrinsics.Register(std::move(type), std::nullopt, {});
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				intrinsicIndex,
 				IdentifierCategory::Intrinsic,
@@ -3869,8 +4541,8 @@ NAZARA_WARNING_POP()
 
 		std::size_t moduleIndex = m_context->moduleIndices.Register(index, std::nullopt, {});
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(moduleIdentifier),
+		RegisterIdentifier({
+			Symbol(moduleIdentifier),
 			{
 				moduleIndex,
 				IdentifierCategory::Module,
@@ -3883,8 +4555,8 @@ NAZARA_WARNING_POP()
 
 	void SanitizeVisitor::RegisterReservedName(std::string name)
 	{
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				std::numeric_limits<std::size_t>::max(),
 				IdentifierCategory::ReservedName,
@@ -3917,8 +4589,8 @@ NAZARA_WARNING_POP()
 
 		if (!unresolved)
 		{
-			m_context->currentEnv->identifiersInScope.push_back({
-				std::move(name),
+			RegisterIdentifier({
+				Symbol(name),
 				{
 					structIndex,
 					IdentifierCategory::Struct,
@@ -3932,24 +4604,24 @@ NAZARA_WARNING_POP()
 		return structIndex;
 	}
 
-	std::size_t SanitizeVisitor::RegisterType(std::string name, std::optional<ExpressionType> expressionType, std::optional<std::size_t> index, const SourceLocation& sourceLocation)
+	std::size_t SanitizeVisitor::RegisterType(BuiltinEnvironment& builtins, std::string name, std::optional<ExpressionType> expressionType, std::optional<std::size_t> index, const SourceLocation& sourceLocation)
 	{
 		if (!IsIdentifierAvailable(name))
 			throw CompilerIdentifierAlreadyUsedError{ sourceLocation, name };
 
 		std::size_t typeIndex;
 		if (expressionType)
-			typeIndex = m_context->types.Register(std::move(*expressionType), index, sourceLocation);
+			typeIndex = builtins.types.Register(std::move(*expressionType), index, sourceLocation);
 		else if (index)
 		{
-			m_context->types.PreregisterIndex(*index, sourceLocation);
+			builtins.types.PreregisterIndex(*index, sourceLocation);
 			typeIndex = *index;
 		}
 		else
-			typeIndex = m_context->types.RegisterNewIndex(true);
+			typeIndex = builtins.types.RegisterNewIndex(true);
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				typeIndex,
 				IdentifierCategory::Type,
@@ -3960,7 +4632,7 @@ NAZARA_WARNING_POP()
 		return typeIndex;
 	}
 
-	std::size_t SanitizeVisitor::RegisterType(std::string name, std::optional<PartialType> partialType, std::optional<std::size_t> index, const SourceLocation& sourceLocation)
+	std::size_t SanitizeVisitor::RegisterType(BuiltinEnvironment& builtins, std::string name, std::optional<PartialType> partialType, std::optional<std::size_t> index, const SourceLocation& sourceLocation)
 	{
 		if (!IsIdentifierAvailable(name))
 			throw CompilerIdentifierAlreadyUsedError{ sourceLocation, name };
@@ -3972,18 +4644,18 @@ NAZARA_WARNING_POP()
 			namedPartial.name = name;
 			namedPartial.type = std::move(*partialType);
 
-			typeIndex = m_context->types.Register(std::move(namedPartial), index, sourceLocation);
+			typeIndex = builtins.types.Register(std::move(namedPartial), index, sourceLocation);
 		}
 		else if (index)
 		{
-			m_context->types.PreregisterIndex(*index, sourceLocation);
+			builtins.types.PreregisterIndex(*index, sourceLocation);
 			typeIndex = *index;
 		}
 		else
-			typeIndex = m_context->types.RegisterNewIndex(true);
+			typeIndex = builtins.types.RegisterNewIndex(true);
 
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				typeIndex,
 				IdentifierCategory::Type,
@@ -3996,8 +4668,8 @@ NAZARA_WARNING_POP()
 
 	void SanitizeVisitor::RegisterUnresolved(std::string name)
 	{
-		m_context->currentEnv->identifiersInScope.push_back({
-			std::move(name),
+		RegisterIdentifier({
+			Symbol(name),
 			{
 				std::numeric_limits<std::size_t>::max(),
 				IdentifierCategory::Unresolved,
@@ -4032,8 +4704,8 @@ NAZARA_WARNING_POP()
 
 		if (!unresolved)
 		{
-			m_context->currentEnv->identifiersInScope.push_back({
-				std::move(name),
+			RegisterIdentifier({
+				Symbol(name),
 				{
 					varIndex,
 					IdentifierCategory::Variable,
@@ -4084,9 +4756,17 @@ NAZARA_WARNING_POP()
 			std::vector<StatementPtr>* previousList = m_context->currentStatementList;
 			m_context->currentStatementList = &pendingFunc.cloneNode->statements;
 
-			pendingFunc.cloneNode->statements.reserve(pendingFunc.node->statements.size());
-			for (auto& statement : pendingFunc.node->statements)
-				pendingFunc.cloneNode->statements.push_back(CloneStatement(MandatoryStatement(statement, pendingFunc.cloneNode->sourceLocation)));
+			std::vector<StatementPtr>& statements = (pendingFunc.node) ? pendingFunc.node->statements : pendingFunc.inputStatements;
+
+			// Reset input consumption state, previous function bodies may have been copied
+			SetInputConsumption(m_context->consumeInput);
+
+			pendingFunc.cloneNode->statements.reserve(statements.size());
+			for (auto& statement : statements)
+			{
+				MandatoryStatement(statement, pendingFunc.cloneNode->sourceLocation);
+				pendingFunc.cloneNode->statements.push_back(CloneInputStatement(statement));
+			}
 
 			m_context->currentStatementList = previousList;
 			m_context->currentFunction = nullptr;
@@ -4159,7 +4839,7 @@ NAZARA_WARNING_POP()
 
 		std::size_t typeIndex = std::get<Type>(exprType).typeIndex;
 
-		const auto& type = m_context->types.Retrieve(typeIndex, sourceLocation);
+		const auto& type = m_context->builtins->types.Retrieve(typeIndex, sourceLocation);
 		if (!std::holds_alternative<ExpressionType>(type))
 			throw CompilerFullTypeExpectedError{ sourceLocation, ToString(type, sourceLocation) };
 
@@ -4186,14 +4866,113 @@ NAZARA_WARNING_POP()
 		return ResolveType(*exprType, resolveAlias, sourceLocation);
 	}
 
-	MultiStatementPtr SanitizeVisitor::SanitizeInternal(MultiStatement& rootNode, std::string* error)
+	ModulePtr SanitizeVisitor::SanitizeInternal(const Module& module, bool consumeInput, bool keepResolvedExpressions, const Options& options, std::string* error)
 	{
+		ModulePtr clone = std::make_shared<Module>(module.metadata);
+
+		Context currentContext;
+		currentContext.options = options;
+		currentContext.currentModule = clone;
+		currentContext.keepResolvedExpressions = keepResolvedExpressions;
+
+		m_context = &currentContext;
+		NAZARA_DEFER({ m_context = nullptr; });
+
+		PreregisterIndices(module);
+
+		// Register global env, on top of the shared builtin one
+		m_context->builtins = GetBuiltinEnvironment();
+
+		m_context->globalEnv = std::make_shared<Environment>();
+		m_context->globalEnv->parentEnv = m_context->builtins->environment;
+		m_context->currentEnv = m_context->globalEnv;
+		RegisterBuiltinConstants();
+
+		m_context->moduleEnv = std::make_shared<Environment>();
+		m_context->moduleEnv->moduleId = clone->metadata->moduleName;
+		m_context->moduleEnv->parentEnv = m_context->globalEnv;
+
+		for (std::size_t moduleId = 0; moduleId < module.importedModules.size(); ++moduleId)
+		{
+			const auto& importedModule = module.importedModules[moduleId];
+			if (!importedModule.module)
+				throw std::runtime_error("unexpected invalid imported module");
+
+			if (!importedModule.module->importedModules.empty())
+				throw std::runtime_error("imported modules cannot have imported modules themselves");
+
+			auto& cloneImportedModule = clone->importedModules.emplace_back();
+			cloneImportedModule.identifier = importedModule.identifier;
+			cloneImportedModule.module = std::make_shared<Module>(importedModule.module->metadata);
+
+			auto importedModuleEnv = std::make_shared<Environment>();
+			importedModuleEnv->moduleId = cloneImportedModule.module->metadata->moduleName;
+			importedModuleEnv->parentEnv = m_context->globalEnv;
+
+			m_context->currentEnv = importedModuleEnv;
+
+			cloneImportedModule.module->rootNode = SanitizeInternal(*importedModule.module->rootNode, false, error);
+			if (!cloneImportedModule.module->rootNode)
+				return {};
+
+			m_context->moduleByName[cloneImportedModule.module->metadata->moduleName] = moduleId;
+			auto& moduleData = m_context->modules.emplace_back();
+			moduleData.environment = std::move(importedModuleEnv);
+			moduleData.moduleName = cloneImportedModule.identifier;
+
+			m_context->currentEnv = m_context->globalEnv;
+			RegisterModule(cloneImportedModule.identifier, moduleId);
+		}
+
+		m_context->currentEnv = m_context->moduleEnv;
+
+		clone->rootNode = SanitizeInternal(*module.rootNode, consumeInput, error);
+		if (!clone->rootNode)
+			return {};
+
+		// Remove unused statements of imported modules
+		for (std::size_t moduleId = 0; moduleId < clone->importedModules.size(); ++moduleId)
+		{
+			auto& moduleData = m_context->modules[moduleId];
+			auto& importedModule = clone->importedModules[moduleId];
+
+			if (moduleData.dependenciesVisitor)
+			{
+				moduleData.dependenciesVisitor->Resolve(true); //< allow unknown identifiers since we may be referencing other modules
+
+				importedModule.module = EliminateUnusedPass(*importedModule.module, moduleData.dependenciesVisitor->GetUsage());
+			}
+		}
+
+		return clone;
+	}
+
+	MultiStatementPtr SanitizeVisitor::SanitizeInternal(MultiStatement& rootNode, bool consumeInput, std::string* error)
+	{
+		bool previousConsumeInput = m_context->consumeInput;
+		m_context->consumeInput = consumeInput;
+		SetInputConsumption(consumeInput);
+		NAZARA_DEFER({
+			m_context->consumeInput = previousConsumeInput;
+			SetInputConsumption(previousConsumeInput);
+		});
+
 		MultiStatementPtr output;
 		{
 			// First pass, evaluate everything except function code
 			try
 			{
-				output = Nz::StaticUniquePointerCast<MultiStatement>(Cloner::Clone(rootNode));
+				if (consumeInput)
+				{
+					// The root node belongs to the module, only its statements can be taken from it
+					StatementPtr inputRoot = ShaderBuilder::MultiStatement(std::move(rootNode.statements));
+					inputRoot->sourceLocation = rootNode.sourceLocation;
+
+					output = Nz::StaticUniquePointerCast<MultiStatement>(CloneInputStatement(inputRoot));
+				}
+				else
+					output = Nz::StaticUniquePointerCast<MultiStatement>(Cloner::Clone(rootNode));
+
 				ResolveFunctions();
 			}
 			catch (const std::runtime_error& err)
@@ -4226,41 +5005,42 @@ NAZARA_WARNING_POP()
 		return true;
 	}
 
-	std::string SanitizeVisitor::ToString(const ExpressionType& exprType, const SourceLocation& sourceLocation) const
+	Stringifier SanitizeVisitor::BuildStringifier(const SourceLocation& sourceLocation) const
 	{
+		// Captures the source location by value as the stringifier may outlive it
 		Stringifier stringifier;
-		stringifier.aliasStringifier = [&](std::size_t aliasIndex)
+		stringifier.aliasStringifier = [this, sourceLocation](std::size_t aliasIndex)
 		{
-			return m_context->aliases.Retrieve(aliasIndex, sourceLocation).name;
+			return std::string(m_context->aliases.Retrieve(aliasIndex, sourceLocation).name.GetName());
 		};
 
-		stringifier.moduleStringifier = [&](std::size_t moduleIndex)
+		stringifier.moduleStringifier = [this](std::size_t moduleIndex)
 		{
 			const std::string& moduleName = m_context->modules[moduleIndex].moduleName;
 			return (!moduleName.empty()) ? moduleName : fmt::format("<anonymous module #{}>", moduleIndex);
 		};
 		
-		stringifier.namedExternalBlockStringifier = [&](std::size_t namedExternalBlockIndex)
+		stringifier.namedExternalBlockStringifier = [this](std::size_t namedExternalBlockIndex)
 		{
 			return m_context->namedExternalBlocks[namedExternalBlockIndex].name;
 		};
 
-		stringifier.structStringifier = [&](std::size_t structIndex)
+		stringifier.structStringifier = [this, sourceLocation](std::size_t structIndex)
 		{
 			return m_context->structs.Retrieve(structIndex, sourceLocation)->name;
 		};
 
-		stringifier.structStringifier = [&](std::size_t structIndex)
+		stringifier.typeStringifier = [this, sourceLocation](std::size_t typeIndex)
 		{
-			return m_context->structs.Retrieve(structIndex, sourceLocation)->name;
+			return ToString(m_context->builtins->types.Retrieve(typeIndex, sourceLocation), sourceLocation);
 		};
 
-		stringifier.typeStringifier = [&](std::size_t typeIndex)
-		{
-			return ToString(m_context->types.Retrieve(typeIndex, sourceLocation), sourceLocation);
-		};
+		return stringifier;
+	}
 
-		return Ast::ToString(exprType, stringifier);
+	std::string SanitizeVisitor::ToString(const ExpressionType& exprType, const SourceLocation& sourceLocation) const
+	{
+		return Ast::ToString(exprType, BuildStringifier(sourceLocation));
 	}
 
 	std::string SanitizeVisitor::ToString(const NamedPartialType& partialType, const SourceLocation& /*sourceLocation*/) const
@@ -4309,7 +5089,7 @@ NAZARA_WARNING_POP()
 		const ExpressionType& resolvedType = ResolveAlias(*exprType);
 
 		Identifier aliasIdentifier;
-		aliasIdentifier.name = node.name;
+		aliasIdentifier.name = Symbol(node.name);
 
 		if (IsStructType(resolvedType))
 		{
@@ -4397,7 +5177,7 @@ NAZARA_WARNING_POP()
 		if (IsTypeExpression(resolvedExprType))
 		{
 			std::size_t typeIndex = std::get<Type>(resolvedExprType).typeIndex;
-			const auto& type = m_context->types.Retrieve(typeIndex, node.sourceLocation);
+			const auto& type = m_context->builtins->types.Retrieve(typeIndex, node.sourceLocation);
 
 			if (!std::holds_alternative<NamedPartialType>(type))
 				throw CompilerExpectedPartialTypeError{ node.sourceLocation, ToString(std::get<ExpressionType>(type), node.sourceLocation) };
@@ -4474,7 +5254,7 @@ NAZARA_WARNING_POP()
 			}
 
 			assert(parameters.size() >= requiredParameterCount && parameters.size() <= totalParameterCount);
-			node.cachedExpressionType = partialType.type.buildFunc(parameters.data(), parameters.size(), node.sourceLocation);
+			node.cachedExpressionType = partialType.type.buildFunc(parameters.data(), parameters.size(), node.sourceLocation, BuildStringifier(node.sourceLocation));
 		}
 		else
 		{
@@ -6270,8 +7050,7 @@ NAZARA_WARNING_POP()
 			const ArrayType& arrayType = std::get<ArrayType>(exprType);
 
 			ArrayType wrappedArrayType;
-			wrappedArrayType.containedType = std::make_unique<ContainedType>();
-			wrappedArrayType.containedType->type = UnwrapExternalType(arrayType.containedType->type);
+			wrappedArrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ UnwrapExternalType(arrayType.containedType->type) });
 			wrappedArrayType.length = arrayType.length;
 
 			return wrappedArrayType;
@@ -6297,8 +7076,7 @@ NAZARA_WARNING_POP()
 			const ArrayType& arrayType = std::get<ArrayType>(exprType);
 
 			ArrayType wrappedArrayType;
-			wrappedArrayType.containedType = std::make_unique<ContainedType>();
-			wrappedArrayType.containedType->type = WrapExternalType<T>(arrayType.containedType->type);
+			wrappedArrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ WrapExternalType<T>(arrayType.containedType->type) });
 			wrappedArrayType.length = arrayType.length;
 			wrappedArrayType.isWrapped = true;
 
@@ -6310,8 +7088,7 @@ NAZARA_WARNING_POP()
 			ExpressionType wrapperInnerType = WrapExternalType<T>(arrayType.containedType->type);
 
 			DynArrayType wrappedDynArrayType;
-			wrappedDynArrayType.containedType = std::make_unique<ContainedType>();
-			wrappedDynArrayType.containedType->type = wrapperInnerType;
+			wrappedDynArrayType.containedType = std::make_shared<const ContainedType>(ContainedType{ wrapperInnerType });
 
 			return wrappedDynArrayType;
 		}
@@ -0,0 +1,105 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Ast/SanitizedModuleCache.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace nzsl::Ast
+{
+	SanitizedModuleCache::SanitizedModuleCache(ModuleResolver& moduleResolver)
+	{
+		m_onModuleUpdated.Connect(moduleResolver.OnModuleUpdated, [this](ModuleResolver* /*resolver*/, const std::string& moduleName)
+		{
+			Invalidate(moduleName);
+		});
+	}
+
+	void SanitizedModuleCache::Clear()
+	{
+		std::lock_guard lock(m_mutex);
+		m_entriesByModuleName.clear();
+	}
+
+	auto SanitizedModuleCache::Find(const Module& module, const Key& key) const -> CachedModule
+	{
+		std::lock_guard lock(m_mutex);
+
+		auto it = m_entriesByModuleName.find(module.metadata->moduleName);
+		if (it == m_entriesByModuleName.end())
+			return {};
+
+		for (const Entry& entry : it->second)
+		{
+			if (entry.module.lock().get() == &module && entry.key == key)
+				return entry.cachedModule;
+		}
+
+		return {};
+	}
+
+	std::size_t SanitizedModuleCache::GetEntryCount() const
+	{
+		std::lock_guard lock(m_mutex);
+
+		std::size_t entryCount = 0;
+		for (const auto& [moduleName, entries] : m_entriesByModuleName)
+		{
+			for (const Entry& entry : entries)
+			{
+				if (!entry.module.expired())
+					entryCount++;
+			}
+		}
+
+		return entryCount;
+	}
+
+	void SanitizedModuleCache::Invalidate(const std::string& moduleName)
+	{
+		std::lock_guard lock(m_mutex);
+		m_entriesByModuleName.erase(moduleName);
+	}
+
+	void SanitizedModuleCache::Register(const ModulePtr& module, Key key, CachedModule cachedModule)
+	{
+		assert(module);
+		assert(cachedModule.sanitizedModule);
+		assert(cachedModule.registrations);
+
+		std::lock_guard lock(m_mutex);
+
+		RemoveExpiredEntries();
+
+		std::vector<Entry>& entries = m_entriesByModuleName[module->metadata->moduleName];
+		for (Entry& entry : entries)
+		{
+			if (entry.module.lock() == module && entry.key == key)
+			{
+				// Another thread sanitized the same module concurrently
+				entry.cachedModule = std::move(cachedModule);
+				return;
+			}
+		}
+
+		auto& entry = entries.emplace_back();
+		entry.key = std::move(key);
+		entry.module = module;
+		entry.cachedModule = std::move(cachedModule);
+	}
+
+	void SanitizedModuleCache::RemoveExpiredEntries()
+	{
+		for (auto it = m_entriesByModuleName.begin(); it != m_entriesByModuleName.end();)
+		{
+			std::vector<Entry>& entries = it->second;
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.module.expired(); }), entries.end());
+
+			if (entries.empty())
+				it = m_entriesByModuleName.erase(it);
+			else
+				++it;
+		}
+	}
+}
@@ -3,20 +3,110 @@
 // For conditions of distribution and use, see copyright notice in Config.hpp
 
 #include <NZSL/FilesystemModuleResolver.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/PathUtils.hpp>
 #include <NZSL/Archive.hpp>
+#include <NZSL/Lexer.hpp>
 #include <NZSL/Parser.hpp>
 #include <NZSL/Ast/AstSerializer.hpp>
 #ifdef NZSL_EFSW
 #include <efsw/efsw.h>
 #endif
 #include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <exception>
 #include <fstream>
+#include <thread>
 
 namespace nzsl
 {
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		Ast::ModulePtr LoadArchiveModule(const Archive::ModuleData& moduleData)
+		{
+			std::vector<std::uint8_t> data = Archive::DecompressModule(&moduleData.data[0], moduleData.data.size(), moduleData.flags);
+			switch (moduleData.kind)
+			{
+				case ArchiveEntryKind::BinaryShaderModule:
+				{
+					Deserializer deserializer(&data[0], data.size());
+					return Ast::DeserializeShader(deserializer);
+				}
+			}
+
+			return {};
+		}
+
+		void LoadArchiveModules(const Archive& archive, std::vector<Ast::ModulePtr>& modules)
+		{
+			for (const Archive::ModuleData& moduleData : archive.GetModules())
+			{
+				if (Ast::ModulePtr module = LoadArchiveModule(moduleData))
+					modules.push_back(std::move(module));
+			}
+		}
+
+		std::vector<char> ReadFileContent(const std::filesystem::path& realPath)
+		{
+			std::uintmax_t filesize = std::filesystem::file_size(realPath);
+			if (filesize == 0)
+				return {};
+
+			std::ifstream inputFile(realPath, std::ios::in | std::ios::binary);
+			if (!inputFile)
+				throw std::runtime_error("failed to open " + Nz::PathToString(realPath));
+
+			std::vector<char> content(Nz::SafeCast<std::size_t>(filesize));
+			if (!inputFile.read(&content[0], Nz::SafeCast<std::size_t>(filesize)))
+				throw std::runtime_error("failed to read " + Nz::PathToString(realPath));
+
+			return content;
+		}
+
+		std::string ScanModuleName(std::string_view source, const std::string& filePath)
+		{
+			// The root module statement can only be preceded by attributes, only lex up to its name
+			Lexer lexer(source, filePath);
+
+			Token token = lexer.Next();
+			while (token.type == TokenType::OpenSquareBracket)
+			{
+				unsigned int bracketDepth = 1;
+				do
+				{
+					token = lexer.Next();
+					if (token.type == TokenType::OpenSquareBracket)
+						bracketDepth++;
+					else if (token.type == TokenType::ClosingSquareBracket)
+						bracketDepth--;
+					else if (token.type == TokenType::EndOfStream)
+						throw std::runtime_error("unexpected end of file in attributes");
+				}
+				while (bracketDepth > 0);
+
+				token = lexer.Next();
+			}
+
+			if (token.type != TokenType::Module)
+				throw std::runtime_error("expected module declaration");
+
+			std::string moduleName;
+			while ((token = lexer.Next()).type == TokenType::Identifier)
+			{
+				moduleName += std::get<std::string_view>(token.data);
+				if (lexer.Next().type != TokenType::Dot)
+					break;
+
+				moduleName += '.';
+			}
+
+			return moduleName;
+		}
+	}
+
 	FilesystemModuleResolver::~FilesystemModuleResolver()
 	{
 #ifdef NZSL_EFSW
@@ -25,113 +115,452 @@ namespace nzsl
 #endif
 	}
 
-	void FilesystemModuleResolver::RegisterArchive(const Archive& archive)
+	void FilesystemModuleResolver::IndexDirectory(const std::filesystem::path& realPath, bool watchDirectory)
 	{
-		for (const Archive::ModuleData& moduleData : archive.GetModules())
+		if (!std::filesystem::is_directory(realPath))
+			return;
+
+		if (watchDirectory)
 		{
-			std::vector<std::uint8_t> data = Archive::DecompressModule(&moduleData.data[0], moduleData.data.size(), moduleData.flags);
-			switch (moduleData.kind)
+			WatchDirectory(realPath);
+
+			std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(realPath);
+			if (canonicalPath.filename().empty())
+				canonicalPath = canonicalPath.parent_path(); //< remove trailing separator
+
+			std::lock_guard lock(m_moduleLock);
+			m_indexOnlyDirectories.push_back(std::move(canonicalPath));
+		}
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(realPath))
+		{
+			if (entry.is_regular_file() && CheckExtension(Nz::PathToString(entry.path())))
+				IndexFile(entry.path());
+		}
+	}
+
+	void FilesystemModuleResolver::IndexFile(const std::filesystem::path& realPath)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		// Files are read without holding the lock, modules are indexed all at once afterwards
+		std::vector<std::pair<std::string, LazyModule>> indexedModules;
+		try
+		{
+			std::vector<char> content = ReadFileContent(realPath);
+			if (content.empty())
+				return; //< ignore empty files
+
+			auto AddModule = [&](std::string moduleName, LazyModule lazyModule)
 			{
-				case ArchiveEntryKind::BinaryShaderModule:
+				if (moduleName.empty())
+					throw std::runtime_error("cannot register anonymous module");
+
+				indexedModules.emplace_back(std::move(moduleName), std::move(lazyModule));
+			};
+
+			LazyModule lazyModule;
+			lazyModule.filePath = realPath;
+
+			std::string ext = Nz::PathToString(realPath.extension());
+			if (ext == BinaryModuleExtension)
+			{
+				Deserializer deserializer(content.data(), content.size());
+				AddModule(Ast::DeserializeShaderMetadata(deserializer).moduleName, std::move(lazyModule));
+			}
+			else if (ext == ArchiveExtension)
+			{
+				// Archive is kept in memory with its modules still compressed
+				Deserializer deserializer(content.data(), content.size());
+				lazyModule.archive = std::make_shared<Archive>(DeserializeArchive(deserializer));
+
+				const auto& archiveModules = lazyModule.archive->GetModules();
+				for (std::size_t i = 0; i < archiveModules.size(); ++i)
 				{
-					Deserializer deserializer(&data[0], data.size());
-					RegisterModule(Ast::DeserializeShader(deserializer));
-					break;
+					lazyModule.archiveModuleIndex = i;
+					AddModule(archiveModules[i].name, lazyModule);
 				}
 			}
+			else if (ext == ModuleExtension)
+				AddModule(ScanModuleName(std::string_view(content.data(), content.size()), Nz::PathToString(realPath)), std::move(lazyModule));
+			else
+				throw std::runtime_error("unknown extension " + ext);
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error(fmt::format("failed to index module {}: {}", Nz::PathToString(realPath), e.what()));
 		}
+
+		PendingSignals signals;
+		{
+			std::lock_guard lock(m_moduleLock);
+			for (auto& [moduleName, lazyModule] : indexedModules)
+				IndexModule(std::move(moduleName), std::move(lazyModule), signals);
+		}
+
+		TriggerSignals(signals);
+	}
+
+	void FilesystemModuleResolver::RegisterArchive(const Archive& archive)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		std::vector<Ast::ModulePtr> modules;
+		LoadArchiveModules(archive, modules);
+
+		for (Ast::ModulePtr& module : modules)
+			RegisterModule(std::move(module));
 	}
 
-	void FilesystemModuleResolver::RegisterDirectory(const std::filesystem::path& realPath, bool watchDirectory)
+	void FilesystemModuleResolver::RegisterDirectory(const std::filesystem::path& realPath, bool watchDirectory, unsigned int workerCount)
 	{
 		if (!std::filesystem::is_directory(realPath))
 			return;
 
 		if (watchDirectory)
+			WatchDirectory(realPath);
+
+		std::vector<std::filesystem::path> filePaths;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(realPath))
 		{
-#ifdef NZSL_EFSW
-			if (!m_fileWatcher)
+			if (entry.is_regular_file() && CheckExtension(Nz::PathToString(entry.path())))
+				filePaths.push_back(entry.path());
+		}
+
+		auto RegisterFailure = [&](std::size_t fileIndex, const std::exception& e)
+		{
+			return std::runtime_error(fmt::format("failed to register module {}: {}", Nz::PathToString(filePaths[fileIndex]), e.what()));
+		};
+
+		if (workerCount == 0)
+			workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		workerCount = static_cast<unsigned int>(std::min<std::size_t>(workerCount, filePaths.size()));
+		if (workerCount <= 1)
+		{
+			for (std::size_t i = 0; i < filePaths.size(); ++i)
 			{
-				m_fileWatcher = efsw_create(0);
-				efsw_watch(m_fileWatcher);
+				try
+				{
+					RegisterFile(filePaths[i]);
+				}
+				catch (const std::exception& e)
+				{
+					throw RegisterFailure(i, e);
+				}
 			}
 
-			auto FileSystemCallback = [](efsw_watcher /*watcher*/, efsw_watchid /*watchid*/, const char* dir, const char* filename, efsw_action action, const char* oldFileName, void* param)
+			return;
+		}
+
+		// Files are loaded concurrently but registered in directory order on this thread, so errors and signals happen exactly as with a serial load
+		std::vector<LoadedFile> loadedFiles(filePaths.size());
+		std::vector<std::exception_ptr> loadErrors(filePaths.size());
+		std::atomic<std::size_t> nextFileIndex = 0;
+		std::atomic<std::size_t> firstErrorIndex = filePaths.size();
+
+		auto LoadFiles = [&]
+		{
+			for (;;)
 			{
-				FilesystemModuleResolver* resolver = static_cast<FilesystemModuleResolver*>(param);
+				std::size_t fileIndex = nextFileIndex++;
+				if (fileIndex >= firstErrorIndex)
+					break; //< files after the first error would never be registered
 
-				switch (action)
+				try
+				{
+					loadedFiles[fileIndex] = LoadFile(filePaths[fileIndex]);
+				}
+				catch (...)
 				{
-					case EFSW_ADD:
-						resolver->OnFileAdded(dir, filename);
-						break;
+					loadErrors[fileIndex] = std::current_exception();
 
-					case EFSW_DELETE:
-						resolver->OnFileRemoved(dir, filename);
-						break;
+					std::size_t errorIndex = firstErrorIndex;
+					while (fileIndex < errorIndex && !firstErrorIndex.compare_exchange_weak(errorIndex, fileIndex));
+				}
+			}
+		};
 
-					case EFSW_MODIFIED:
-						resolver->OnFileUpdated(dir, filename);
-						break;
+		{
+			std::vector<std::thread> workers;
+			workers.reserve(workerCount - 1);
 
-					case EFSW_MOVED:
-						resolver->OnFileMoved(dir, filename, (oldFileName) ? oldFileName : std::string_view());
-						break;
-				}
-			};
-		
-			efsw_addwatch(m_fileWatcher, Nz::PathToString(realPath).c_str(), FileSystemCallback, 1, this);
-#else
-			throw std::runtime_error("nzsl was built without filesystem watch feature");
-#endif
+			NAZARA_DEFER({
+				for (std::thread& worker : workers)
+					worker.join();
+			});
+
+			for (unsigned int i = 1; i < workerCount; ++i)
+				workers.emplace_back(LoadFiles);
+
+			LoadFiles();
 		}
 
-		for (const auto& entry : std::filesystem::recursive_directory_iterator(realPath))
+		for (std::size_t i = 0; i < filePaths.size(); ++i)
 		{
-			if (entry.is_regular_file() && CheckExtension(Nz::PathToString(entry.path())))
+			try
+			{
+				if (loadErrors[i])
+					std::rethrow_exception(loadErrors[i]);
+
+				RegisterLoadedFile(std::move(loadedFiles[i]));
+			}
+			catch (const std::exception& e)
+			{
+				throw RegisterFailure(i, e);
+			}
+		}
+	}
+
+	void FilesystemModuleResolver::RegisterFile(const std::filesystem::path& realPath)
+	{
+		RegisterLoadedFile(LoadFile(realPath, true));
+	}
+
+	void FilesystemModuleResolver::RegisterModule(std::string_view moduleSource)
+	{
+		Ast::ModulePtr module = Parse(moduleSource);
+		if (!module)
+			return;
+
+		return RegisterModule(std::move(module));
+	}
+
+	void FilesystemModuleResolver::RegisterModule(Ast::ModulePtr module)
+	{
+		assert(module);
+
+		PendingSignals signals;
+		{
+			std::lock_guard lock(m_moduleLock);
+			PublishModule(std::move(module), signals);
+		}
+
+		TriggerSignals(signals);
+	}
+
+	Ast::ModulePtr FilesystemModuleResolver::Resolve(const std::string& moduleName)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		std::unique_lock lock(m_moduleLock);
+
+		// Don't load the same module twice, wait for the thread already loading it
+		m_moduleLoadedCondition.wait(lock, [&] { return m_loadingModules.find(moduleName) == m_loadingModules.end(); });
+
+		auto it = m_modules.find(moduleName);
+		if (it != m_modules.end())
+		{
+			m_unresolvedModules.erase(moduleName);
+			return it->second;
+		}
+
+		auto lazyIt = m_lazyModules.find(moduleName);
+		if (lazyIt == m_lazyModules.end())
+			return {};
+
+		// Indexed module, load it now without holding the lock so that other modules can be resolved (and files reloaded) meanwhile
+		LazyModule lazyModule = lazyIt->second;
+		m_loadingModules.insert(moduleName);
+		lock.unlock();
+
+		Ast::ModulePtr archiveModule;
+		LoadedFile loadedFile;
+		std::exception_ptr loadError;
+		try
+		{
+			if (lazyModule.archive)
 			{
 				try
 				{
-					RegisterFile(entry.path());
+					archiveModule = LoadArchiveModule(lazyModule.archive->GetModules()[lazyModule.archiveModuleIndex]);
 				}
 				catch (const std::exception& e)
 				{
-					throw std::runtime_error(fmt::format("failed to register module {}: {}", Nz::PathToString(entry.path()), e.what()));
+					throw std::runtime_error(fmt::format("failed to load module {} from archive {}: {}", moduleName, Nz::PathToString(lazyModule.filePath), e.what()));
 				}
 			}
+			else
+				loadedFile = LoadFile(lazyModule.filePath);
+		}
+		catch (...)
+		{
+			loadError = std::current_exception();
+		}
+
+		lock.lock();
+
+		m_loadingModules.erase(moduleName);
+		m_moduleLoadedCondition.notify_all();
+
+		if (loadError)
+			std::rethrow_exception(loadError);
+
+		// The module may have been registered, removed or indexed again while it was loading, only publish it if its index entry is still the one we loaded
+		it = m_modules.find(moduleName);
+		if (it != m_modules.end())
+		{
+			m_unresolvedModules.erase(moduleName);
+			return it->second;
+		}
+
+		lazyIt = m_lazyModules.find(moduleName);
+		if (lazyIt == m_lazyModules.end())
+			return {};
+
+		const LazyModule& currentLazyModule = lazyIt->second;
+		if (currentLazyModule.filePath != lazyModule.filePath || currentLazyModule.archive != lazyModule.archive || currentLazyModule.archiveModuleIndex != lazyModule.archiveModuleIndex)
+		{
+			lock.unlock();
+			return Resolve(moduleName);
+		}
+
+		PendingSignals signals;
+		if (lazyModule.archive)
+		{
+			if (!archiveModule)
+				return {};
+
+			PublishModule(std::move(archiveModule), signals);
+		}
+		else
+			PublishLoadedFile(std::move(loadedFile), signals);
+
+		// Module name comes from the file itself, which may not match the index if the file changed since then
+		m_lazyModules.erase(moduleName);
+
+		Ast::ModulePtr module;
+		if (it = m_modules.find(moduleName); it != m_modules.end())
+		{
+			m_unresolvedModules.erase(moduleName);
+			module = it->second;
 		}
+
+		lock.unlock();
+
+		TriggerSignals(signals);
+
+		return module;
 	}
 
-	void FilesystemModuleResolver::RegisterFile(const std::filesystem::path& realPath)
+	void FilesystemModuleResolver::IndexModule(std::string moduleName, LazyModule lazyModule, PendingSignals& signals)
 	{
-		Ast::ModulePtr module;
-		try
+		assert(!moduleName.empty());
+
+		if (!lazyModule.archive)
+			m_moduleByFilepath.insert_or_assign(Nz::PathToString(std::filesystem::weakly_canonical(lazyModule.filePath)), moduleName);
+
+		// An already loaded module is replaced by the indexed one, which will be loaded on its next Resolve
+		bool isUpdate = m_modules.erase(moduleName) > 0;
+		m_unresolvedModules.erase(moduleName);
+
+		auto it = m_lazyModules.insert_or_assign(std::move(moduleName), std::move(lazyModule)).first;
+		if (isUpdate)
+			signals.updatedModules.push_back(it->first);
+	}
+
+	bool FilesystemModuleResolver::IsInIndexOnlyDirectory(const std::filesystem::path& canonicalPath) const
+	{
+		for (const std::filesystem::path& directory : m_indexOnlyDirectories)
 		{
-			std::uintmax_t filesize = std::filesystem::file_size(realPath);
-			if (filesize == 0)
-				return; //< ignore empty files
+			auto [directoryIt, pathIt] = std::mismatch(directory.begin(), directory.end(), canonicalPath.begin(), canonicalPath.end());
+			if (directoryIt == directory.end())
+				return true;
+		}
 
-			std::ifstream inputFile(realPath, std::ios::in | std::ios::binary);
-			if (!inputFile)
-				throw std::runtime_error("failed to open " + Nz::PathToString(realPath));
+		return false;
+	}
 
-			std::vector<char> content(Nz::SafeCast<std::size_t>(filesize));
-			if (!inputFile.read(&content[0], Nz::SafeCast<std::size_t>(filesize)))
-				throw std::runtime_error("failed to read " + Nz::PathToString(realPath));
+	auto FilesystemModuleResolver::LoadFile(const std::filesystem::path& realPath, bool reuseRegisteredModule) -> LoadedFile
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		LoadedFile loadedFile;
+		loadedFile.canonicalPath = Nz::PathToString(std::filesystem::weakly_canonical(realPath));
+
+		try
+		{
+			std::vector<char> content = ReadFileContent(realPath);
+			if (content.empty())
+				return loadedFile; //< ignore empty files
 
 			std::string ext = Nz::PathToString(realPath.extension());
 			if (ext == BinaryModuleExtension)
 			{
 				Deserializer deserializer(content.data(), content.size());
-				module = Ast::DeserializeShader(deserializer);
+				loadedFile.module = Ast::DeserializeShader(deserializer);
 			}
 			else if (ext == ArchiveExtension)
 			{
 				Deserializer deserializer(content.data(), content.size());
-				RegisterArchive(DeserializeArchive(deserializer));
+				LoadArchiveModules(DeserializeArchive(deserializer), loadedFile.archiveModules);
 			}
 			else if (ext == ModuleExtension)
-				module = Parse(std::string_view(content.data(), content.size()), Nz::PathToString(realPath));
+			{
+				std::string_view source(content.data(), content.size());
+				if (m_fileWatcher)
+				{
+					// Watched files keep their last version around so that updates only reparse the root statements which changed,
+					// the parser is taken out of the map while parsing so that other files can be parsed concurrently
+					IncrementalParser parser;
+					Ast::ModulePtr previousModule;
+					{
+						std::lock_guard lock(m_moduleLock);
+						if (auto it = m_parserByFilepath.find(loadedFile.canonicalPath); it != m_parserByFilepath.end())
+							parser = std::move(it->second);
+
+						// A version which Resolve never returned is only referenced by the resolver and the parser, the resolver hands it over to the parser
+						// while reparsing so that its unchanged statements are moved instead of copied (Resolve waits for the new version meanwhile)
+						if (reuseRegisteredModule && parser.GetModule())
+						{
+							const std::string& moduleName = parser.GetModule()->metadata->moduleName;
+
+							auto moduleIt = m_modules.find(moduleName);
+							if (moduleIt != m_modules.end() && moduleIt->second == parser.GetModule() && m_unresolvedModules.erase(moduleName) > 0)
+							{
+								previousModule = std::move(moduleIt->second);
+								loadedFile.releasedModuleName = moduleIt->first;
+								m_loadingModules.insert(moduleIt->first);
+								m_modules.erase(moduleIt);
+							}
+						}
+					}
+
+					IncrementalParser::Result result;
+					try
+					{
+						if (previousModule)
+							result = parser.Parse(std::move(previousModule), source, Nz::PathToString(realPath));
+						else
+							result = parser.Parse(source, Nz::PathToString(realPath));
+					}
+					catch (...)
+					{
+						// The previous version is left untouched on failure, publish it again
+						std::lock_guard lock(m_moduleLock);
+						if (!loadedFile.releasedModuleName.empty())
+						{
+							if (m_modules.emplace(loadedFile.releasedModuleName, std::move(previousModule)).second)
+								m_unresolvedModules.insert(loadedFile.releasedModuleName);
+
+							m_loadingModules.erase(loadedFile.releasedModuleName);
+							m_moduleLoadedCondition.notify_all();
+						}
+
+						m_parserByFilepath.insert_or_assign(loadedFile.canonicalPath, std::move(parser));
+						throw;
+					}
+
+					loadedFile.module = std::move(result.module);
+					loadedFile.changedDeclarations = std::move(result.changedDeclarations);
+					loadedFile.isIncrementallyParsed = true;
+
+					std::lock_guard lock(m_moduleLock);
+					m_parserByFilepath.insert_or_assign(loadedFile.canonicalPath, std::move(parser));
+				}
+				else
+					loadedFile.module = Parse(source, Nz::PathToString(realPath));
+			}
 			else
 				throw std::runtime_error("unknown extension " + ext);
 		}
@@ -140,55 +569,124 @@ namespace nzsl
 			throw std::runtime_error(fmt::format("failed to register module {}: {}", Nz::PathToString(realPath), e.what()));
 		}
 
-		if (!module)
-			return;
+		return loadedFile;
+	}
 
-		std::lock_guard lock(m_moduleLock);
+	void FilesystemModuleResolver::PublishLoadedFile(LoadedFile&& loadedFile, PendingSignals& signals)
+	{
+		if (!loadedFile.releasedModuleName.empty())
+		{
+			m_loadingModules.erase(loadedFile.releasedModuleName);
+			m_moduleLoadedCondition.notify_all();
+		}
 
-		std::string moduleName = module->metadata->moduleName;
-		RegisterModule(std::move(module));
+		for (Ast::ModulePtr& module : loadedFile.archiveModules)
+			PublishModule(std::move(module), signals);
 
-		std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(realPath);
-		m_moduleByFilepath.emplace(Nz::PathToString(canonicalPath), std::move(moduleName));
-	}
+		if (!loadedFile.module)
+		{
+			if (!loadedFile.releasedModuleName.empty())
+				signals.updatedModules.push_back(loadedFile.releasedModuleName);
 
-	void FilesystemModuleResolver::RegisterModule(std::string_view moduleSource)
-	{
-		Ast::ModulePtr module = Parse(moduleSource);
-		if (!module)
 			return;
+		}
 
-		return RegisterModule(std::move(module));
+		std::string moduleName = loadedFile.module->metadata->moduleName;
+		bool isRegistered = m_modules.find(moduleName) != m_modules.end();
+		bool isUpdate = isRegistered || moduleName == loadedFile.releasedModuleName;
+
+		PublishModule(std::move(loadedFile.module), signals);
+		if (loadedFile.isIncrementallyParsed)
+			m_unresolvedModules.insert(moduleName);
+
+		// PublishModule only signals the modules it replaces
+		if (!loadedFile.releasedModuleName.empty() && (loadedFile.releasedModuleName != moduleName || !isRegistered))
+			signals.updatedModules.push_back(loadedFile.releasedModuleName);
+
+		if (isUpdate && loadedFile.changedDeclarations)
+			signals.updatedDeclarations.emplace_back(moduleName, std::move(*loadedFile.changedDeclarations));
+
+		m_moduleByFilepath.insert_or_assign(std::move(loadedFile.canonicalPath), std::move(moduleName));
 	}
 
-	void FilesystemModuleResolver::RegisterModule(Ast::ModulePtr module)
+	void FilesystemModuleResolver::PublishModule(Ast::ModulePtr module, PendingSignals& signals)
 	{
-		assert(module);
-
 		std::string moduleName = module->metadata->moduleName;
 		if (moduleName.empty())
 			throw std::runtime_error("cannot register anonymous module");
 
-		std::lock_guard lock(m_moduleLock);
+		m_lazyModules.erase(moduleName);
+		m_unresolvedModules.erase(moduleName);
 
 		auto it = m_modules.find(moduleName);
 		if (it != m_modules.end())
 		{
 			it->second = std::move(module);
 
-			OnModuleUpdated(this, moduleName);
+			signals.updatedModules.push_back(std::move(moduleName));
 		}
 		else
 			m_modules.emplace(std::move(moduleName), std::move(module));
 	}
 
-	Ast::ModulePtr FilesystemModuleResolver::Resolve(const std::string& moduleName)
+	void FilesystemModuleResolver::RegisterLoadedFile(LoadedFile&& loadedFile)
 	{
-		auto it = m_modules.find(moduleName);
-		if (it == m_modules.end())
-			return {};
+		PendingSignals signals;
+		{
+			std::lock_guard lock(m_moduleLock);
+			PublishLoadedFile(std::move(loadedFile), signals);
+		}
+
+		TriggerSignals(signals);
+	}
+
+	void FilesystemModuleResolver::TriggerSignals(const PendingSignals& signals)
+	{
+		for (const std::string& moduleName : signals.updatedModules)
+			OnModuleUpdated(this, moduleName);
 
-		return it->second;
+		for (const auto& [moduleName, declarations] : signals.updatedDeclarations)
+			OnModuleDeclarationsUpdated(this, moduleName, declarations);
+	}
+
+	void FilesystemModuleResolver::WatchDirectory(const std::filesystem::path& realPath)
+	{
+#ifdef NZSL_EFSW
+		if (!m_fileWatcher)
+		{
+			m_fileWatcher = efsw_create(0);
+			efsw_watch(m_fileWatcher);
+		}
+
+		auto FileSystemCallback = [](efsw_watcher /*watcher*/, efsw_watchid /*watchid*/, const char* dir, const char* filename, efsw_action action, const char* oldFileName, void* param)
+		{
+			FilesystemModuleResolver* resolver = static_cast<FilesystemModuleResolver*>(param);
+
+			switch (action)
+			{
+				case EFSW_ADD:
+					resolver->OnFileAdded(dir, filename);
+					break;
+
+				case EFSW_DELETE:
+					resolver->OnFileRemoved(dir, filename);
+					break;
+
+				case EFSW_MODIFIED:
+					resolver->OnFileUpdated(dir, filename);
+					break;
+
+				case EFSW_MOVED:
+					resolver->OnFileMoved(dir, filename, (oldFileName) ? oldFileName : std::string_view());
+					break;
+			}
+		};
+
+		efsw_addwatch(m_fileWatcher, Nz::PathToString(realPath).c_str(), FileSystemCallback, 1, this);
+#else
+		NazaraUnused(realPath);
+		throw std::runtime_error("nzsl was built without filesystem watch feature");
+#endif
 	}
 
 	void FilesystemModuleResolver::OnFileAdded(std::string_view directory, std::string_view filename)
@@ -198,9 +696,18 @@ namespace nzsl
 
 		std::filesystem::path filepath = Nz::Utf8Path(directory) / Nz::Utf8Path(filename);
 
+		bool indexOnly;
+		{
+			std::lock_guard lock(m_moduleLock);
+			indexOnly = IsInIndexOnlyDirectory(std::filesystem::weakly_canonical(filepath));
+		}
+
 		try
 		{
-			RegisterFile(filepath);
+			if (indexOnly)
+				IndexFile(filepath);
+			else
+				RegisterFile(filepath);
 		}
 		catch (const std::exception& e)
 		{
@@ -220,9 +727,13 @@ namespace nzsl
 		auto it = m_moduleByFilepath.find(Nz::PathToString(canonicalPath));
 		if (it != m_moduleByFilepath.end())
 		{
+			m_lazyModules.erase(it->second);
 			m_modules.erase(it->second);
+			m_unresolvedModules.erase(it->second);
 			m_moduleByFilepath.erase(it);
 		}
+
+		m_parserByFilepath.erase(Nz::PathToString(canonicalPath));
 	}
 
 	void FilesystemModuleResolver::OnFileMoved(std::string_view directory, std::string_view filename, std::string_view oldFilename)
@@ -243,7 +754,18 @@ namespace nzsl
 			std::string moduleName = std::move(it->second);
 			m_moduleByFilepath.erase(it);
 
-			m_moduleByFilepath.emplace(Nz::PathToString(newCanonicalPath), std::move(moduleName));
+			if (auto lazyIt = m_lazyModules.find(moduleName); lazyIt != m_lazyModules.end() && !lazyIt->second.archive)
+				lazyIt->second.filePath = newCanonicalPath;
+
+			m_moduleByFilepath.insert_or_assign(Nz::PathToString(newCanonicalPath), std::move(moduleName));
+
+			if (auto parserIt = m_parserByFilepath.find(Nz::PathToString(canonicalPath)); parserIt != m_parserByFilepath.end())
+			{
+				IncrementalParser parser = std::move(parserIt->second);
+				m_parserByFilepath.erase(parserIt);
+
+				m_parserByFilepath.insert_or_assign(Nz::PathToString(newCanonicalPath), std::move(parser));
+			}
 		}
 	}
 
@@ -254,9 +776,26 @@ namespace nzsl
 
 		std::filesystem::path filepath = Nz::Utf8Path(directory) / Nz::Utf8Path(filename);
 
+		// Files of indexed directories are only loaded again if their module was already resolved
+		bool indexOnly;
+		{
+			std::lock_guard lock(m_moduleLock);
+
+			std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(filepath);
+			indexOnly = IsInIndexOnlyDirectory(canonicalPath);
+			if (indexOnly)
+			{
+				if (auto it = m_moduleByFilepath.find(Nz::PathToString(canonicalPath)); it != m_moduleByFilepath.end())
+					indexOnly = (m_modules.find(it->second) == m_modules.end());
+			}
+		}
+
 		try
 		{
-			RegisterFile(filepath);
+			if (indexOnly)
+				IndexFile(filepath);
+			else
+				RegisterFile(filepath);
 		}
 		catch (const std::exception& e)
 		{
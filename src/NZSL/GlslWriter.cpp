@@ -8,9 +8,8 @@
 #include <NazaraUtils/CallOnExit.hpp>
 #include <NazaraUtils/PathUtils.hpp>
 #include <NZSL/Enums.hpp>
-#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
 #include <NZSL/Ast/ConstantValue.hpp>
-#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/PassManager.hpp>
 #include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <NZSL/Ast/Utils.hpp>
 #include <NZSL/Lang/LangData.hpp>
@@ -386,12 +385,14 @@ namespace nzsl
 
 		if (states.optimize)
 		{
-			sanitizedModule = Ast::PropagateConstants(*targetModule);
-
 			Ast::DependencyCheckerVisitor::Config dependencyConfig;
 			dependencyConfig.usedShaderStages = (shaderStage) ? *shaderStage : ShaderStageType_All; //< only one should exist anyway
 
-			sanitizedModule = Ast::EliminateUnusedPass(*sanitizedModule, dependencyConfig);
+			// Reuse our sanitized module if we have one, so passes can work on it in place
+			if (sanitizedModule)
+				sanitizedModule = Ast::Optimize(std::move(sanitizedModule), dependencyConfig);
+			else
+				sanitizedModule = Ast::Optimize(*targetModule, dependencyConfig);
 
 			targetModule = sanitizedModule.get();
 		}
@@ -1350,13 +1351,13 @@ namespace nzsl
 			const SourceLocation& rootLocation = module.rootNode->sourceLocation;
 
 			AppendComment("NZSL version: " + std::to_string(metadata.shaderLangVersion / 100) + "." + std::to_string((metadata.shaderLangVersion % 100) / 10));
-			if (rootLocation.file)
+			if (rootLocation.HasFile())
 			{
-				AppendComment("from " + *rootLocation.file);
+				AppendComment("from " + std::string(rootLocation.GetFilePath()));
 				if (m_currentState->states->debugLevel >= DebugLevel::Full)
 				{
 					// Try to embed source code
-					std::ifstream file(Nz::Utf8Path(*rootLocation.file));
+					std::ifstream file(Nz::Utf8Path(rootLocation.GetFilePath()));
 					if (file)
 					{
 						AppendLine("#if 0 // Module source code");
@@ -1595,8 +1596,8 @@ namespace nzsl
 			return;
 
 		std::string_view file;
-		if (sourceLocation.file)
-			file = *sourceLocation.file;
+		if (sourceLocation.HasFile())
+			file = sourceLocation.GetFilePath();
 		else
 			file = "unknown";
 
@@ -0,0 +1,600 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/IncrementalParser.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <NazaraUtils/Hash.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/Ast/Cloner.hpp>
+#include <NZSL/Ast/RecursiveVisitor.hpp>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace nzsl
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		// Moves all the source locations of a statement by a number of lines, in place
+		class SourceLocationShifter final : public Ast::RecursiveVisitor
+		{
+			public:
+				SourceLocationShifter(std::int64_t lineOffset) :
+				m_lineOffset(lineOffset)
+				{
+				}
+
+				void Shift(Ast::Statement& statement)
+				{
+					statement.Visit(*this);
+				}
+
+			private:
+#define NZSL_SHADERAST_NODE(NodeType, Category) void Visit(Ast::NodeType##Category& node) override \
+				{ \
+					ShiftLocation(node.sourceLocation); \
+					ShiftMembers(node); \
+					RecursiveVisitor::Visit(node); \
+				}
+
+#include <NZSL/Ast/NodeList.hpp>
+
+				// Locations and expressions which aren't reached by RecursiveVisitor
+				template<typename T>
+				void ShiftMembers(T& /*node*/)
+				{
+				}
+
+				void ShiftMembers(Ast::AccessIdentifierExpression& node)
+				{
+					for (auto& identifier : node.identifiers)
+						ShiftLocation(identifier.sourceLocation);
+				}
+
+				void ShiftMembers(Ast::CastExpression& node)
+				{
+					ShiftValue(node.targetType);
+				}
+
+				void ShiftMembers(Ast::ConditionalExpression& node)
+				{
+					node.condition->Visit(*this);
+				}
+
+				void ShiftMembers(Ast::ConditionalStatement& node)
+				{
+					node.condition->Visit(*this);
+				}
+
+				void ShiftMembers(Ast::DeclareConstStatement& node)
+				{
+					ShiftValue(node.isExported);
+					ShiftValue(node.type);
+				}
+
+				void ShiftMembers(Ast::DeclareExternalStatement& node)
+				{
+					ShiftValue(node.autoBinding);
+					ShiftValue(node.bindingSet);
+
+					for (auto& externalVar : node.externalVars)
+					{
+						ShiftValue(externalVar.bindingIndex);
+						ShiftValue(externalVar.bindingSet);
+						ShiftValue(externalVar.type);
+						ShiftLocation(externalVar.sourceLocation);
+					}
+				}
+
+				void ShiftMembers(Ast::DeclareFunctionStatement& node)
+				{
+					ShiftValue(node.depthWrite);
+					ShiftValue(node.earlyFragmentTests);
+					ShiftValue(node.entryStage);
+					ShiftValue(node.isExported);
+					ShiftValue(node.returnType);
+					ShiftValue(node.workgroupSize);
+
+					for (auto& parameter : node.parameters)
+					{
+						ShiftValue(parameter.type);
+						ShiftLocation(parameter.sourceLocation);
+					}
+				}
+
+				void ShiftMembers(Ast::DeclareOptionStatement& node)
+				{
+					ShiftValue(node.optType);
+				}
+
+				void ShiftMembers(Ast::DeclareStructStatement& node)
+				{
+					ShiftValue(node.isExported);
+					ShiftValue(node.description.layout);
+
+					for (auto& member : node.description.members)
+					{
+						ShiftValue(member.builtin);
+						ShiftValue(member.cond);
+						ShiftValue(member.interp);
+						ShiftValue(member.locationIndex);
+						ShiftValue(member.type);
+						ShiftLocation(member.sourceLocation);
+					}
+				}
+
+				void ShiftMembers(Ast::DeclareVariableStatement& node)
+				{
+					ShiftValue(node.varType);
+				}
+
+				void ShiftMembers(Ast::ForStatement& node)
+				{
+					ShiftValue(node.unroll);
+				}
+
+				void ShiftMembers(Ast::ForEachStatement& node)
+				{
+					ShiftValue(node.unroll);
+				}
+
+				void ShiftMembers(Ast::ImportStatement& node)
+				{
+					for (auto& identifier : node.identifiers)
+					{
+						ShiftLocation(identifier.identifierLoc);
+						ShiftLocation(identifier.renamedIdentifierLoc);
+					}
+				}
+
+				void ShiftMembers(Ast::WhileStatement& node)
+				{
+					ShiftValue(node.unroll);
+				}
+
+				void ShiftLocation(SourceLocation& sourceLocation) const
+				{
+					if (!sourceLocation.IsValid())
+						return;
+
+					sourceLocation.startLine = Nz::SafeCast<std::uint32_t>(sourceLocation.startLine + m_lineOffset);
+					sourceLocation.endLine = Nz::SafeCast<std::uint32_t>(sourceLocation.endLine + m_lineOffset);
+				}
+
+				template<typename T>
+				void ShiftValue(Ast::ExpressionValue<T>& value)
+				{
+					if (value.IsExpression())
+						value.GetExpression()->Visit(*this);
+				}
+
+				std::int64_t m_lineOffset;
+		};
+
+		void CollectDeclarationNames(const Ast::Statement& statement, std::vector<std::string>& names)
+		{
+			switch (statement.GetType())
+			{
+				case Ast::NodeType::BranchStatement:
+				{
+					const auto& branch = Nz::SafeCast<const Ast::BranchStatement&>(statement);
+					for (const auto& condStatement : branch.condStatements)
+						CollectDeclarationNames(*condStatement.statement, names);
+
+					if (branch.elseStatement)
+						CollectDeclarationNames(*branch.elseStatement, names);
+
+					break;
+				}
+
+				case Ast::NodeType::ConditionalStatement:
+					CollectDeclarationNames(*Nz::SafeCast<const Ast::ConditionalStatement&>(statement).statement, names);
+					break;
+
+				case Ast::NodeType::DeclareAliasStatement:
+					names.push_back(Nz::SafeCast<const Ast::DeclareAliasStatement&>(statement).name);
+					break;
+
+				case Ast::NodeType::DeclareConstStatement:
+					names.push_back(Nz::SafeCast<const Ast::DeclareConstStatement&>(statement).name);
+					break;
+
+				case Ast::NodeType::DeclareExternalStatement:
+				{
+					const auto& external = Nz::SafeCast<const Ast::DeclareExternalStatement&>(statement);
+					if (!external.name.empty())
+						names.push_back(external.name);
+					else
+					{
+						for (const auto& externalVar : external.externalVars)
+							names.push_back(externalVar.name);
+					}
+					break;
+				}
+
+				case Ast::NodeType::DeclareFunctionStatement:
+					names.push_back(Nz::SafeCast<const Ast::DeclareFunctionStatement&>(statement).name);
+					break;
+
+				case Ast::NodeType::DeclareOptionStatement:
+					names.push_back(Nz::SafeCast<const Ast::DeclareOptionStatement&>(statement).optName);
+					break;
+
+				case Ast::NodeType::DeclareStructStatement:
+					names.push_back(Nz::SafeCast<const Ast::DeclareStructStatement&>(statement).description.name);
+					break;
+
+				case Ast::NodeType::DeclareVariableStatement:
+					names.push_back(Nz::SafeCast<const Ast::DeclareVariableStatement&>(statement).varName);
+					break;
+
+				case Ast::NodeType::ImportStatement:
+					names.push_back(Nz::SafeCast<const Ast::ImportStatement&>(statement).moduleName);
+					break;
+
+				case Ast::NodeType::MultiStatement:
+				{
+					for (const auto& childStatement : Nz::SafeCast<const Ast::MultiStatement&>(statement).statements)
+						CollectDeclarationNames(*childStatement, names);
+					break;
+				}
+
+				case Ast::NodeType::ScopedStatement:
+					CollectDeclarationNames(*Nz::SafeCast<const Ast::ScopedStatement&>(statement).statement, names);
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		// Tokens are compared relatively to the first line of their statement, so that moving a statement doesn't change it
+		bool AreTokensEquivalent(const Token* lhs, const Token* rhs, std::size_t tokenCount)
+		{
+			if (tokenCount == 0)
+				return true;
+
+			std::uint32_t lhsFirstLine = lhs[0].location.startLine;
+			std::uint32_t rhsFirstLine = rhs[0].location.startLine;
+
+			for (std::size_t i = 0; i < tokenCount; ++i)
+			{
+				const Token& lhsToken = lhs[i];
+				const Token& rhsToken = rhs[i];
+
+				if (lhsToken.type != rhsToken.type || lhsToken.data != rhsToken.data)
+					return false;
+
+				if (lhsToken.location.startColumn != rhsToken.location.startColumn || lhsToken.location.endColumn != rhsToken.location.endColumn)
+					return false;
+
+				if (lhsToken.location.startLine - lhsFirstLine != rhsToken.location.startLine - rhsFirstLine ||
+				    lhsToken.location.endLine - lhsFirstLine != rhsToken.location.endLine - rhsFirstLine)
+					return false;
+			}
+
+			return true;
+		}
+
+		std::size_t HashTokens(const Token* tokens, std::size_t tokenCount)
+		{
+			std::size_t seed = tokenCount;
+			if (tokenCount == 0)
+				return seed;
+
+			std::uint32_t firstLine = tokens[0].location.startLine;
+			for (std::size_t i = 0; i < tokenCount; ++i)
+			{
+				const Token& token = tokens[i];
+
+				Nz::HashCombine(seed, token.type);
+				Nz::HashCombine(seed, token.data);
+				Nz::HashCombine(seed, token.location.startLine - firstLine);
+				Nz::HashCombine(seed, token.location.startColumn);
+			}
+
+			return seed;
+		}
+
+		// Returns the token following the end of the root statement starting at index, without parsing it
+		std::size_t FindRootStatementEnd(const std::vector<Token>& tokens, std::size_t index)
+		{
+			std::size_t depth = 0;
+			for (; tokens[index].type != TokenType::EndOfStream; ++index)
+			{
+				switch (tokens[index].type)
+				{
+					case TokenType::OpenCurlyBracket:
+					case TokenType::OpenParenthesis:
+					case TokenType::OpenSquareBracket:
+						depth++;
+						break;
+
+					case TokenType::ClosingParenthesis:
+					case TokenType::ClosingSquareBracket:
+						if (depth > 0)
+							depth--;
+						break;
+
+					case TokenType::ClosingCurlyBracket:
+					{
+						// const if (...) {} else {} is a single statement
+						if (depth > 0 && --depth == 0 && tokens[index + 1].type != TokenType::Else)
+							return index + 1;
+
+						break;
+					}
+
+					case TokenType::Semicolon:
+					{
+						if (depth == 0)
+							return index + 1;
+
+						break;
+					}
+
+					default:
+						break;
+				}
+			}
+
+			return index;
+		}
+
+		bool IsModuleStatement(const std::vector<Token>& tokens, std::size_t index)
+		{
+			// Skip attributes
+			while (tokens[index].type == TokenType::OpenSquareBracket)
+			{
+				std::size_t depth = 0;
+				do
+				{
+					switch (tokens[index].type)
+					{
+						case TokenType::OpenSquareBracket:
+							depth++;
+							break;
+
+						case TokenType::ClosingSquareBracket:
+							depth--;
+							break;
+
+						case TokenType::EndOfStream:
+							return false;
+
+						default:
+							break;
+					}
+
+					index++;
+				}
+				while (depth > 0);
+			}
+
+			return tokens[index].type == TokenType::Module;
+		}
+	}
+
+	auto IncrementalParser::Parse(std::string_view source, const std::string& filePath) -> Result
+	{
+		return ParseInternal(source, filePath, false);
+	}
+
+	auto IncrementalParser::Parse(Ast::ModulePtr&& previousModule, std::string_view source, const std::string& filePath) -> Result
+	{
+		if (previousModule != m_module)
+			throw std::runtime_error("previous module is not the last module parsed");
+
+		Result result = ParseInternal(source, filePath, true);
+		previousModule.reset();
+
+		return result;
+	}
+
+	auto IncrementalParser::ParseInternal(std::string_view source, const std::string& filePath, bool movePreviousStatements) -> Result
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		// Tokens reference the source, keep our own copy of it to compare the next version against them
+		std::vector<char> newSource(source.begin(), source.end());
+		std::vector<Token> tokens = Tokenize(std::string_view(newSource.data(), newSource.size()), filePath);
+
+		std::size_t headerTokenCount = 0;
+		std::vector<RootChunk> chunks;
+		bool isSplit = SplitRootStatements(tokens, headerTokenCount, chunks);
+
+		Result result;
+		result.fullReparse = true;
+
+		if (isSplit && m_headerTokenCount > 0 && headerTokenCount == m_headerTokenCount && AreTokensEquivalent(&m_tokens[0], &tokens[0], headerTokenCount))
+		{
+			constexpr std::size_t NoChunk = std::numeric_limits<std::size_t>::max();
+
+			std::unordered_multimap<std::size_t, std::size_t> previousChunksByHash;
+			for (std::size_t i = 0; i < m_chunks.size(); ++i)
+				previousChunksByHash.emplace(m_chunks[i].hash, i);
+
+			// Root statements are reparsed together, behind the module header which is required by the parser
+			std::vector<Token> changedTokens(tokens.begin(), tokens.begin() + headerTokenCount);
+			std::vector<std::size_t> expectedStatementEnds;
+
+			std::vector<std::size_t> reusedChunks(chunks.size(), NoChunk);
+			std::vector<bool> isPreviousChunkReused(m_chunks.size(), false);
+			for (std::size_t i = 0; i < chunks.size(); ++i)
+			{
+				const RootChunk& chunk = chunks[i];
+
+				auto range = previousChunksByHash.equal_range(chunk.hash);
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					// Each previous statement is reused at most once, as it may be moved to the new module
+					if (isPreviousChunkReused[it->second])
+						continue;
+
+					const RootChunk& previousChunk = m_chunks[it->second];
+					if (previousChunk.tokenCount == chunk.tokenCount && AreTokensEquivalent(&m_tokens[previousChunk.firstToken], &tokens[chunk.firstToken], chunk.tokenCount))
+					{
+						reusedChunks[i] = it->second;
+						isPreviousChunkReused[it->second] = true;
+						break;
+					}
+				}
+
+				if (reusedChunks[i] == NoChunk)
+				{
+					changedTokens.insert(changedTokens.end(), tokens.begin() + chunk.firstToken, tokens.begin() + chunk.firstToken + chunk.tokenCount);
+					expectedStatementEnds.push_back(changedTokens.size());
+				}
+			}
+			changedTokens.push_back(tokens.back()); //< EndOfStream
+
+			Ast::ModulePtr changedModule;
+			std::vector<std::size_t> statementEnds;
+			try
+			{
+				Parser parser;
+				changedModule = parser.Parse(changedTokens, &statementEnds);
+			}
+			catch (const std::exception&)
+			{
+				// the split may not match the actual root statements, let the full parse report errors
+			}
+
+			if (changedModule && changedModule->importedModules.empty() && statementEnds == expectedStatementEnds)
+			{
+				std::vector<Ast::StatementPtr>& previousStatements = m_module->rootNode->statements;
+				std::vector<Ast::StatementPtr>& changedStatements = changedModule->rootNode->statements;
+
+				auto module = std::make_shared<Ast::Module>(m_module->metadata);
+				std::vector<Ast::StatementPtr>& statements = module->rootNode->statements;
+				statements.reserve(chunks.size());
+
+				std::size_t changedStatementIndex = 0;
+				for (std::size_t i = 0; i < chunks.size(); ++i)
+				{
+					if (std::size_t previousChunkIndex = reusedChunks[i]; previousChunkIndex != NoChunk)
+					{
+						// Reused statements are only moved if the previous module was handed over to the parser
+						Ast::StatementPtr statement;
+						if (movePreviousStatements)
+							statement = std::move(previousStatements[previousChunkIndex]);
+						else
+							statement = Ast::Clone(*previousStatements[previousChunkIndex]);
+
+						std::int64_t lineOffset = std::int64_t(tokens[chunks[i].firstToken].location.startLine) - std::int64_t(m_tokens[m_chunks[previousChunkIndex].firstToken].location.startLine);
+						if (lineOffset != 0)
+						{
+							SourceLocationShifter shifter(lineOffset);
+							shifter.Shift(*statement);
+						}
+
+						statements.push_back(std::move(statement));
+					}
+					else
+					{
+						Ast::StatementPtr& statement = changedStatements[changedStatementIndex++];
+						CollectDeclarationNames(*statement, result.changedDeclarations);
+
+						statements.push_back(std::move(statement));
+					}
+				}
+
+				for (std::size_t i = 0; i < m_chunks.size(); ++i)
+				{
+					if (!isPreviousChunkReused[i])
+						CollectDeclarationNames(*previousStatements[i], result.changedDeclarations);
+				}
+
+				if (!statements.empty())
+				{
+					module->rootNode->sourceLocation = statements.front()->sourceLocation;
+					if (statements.back()->sourceLocation.IsValid())
+						module->rootNode->sourceLocation.ExtendToRight(statements.back()->sourceLocation);
+				}
+
+				result.module = std::move(module);
+				result.fullReparse = false;
+			}
+		}
+
+		if (!result.module)
+		{
+			std::vector<std::size_t> statementEnds;
+
+			Parser parser;
+			result.module = parser.Parse(tokens, &statementEnds);
+
+			for (const Ast::StatementPtr& statement : result.module->rootNode->statements)
+				CollectDeclarationNames(*statement, result.changedDeclarations);
+
+			if (m_module)
+			{
+				for (const Ast::StatementPtr& statement : m_module->rootNode->statements)
+					CollectDeclarationNames(*statement, result.changedDeclarations);
+			}
+
+			// Only keep the split for the next version if it matches what the parser found
+			bool isReusable = isSplit && result.module->importedModules.empty() && statementEnds.size() == chunks.size();
+			for (std::size_t i = 0; isReusable && i < chunks.size(); ++i)
+				isReusable = (statementEnds[i] == chunks[i].firstToken + chunks[i].tokenCount);
+
+			if (!isReusable)
+				headerTokenCount = 0;
+		}
+
+		std::sort(result.changedDeclarations.begin(), result.changedDeclarations.end());
+		result.changedDeclarations.erase(std::unique(result.changedDeclarations.begin(), result.changedDeclarations.end()), result.changedDeclarations.end());
+
+		m_headerTokenCount = headerTokenCount;
+		m_chunks = std::move(chunks);
+		m_module = result.module;
+		m_source = std::move(newSource);
+		m_tokens = std::move(tokens);
+
+		return result;
+	}
+
+	void IncrementalParser::Reset()
+	{
+		m_headerTokenCount = 0;
+		m_chunks.clear();
+		m_module.reset();
+		m_source.clear();
+		m_tokens.clear();
+	}
+
+	bool IncrementalParser::SplitRootStatements(const std::vector<Token>& tokens, std::size_t& headerTokenCount, std::vector<RootChunk>& chunks)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		assert(!tokens.empty() && tokens.back().type == TokenType::EndOfStream);
+
+		// Module statement is expected first, imported modules (module statements with a body) are not handled
+		if (!IsModuleStatement(tokens, 0))
+			return false;
+
+		headerTokenCount = FindRootStatementEnd(tokens, 0);
+		if (tokens[headerTokenCount - 1].type != TokenType::Semicolon)
+			return false;
+
+		for (std::size_t index = headerTokenCount; tokens[index].type != TokenType::EndOfStream;)
+		{
+			if (IsModuleStatement(tokens, index))
+				return false;
+
+			std::size_t end = FindRootStatementEnd(tokens, index);
+
+			auto& chunk = chunks.emplace_back();
+			chunk.firstToken = index;
+			chunk.tokenCount = end - index;
+			chunk.hash = HashTokens(&tokens[index], chunk.tokenCount);
+
+			index = end;
+		}
+
+		return true;
+	}
+}
@@ -125,9 +125,7 @@ namespace nzsl
 		{
 			if (m_sourceLocation.IsValid())
 			{
-				std::string_view sourceFile;
-				if (m_sourceLocation.file)
-					sourceFile = *m_sourceLocation.file;
+				std::string_view sourceFile = m_sourceLocation.GetFilePath();
 
 				if (m_sourceLocation.startLine != m_sourceLocation.endLine)
 					m_fullErrorMessage = fmt::format("{}({} -> {},{} -> {}): {} error: {}", sourceFile, m_sourceLocation.startLine, m_sourceLocation.endLine, m_sourceLocation.startColumn, m_sourceLocation.endColumn, m_errorType, GetErrorMessage());
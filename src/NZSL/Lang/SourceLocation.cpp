@@ -0,0 +1,73 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Lang/SourceLocation.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace nzsl
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		// Kept apart from the symbol table, files are registered once per lexed source and looked up when reporting errors
+		struct SourceFileRegistry
+		{
+			std::deque<std::string> filePaths; //< indexed by file id - 1, deque so that views on paths stay valid when inserting
+			std::shared_mutex mutex;
+			std::unordered_map<std::string_view, SourceFileId> fileIds;
+		};
+
+		SourceFileRegistry& GetSourceFileRegistry()
+		{
+			static SourceFileRegistry registry;
+			return registry;
+		}
+	}
+
+	SourceFileId RegisterSourceFile(std::string_view filePath)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		SourceFileRegistry& registry = GetSourceFileRegistry();
+		{
+			std::shared_lock lock(registry.mutex);
+			if (auto it = registry.fileIds.find(filePath); it != registry.fileIds.end())
+				return it->second;
+		}
+
+		std::unique_lock lock(registry.mutex);
+
+		// another thread may have registered it in the meantime
+		if (auto it = registry.fileIds.find(filePath); it != registry.fileIds.end())
+			return it->second;
+
+		const std::string& storedPath = registry.filePaths.emplace_back(filePath);
+
+		// zero is InvalidSourceFileId
+		SourceFileId fileId = Nz::SafeCast<SourceFileId>(registry.filePaths.size());
+		registry.fileIds.emplace(storedPath, fileId);
+
+		return fileId;
+	}
+
+	std::string_view GetSourceFilePath(SourceFileId fileId)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		if (fileId == InvalidSourceFileId)
+			return {};
+
+		SourceFileRegistry& registry = GetSourceFileRegistry();
+
+		std::shared_lock lock(registry.mutex);
+		assert(fileId <= registry.filePaths.size());
+
+		return registry.filePaths[fileId - 1];
+	}
+}
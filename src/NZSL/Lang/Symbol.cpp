@@ -0,0 +1,142 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/Lang/Symbol.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nzsl
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		struct SymbolTable
+		{
+			std::deque<std::string> names; //< deque so that views on names stay valid when inserting
+			std::shared_mutex mutex;
+			std::unordered_map<std::string_view, std::uint32_t> symbols;
+		};
+
+		// Symbols already seen by a thread, so that looking them up again doesn't have to go through the shared table lock
+		struct ThreadSymbolCache
+		{
+			std::unordered_map<std::string_view, std::uint32_t> symbols;
+			std::vector<const std::string*> names; //< indexed by id, may lag behind the symbol table
+		};
+
+		SymbolTable& GetSymbolTable()
+		{
+			static SymbolTable symbolTable;
+			return symbolTable;
+		}
+
+		ThreadSymbolCache& GetThreadSymbolCache()
+		{
+			thread_local ThreadSymbolCache symbolCache;
+			return symbolCache;
+		}
+	}
+
+	Symbol::Symbol(std::string_view name)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		ThreadSymbolCache& symbolCache = GetThreadSymbolCache();
+		if (auto it = symbolCache.symbols.find(name); it != symbolCache.symbols.end())
+		{
+			m_id = it->second;
+			m_name = it->first;
+			return;
+		}
+
+		SymbolTable& symbolTable = GetSymbolTable();
+
+		// Most names are already known, only take the exclusive lock when we need to insert
+		bool found = false;
+		{
+			std::shared_lock lock(symbolTable.mutex);
+			if (auto it = symbolTable.symbols.find(name); it != symbolTable.symbols.end())
+			{
+				m_id = it->second;
+				m_name = it->first;
+				found = true;
+			}
+		}
+
+		if (!found)
+		{
+			std::unique_lock lock(symbolTable.mutex);
+
+			// another thread may have inserted it in the meantime
+			if (auto it = symbolTable.symbols.find(name); it != symbolTable.symbols.end())
+			{
+				m_id = it->second;
+				m_name = it->first;
+			}
+			else
+			{
+				const std::string& storedName = symbolTable.names.emplace_back(name);
+
+				m_id = Nz::SafeCast<std::uint32_t>(symbolTable.names.size() - 1);
+				m_name = storedName;
+
+				symbolTable.symbols.emplace(m_name, m_id);
+			}
+		}
+
+		symbolCache.symbols.emplace(m_name, m_id);
+	}
+
+	Symbol Symbol::Find(std::string_view name)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		ThreadSymbolCache& symbolCache = GetThreadSymbolCache();
+		if (auto it = symbolCache.symbols.find(name); it != symbolCache.symbols.end())
+			return Symbol(it->second, it->first);
+
+		SymbolTable& symbolTable = GetSymbolTable();
+
+		Symbol symbol;
+		{
+			std::shared_lock lock(symbolTable.mutex);
+			auto it = symbolTable.symbols.find(name);
+			if (it == symbolTable.symbols.end())
+				return symbol; //< not cached as it may be interned later by another thread
+
+			symbol = Symbol(it->second, it->first);
+		}
+
+		symbolCache.symbols.emplace(symbol.m_name, symbol.m_id);
+
+		return symbol;
+	}
+
+	Symbol Symbol::FromId(std::uint32_t id)
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		ThreadSymbolCache& symbolCache = GetThreadSymbolCache();
+		if (id >= symbolCache.names.size())
+		{
+			// Catch up with the symbol table at once, ids are never reused
+			SymbolTable& symbolTable = GetSymbolTable();
+
+			std::shared_lock lock(symbolTable.mutex);
+			if (id >= symbolTable.names.size())
+				return Symbol{}; //< unknown id (this includes InvalidId)
+
+			std::size_t firstId = symbolCache.names.size();
+			symbolCache.names.resize(symbolTable.names.size());
+			for (std::size_t i = firstId; i < symbolTable.names.size(); ++i)
+				symbolCache.names[i] = &symbolTable.names[i];
+		}
+
+		return Symbol(id, *symbolCache.names[id]);
+	}
+}
@@ -9,14 +9,22 @@
 #include <fmt/format.h>
 #include <frozen/string.h>
 #include <frozen/unordered_map.h>
-#include <cctype>
+#include <array>
 #include <charconv>
-#include <locale>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NZSL_LEXER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 namespace nzsl
 {
 	namespace
@@ -48,6 +56,184 @@ namespace nzsl
 			{ "true",         TokenType::BoolTrue },
 			{ "while",        TokenType::While }
 		});
+
+		template<typename F>
+		constexpr std::array<bool, 256> BuildCharacterTable(F&& predicate)
+		{
+			std::array<bool, 256> table{};
+			for (std::size_t i = 0; i < table.size(); ++i)
+				table[i] = predicate(static_cast<unsigned char>(i));
+
+			return table;
+		}
+
+		// Locale-independent replacements for std::isalnum/std::isdigit (which are also undefined for negative chars)
+		constexpr auto s_blankCharacters = BuildCharacterTable([](unsigned char c) { return c == ' ' || c == '\t' || c == '\r'; });
+		constexpr auto s_digitCharacters = BuildCharacterTable([](unsigned char c) { return c >= '0' && c <= '9'; });
+		constexpr auto s_identifierCharacters = BuildCharacterTable([](unsigned char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; });
+
+		constexpr bool IsIdentifierChar(char c)
+		{
+			return s_identifierCharacters[static_cast<unsigned char>(c)];
+		}
+
+#ifdef NZSL_LEXER_SSE2
+		unsigned int FindFirstSetBit(unsigned int mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return index;
+#else
+			return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+		}
+
+		__m128i InRange(__m128i chars, char first, char last)
+		{
+			// characters above 0x7F are negative as signed bytes and never belong to the ranges we test
+			return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(static_cast<char>(first - 1))), _mm_cmplt_epi8(chars, _mm_set1_epi8(static_cast<char>(last + 1))));
+		}
+
+		__m128i Equal(__m128i chars, char c)
+		{
+			return _mm_cmpeq_epi8(chars, _mm_set1_epi8(c));
+		}
+#endif
+
+		// Returns the position of the first character from pos which doesn't match, checks 16 characters at once when SSE2 is available
+		template<typename ScalarPredicate, typename VectorPredicate>
+		std::size_t ScanWhile(std::string_view str, std::size_t pos, ScalarPredicate&& scalarPredicate, [[maybe_unused]] VectorPredicate&& vectorPredicate)
+		{
+#ifdef NZSL_LEXER_SSE2
+			while (pos + 16 <= str.size())
+			{
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+				unsigned int mismatchMask = ~static_cast<unsigned int>(_mm_movemask_epi8(vectorPredicate(chars))) & 0xFFFF;
+				if (mismatchMask != 0)
+					return pos + FindFirstSetBit(mismatchMask);
+
+				pos += 16;
+			}
+#endif
+
+			while (pos < str.size() && scalarPredicate(str[pos]))
+				pos++;
+
+			return pos;
+		}
+
+#ifdef NZSL_LEXER_SSE2
+#define NZSL_LEXER_VECTOR_PREDICATE(expr) [](__m128i chars) { return expr; }
+#else
+#define NZSL_LEXER_VECTOR_PREDICATE(expr) nullptr
+#endif
+
+		std::size_t ScanBlanks(std::string_view str, std::size_t pos)
+		{
+			return ScanWhile(str, pos, [](char c) { return s_blankCharacters[static_cast<unsigned char>(c)]; },
+				NZSL_LEXER_VECTOR_PREDICATE(_mm_or_si128(_mm_or_si128(Equal(chars, ' '), Equal(chars, '\t')), Equal(chars, '\r'))));
+		}
+
+		std::size_t ScanDigits(std::string_view str, std::size_t pos)
+		{
+			return ScanWhile(str, pos, [](char c) { return s_digitCharacters[static_cast<unsigned char>(c)]; },
+				NZSL_LEXER_VECTOR_PREDICATE(InRange(chars, '0', '9')));
+		}
+
+		std::size_t ScanIdentifier(std::string_view str, std::size_t pos)
+		{
+			return ScanWhile(str, pos, IsIdentifierChar,
+				NZSL_LEXER_VECTOR_PREDICATE(_mm_or_si128(_mm_or_si128(InRange(chars, 'a', 'z'), InRange(chars, 'A', 'Z')), _mm_or_si128(InRange(chars, '0', '9'), Equal(chars, '_')))));
+		}
+
+		// Stops on the line feed ending the comment (or on the end of the source)
+		std::size_t ScanLineComment(std::string_view str, std::size_t pos)
+		{
+			return ScanWhile(str, pos, [](char c) { return c != '\n' && c != '\0'; },
+				NZSL_LEXER_VECTOR_PREDICATE(_mm_andnot_si128(_mm_or_si128(Equal(chars, '\n'), Equal(chars, '\0')), _mm_set1_epi8(-1))));
+		}
+
+		// Stops on characters the block comment loop has to look at: a star (possible end of comment), a line feed or the end of the source
+		std::size_t ScanBlockComment(std::string_view str, std::size_t pos)
+		{
+			return ScanWhile(str, pos, [](char c) { return c != '*' && c != '\n' && c != '\0'; },
+				NZSL_LEXER_VECTOR_PREDICATE(_mm_andnot_si128(_mm_or_si128(_mm_or_si128(Equal(chars, '*'), Equal(chars, '\n')), Equal(chars, '\0')), _mm_set1_epi8(-1))));
+		}
+
+#undef NZSL_LEXER_VECTOR_PREDICATE
+
+		std::string_view GetStringData(const Token& token)
+		{
+			return std::get<std::string_view>(token.data);
+		}
+
+		std::string_view GetStringData(const OwningToken& token)
+		{
+			return std::get<std::string>(token.data);
+		}
+
+		// Both token representations print string literals unescaped, so a token stringifies the same way however it is held
+		std::string GetStringLiteral(const Token& token)
+		{
+			return UnescapeString(std::get<std::string_view>(token.data));
+		}
+
+		std::string_view GetStringLiteral(const OwningToken& token)
+		{
+			return std::get<std::string>(token.data);
+		}
+
+		template<typename T>
+		std::string TokensToString(const std::vector<T>& tokens, bool pretty)
+		{
+			if (tokens.empty())
+				return {};
+
+			unsigned int lastLineNumber = tokens.front().location.startLine;
+
+			std::stringstream ss;
+			bool empty = true;
+
+			for (const T& token : tokens)
+			{
+				if (token.location.startLine != lastLineNumber && pretty)
+				{
+					lastLineNumber = token.location.startLine;
+					if (!empty)
+						ss << '\n';
+				}
+				else if (!empty)
+					ss << ' ';
+
+				ss << ToString(token.type);
+				switch (token.type)
+				{
+					case TokenType::FloatingPointValue:
+						ss << "(" << std::get<double>(token.data) << ")";
+						break;
+
+					case TokenType::Identifier:
+						ss << "(" << GetStringData(token) << ")";
+						break;
+
+					case TokenType::IntegerValue:
+						ss << "(" << std::get<long long>(token.data) << ")";
+						break;
+
+					case TokenType::StringValue:
+						ss << "(\"" << GetStringLiteral(token) << "\")";
+						break;
+
+					default:
+						break;
+				}
+
+				empty = false;
+			}
+
+			return std::move(ss).str();
+		}
 	}
 
 	std::string EscapeString(std::string_view str, bool quote)
@@ -83,9 +269,46 @@ namespace nzsl
 		return result;
 	}
 
-	std::vector<Token> Tokenize(std::string_view str, const std::string& filePath)
+	std::string UnescapeString(std::string_view str)
+	{
+		std::string result;
+		result.reserve(str.size());
+
+		for (std::size_t i = 0; i < str.size(); ++i)
+		{
+			char c = str[i];
+			if (c == '\\' && i + 1 < str.size())
+			{
+				switch (str[++i])
+				{
+					case 'n': c = '\n'; break;
+					case 'r': c = '\r'; break;
+					case 't': c = '\t'; break;
+					default:  c = str[i]; break; //< quote and backslash
+				}
+			}
+
+			result.push_back(c);
+		}
+
+		return result;
+	}
+
+	Lexer::Lexer(std::string_view str, const std::string& filePath) :
+	m_currentPos(0),
+	m_lineStartPos(0),
+	m_source(str),
+	m_currentLine(1),
+	m_currentFile(InvalidSourceFileId)
 	{
-		std::size_t currentPos = 0;
+		if (!filePath.empty())
+			m_currentFile = RegisterSourceFile(filePath);
+	}
+
+	Token Lexer::Next()
+	{
+		std::string_view str = m_source;
+		std::size_t& currentPos = m_currentPos;
 
 		auto Peek = [&](std::size_t advance = 1) -> char
 		{
@@ -95,15 +318,9 @@ namespace nzsl
 				return '\0';
 		};
 
-		auto IsAlphaNum = [&](const char c)
-		{
-			return std::isalnum(c) || c == '_';
-		};
-
-		std::uint32_t currentLine = 1;
-		std::size_t lineStartPos = 0;
-		std::string literalTemp;
-		std::vector<Token> tokens;
+		std::uint32_t& currentLine = m_currentLine;
+		std::size_t& lineStartPos = m_lineStartPos;
+		std::string& literalTemp = m_literalTemp;
 
 		auto HandleNewLine = [&]
 		{
@@ -111,16 +328,23 @@ namespace nzsl
 			lineStartPos = currentPos + 1;
 		};
 
-		std::shared_ptr<const std::string> currentFile;
-		if (!filePath.empty())
-			currentFile = std::make_shared<std::string>(filePath);
-
 		for (;;)
 		{
+			// Skip blank characters and line feeds before building a token
+			for (;;)
+			{
+				currentPos = ScanBlanks(str, currentPos);
+				if (Peek(0) != '\n')
+					break;
+
+				HandleNewLine();
+				currentPos++;
+			}
+
 			char c = Peek(0);
 
 			Token token;
-			token.location.file = currentFile;
+			token.location.fileId = m_currentFile;
 
 			if (c == '\0')
 			{
@@ -130,8 +354,7 @@ namespace nzsl
 				token.location.endColumn = token.location.startColumn;
 				token.location.endLine = token.location.startLine;
 
-				tokens.push_back(std::move(token));
-				break;
+				return token;
 			}
 
 			token.location.startColumn = Nz::SafeCast<std::uint32_t>(currentPos - lineStartPos) + 1;
@@ -140,15 +363,6 @@ namespace nzsl
 			std::optional<TokenType> tokenType;
 			switch (c)
 			{
-				case ' ':
-				case '\t':
-				case '\r':
-					break; //< Ignore blank spaces
-
-				case '\n':
-					HandleNewLine();
-					break;
-
 				case '-':
 				{
 					char next = Peek();
@@ -173,20 +387,17 @@ namespace nzsl
 					char next = Peek();
 					if (next == '/')
 					{
-						// Line comment
-						do
-						{
-							currentPos++;
-							next = Peek();
-						}
-						while (next != '\0' && next != '\n');
+						// Line comment, stop right before the line feed
+						currentPos = ScanLineComment(str, currentPos + 2) - 1;
 					}
 					else if (next == '*')
 					{
 						// Block comment
+						std::size_t commentPos = currentPos + 2;
 						for (;;)
 						{
-							currentPos++;
+							commentPos = ScanBlockComment(str, commentPos);
+							currentPos = commentPos - 1;
 							next = Peek();
 
 							if (next == '*')
@@ -206,6 +417,8 @@ namespace nzsl
 
 								throw LexerUnfinishedCommentError{ token.location };
 							}
+
+							commentPos++;
 						}
 					}
 					else if (next == '=')
@@ -252,6 +465,11 @@ namespace nzsl
 					bool floatingPoint = false;
 					for (;;)
 					{
+						// Digit runs are valid in every base, copy them at once
+						std::size_t digitEnd = ScanDigits(str, currentPos + 1);
+						literalTemp.append(str.data() + currentPos + 1, digitEnd - currentPos - 1);
+						currentPos = digitEnd - 1;
+
 						auto IsDigitOrSep = [=](char c)
 						{
 							if (c == '_')
@@ -512,15 +730,14 @@ namespace nzsl
 
 				case '"':
 				{
-					// string literal
+					// string literal, escape sequences are validated here but only resolved when needed (see UnescapeString)
 					currentPos++;
 
-					std::string literal;
+					std::size_t start = currentPos;
 
 					char current;
 					while ((current = Peek(0)) != '"')
 					{
-						char character;
 						switch (current)
 						{
 							case '\0':
@@ -536,11 +753,13 @@ namespace nzsl
 								char next = Peek(0);
 								switch (next)
 								{
-									case 'n': character = '\n'; break;
-									case 'r': character = '\r'; break;
-									case 't': character = '\t'; break;
-									case '"': character = '"'; break;
-									case '\\': character = '\\'; break;
+									case 'n':
+									case 'r':
+									case 't':
+									case '"':
+									case '\\':
+										break;
+
 									default:
 										token.location.endColumn = Nz::SafeCast<std::uint32_t>(currentPos - lineStartPos) + 1;
 										token.location.endLine = currentLine;
@@ -550,33 +769,29 @@ namespace nzsl
 							}
 
 							default:
-								character = current;
 								break;
 						}
 
-						literal.push_back(character);
 						currentPos++;
 					}
 
 					tokenType = TokenType::StringValue;
-					token.data = std::move(literal);
+					token.data = str.substr(start, currentPos - start);
 					break;
 				}
 
 				default:
 				{
-					if (IsAlphaNum(c))
+					if (IsIdentifierChar(c))
 					{
 						std::size_t start = currentPos;
-
-						while (IsAlphaNum(Peek()))
-							currentPos++;
+						currentPos = ScanIdentifier(str, currentPos + 1) - 1;
 
 						std::string_view identifier = str.substr(start, currentPos - start + 1);
 						if (auto it = s_reservedKeywords.find(identifier); it == s_reservedKeywords.end())
 						{
 							tokenType = TokenType::Identifier;
-							token.data = std::string(identifier);
+							token.data = identifier;
 						}
 						else
 							tokenType = it->second;
@@ -598,74 +813,102 @@ namespace nzsl
 				token.location.endLine = currentLine;
 				token.type = *tokenType;
 
-				tokens.push_back(std::move(token));
+				currentPos++;
+				return token;
 			}
 
 			currentPos++;
 		}
-
-		return tokens;
 	}
 
-	const char* ToString(TokenType tokenType)
+	std::vector<Token> Tokenize(std::string_view str, const std::string& filePath)
 	{
-		switch (tokenType)
-		{
-#define NZSL_SHADERLANG_TOKEN(X) case TokenType:: X: return #X;
+		Lexer lexer(str, filePath);
 
-#include <NZSL/Lang/TokenList.hpp>
+		std::vector<Token> tokens;
+		do
+		{
+			tokens.push_back(lexer.Next());
 		}
+		while (tokens.back().type != TokenType::EndOfStream);
 
-		return "<Error>";
+		return tokens;
 	}
 
-	std::string ToString(const std::vector<Token>& tokens, bool pretty)
+	OwningToken ToOwningToken(const Token& token)
 	{
-		if (tokens.empty())
-			return {};
+		OwningToken owningToken;
+		owningToken.location = token.location;
+		owningToken.type = token.type;
+		std::visit([&](auto&& arg)
+		{
+			using T = std::decay_t<decltype(arg)>;
 
-		unsigned int lastLineNumber = tokens.front().location.startLine;
+			if constexpr (std::is_same_v<T, std::string_view>)
+			{
+				if (token.type == TokenType::StringValue)
+					owningToken.data = UnescapeString(arg);
+				else
+					owningToken.data = std::string(arg);
+			}
+			else
+				owningToken.data = arg;
+		}, token.data);
 
-		std::stringstream ss;
-		bool empty = true;
+		return owningToken;
+	}
 
-		for (const Token& token : tokens)
+	Token ToToken(const OwningToken& token)
+	{
+		Token viewToken;
+		viewToken.location = token.location;
+		viewToken.type = token.type;
+		std::visit([&](auto&& arg)
 		{
-			if (token.location.startLine != lastLineNumber && pretty)
-			{
-				lastLineNumber = token.location.startLine;
-				if (!empty)
-					ss << '\n';
-			}
-			else if (!empty)
-				ss << ' ';
+			using T = std::decay_t<decltype(arg)>;
 
-			ss << ToString(token.type);
-			switch (token.type)
-			{
-				case TokenType::FloatingPointValue:
-					ss << "(" << std::get<double>(token.data) << ")";
-					break;
+			if constexpr (std::is_same_v<T, std::string>)
+				viewToken.data = std::string_view(arg);
+			else
+				viewToken.data = arg;
+		}, token.data);
 
-				case TokenType::Identifier:
-					ss << "(" << std::get<std::string>(token.data) << ")";
-					break;
+		return viewToken;
+	}
 
-				case TokenType::IntegerValue:
-					ss << "(" << std::get<long long>(token.data) << ")";
-					break;
+	std::vector<OwningToken> TokenizeOwning(std::string_view str, const std::string& filePath)
+	{
+		Lexer lexer(str, filePath);
 
-				case TokenType::StringValue:
-					ss << "(\"" << std::get<std::string>(token.data) << "\")";
-					break;
+		std::vector<OwningToken> tokens;
+		do
+		{
+			tokens.push_back(ToOwningToken(lexer.Next()));
+		}
+		while (tokens.back().type != TokenType::EndOfStream);
 
-				default:
-					break;
-			}
+		return tokens;
+	}
+
+	const char* ToString(TokenType tokenType)
+	{
+		switch (tokenType)
+		{
+#define NZSL_SHADERLANG_TOKEN(X) case TokenType:: X: return #X;
 
-			empty = false;
+#include <NZSL/Lang/TokenList.hpp>
 		}
 
-		return std::move(ss).str();
+		return "<Error>";
+	}
+
+	std::string ToString(const std::vector<Token>& tokens, bool pretty)
+	{
+		return TokensToString(tokens, pretty);
+	}
+
+	std::string ToString(const std::vector<OwningToken>& tokens, bool pretty)
+	{
+		return TokensToString(tokens, pretty);
 	}
 }
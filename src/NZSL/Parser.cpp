@@ -10,6 +10,7 @@
 #include <NZSL/Lang/LangData.hpp>
 #include <frozen/string.h>
 #include <frozen/unordered_map.h>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <fstream>
@@ -84,41 +85,47 @@ namespace nzsl
 		constexpr auto s_unrollModeMapping    = BuildIdentifierMapping(LangData::s_unrollModes);
 	}
 
-	Ast::ModulePtr Parser::Parse(const std::vector<Token>& tokens)
+	Ast::ModulePtr Parser::Parse(const std::vector<Token>& tokens, std::vector<std::size_t>* rootStatementEnds)
 	{
 		Context context;
 		context.tokenCount = tokens.size();
 		context.tokens = tokens.data();
+		context.rootStatementEnds = rootStatementEnds;
 
 		m_context = &context;
 
-		std::vector<Attribute> attributes;
+		return ParseModule();
+	}
 
-		for (;;)
-		{
-			Ast::StatementPtr statement = ParseRootStatement();
-			if (!m_context->module)
-			{
-				const Token& nextToken = Peek();
-				throw ParserUnexpectedTokenError{ nextToken.location, nextToken.type };
-			}
+	Ast::ModulePtr Parser::Parse(Lexer& lexer)
+	{
+		Context context;
+		context.lexer = &lexer;
 
-			if (!statement)
-				break;
+		m_context = &context;
 
-			m_context->module->rootNode->statements.push_back(std::move(statement));
-		}
+		return ParseModule();
+	}
 
-		// Handle source location for the root node of the module
-		Ast::MultiStatementPtr& moduleStatements = m_context->module->rootNode;
-		if (!moduleStatements->statements.empty())
+	Ast::ModulePtr Parser::Parse(const std::vector<OwningToken>& tokens)
+	{
+		// parse through tokens referencing the owned strings, which outlive the parsing
+		// string literals are the exception as the parser expects them escaped like in the source
+		std::size_t stringCount = std::count_if(tokens.begin(), tokens.end(), [](const OwningToken& token) { return token.type == TokenType::StringValue; });
+
+		std::vector<std::string> escapedStrings;
+		escapedStrings.reserve(stringCount);
+
+		std::vector<Token> viewTokens;
+		viewTokens.reserve(tokens.size());
+		for (const OwningToken& token : tokens)
 		{
-			moduleStatements->sourceLocation = moduleStatements->statements.front()->sourceLocation;
-			if (moduleStatements->statements.back()->sourceLocation.IsValid())
-				moduleStatements->sourceLocation.ExtendToRight(moduleStatements->statements.back()->sourceLocation);
+			Token& viewToken = viewTokens.emplace_back(ToToken(token));
+			if (token.type == TokenType::StringValue)
+				viewToken.data = std::string_view(escapedStrings.emplace_back(EscapeString(std::get<std::string>(token.data), false)));
 		}
 
-		return std::move(context.module);
+		return Parse(viewTokens);
 	}
 
 	std::string_view Parser::ToString(Ast::AttributeType attributeType)
@@ -195,7 +202,7 @@ namespace nzsl
 
 	void Parser::Consume(std::size_t count)
 	{
-		assert(m_context->tokenIndex + count < m_context->tokenCount);
+		assert(m_context->lexer || m_context->tokenIndex + count < m_context->tokenCount);
 		m_context->tokenIndex += count;
 	}
 
@@ -225,10 +232,63 @@ namespace nzsl
 
 	const Token& Parser::Peek(std::size_t advance)
 	{
+		if (m_context->lexer)
+		{
+			while (m_context->tokenIndex + advance >= m_context->tokenBuffer.size())
+				m_context->tokenBuffer.push_back(m_context->lexer->Next());
+
+			return m_context->tokenBuffer[m_context->tokenIndex + advance];
+		}
+
 		assert(m_context->tokenIndex + advance < m_context->tokenCount);
 		return m_context->tokens[m_context->tokenIndex + advance];
 	}
 
+	void Parser::ReleaseConsumedTokens()
+	{
+		// Statement parsing keeps references on already consumed tokens, so they can only be released between root statements
+		if (!m_context->lexer)
+			return;
+
+		m_context->tokenBuffer.erase(m_context->tokenBuffer.begin(), m_context->tokenBuffer.begin() + Nz::SafeCast<std::ptrdiff_t>(m_context->tokenIndex));
+		m_context->tokenIndex = 0;
+	}
+
+	Ast::ModulePtr Parser::ParseModule()
+	{
+		std::vector<Attribute> attributes;
+
+		for (;;)
+		{
+			Ast::StatementPtr statement = ParseRootStatement();
+			if (!m_context->module)
+			{
+				const Token& nextToken = Peek();
+				throw ParserUnexpectedTokenError{ nextToken.location, nextToken.type };
+			}
+
+			if (!statement)
+				break;
+
+			m_context->module->rootNode->statements.push_back(std::move(statement));
+			if (m_context->rootStatementEnds)
+				m_context->rootStatementEnds->push_back(m_context->tokenIndex);
+
+			ReleaseConsumedTokens();
+		}
+
+		// Handle source location for the root node of the module
+		Ast::MultiStatementPtr& moduleStatements = m_context->module->rootNode;
+		if (!moduleStatements->statements.empty())
+		{
+			moduleStatements->sourceLocation = moduleStatements->statements.front()->sourceLocation;
+			if (moduleStatements->statements.back()->sourceLocation.IsValid())
+				moduleStatements->sourceLocation.ExtendToRight(moduleStatements->statements.back()->sourceLocation);
+		}
+
+		return std::move(m_context->module);
+	}
+
 	std::vector<Parser::Attribute> Parser::ParseAttributes()
 	{
 		NAZARA_USE_ANONYMOUS_NAMESPACE
@@ -260,7 +320,7 @@ namespace nzsl
 				Expect(Advance(), TokenType::Comma);
 
 			const Token& identifierToken = Expect(Advance(), TokenType::Identifier);
-			std::string_view identifier = std::get<std::string>(identifierToken.data);
+			std::string_view identifier = std::get<std::string_view>(identifierToken.data);
 
 			SourceLocation attributeLocation = identifierToken.location;
 
@@ -1734,9 +1794,9 @@ namespace nzsl
 	Ast::ExpressionPtr Parser::ParseIdentifier()
 	{
 		const Token& identifierToken = Expect(Advance(), TokenType::Identifier);
-		const std::string& identifier = std::get<std::string>(identifierToken.data);
+		std::string_view identifier = std::get<std::string_view>(identifierToken.data);
 
-		auto identifierExpr = ShaderBuilder::Identifier(identifier);
+		auto identifierExpr = ShaderBuilder::Identifier(std::string(identifier));
 		identifierExpr->sourceLocation = identifierToken.location;
 
 		return identifierExpr;
@@ -1842,19 +1902,19 @@ namespace nzsl
 	Ast::ExpressionPtr Parser::ParseStringExpression()
 	{
 		const Token& litteralToken = Expect(Advance(), TokenType::StringValue);
-		auto constantExpr = ShaderBuilder::ConstantValue(std::get<std::string>(litteralToken.data));
+		auto constantExpr = ShaderBuilder::ConstantValue(UnescapeString(std::get<std::string_view>(litteralToken.data)));
 		constantExpr->sourceLocation = litteralToken.location;
 
 		return constantExpr;
 	}
 
-	const std::string& Parser::ParseIdentifierAsName(SourceLocation* sourceLocation)
+	std::string Parser::ParseIdentifierAsName(SourceLocation* sourceLocation)
 	{
 		const Token& identifierToken = Expect(Advance(), TokenType::Identifier);
 		if (sourceLocation)
 			*sourceLocation = identifierToken.location;
 
-		return std::get<std::string>(identifierToken.data);
+		return std::string(std::get<std::string_view>(identifierToken.data));
 	}
 
 	std::string Parser::ParseModuleName(SourceLocation* sourceLocation)
@@ -0,0 +1,488 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/PermutationCompiler.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+#include <NZSL/Ast/OptionRelevanceVisitor.hpp>
+#include <NZSL/Ast/ReflectVisitor.hpp>
+#include <NZSL/Ast/SanitizedModuleCache.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace nzsl
+{
+	namespace NAZARA_ANONYMOUS_NAMESPACE
+	{
+		constexpr std::uint64_t PushConstantBinding = std::numeric_limits<std::uint64_t>::max();
+
+		// Bindings (set << 32 | binding) of the external variables of a sanitized module in declaration order, push constants being reported as PushConstantBinding
+		std::vector<std::uint64_t> CollectExternalBindings(const Ast::Module& module)
+		{
+			std::vector<std::uint64_t> bindings;
+
+			Ast::ReflectVisitor::Callbacks callbacks;
+			callbacks.onExternalDeclaration = [&](const Ast::DeclareExternalStatement& extDecl)
+			{
+				for (const auto& extVar : extDecl.externalVars)
+				{
+					if (Ast::IsPushConstantType(extVar.type.GetResultingValue()))
+					{
+						bindings.push_back(PushConstantBinding);
+						continue;
+					}
+
+					if (!extVar.bindingIndex.HasValue())
+						continue;
+
+					std::uint64_t bindingSet = (extVar.bindingSet.HasValue()) ? extVar.bindingSet.GetResultingValue() : 0;
+					bindings.push_back(bindingSet << 32 | extVar.bindingIndex.GetResultingValue());
+				}
+			};
+
+			Ast::ReflectVisitor reflectVisitor;
+			reflectVisitor.Reflect(module, callbacks);
+
+			return bindings;
+		}
+
+		// Calls func for every combination on workerCount threads, only the first error (in combination order) is reported
+		template<typename F>
+		void ForEachCombination(std::size_t combinationCount, unsigned int workerCount, const F& func)
+		{
+			workerCount = static_cast<unsigned int>(std::min<std::size_t>(workerCount, combinationCount));
+			if (workerCount <= 1)
+			{
+				for (std::size_t i = 0; i < combinationCount; ++i)
+					func(i);
+
+				return;
+			}
+
+			std::vector<std::exception_ptr> compileErrors(combinationCount);
+			std::atomic<std::size_t> nextCombinationIndex = 0;
+			std::atomic<std::size_t> firstErrorIndex = combinationCount;
+
+			auto ProcessCombinations = [&]
+			{
+				for (;;)
+				{
+					std::size_t combinationIndex = nextCombinationIndex++;
+					if (combinationIndex >= firstErrorIndex)
+						break;
+
+					try
+					{
+						func(combinationIndex);
+					}
+					catch (...)
+					{
+						compileErrors[combinationIndex] = std::current_exception();
+
+						std::size_t errorIndex = firstErrorIndex;
+						while (combinationIndex < errorIndex && !firstErrorIndex.compare_exchange_weak(errorIndex, combinationIndex));
+					}
+				}
+			};
+
+			{
+				std::vector<std::thread> workers;
+				workers.reserve(workerCount - 1);
+
+				NAZARA_DEFER({
+					for (std::thread& worker : workers)
+						worker.join();
+				});
+
+				for (unsigned int i = 1; i < workerCount; ++i)
+					workers.emplace_back(ProcessCombinations);
+
+				ProcessCombinations();
+			}
+
+			if (std::size_t errorIndex = firstErrorIndex; errorIndex < combinationCount)
+				std::rethrow_exception(compileErrors[errorIndex]);
+		}
+
+		std::uint64_t HashBlob(const std::vector<std::uint8_t>& data)
+		{
+			// FNV-1a
+			std::uint64_t hash = 14695981039346656037ull;
+			for (std::uint8_t byte : data)
+			{
+				hash ^= byte;
+				hash *= 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		template<typename T>
+		std::vector<std::uint8_t> ToBlobData(const T* data, std::size_t count)
+		{
+			std::vector<std::uint8_t> blobData(count * sizeof(T));
+			if (count > 0)
+				std::memcpy(blobData.data(), data, blobData.size());
+
+			return blobData;
+		}
+	}
+
+	auto PermutationCompiler::Compile(const Ast::Module& module, const Parameters& parameters) -> Output
+	{
+		NAZARA_USE_ANONYMOUS_NAMESPACE
+
+		std::size_t combinationCount = GetCombinationCount(parameters.optionMatrix);
+
+		std::vector<Ast::OptionHash> optionHashes;
+		optionHashes.reserve(parameters.optionMatrix.size());
+		for (const OptionValues& optionValues : parameters.optionMatrix)
+			optionHashes.push_back(Ast::HashOption(std::string_view(optionValues.optionName)));
+
+		auto GetOptionValueIndices = [&](std::size_t combinationIndex)
+		{
+			std::vector<std::size_t> optionValueIndices(parameters.optionMatrix.size());
+			for (std::size_t i = parameters.optionMatrix.size(); i-- > 0;)
+			{
+				std::size_t valueCount = parameters.optionMatrix[i].values.size();
+				optionValueIndices[i] = combinationIndex % valueCount;
+				combinationIndex /= valueCount;
+			}
+
+			return optionValueIndices;
+		};
+
+		auto GetCombinationIndex = [&](const std::vector<std::size_t>& optionValueIndices)
+		{
+			std::size_t combinationIndex = 0;
+			for (std::size_t i = 0; i < parameters.optionMatrix.size(); ++i)
+				combinationIndex = combinationIndex * parameters.optionMatrix[i].values.size() + optionValueIndices[i];
+
+			return combinationIndex;
+		};
+
+		// Options relevance is computed on a partially sanitized module, where options are not resolved yet
+		std::optional<Ast::OptionRelevanceVisitor::Result> optionRelevance;
+		if (parameters.pruneIrrelevantOptions && !parameters.states.sanitized && !parameters.optionMatrix.empty())
+		{
+			Ast::SanitizeVisitor::Options sanitizeOptions;
+			sanitizeOptions.partialSanitization = true;
+			sanitizeOptions.moduleResolver = parameters.states.shaderModuleResolver;
+			sanitizeOptions.optionValues = parameters.states.optionValues;
+			for (Ast::OptionHash optionHash : optionHashes)
+				sanitizeOptions.optionValues.erase(optionHash);
+
+			Ast::ModulePtr partialModule;
+			try
+			{
+				partialModule = Ast::Sanitize(module, sanitizeOptions);
+			}
+			catch (const std::exception&)
+			{
+				// Every combination is compiled then, errors are reported by the compilation
+			}
+
+			if (partialModule)
+				optionRelevance = Ast::AnalyzeOptionRelevance(*partialModule);
+		}
+
+		auto GetRelevantMatrixOptions = [&](const Target& target)
+		{
+			std::vector<bool> relevantMatrixOptions(parameters.optionMatrix.size(), true);
+			if (!optionRelevance)
+				return relevantMatrixOptions;
+
+			Nz::Bitset<> relevantOptions;
+			if (!parameters.states.optimize)
+				relevantOptions = optionRelevance->referencedOptions; //< unused functions are still generated
+			else if (target.backend == Backend::GLSL && target.shaderStage)
+				relevantOptions = optionRelevance->GetRelevantOptions(*target.shaderStage);
+			else
+				relevantOptions = optionRelevance->GetRelevantOptions(ShaderStageType_All);
+
+			for (std::size_t i = 0; i < parameters.optionMatrix.size(); ++i)
+			{
+				bool isRelevant = false;
+				for (std::size_t optionIndex : relevantOptions.IterBits())
+				{
+					if (optionRelevance->options[optionIndex] == parameters.optionMatrix[i].optionName)
+					{
+						isRelevant = true;
+						break;
+					}
+				}
+
+				relevantMatrixOptions[i] = isRelevant;
+			}
+
+			return relevantMatrixOptions;
+		};
+
+		// A combination is only compiled for a target if it's the first one giving the same values to the options relevant to that target
+		std::vector<std::vector<std::size_t>> canonicalCombinations(parameters.targets.size());
+		for (std::size_t targetIndex = 0; targetIndex < parameters.targets.size(); ++targetIndex)
+		{
+			std::vector<bool> relevantMatrixOptions = GetRelevantMatrixOptions(parameters.targets[targetIndex]);
+
+			std::vector<std::size_t>& targetCanonicalCombinations = canonicalCombinations[targetIndex];
+			targetCanonicalCombinations.resize(combinationCount);
+			for (std::size_t combinationIndex = 0; combinationIndex < combinationCount; ++combinationIndex)
+			{
+				std::vector<std::size_t> optionValueIndices = GetOptionValueIndices(combinationIndex);
+				for (std::size_t i = 0; i < optionValueIndices.size(); ++i)
+				{
+					if (!relevantMatrixOptions[i])
+						optionValueIndices[i] = 0;
+				}
+
+				targetCanonicalCombinations[combinationIndex] = GetCombinationIndex(optionValueIndices);
+			}
+		}
+
+		// Imported modules which don't import other modules are sanitized once per set of values of the options they declare instead of once per combination
+		std::shared_ptr<Ast::SanitizedModuleCache> moduleCache = (parameters.states.shaderModuleResolver) ? std::make_shared<Ast::SanitizedModuleCache>(*parameters.states.shaderModuleResolver) : std::make_shared<Ast::SanitizedModuleCache>();
+
+		// SPIR-V types and constants are built once for all combinations, unless targets bring their own cache
+		std::shared_ptr<SpirvTypeCache> spirvTypeCache = std::make_shared<SpirvTypeCache>();
+
+		unsigned int workerCount = parameters.workerCount;
+		if (workerCount == 0)
+			workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		auto BuildStates = [&](std::size_t combinationIndex)
+		{
+			std::vector<std::size_t> optionValueIndices = GetOptionValueIndices(combinationIndex);
+
+			ShaderWriter::States states = parameters.states;
+			for (std::size_t i = 0; i < parameters.optionMatrix.size(); ++i)
+				states.optionValues.insert_or_assign(optionHashes[i], parameters.optionMatrix[i].values[optionValueIndices[i]]);
+
+			return states;
+		};
+
+		auto SanitizeFor = [&](const ShaderWriter::States& states, Ast::SanitizeVisitor::Options options)
+		{
+			options.optionValues = states.optionValues;
+			options.moduleResolver = states.shaderModuleResolver;
+			options.moduleCache = moduleCache;
+
+			return Ast::Sanitize(module, options);
+		};
+
+		auto IsCanonicalForBackend = [&](std::size_t combinationIndex, Backend backend)
+		{
+			for (std::size_t targetIndex = 0; targetIndex < parameters.targets.size(); ++targetIndex)
+			{
+				if (parameters.targets[targetIndex].backend == backend && canonicalCombinations[targetIndex][combinationIndex] == combinationIndex)
+					return true;
+			}
+
+			return false;
+		};
+
+		// Externals depend on option values, bindings are numbered in the order they first appear going through combinations in order
+		// so that every GLSL variant uses the same mapping, whatever the scheduling of workers
+		GlslWriter::Parameters sharedGlslParameters;
+		std::vector<Ast::ModulePtr> glslModules; //< sanitized modules of the combinations generated for GLSL targets, reused by their compilation
+		bool hasGlslTarget = std::any_of(parameters.targets.begin(), parameters.targets.end(), [](const Target& target) { return target.backend == Backend::GLSL; });
+		if (parameters.mapGlslBindings && hasGlslTarget)
+		{
+			// Only combinations generated for a GLSL target are visited, the others share their output
+			std::vector<std::vector<std::uint64_t>> combinationBindings;
+			if (parameters.states.sanitized)
+				combinationBindings.push_back(CollectExternalBindings(module));
+			else
+			{
+				combinationBindings.resize(combinationCount);
+				glslModules.resize(combinationCount);
+				ForEachCombination(combinationCount, workerCount, [&](std::size_t combinationIndex)
+				{
+					if (!IsCanonicalForBackend(combinationIndex, Backend::GLSL))
+						return;
+
+					glslModules[combinationIndex] = SanitizeFor(BuildStates(combinationIndex), GlslWriter::GetSanitizeOptions());
+					combinationBindings[combinationIndex] = CollectExternalBindings(*glslModules[combinationIndex]);
+				});
+			}
+
+			unsigned int glslBinding = 0;
+			for (const std::vector<std::uint64_t>& bindings : combinationBindings)
+			{
+				for (std::uint64_t binding : bindings)
+				{
+					if (binding == PushConstantBinding)
+					{
+						if (!sharedGlslParameters.pushConstantBinding)
+							sharedGlslParameters.pushConstantBinding = glslBinding++;
+					}
+					else if (sharedGlslParameters.bindingMapping.emplace(binding, glslBinding).second)
+						glslBinding++;
+				}
+			}
+		}
+
+		// Every backend sanitizes the module with its own options, which are shared by all its targets (GLSL stages, SPIR-V environments with the same specialization constants)
+		auto CompileCombination = [&](std::size_t combinationIndex, std::vector<std::vector<std::uint8_t>>& targetOutputs)
+		{
+			targetOutputs.resize(parameters.targets.size());
+
+			bool isCanonical = false;
+			for (std::size_t targetIndex = 0; targetIndex < parameters.targets.size(); ++targetIndex)
+			{
+				if (canonicalCombinations[targetIndex][combinationIndex] == combinationIndex)
+				{
+					isCanonical = true;
+					break;
+				}
+			}
+
+			if (!isCanonical)
+				return;
+
+			ShaderWriter::States states = BuildStates(combinationIndex);
+
+			// The module sanitized while mapping bindings is released once this combination is compiled
+			Ast::ModulePtr glslModule = (!glslModules.empty()) ? std::move(glslModules[combinationIndex]) : nullptr;
+			std::vector<std::pair<const std::unordered_set<Ast::OptionHash>*, Ast::ModulePtr>> spirvModules; //< options emitted as specialization constants are kept by the sanitization, one module per distinct set
+
+			ShaderWriter::States sanitizedStates = states;
+			sanitizedStates.sanitized = true;
+
+			for (std::size_t targetIndex = 0; targetIndex < parameters.targets.size(); ++targetIndex)
+			{
+				if (canonicalCombinations[targetIndex][combinationIndex] != combinationIndex)
+					continue;
+
+				const Target& target = parameters.targets[targetIndex];
+				switch (target.backend)
+				{
+					case Backend::GLSL:
+					{
+						if (!glslModule)
+							glslModule = (states.sanitized) ? nullptr : SanitizeFor(states, GlslWriter::GetSanitizeOptions());
+
+						GlslWriter writer;
+						writer.SetEnv(target.glslEnv);
+
+						const GlslWriter::Parameters& glslParameters = (parameters.mapGlslBindings) ? sharedGlslParameters : target.glslParameters;
+
+						GlslWriter::Output output = writer.Generate(target.shaderStage, (glslModule) ? *glslModule : module, glslParameters, sanitizedStates);
+						targetOutputs[targetIndex] = ToBlobData(output.code.data(), output.code.size());
+						break;
+					}
+
+					case Backend::SPIRV:
+					{
+						const Ast::Module* spirvModule = &module;
+						if (!states.sanitized)
+						{
+							const std::unordered_set<Ast::OptionHash>& specializationConstantOptions = target.spirvEnv.specializationConstantOptions;
+
+							auto it = std::find_if(spirvModules.begin(), spirvModules.end(), [&](const auto& spirvModuleEntry) { return *spirvModuleEntry.first == specializationConstantOptions; });
+							if (it == spirvModules.end())
+							{
+								Ast::SanitizeVisitor::Options sanitizeOptions = SpirvWriter::GetSanitizeOptions();
+								sanitizeOptions.specializationConstantOptions = specializationConstantOptions;
+
+								spirvModules.emplace_back(&specializationConstantOptions, SanitizeFor(states, std::move(sanitizeOptions)));
+								it = std::prev(spirvModules.end());
+							}
+
+							spirvModule = it->second.get();
+						}
+
+						SpirvWriter::Environment spirvEnv = target.spirvEnv;
+						if (!spirvEnv.typeCache)
+							spirvEnv.typeCache = spirvTypeCache;
+
+						SpirvWriter writer;
+						writer.SetEnv(std::move(spirvEnv));
+
+						std::vector<std::uint32_t> spirv = writer.Generate(*spirvModule, sanitizedStates);
+						targetOutputs[targetIndex] = ToBlobData(spirv.data(), spirv.size());
+						break;
+					}
+				}
+			}
+		};
+
+		std::vector<std::vector<std::vector<std::uint8_t>>> combinationOutputs(combinationCount);
+		ForEachCombination(combinationCount, workerCount, [&](std::size_t combinationIndex)
+		{
+			CompileCombination(combinationIndex, combinationOutputs[combinationIndex]);
+		});
+
+		// Deduplication happens on this thread in variant order so blob indices don't depend on scheduling
+		Output output;
+		output.generatedVariantCount = 0;
+		output.glslParameters = std::move(sharedGlslParameters);
+		output.variants.reserve(combinationCount * parameters.targets.size());
+
+		std::unordered_multimap<std::uint64_t, std::size_t> blobsByHash;
+		for (std::size_t combinationIndex = 0; combinationIndex < combinationCount; ++combinationIndex)
+		{
+			std::vector<std::size_t> optionValueIndices = GetOptionValueIndices(combinationIndex);
+
+			auto& targetOutputs = combinationOutputs[combinationIndex];
+			for (std::size_t targetIndex = 0; targetIndex < targetOutputs.size(); ++targetIndex)
+			{
+				std::optional<std::size_t> blobIndex;
+
+				std::size_t canonicalCombinationIndex = canonicalCombinations[targetIndex][combinationIndex];
+				if (canonicalCombinationIndex != combinationIndex)
+				{
+					// Canonical combinations always come first as they only differ by having their irrelevant options set to the first value
+					assert(canonicalCombinationIndex < combinationIndex);
+					blobIndex = output.variants[canonicalCombinationIndex * parameters.targets.size() + targetIndex].blobIndex;
+				}
+				else
+				{
+					output.generatedVariantCount++;
+
+					std::vector<std::uint8_t>& data = targetOutputs[targetIndex];
+					std::uint64_t hash = HashBlob(data);
+
+					auto range = blobsByHash.equal_range(hash);
+					for (auto it = range.first; it != range.second; ++it)
+					{
+						if (output.blobs[it->second].data == data)
+						{
+							blobIndex = it->second;
+							break;
+						}
+					}
+
+					if (!blobIndex)
+					{
+						blobIndex = output.blobs.size();
+						blobsByHash.emplace(hash, *blobIndex);
+
+						auto& blob = output.blobs.emplace_back();
+						blob.hash = hash;
+						blob.data = std::move(data);
+					}
+				}
+
+				auto& variant = output.variants.emplace_back();
+				variant.blobIndex = *blobIndex;
+				variant.targetIndex = targetIndex;
+				variant.optionValueIndices = optionValueIndices;
+			}
+
+			targetOutputs.clear();
+			targetOutputs.shrink_to_fit();
+		}
+
+		return output;
+	}
+}
@@ -1508,13 +1508,13 @@ namespace nzsl
 		if (!m_writer.HasDebugInfo(DebugLevel::Regular))
 			return;
 
-		if (!sourceLocation.IsValid() || !sourceLocation.file)
+		if (!sourceLocation.IsValid() || !sourceLocation.HasFile())
 			return;
 
-		if (m_lastLocation.file == sourceLocation.file && m_lastLocation.startLine == sourceLocation.startLine && m_lastLocation.startColumn == sourceLocation.startColumn)
+		if (m_lastLocation.fileId == sourceLocation.fileId && m_lastLocation.startLine == sourceLocation.startLine && m_lastLocation.startColumn == sourceLocation.startColumn)
 			return;
 
-		std::uint32_t fileId = m_writer.GetSourceFileId(sourceLocation.file);
+		std::uint32_t fileId = m_writer.GetSourceFileId(sourceLocation.fileId);
 
 		if (m_currentBlock)
 			m_currentBlock->Append(SpirvOp::OpLine, fileId, sourceLocation.startLine, sourceLocation.startColumn);
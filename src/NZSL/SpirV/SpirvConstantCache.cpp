@@ -4,10 +4,12 @@
 
 #include <NZSL/SpirV/SpirvConstantCache.hpp>
 #include <NazaraUtils/Assert.hpp>
+#include <NazaraUtils/Hash.hpp>
 #include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Ast/Nodes.hpp>
 #include <NZSL/Math/FieldOffsets.hpp>
 #include <NZSL/SpirV/SpirvSection.hpp>
+#include <NZSL/SpirV/SpirvTypeCache.hpp>
 #include <tsl/ordered_map.h>
 #include <cassert>
 #include <stdexcept>
@@ -191,11 +193,11 @@ namespace nzsl
 		template<typename T>
 		bool Compare(const std::shared_ptr<T>& lhs, const std::shared_ptr<T>& rhs) const
 		{
-			if (bool(lhs) != bool(rhs))
-				return false;
+			if (lhs == rhs)
+				return true; //< shared descriptions (from SpirvTypeCache)
 
-			if (!lhs)
-				return true;
+			if (!lhs || !rhs)
+				return false;
 
 			return Compare(*lhs, *rhs);
 		}
@@ -407,13 +409,149 @@ namespace nzsl
 		SpirvConstantCache& cache;
 	};
 
-	//< FIXME PLZ
-	struct AnyHasher
+	// Structural hash, must stay consistent with Eq
+	struct SpirvConstantCache::AnyHasher
 	{
-		template<typename U>
-		std::size_t operator()(const U&) const
+		std::size_t Hash(const ConstantBool& constant) const
+		{
+			return Nz::HashCombine(constant.value);
+		}
+
+		std::size_t Hash(const ConstantComposite& constant) const
+		{
+			return Nz::HashCombine(Hash(constant.type), Hash(constant.values));
+		}
+
+		std::size_t Hash(const ConstantScalar& constant) const
+		{
+			return Nz::HashCombine(constant.value);
+		}
+
+		std::size_t Hash(const Array& array) const
+		{
+			return Nz::HashCombine(Hash(array.length), Hash(array.elementType), array.stride);
+		}
+
+		std::size_t Hash(const Bool& /*boolType*/) const
+		{
+			return 0;
+		}
+
+		std::size_t Hash(const Float& floatType) const
+		{
+			return Nz::HashCombine(floatType.width);
+		}
+
+		std::size_t Hash(const Function& function) const
+		{
+			return Nz::HashCombine(Hash(function.parameters), Hash(function.returnType));
+		}
+
+		std::size_t Hash(const Image& image) const
+		{
+			return Nz::HashCombine(image.arrayed, image.dim, image.format, image.multisampled, image.qualifier, Hash(image.sampledType), image.depth, image.sampled);
+		}
+
+		std::size_t Hash(const Integer& integer) const
+		{
+			return Nz::HashCombine(integer.width, integer.signedness);
+		}
+
+		std::size_t Hash(const Matrix& matrix) const
+		{
+			return Nz::HashCombine(matrix.columnCount, Hash(matrix.columnType));
+		}
+
+		std::size_t Hash(const Pointer& pointer) const
+		{
+			return Nz::HashCombine(pointer.storageClass, Hash(pointer.type));
+		}
+
+		std::size_t Hash(const SampledImage& sampledImage) const
+		{
+			return Hash(sampledImage.image);
+		}
+
+		std::size_t Hash(const Structure& structure) const
+		{
+			std::size_t h = Nz::HashCombine(structure.name, structure.layout, structure.decorations.size());
+			for (SpirvDecoration decoration : structure.decorations)
+				Nz::HashCombine(h, decoration);
+
+			Nz::HashCombine(h, Hash(structure.members));
+
+			return h;
+		}
+
+		std::size_t Hash(const Structure::Member& member) const
+		{
+			// offset is not part of the comparison
+			return Nz::HashCombine(Hash(member.type), member.name);
+		}
+
+		std::size_t Hash(const Vector& vector) const
+		{
+			return Nz::HashCombine(Hash(vector.componentType), vector.componentCount);
+		}
+
+		std::size_t Hash(const Void& /*voidType*/) const
+		{
+			return 0;
+		}
+
+
+		std::size_t Hash(const Constant& constant) const
+		{
+			return Hash(constant.constant);
+		}
+
+		std::size_t Hash(const Type& type) const
+		{
+			return Hash(type.type);
+		}
+
+
+		std::size_t Hash(const std::variant<AnyConstant, AnyType>& key) const
 		{
-			return 42;
+			// ids are looked up using a bare AnyConstant/AnyType, their hash must match the stored key one
+			return std::visit([&](auto&& arg)
+			{
+				return Hash(arg);
+			}, key);
+		}
+
+		template<typename T>
+		std::size_t Hash(const std::shared_ptr<T>& ptr) const
+		{
+			if (!ptr)
+				return 0;
+
+			return Hash(*ptr);
+		}
+
+		template<typename... T>
+		std::size_t Hash(const std::variant<T...>& value) const
+		{
+			return std::visit([&](auto&& arg)
+			{
+				return Nz::HashCombine(value.index(), Hash(arg));
+			}, value);
+		}
+
+		template<typename T>
+		std::size_t Hash(const std::vector<T>& values) const
+		{
+			std::size_t h = Nz::HashCombine(values.size());
+			for (const T& value : values)
+				Nz::HashCombine(h, Hash(value));
+
+			return h;
+		}
+
+		template<typename T>
+		std::size_t operator()(const T& value) const
+		{
+			return Hash(value);
 		}
 	};
 
@@ -443,8 +581,10 @@ namespace nzsl
 		std::vector<Source> debugSources;
 		tsl::ordered_map<std::string, std::uint32_t /*id*/, std::hash<std::string_view>, std::equal_to<>> debugStrings;
 		tsl::ordered_map<std::variant<AnyConstant, AnyType>, std::uint32_t /*id*/, AnyHasher, Eq> ids;
+		std::vector<std::pair<SpecConstant, std::uint32_t /*id*/>> specConstants;
 		std::vector<std::pair<Variable, std::uint32_t /*id*/>> variables;
 		StructCallback structCallback;
+		std::shared_ptr<SpirvTypeCache> typeCache;
 		std::uint32_t& nextResultId;
 		SpirvWriter& writer;
 		std::optional<StructLayout> currentBlockLayout;
@@ -491,7 +631,18 @@ namespace nzsl
 
 	auto SpirvConstantCache::BuildConstant(const Ast::ConstantSingleValue& value) const -> ConstantPtr
 	{
-		return std::make_shared<Constant>(std::visit([&](auto&& arg) -> SpirvConstantCache::AnyConstant
+		std::optional<SpirvTypeCache::ConstantKey> cacheKey;
+		if (m_internal->typeCache)
+		{
+			cacheKey = SpirvTypeCache::BuildConstantKey(value);
+			if (cacheKey)
+			{
+				if (ConstantPtr constant = m_internal->typeCache->FindConstant(*cacheKey))
+					return constant;
+			}
+		}
+
+		ConstantPtr constant = std::make_shared<Constant>(std::visit([&](auto&& arg) -> SpirvConstantCache::AnyConstant
 		{
 			using T = std::decay_t<decltype(arg)>;
 
@@ -539,6 +690,11 @@ namespace nzsl
 			else
 				static_assert(Nz::AlwaysFalse<T>(), "non-exhaustive visitor");
 		}, value));
+
+		if (cacheKey)
+			m_internal->typeCache->RegisterConstant(std::move(*cacheKey), constant);
+
+		return constant;
 	}
 
 	FieldOffsets SpirvConstantCache::BuildFieldOffsets(const Structure& structData) const
@@ -752,10 +908,26 @@ namespace nzsl
 
 	auto SpirvConstantCache::BuildType(const Ast::ExpressionType& type) const -> TypePtr
 	{
-		return std::visit([&](auto&& arg) -> TypePtr
+		std::optional<SpirvTypeCache::TypeKey> cacheKey;
+		if (m_internal->typeCache)
+		{
+			cacheKey = SpirvTypeCache::BuildTypeKey(type, m_internal->currentBlockLayout);
+			if (cacheKey)
+			{
+				if (TypePtr typePtr = m_internal->typeCache->FindType(*cacheKey))
+					return typePtr;
+			}
+		}
+
+		TypePtr typePtr = std::visit([&](auto&& arg) -> TypePtr
 		{
 			return BuildType(arg);
 		}, type);
+
+		if (cacheKey)
+			m_internal->typeCache->RegisterType(std::move(*cacheKey), typePtr);
+
+		return typePtr;
 	}
 
 	auto SpirvConstantCache::BuildType(const Ast::ExpressionType& type, SpirvStorageClass storageClass) const -> TypePtr
@@ -767,10 +939,7 @@ namespace nzsl
 				m_internal->currentBlockLayout = (storageClass == SpirvStorageClass::Uniform) ? StructLayout::Std140 : StructLayout::Std430; // FIXME: When does that happen?
 		}
 
-		auto typePtr = std::visit([&](auto&& arg) -> TypePtr
-		{
-			return BuildType(arg);
-		}, type);
+		TypePtr typePtr = BuildType(type);
 
 		m_internal->currentBlockLayout = prevBlockLayout;
 
@@ -1016,36 +1185,50 @@ namespace nzsl
 	{
 		AnyConstant& constant = c.constant;
 
+		// Dependencies of a registered constant are already registered
+		std::size_t h = m_internal->ids.hash_function()(constant);
+		if (auto it = m_internal->ids.find(constant, h); it != m_internal->ids.end())
+			return it.value();
+
 		DepRegisterer registerer(*this);
 		registerer.Register(constant);
 
-		std::size_t h = m_internal->ids.hash_function()(constant);
-		auto it = m_internal->ids.find(constant, h);
-		if (it == m_internal->ids.end())
-		{
-			std::uint32_t resultId = m_internal->nextResultId++;
-			it = m_internal->ids.emplace(std::move(constant), resultId).first;
-		}
+		std::uint32_t resultId = m_internal->nextResultId++;
+		m_internal->ids.emplace(std::move(constant), resultId);
 
-		return it.value();
+		return resultId;
 	}
 
 	std::uint32_t SpirvConstantCache::Register(Type t)
 	{
 		AnyType& type = t.type;
 
+		// Dependencies of a registered type are already registered
+		std::size_t h = m_internal->ids.hash_function()(type);
+		if (auto it = m_internal->ids.find(type, h); it != m_internal->ids.end())
+			return it.value();
+
 		DepRegisterer registerer(*this);
 		registerer.Register(type);
 
-		std::size_t h = m_internal->ids.hash_function()(type);
-		auto it = m_internal->ids.find(type, h);
-		if (it == m_internal->ids.end())
-		{
-			std::uint32_t resultId = m_internal->nextResultId++;
-			it = m_internal->ids.emplace(std::move(type), resultId).first;
-		}
+		std::uint32_t resultId = m_internal->nextResultId++;
+		m_internal->ids.emplace(std::move(type), resultId);
 
-		return it.value();
+		return resultId;
+	}
+
+	std::uint32_t SpirvConstantCache::Register(SpecConstant c)
+	{
+		assert(c.defaultValue);
+
+		// Only the default value type is required, the default value itself is part of the specialization constant declaration
+		DepRegisterer registerer(*this);
+		registerer.Register(c.defaultValue->constant);
+
+		std::uint32_t resultId = m_internal->nextResultId++;
+		m_internal->specConstants.emplace_back(std::move(c), resultId);
+
+		return resultId;
 	}
 
 	std::uint32_t SpirvConstantCache::Register(Variable v)
@@ -1156,6 +1339,11 @@ namespace nzsl
 		m_internal->structCallback = std::move(callback);
 	}
 
+	void SpirvConstantCache::SetTypeCache(std::shared_ptr<SpirvTypeCache> typeCache)
+	{
+		m_internal->typeCache = std::move(typeCache);
+	}
+
 	void SpirvConstantCache::Write(SpirvSection& annotations, SpirvSection& constants, SpirvSection& debugInfos, DebugLevel debugLevel)
 	{
 		for (auto&& [str, id] : m_internal->debugStrings)
@@ -1199,11 +1387,21 @@ namespace nzsl
 
 			std::visit(Nz::Overloaded
 			{
-				[&](const AnyConstant& constant) { Write(constant, resultId, constants); },
+				[&](const AnyConstant& constant) { Write(constant, resultId, constants, false); },
 					[&](const AnyType& type) { Write(type, resultId, annotations, constants, debugInfos, debugLevel); },
 			}, object);
 		}
 
+		for (auto&& [specConstant, id] : m_internal->specConstants)
+		{
+			if (!specConstant.debugName.empty() && debugLevel >= DebugLevel::Minimal)
+				debugInfos.Append(SpirvOp::OpName, id, specConstant.debugName);
+
+			annotations.Append(SpirvOp::OpDecorate, id, SpirvDecoration::SpecId, specConstant.specId);
+
+			Write(specConstant.defaultValue->constant, id, constants, true);
+		}
+
 		for (auto&& [variable, id] : m_internal->variables)
 		{
 			const auto& var = variable;
@@ -1255,17 +1453,22 @@ namespace nzsl
 			throw std::runtime_error("an internal error occurred");
 	}
 
-	void SpirvConstantCache::Write(const AnyConstant& constant, std::uint32_t resultId, SpirvSection& constants)
+	void SpirvConstantCache::Write(const AnyConstant& constant, std::uint32_t resultId, SpirvSection& constants, bool isSpecConstant)
 	{
 		std::visit([&](auto&& arg)
 		{
 			using ConstantType = std::decay_t<decltype(arg)>;
 
 			if constexpr (std::is_same_v<ConstantType, ConstantBool>)
-				constants.Append((arg.value) ? SpirvOp::OpConstantTrue : SpirvOp::OpConstantFalse, GetId({ Bool{} }), resultId);
+			{
+				if (isSpecConstant)
+					constants.Append((arg.value) ? SpirvOp::OpSpecConstantTrue : SpirvOp::OpSpecConstantFalse, GetId({ Bool{} }), resultId);
+				else
+					constants.Append((arg.value) ? SpirvOp::OpConstantTrue : SpirvOp::OpConstantFalse, GetId({ Bool{} }), resultId);
+			}
 			else if constexpr (std::is_same_v<ConstantType, ConstantComposite>)
 			{
-				constants.AppendVariadic(SpirvOp::OpConstantComposite, [&](const auto& appender)
+				constants.AppendVariadic((isSpecConstant) ? SpirvOp::OpSpecConstantComposite : SpirvOp::OpConstantComposite, [&](const auto& appender)
 				{
 					appender(GetId(arg.type->type));
 					appender(resultId);
@@ -1296,7 +1499,7 @@ namespace nzsl
 					else
 						static_assert(Nz::AlwaysFalse<ValueType>::value, "non-exhaustive visitor");
 
-					constants.Append(SpirvOp::OpConstant, typeId, resultId, SpirvSection::Raw{ &value, sizeof(value) });
+					constants.Append((isSpecConstant) ? SpirvOp::OpSpecConstant : SpirvOp::OpConstant, typeId, resultId, SpirvSection::Raw{ &value, sizeof(value) });
 
 				}, arg.value);
 			}
@@ -11,6 +11,34 @@
 
 namespace nzsl
 {
+	constexpr std::uint16_t InvalidInstructionIndex = 0xFFFF;
+
+	template<typename T, std::size_t N>
+	constexpr std::size_t GetMaxOpcode(const std::array<T, N>& instructions)
+	{
+		std::size_t maxOpcode = 0;
+		for (const T& instruction : instructions)
+			maxOpcode = std::max(maxOpcode, static_cast<std::size_t>(instruction.op));
+
+		return maxOpcode;
+	}
+
+	// Maps every opcode to its index in the instruction array (or InvalidInstructionIndex), for a direct lookup
+	template<std::size_t MaxOpcode, typename T, std::size_t N>
+	constexpr std::array<std::uint16_t, MaxOpcode + 1> BuildInstructionIndices(const std::array<T, N>& instructions)
+	{
+		static_assert(N < InvalidInstructionIndex);
+
+		std::array<std::uint16_t, MaxOpcode + 1> indices = {};
+		for (std::uint16_t& index : indices)
+			index = InvalidInstructionIndex;
+
+		for (std::size_t i = 0; i < N; ++i)
+			indices[static_cast<std::size_t>(instructions[i].op)] = static_cast<std::uint16_t>(i);
+
+		return indices;
+	}
+
 	static constexpr std::array<SpirvOperand, 1420> s_operands = {
 		{
 			{
@@ -5704,7 +5732,7 @@ namespace nzsl
 		}
 	};
 
-	static std::array<SpirvInstruction, 759> s_instructions = {
+	static constexpr std::array<SpirvInstruction, 759> s_instructions = {
 		{
 			{
 				SpirvOp::OpNop,
@@ -11022,7 +11050,9 @@ namespace nzsl
 		}
 	};
 
-	static std::array<SpirvGlslStd450Instruction, 81> s_instructionsGlslStd450 = {
+	static constexpr auto s_instructionIndices = BuildInstructionIndices<GetMaxOpcode(s_instructions)>(s_instructions);
+
+	static constexpr std::array<SpirvGlslStd450Instruction, 81> s_instructionsGlslStd450 = {
 		{
 			{
 				SpirvGlslStd450Op::Round,
@@ -11594,6 +11624,8 @@ namespace nzsl
 		}
 	};
 
+	static constexpr auto s_instructionIndicesGlslStd450 = BuildInstructionIndices<GetMaxOpcode(s_instructionsGlslStd450)>(s_instructionsGlslStd450);
+
 	
 	std::pair<const SpirvOperand*, std::size_t> GetSpirvExtraOperands([[maybe_unused]] SpirvAccessQualifier kind)
 	{
@@ -12022,20 +12054,26 @@ namespace nzsl
 
 	const SpirvInstruction* GetSpirvInstruction(std::uint16_t op)
 	{
-		auto it = std::lower_bound(std::begin(s_instructions), std::end(s_instructions), op, [](const SpirvInstruction& inst, std::uint16_t op) { return std::uint16_t(inst.op) < op; });
-		if (it != std::end(s_instructions) && std::uint16_t(it->op) == op)
-			return &*it;
-		else
+		if (op >= s_instructionIndices.size())
+			return nullptr;
+
+		std::uint16_t index = s_instructionIndices[op];
+		if (index == InvalidInstructionIndex)
 			return nullptr;
+
+		return &s_instructions[index];
 	}
 
 	const SpirvGlslStd450Instruction* GetSpirvGlslStd450Instruction(std::uint16_t op)
 	{
-		auto it = std::lower_bound(std::begin(s_instructionsGlslStd450), std::end(s_instructionsGlslStd450), op, [](const SpirvGlslStd450Instruction& inst, std::uint16_t op) { return std::uint16_t(inst.op) < op; });
-		if (it != std::end(s_instructionsGlslStd450) && std::uint16_t(it->op) == op)
-			return &*it;
-		else
+		if (op >= s_instructionIndicesGlslStd450.size())
+			return nullptr;
+
+		std::uint16_t index = s_instructionIndicesGlslStd450[op];
+		if (index == InvalidInstructionIndex)
 			return nullptr;
+
+		return &s_instructionsGlslStd450[index];
 	}
 
 	std::string_view ToString(SpirvAccessQualifier value)
@@ -13,6 +13,15 @@
 
 namespace nzsl
 {
+	namespace
+	{
+		// Bitmask parameters aren't part of the grammar operands
+		constexpr SpirvOperand s_imageOperandParameter = { SpirvOperandKind::IdRef, "'Image Operand'" };
+		constexpr SpirvOperand s_loopControlParameter = { SpirvOperandKind::LiteralInteger, "'Loop Control Parameter'" };
+		constexpr SpirvOperand s_memoryAccessAlignment = { SpirvOperandKind::LiteralInteger, "'Alignment'" };
+		constexpr SpirvOperand s_memoryAccessScope = { SpirvOperandKind::IdScope, "'Scope'" };
+	}
+
 	void SpirvDecoder::Decode(const std::uint32_t* codepoints, std::size_t count)
 	{
 		m_currentCodepoint = codepoints;
@@ -44,6 +53,11 @@ namespace nzsl
 			std::uint16_t wordCount = static_cast<std::uint16_t>((firstWord >> 16) & 0xFFFF);
 			std::uint16_t opcode = static_cast<std::uint16_t>(firstWord & 0xFFFF);
 
+			if (wordCount == 0)
+				throw std::runtime_error("invalid instruction word count");
+
+			m_instructionEnd = instructionBegin + wordCount;
+
 			const SpirvInstruction* inst = GetSpirvInstruction(opcode);
 			if (!inst)
 				throw std::runtime_error("invalid instruction");
@@ -55,11 +69,158 @@ namespace nzsl
 		}
 	}
 
+	void SpirvDecoder::ForEachOperand(const SpirvOperand* operands, std::size_t minOperandCount, const OperandCallback& callback)
+	{
+		std::size_t currentOperand = 0;
+		while (currentOperand < minOperandCount && m_currentCodepoint < m_instructionEnd)
+		{
+			ReadOperand(operands[currentOperand], callback);
+
+			// Last operand may be repeated
+			if (currentOperand < minOperandCount - 1)
+				currentOperand++;
+		}
+	}
+
 	bool SpirvDecoder::HandleHeader(const SpirvHeader& /*header*/)
 	{
 		return true;
 	}
 
+	void SpirvDecoder::ReadOperand(const SpirvOperand& operand, const OperandCallback& callback)
+	{
+		const std::uint32_t* operandBegin = m_currentCodepoint;
+		auto ReadParameter = [&](const SpirvOperand& parameter)
+		{
+			const std::uint32_t* parameterBegin = m_currentCodepoint;
+			ReadWord();
+
+			callback(parameter, parameterBegin, 1);
+		};
+
+		switch (operand.kind)
+		{
+#define NZSL_HandleOperandKind(Kind) \
+			case SpirvOperandKind:: Kind : \
+			{ \
+				Spirv##Kind value = static_cast<Spirv##Kind>(ReadWord()); \
+				callback(operand, operandBegin, 1); \
+\
+				/* handle extra operands */ \
+				auto [operandPtr, operandCount] = GetSpirvExtraOperands(value); \
+				for (std::size_t i = 0; i < operandCount; ++i) \
+					ReadOperand(operandPtr[i], callback); \
+\
+				break; \
+			} \
+
+			NZSL_HandleOperandKind(AccessQualifier)
+			NZSL_HandleOperandKind(AddressingModel)
+			NZSL_HandleOperandKind(BuiltIn)
+			NZSL_HandleOperandKind(Capability)
+			NZSL_HandleOperandKind(Decoration)
+			NZSL_HandleOperandKind(Dim)
+			NZSL_HandleOperandKind(ExecutionMode)
+			NZSL_HandleOperandKind(ExecutionModel)
+			NZSL_HandleOperandKind(FPDenormMode)
+			NZSL_HandleOperandKind(FPOperationMode)
+			NZSL_HandleOperandKind(FPRoundingMode)
+			NZSL_HandleOperandKind(FunctionParameterAttribute)
+			NZSL_HandleOperandKind(GroupOperation)
+			NZSL_HandleOperandKind(ImageChannelDataType)
+			NZSL_HandleOperandKind(ImageChannelOrder)
+			NZSL_HandleOperandKind(ImageFormat)
+			NZSL_HandleOperandKind(KernelEnqueueFlags)
+			NZSL_HandleOperandKind(LinkageType)
+			NZSL_HandleOperandKind(MemoryModel)
+			NZSL_HandleOperandKind(OverflowModes)
+			NZSL_HandleOperandKind(PackedVectorFormat)
+			NZSL_HandleOperandKind(QuantizationModes)
+			NZSL_HandleOperandKind(RayQueryCandidateIntersectionType)
+			NZSL_HandleOperandKind(RayQueryCommittedIntersectionType)
+			NZSL_HandleOperandKind(RayQueryIntersection)
+			NZSL_HandleOperandKind(SamplerAddressingMode)
+			NZSL_HandleOperandKind(SamplerFilterMode)
+			NZSL_HandleOperandKind(Scope)
+			NZSL_HandleOperandKind(SourceLanguage)
+			NZSL_HandleOperandKind(StorageClass)
+#undef NZSL_HandleOperandKind
+
+			case SpirvOperandKind::ImageOperands:
+			{
+				// Every image operand parameter is an id, they end the instruction
+				ReadWord();
+				callback(operand, operandBegin, 1);
+
+				while (m_currentCodepoint < m_instructionEnd)
+					ReadParameter(s_imageOperandParameter);
+
+				break;
+			}
+
+			case SpirvOperandKind::LoopControl:
+			{
+				// Loop control parameters are literals ending the instruction
+				ReadWord();
+				callback(operand, operandBegin, 1);
+
+				while (m_currentCodepoint < m_instructionEnd)
+					ReadParameter(s_loopControlParameter);
+
+				break;
+			}
+
+			case SpirvOperandKind::MemoryAccess:
+			{
+				std::uint32_t memoryAccess = ReadWord();
+				callback(operand, operandBegin, 1);
+
+				if (memoryAccess & static_cast<std::uint32_t>(SpirvMemoryAccess::Aligned))
+					ReadParameter(s_memoryAccessAlignment);
+
+				if (memoryAccess & static_cast<std::uint32_t>(SpirvMemoryAccess::MakePointerAvailable))
+					ReadParameter(s_memoryAccessScope);
+
+				if (memoryAccess & static_cast<std::uint32_t>(SpirvMemoryAccess::MakePointerVisible))
+					ReadParameter(s_memoryAccessScope);
+
+				break;
+			}
+
+			case SpirvOperandKind::LiteralContextDependentNumber:
+			{
+				// Constant values size depends on their type, they end the instruction
+				m_currentCodepoint = m_instructionEnd;
+				callback(operand, operandBegin, static_cast<std::size_t>(m_currentCodepoint - operandBegin));
+				break;
+			}
+
+			case SpirvOperandKind::LiteralString:
+			{
+				SkipString();
+				callback(operand, operandBegin, static_cast<std::size_t>(m_currentCodepoint - operandBegin));
+				break;
+			}
+
+			case SpirvOperandKind::PairIdRefIdRef:
+			case SpirvOperandKind::PairIdRefLiteralInteger:
+			case SpirvOperandKind::PairLiteralIntegerIdRef:
+			{
+				ReadWord();
+				ReadWord();
+				callback(operand, operandBegin, 2);
+				break;
+			}
+
+			default:
+			{
+				ReadWord();
+				callback(operand, operandBegin, 1);
+				break;
+			}
+		}
+	}
+
 	std::string SpirvDecoder::ReadString()
 	{
 		std::string str;
@@ -85,4 +246,15 @@ namespace nzsl
 
 		return *m_currentCodepoint++;
 	}
+
+	void SpirvDecoder::SkipString()
+	{
+		// Strings are null-terminated and padded to a word boundary
+		for (;;)
+		{
+			std::uint32_t value = ReadWord();
+			if ((value & 0xFF000000) == 0 || (value & 0x00FF0000) == 0 || (value & 0x0000FF00) == 0 || (value & 0x000000FF) == 0)
+				return;
+		}
+	}
 }
@@ -0,0 +1,393 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/SpirV/SpirvOptimizer.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+#include <NazaraUtils/Hash.hpp>
+#include <NZSL/SpirV/SpirvData.hpp>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace nzsl
+{
+	namespace
+	{
+		struct WordsHasher
+		{
+			std::size_t operator()(const std::vector<std::uint32_t>& words) const
+			{
+				std::size_t h = 0;
+				for (std::uint32_t word : words)
+					Nz::HashCombine(h, word);
+
+				return h;
+			}
+		};
+
+		// Names and decorations, their first operand being their target
+		bool IsAnnotation(SpirvOp op)
+		{
+			switch (op)
+			{
+				case SpirvOp::OpDecorate:
+				case SpirvOp::OpDecorateId:
+				case SpirvOp::OpDecorateString:
+				case SpirvOp::OpMemberDecorate:
+				case SpirvOp::OpMemberDecorateString:
+				case SpirvOp::OpMemberName:
+				case SpirvOp::OpName:
+					return true;
+
+				default:
+					return false;
+			}
+		}
+
+		bool IsDecoration(SpirvOp op)
+		{
+			return IsAnnotation(op) && op != SpirvOp::OpName && op != SpirvOp::OpMemberName;
+		}
+
+		// Module-level instructions which can be removed if nothing references their result
+		bool IsRemovable(SpirvOp op)
+		{
+			switch (op)
+			{
+				case SpirvOp::OpConstant:
+				case SpirvOp::OpConstantComposite:
+				case SpirvOp::OpConstantFalse:
+				case SpirvOp::OpConstantNull:
+				case SpirvOp::OpConstantSampler:
+				case SpirvOp::OpConstantTrue:
+				case SpirvOp::OpString:
+				case SpirvOp::OpTypeArray:
+				case SpirvOp::OpTypeBool:
+				case SpirvOp::OpTypeFloat:
+				case SpirvOp::OpTypeFunction:
+				case SpirvOp::OpTypeImage:
+				case SpirvOp::OpTypeInt:
+				case SpirvOp::OpTypeMatrix:
+				case SpirvOp::OpTypePointer:
+				case SpirvOp::OpTypeRuntimeArray:
+				case SpirvOp::OpTypeSampledImage:
+				case SpirvOp::OpTypeSampler:
+				case SpirvOp::OpTypeStruct:
+				case SpirvOp::OpTypeVector:
+				case SpirvOp::OpTypeVoid:
+					return true;
+
+				default:
+					return false;
+			}
+		}
+
+		// Two structs with the same members are different types, other types and constants are defined by their operands
+		bool IsMergeable(SpirvOp op)
+		{
+			return IsRemovable(op) && op != SpirvOp::OpTypeStruct && op != SpirvOp::OpString;
+		}
+
+		constexpr std::size_t InvalidIndex = std::numeric_limits<std::size_t>::max();
+	}
+
+	struct SpirvOptimizer::Instruction
+	{
+		SpirvOp op;
+		std::size_t firstId; //< index of the first id offset in State::idOffsets
+		std::size_t idCount;
+		std::size_t offset; //< in words, from the beginning of the module
+		std::uint32_t resultId = 0;
+		std::uint32_t resultIdOffset = 0;
+		std::uint32_t wordCount;
+		bool removed = false;
+	};
+
+	struct SpirvOptimizer::State
+	{
+		State(const std::uint32_t* c, const Settings& s) :
+		codepoints(c),
+		settings(s)
+		{
+		}
+
+		template<typename F> void ForEachId(const Instruction& instruction, F&& callback) const
+		{
+			for (std::size_t i = 0; i < instruction.idCount; ++i)
+				callback(idOffsets[instruction.firstId + i]);
+		}
+
+		SpirvHeader header;
+		std::vector<Instruction> instructions;
+		std::vector<std::uint32_t> idOffsets; //< offsets of every id operand, relative to their instruction
+		const std::uint32_t* codepoints;
+		const Settings& settings;
+	};
+
+	std::vector<std::uint32_t> SpirvOptimizer::Optimize(const std::uint32_t* codepoints, std::size_t count, const Settings& settings)
+	{
+		State state(codepoints, settings);
+
+		m_currentState = &state;
+		Nz::CallOnExit resetOnExit([&] { m_currentState = nullptr; });
+
+		Decode(codepoints, count);
+
+		std::uint32_t bound = state.header.bound;
+
+		std::vector<std::uint32_t> remappedIds(bound);
+		std::iota(remappedIds.begin(), remappedIds.end(), 0);
+
+		if (settings.mergeDuplicates)
+			MergeDuplicates(remappedIds);
+
+		if (settings.removeUnused)
+			RemoveUnused(remappedIds);
+
+		if (settings.compactIds)
+		{
+			// Number ids by order of appearance
+			std::vector<std::uint32_t> compactIds(bound, 0);
+			std::uint32_t nextId = 1;
+			for (const Instruction& instruction : state.instructions)
+			{
+				if (instruction.removed)
+					continue;
+
+				state.ForEachId(instruction, [&](std::uint32_t idOffset)
+				{
+					std::uint32_t id = remappedIds[codepoints[instruction.offset + idOffset]];
+					if (compactIds[id] == 0)
+						compactIds[id] = nextId++;
+				});
+			}
+
+			for (std::uint32_t& id : remappedIds)
+				id = compactIds[id];
+
+			bound = nextId;
+		}
+
+		std::vector<std::uint32_t> output;
+		output.reserve(count);
+		output.push_back(SpirvMagicNumber);
+		output.push_back(state.header.versionNumber);
+		output.push_back(state.header.generatorId);
+		output.push_back(bound);
+		output.push_back(state.header.schema);
+
+		for (const Instruction& instruction : state.instructions)
+		{
+			if (instruction.removed)
+				continue;
+
+			std::size_t instructionOffset = output.size();
+			output.insert(output.end(), codepoints + instruction.offset, codepoints + instruction.offset + instruction.wordCount);
+
+			state.ForEachId(instruction, [&](std::uint32_t idOffset)
+			{
+				std::uint32_t& id = output[instructionOffset + idOffset];
+				id = remappedIds[id];
+			});
+		}
+
+		return output;
+	}
+
+	bool SpirvOptimizer::HandleHeader(const SpirvHeader& header)
+	{
+		m_currentState->header = header;
+		return true;
+	}
+
+	bool SpirvOptimizer::HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount)
+	{
+		const std::uint32_t* instructionBegin = GetCurrentPtr() - 1;
+
+		Instruction& inst = m_currentState->instructions.emplace_back();
+		inst.op = instruction.op;
+		inst.firstId = m_currentState->idOffsets.size();
+		inst.offset = static_cast<std::size_t>(instructionBegin - m_currentState->codepoints);
+		inst.wordCount = wordCount;
+
+		auto HandleId = [&](const std::uint32_t* idPtr)
+		{
+			std::uint32_t id = *idPtr;
+			if (id == 0 || id >= m_currentState->header.bound)
+				throw std::runtime_error("invalid SPIR-V: id " + std::to_string(id) + " is out of bounds");
+
+			std::uint32_t idOffset = static_cast<std::uint32_t>(idPtr - instructionBegin);
+			m_currentState->idOffsets.push_back(idOffset);
+
+			return idOffset;
+		};
+
+		ForEachOperand(instruction, [&](const SpirvOperand& operand, const std::uint32_t* words, std::size_t /*wordCount*/)
+		{
+			switch (operand.kind)
+			{
+				case SpirvOperandKind::IdResult:
+					inst.resultId = *words;
+					inst.resultIdOffset = HandleId(words);
+					break;
+
+				case SpirvOperandKind::IdMemorySemantics:
+				case SpirvOperandKind::IdRef:
+				case SpirvOperandKind::IdResultType:
+				case SpirvOperandKind::IdScope:
+				case SpirvOperandKind::PairIdRefLiteralInteger:
+					HandleId(&words[0]);
+					break;
+
+				case SpirvOperandKind::PairIdRefIdRef:
+					HandleId(&words[0]);
+					HandleId(&words[1]);
+					break;
+
+				case SpirvOperandKind::PairLiteralIntegerIdRef:
+					HandleId(&words[1]);
+					break;
+
+				default:
+					break;
+			}
+		});
+
+		inst.idCount = m_currentState->idOffsets.size() - inst.firstId;
+
+		return true;
+	}
+
+	void SpirvOptimizer::MergeDuplicates(std::vector<std::uint32_t>& remappedIds)
+	{
+		const std::uint32_t* codepoints = m_currentState->codepoints;
+
+		// Decorations (ArrayStride, Offset, ...) can give different layouts to identical types, keep decorated ids distinct
+		std::unordered_set<std::uint32_t> decoratedIds;
+		for (const Instruction& instruction : m_currentState->instructions)
+		{
+			if (IsDecoration(instruction.op))
+				decoratedIds.insert(codepoints[instruction.offset + 1]);
+		}
+
+		// Types and constants are declared before being used, so operands of an instruction are already remapped when we reach it
+		std::unordered_map<std::vector<std::uint32_t>, std::uint32_t, WordsHasher> knownIds;
+		std::vector<std::uint32_t> key;
+		for (Instruction& instruction : m_currentState->instructions)
+		{
+			if (!IsMergeable(instruction.op) || instruction.resultId == 0 || decoratedIds.count(instruction.resultId) != 0)
+				continue;
+
+			key.assign(codepoints + instruction.offset, codepoints + instruction.offset + instruction.wordCount);
+			m_currentState->ForEachId(instruction, [&](std::uint32_t idOffset)
+			{
+				key[idOffset] = (idOffset == instruction.resultIdOffset) ? 0 : remappedIds[key[idOffset]];
+			});
+
+			auto [it, inserted] = knownIds.emplace(key, instruction.resultId);
+			if (!inserted)
+			{
+				remappedIds[instruction.resultId] = it->second;
+				instruction.removed = true;
+			}
+		}
+
+		// Names of merged ids would conflict with the ones of the id they were merged into
+		for (Instruction& instruction : m_currentState->instructions)
+		{
+			if (!IsAnnotation(instruction.op))
+				continue;
+
+			std::uint32_t targetId = codepoints[instruction.offset + 1];
+			if (remappedIds[targetId] != targetId)
+				instruction.removed = true;
+		}
+	}
+
+	void SpirvOptimizer::RemoveUnused(const std::vector<std::uint32_t>& remappedIds)
+	{
+		const std::uint32_t* codepoints = m_currentState->codepoints;
+		auto& instructions = m_currentState->instructions;
+
+		std::vector<std::size_t> definitions(remappedIds.size(), InvalidIndex);
+		std::unordered_map<std::uint32_t /*targetId*/, std::vector<std::size_t>> annotations;
+		for (std::size_t i = 0; i < instructions.size(); ++i)
+		{
+			const Instruction& instruction = instructions[i];
+			if (instruction.removed)
+				continue;
+
+			if (IsAnnotation(instruction.op))
+				annotations[remappedIds[codepoints[instruction.offset + 1]]].push_back(i);
+			else if (IsRemovable(instruction.op))
+				definitions[instruction.resultId] = i;
+		}
+
+		std::vector<bool> isLive(remappedIds.size(), false);
+		std::vector<std::uint32_t> pendingIds;
+
+		auto MarkUsedIds = [&](const Instruction& instruction)
+		{
+			// The target of an annotation isn't a use
+			std::uint32_t firstUseOffset = (IsAnnotation(instruction.op)) ? 2 : 0;
+
+			m_currentState->ForEachId(instruction, [&](std::uint32_t idOffset)
+			{
+				if (idOffset == instruction.resultIdOffset || idOffset < firstUseOffset)
+					return;
+
+				std::uint32_t id = remappedIds[codepoints[instruction.offset + idOffset]];
+				if (!isLive[id])
+				{
+					isLive[id] = true;
+					pendingIds.push_back(id);
+				}
+			});
+		};
+
+		// Every instruction which isn't a type, a constant, a string or an annotation is kept along with what it uses
+		for (const Instruction& instruction : instructions)
+		{
+			if (instruction.removed || IsAnnotation(instruction.op) || IsRemovable(instruction.op))
+				continue;
+
+			if (instruction.resultId != 0 && !isLive[instruction.resultId])
+			{
+				isLive[instruction.resultId] = true;
+				pendingIds.push_back(instruction.resultId);
+			}
+
+			MarkUsedIds(instruction);
+		}
+
+		while (!pendingIds.empty())
+		{
+			std::uint32_t id = pendingIds.back();
+			pendingIds.pop_back();
+
+			if (std::size_t definitionIndex = definitions[id]; definitionIndex != InvalidIndex)
+				MarkUsedIds(instructions[definitionIndex]);
+
+			if (auto it = annotations.find(id); it != annotations.end())
+			{
+				for (std::size_t annotationIndex : it->second)
+					MarkUsedIds(instructions[annotationIndex]);
+			}
+		}
+
+		for (Instruction& instruction : instructions)
+		{
+			if (instruction.removed)
+				continue;
+
+			if (IsAnnotation(instruction.op))
+				instruction.removed = !isLive[remappedIds[codepoints[instruction.offset + 1]]];
+			else if (IsRemovable(instruction.op))
+				instruction.removed = !isLive[instruction.resultId];
+		}
+	}
+}
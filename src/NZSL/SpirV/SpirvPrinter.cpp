@@ -76,19 +76,13 @@ namespace nzsl
 			std::uint32_t resultId = 0;
 			auto PrintParameter = [&](const SpirvOperand* operands, std::size_t minOperandCount)
 			{
-				std::size_t currentOperand = 0;
-				while (GetCurrentPtr() < endPtr)
+				ForEachOperand(operands, minOperandCount, [&](const SpirvOperand& operand, const std::uint32_t* words, std::size_t operandWordCount)
 				{
-					const SpirvOperand* operand = &operands[currentOperand];
-
-					if (operand->kind != SpirvOperandKind::IdResult)
-						PrintOperand(instructionStream, operand);
+					if (operand.kind != SpirvOperandKind::IdResult)
+						PrintOperand(instructionStream, operand, words, operandWordCount);
 					else
-						resultId = ReadWord();
-
-					if (currentOperand < minOperandCount - 1)
-						currentOperand++;
-				}
+						resultId = words[0];
+				});
 			};
 
 			switch (instruction.op)
@@ -184,15 +178,22 @@ namespace nzsl
 
 				case SpirvOp::OpConstant:
 				{
-					const std::uint32_t* savedPtr = GetCurrentPtr();
-
-					PrintOperand(instructionStream, &instruction.operands[0]);
-
-					ResetPtr(savedPtr);
-
 					std::uint32_t resultType = ReadWord();
 					resultId = ReadWord();
 
+					instructionStream << " %" << resultType;
+
+					// Fallback for constants whose type is unknown or whose width isn't supported
+					auto PrintValue = [&]
+					{
+						const std::uint32_t* valuePtr = GetCurrentPtr();
+						if (valuePtr < endPtr)
+						{
+							PrintOperand(instructionStream, instruction.operands[2], valuePtr, static_cast<std::size_t>(endPtr - valuePtr));
+							ResetPtr(endPtr);
+						}
+					};
+
 					if (auto floatIt = m_currentState->floatingPointTypes.find(resultType); floatIt != m_currentState->floatingPointTypes.end())
 					{
 						std::uint32_t width = floatIt->second;
@@ -217,7 +218,7 @@ namespace nzsl
 							instructionStream << " f64(" << f64 << ")";
 						}
 						else
-							PrintOperand(instructionStream, &instruction.operands[2]);
+							PrintValue();
 					}
 					else if (auto intIt = m_currentState->integerTypes.find(resultType); intIt != m_currentState->integerTypes.end())
 					{
@@ -242,7 +243,7 @@ namespace nzsl
 							instructionStream << " i" << width << "(" << iVal << ")";
 						}
 						else
-							PrintOperand(instructionStream, &instruction.operands[2]);
+							PrintValue();
 					}
 					else if (auto uintIt = m_currentState->unsignedIntegerTypes.find(resultType); uintIt != m_currentState->unsignedIntegerTypes.end())
 					{
@@ -260,10 +261,10 @@ namespace nzsl
 							instructionStream << " u" << width << "(" << value << ")";
 						}
 						else
-							PrintOperand(instructionStream, &instruction.operands[2]);
+							PrintValue();
 					}
 					else
-						PrintOperand(instructionStream, &instruction.operands[2]);
+						PrintValue();
 
 					break;
 				}
@@ -293,31 +294,24 @@ namespace nzsl
 		return true;
 	}
 	
-	void SpirvPrinter::PrintOperand(std::ostream& instructionStream, const SpirvOperand* operand)
+	void SpirvPrinter::PrintOperand(std::ostream& instructionStream, const SpirvOperand& operand, const std::uint32_t* words, std::size_t wordCount)
 	{
-		switch (operand->kind)
+		// Operand words are delimited by SpirvDecoder::ForEachOperand, which also handles extra operands and bitmask parameters
+		switch (operand.kind)
 		{
 			case SpirvOperandKind::IdRef:
 			case SpirvOperandKind::IdResultType:
 			case SpirvOperandKind::IdMemorySemantics:
 			case SpirvOperandKind::IdScope:
 			{
-				std::uint32_t value = ReadWord();
-				instructionStream << " %" << value;
+				instructionStream << " %" << words[0];
 				break;
 			}
 
 #define NZSL_HandleOperandKind(Kind) \
 			case SpirvOperandKind:: Kind : \
 			{ \
-				Spirv##Kind value = static_cast<Spirv##Kind>(ReadWord()); \
-				instructionStream << " " #Kind "(" << ToString(value) << ")"; \
-\
-				/* handle extra operands */ \
-				auto [operandPtr, operandCount] = GetSpirvExtraOperands(value); \
-				for (std::size_t i = 0; i < operandCount; ++i) \
-					PrintOperand(instructionStream, operandPtr + i); \
-\
+				instructionStream << " " #Kind "(" << ToString(static_cast<Spirv##Kind>(words[0])) << ")"; \
 				break; \
 			} \
 
@@ -366,62 +360,53 @@ namespace nzsl
 			case SpirvOperandKind::LiteralSpecConstantOpInteger:
 			case SpirvOperandKind::LiteralContextDependentNumber: //< FIXME
 			{
-				std::uint32_t value = ReadWord();
-				instructionStream << " " << operand->name << "(" << value << ")";
+				instructionStream << " " << operand.name << "(" << words[0];
+				for (std::size_t i = 1; i < wordCount; ++i)
+					instructionStream << " " << words[i];
+
+				instructionStream << ")";
 				break;
 			}
 
 			case SpirvOperandKind::LiteralInteger:
 			{
-				std::uint32_t value = ReadWord();
-				instructionStream << " " << value;
+				instructionStream << " " << words[0];
 				break;
 			}
 
 			case SpirvOperandKind::LiteralString:
 			{
-				std::string str = ReadString();
-				instructionStream << " \"" << str << "\"";
-
-				/*
-				std::size_t offset = GetOutputOffset();
-
-				std::size_t size4 = CountWord(str);
-				for (std::size_t i = 0; i < size4; ++i)
+				instructionStream << " \"";
+				for (std::size_t i = 0; i < wordCount; ++i)
 				{
-					std::uint32_t codepoint = 0;
 					for (std::size_t j = 0; j < 4; ++j)
 					{
-						std::size_t pos = i * 4 + j;
-						if (pos < str.size())
-							codepoint |= std::uint32_t(str[pos]) << (j * 8);
-					}
+						char c = static_cast<char>((words[i] >> (j * 8)) & 0xFF);
+						if (c == '\0')
+							break;
 
-					Append(codepoint);
+						instructionStream << c;
+					}
 				}
-				*/
+				instructionStream << "\"";
 				break;
 			}
 
-
 			case SpirvOperandKind::PairLiteralIntegerIdRef:
 			{
-				ReadWord();
-				ReadWord();
+				instructionStream << " " << words[0] << " %" << words[1];
 				break;
 			}
 
 			case SpirvOperandKind::PairIdRefLiteralInteger:
 			{
-				ReadWord();
-				ReadWord();
+				instructionStream << " %" << words[0] << " " << words[1];
 				break;
 			}
 
 			case SpirvOperandKind::PairIdRefIdRef:
 			{
-				ReadWord();
-				ReadWord();
+				instructionStream << " %" << words[0] << " %" << words[1];
 				break;
 			}
 
@@ -0,0 +1,606 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/SpirV/SpirvReflector.hpp>
+#include <NazaraUtils/CallOnExit.hpp>
+#include <NZSL/SpirV/SpirvData.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace nzsl
+{
+	namespace
+	{
+		std::uint32_t GetWordCount(const std::uint32_t* instruction)
+		{
+			return instruction[0] >> 16;
+		}
+
+		SpirvOp GetOpcode(const std::uint32_t* instruction)
+		{
+			return static_cast<SpirvOp>(instruction[0] & 0xFFFF);
+		}
+
+		// Returns a pointer past the end of the literal string starting at words
+		const std::uint32_t* SkipLiteralString(const std::uint32_t* words, const std::uint32_t* end)
+		{
+			while (words < end)
+			{
+				std::uint32_t value = *words++;
+				if ((value & 0xFF000000) == 0)
+					return words;
+			}
+
+			throw std::runtime_error("invalid SPIR-V: unterminated string");
+		}
+
+		std::string DecodeString(const std::uint32_t* words, const std::uint32_t* end)
+		{
+			std::string str;
+			for (; words < end; ++words)
+			{
+				std::uint32_t value = *words;
+				for (std::size_t j = 0; j < 4; ++j)
+				{
+					char c = static_cast<char>((value >> (j * 8)) & 0xFF);
+					if (c == '\0')
+						return str;
+
+					str.push_back(c);
+				}
+			}
+
+			throw std::runtime_error("invalid SPIR-V: unterminated string");
+		}
+
+		bool IsTypeDeclaration(SpirvOp op)
+		{
+			switch (op)
+			{
+				case SpirvOp::OpTypeArray:
+				case SpirvOp::OpTypeBool:
+				case SpirvOp::OpTypeFloat:
+				case SpirvOp::OpTypeImage:
+				case SpirvOp::OpTypeInt:
+				case SpirvOp::OpTypeMatrix:
+				case SpirvOp::OpTypePointer:
+				case SpirvOp::OpTypeRuntimeArray:
+				case SpirvOp::OpTypeSampledImage:
+				case SpirvOp::OpTypeSampler:
+				case SpirvOp::OpTypeStruct:
+				case SpirvOp::OpTypeVector:
+					return true;
+
+				default:
+					return false;
+			}
+		}
+
+		bool IsConstantDeclaration(SpirvOp op)
+		{
+			switch (op)
+			{
+				case SpirvOp::OpConstant:
+				case SpirvOp::OpConstantComposite:
+				case SpirvOp::OpSpecConstant:
+				case SpirvOp::OpSpecConstantComposite:
+					return true;
+
+				default:
+					return false;
+			}
+		}
+	}
+
+	auto SpirvReflector::Reflect(const std::uint32_t* codepoints, std::size_t count) -> Reflection
+	{
+		Reflection reflection;
+
+		m_codepointEnd = codepoints + count;
+		m_reflection = &reflection;
+		m_workgroupSizeId = 0;
+		m_entryPointInterfaces.clear();
+		m_localSizeIdInstructions.clear();
+		m_members.clear();
+
+		Nz::CallOnExit resetOnExit([&] { m_reflection = nullptr; });
+
+		Decode(codepoints, count);
+
+		// Constants are declared after execution modes, resolve them once the whole module has been read
+		for (const std::uint32_t* instruction : m_localSizeIdInstructions)
+			GetEntryPoint(instruction[1]).localSize = ResolveConstantVector(&instruction[3]);
+
+		// A constant decorated with the WorkgroupSize builtin takes precedence over execution modes
+		if (m_workgroupSizeId != 0)
+		{
+			const std::uint32_t* instruction = GetInstruction(m_workgroupSizeId, 6);
+			Vector3u32 localSize = ResolveConstantVector(&instruction[3]);
+
+			for (EntryPoint& entryPoint : reflection.entryPoints)
+			{
+				if (entryPoint.executionModel == SpirvExecutionModel::GLCompute || entryPoint.localSize)
+					entryPoint.localSize = localSize;
+			}
+		}
+
+		return reflection;
+	}
+
+	bool SpirvReflector::HandleHeader(const SpirvHeader& header)
+	{
+		m_ids.clear();
+		m_ids.resize(header.bound);
+
+		return true;
+	}
+
+	bool SpirvReflector::HandleOpcode(const SpirvInstruction& instruction, std::uint32_t wordCount)
+	{
+		const std::uint32_t* instructionBegin = GetCurrentPtr() - 1;
+		if (wordCount > static_cast<std::size_t>(m_codepointEnd - instructionBegin))
+			throw std::runtime_error("unexpected end of stream");
+
+		const std::uint32_t* instructionEnd = instructionBegin + wordCount;
+
+		auto Word = [&](std::size_t index)
+		{
+			if (index >= wordCount)
+				throw std::runtime_error("invalid SPIR-V: instruction is missing operands");
+
+			return instructionBegin[index];
+		};
+
+		switch (instruction.op)
+		{
+			case SpirvOp::OpEntryPoint:
+			{
+				EntryPoint& entryPoint = m_reflection->entryPoints.emplace_back();
+				entryPoint.executionModel = static_cast<SpirvExecutionModel>(Word(1));
+				entryPoint.id = Word(2);
+				entryPoint.name = DecodeString(&instructionBegin[3], instructionEnd);
+
+				EntryPointInterface& entryPointInterface = m_entryPointInterfaces.emplace_back();
+				entryPointInterface.begin = SkipLiteralString(&instructionBegin[3], instructionEnd);
+				entryPointInterface.end = instructionEnd;
+				break;
+			}
+
+			case SpirvOp::OpExecutionMode:
+			case SpirvOp::OpExecutionModeId:
+			{
+				EntryPoint& entryPoint = GetEntryPoint(Word(1));
+
+				SpirvExecutionMode executionMode = static_cast<SpirvExecutionMode>(Word(2));
+				entryPoint.executionModes.push_back(executionMode);
+
+				if (executionMode == SpirvExecutionMode::LocalSize)
+					entryPoint.localSize = Vector3u32(Word(3), Word(4), Word(5));
+				else if (executionMode == SpirvExecutionMode::LocalSizeId)
+				{
+					Word(5);
+					m_localSizeIdInstructions.push_back(instructionBegin);
+				}
+				break;
+			}
+
+			case SpirvOp::OpName:
+				Word(2);
+				GetIdInfo(Word(1)).nameInstruction = instructionBegin;
+				break;
+
+			case SpirvOp::OpMemberName:
+				Word(3);
+				GetMemberInfo(Word(1), Word(2)).nameInstruction = instructionBegin;
+				break;
+
+			case SpirvOp::OpDecorate:
+			{
+				IdInfo& idInfo = GetIdInfo(Word(1));
+				switch (static_cast<SpirvDecoration>(Word(2)))
+				{
+					case SpirvDecoration::ArrayStride: idInfo.arrayStride = Word(3); break;
+					case SpirvDecoration::Binding: idInfo.bindingIndex = Word(3); break;
+					case SpirvDecoration::BufferBlock: idInfo.isBufferBlock = true; break;
+					case SpirvDecoration::DescriptorSet: idInfo.bindingSet = Word(3); break;
+					case SpirvDecoration::Location: idInfo.location = Word(3); break;
+
+					case SpirvDecoration::BuiltIn:
+					{
+						idInfo.builtin = static_cast<SpirvBuiltIn>(Word(3));
+						if (*idInfo.builtin == SpirvBuiltIn::WorkgroupSize)
+							m_workgroupSizeId = Word(1);
+						break;
+					}
+
+					default:
+						break;
+				}
+				break;
+			}
+
+			case SpirvOp::OpMemberDecorate:
+			{
+				SpirvDecoration decoration = static_cast<SpirvDecoration>(Word(3));
+				switch (decoration)
+				{
+					case SpirvDecoration::MatrixStride: GetMemberInfo(Word(1), Word(2)).matrixStride = Word(4); break;
+					case SpirvDecoration::Offset: GetMemberInfo(Word(1), Word(2)).offset = Word(4); break;
+					case SpirvDecoration::RowMajor: GetMemberInfo(Word(1), Word(2)).isRowMajor = true; break;
+
+					default:
+						break;
+				}
+				break;
+			}
+
+			case SpirvOp::OpVariable:
+			{
+				std::uint32_t typeId = Word(1);
+				std::uint32_t variableId = Word(2);
+				SpirvStorageClass storageClass = static_cast<SpirvStorageClass>(Word(3));
+
+				switch (storageClass)
+				{
+					case SpirvStorageClass::Input:
+					case SpirvStorageClass::Output:
+						RegisterInterfaceVariable(variableId, typeId, storageClass);
+						break;
+
+					case SpirvStorageClass::PushConstant:
+					case SpirvStorageClass::StorageBuffer:
+					case SpirvStorageClass::Uniform:
+					case SpirvStorageClass::UniformConstant:
+						RegisterResourceVariable(variableId, typeId, storageClass);
+						break;
+
+					default:
+						break;
+				}
+				break;
+			}
+
+			// Everything we're interested in is declared before the first function
+			case SpirvOp::OpFunction:
+				return false;
+
+			default:
+			{
+				if (IsTypeDeclaration(instruction.op))
+					GetIdInfo(Word(1)).instruction = instructionBegin;
+				else if (IsConstantDeclaration(instruction.op))
+					GetIdInfo(Word(2)).instruction = instructionBegin;
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	void SpirvReflector::RegisterInterfaceVariable(std::uint32_t variableId, std::uint32_t typeId, SpirvStorageClass storageClass)
+	{
+		const IdInfo& variableInfo = GetIdInfo(variableId);
+
+		InterfaceVariable variable;
+		variable.id = variableId;
+		variable.builtin = variableInfo.builtin;
+		variable.location = variableInfo.location;
+		variable.name = GetName(variableId);
+		variable.componentCount = 0;
+
+		const std::uint32_t* pointerType = GetInstruction(typeId, 4);
+		const std::uint32_t* type = GetInstruction(pointerType[3], 2);
+
+		std::uint32_t componentCount = 1;
+		if (GetOpcode(type) == SpirvOp::OpTypeVector)
+		{
+			type = GetInstruction(pointerType[3], 4);
+			componentCount = type[3];
+			type = GetInstruction(type[2], 2);
+		}
+
+		switch (GetOpcode(type))
+		{
+			case SpirvOp::OpTypeBool:
+				variable.componentType = Ast::PrimitiveType::Boolean;
+				break;
+
+			case SpirvOp::OpTypeFloat:
+			{
+				if (GetWordCount(type) >= 3 && type[2] == 32)
+					variable.componentType = Ast::PrimitiveType::Float32;
+				else if (GetWordCount(type) >= 3 && type[2] == 64)
+					variable.componentType = Ast::PrimitiveType::Float64;
+				break;
+			}
+
+			case SpirvOp::OpTypeInt:
+			{
+				if (GetWordCount(type) >= 4 && type[2] == 32)
+					variable.componentType = (type[3] != 0) ? Ast::PrimitiveType::Int32 : Ast::PrimitiveType::UInt32;
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		if (variable.componentType)
+			variable.componentCount = componentCount;
+
+		for (std::size_t i = 0; i < m_entryPointInterfaces.size(); ++i)
+		{
+			const EntryPointInterface& entryPointInterface = m_entryPointInterfaces[i];
+			if (std::find(entryPointInterface.begin, entryPointInterface.end, variableId) == entryPointInterface.end)
+				continue;
+
+			EntryPoint& entryPoint = m_reflection->entryPoints[i];
+			if (storageClass == SpirvStorageClass::Input)
+				entryPoint.inputs.push_back(variable);
+			else
+				entryPoint.outputs.push_back(variable);
+		}
+	}
+
+	void SpirvReflector::RegisterResourceVariable(std::uint32_t variableId, std::uint32_t typeId, SpirvStorageClass storageClass)
+	{
+		const std::uint32_t* pointerType = GetInstruction(typeId, 4);
+		std::uint32_t pointeeTypeId = pointerType[3];
+
+		std::string name = GetName(variableId);
+		if (name.empty())
+			name = GetName(pointeeTypeId);
+
+		if (storageClass == SpirvStorageClass::PushConstant)
+		{
+			PushConstantBlock& pushConstantBlock = m_reflection->pushConstantBlocks.emplace_back();
+			pushConstantBlock.id = variableId;
+			pushConstantBlock.name = std::move(name);
+			pushConstantBlock.size = ComputeTypeSize(pointeeTypeId, nullptr);
+
+			const std::uint32_t* structType = GetInstruction(pointeeTypeId, 2);
+			if (GetOpcode(structType) == SpirvOp::OpTypeStruct)
+			{
+				std::uint32_t memberCount = GetWordCount(structType) - 2;
+				pushConstantBlock.members.reserve(memberCount);
+
+				for (std::uint32_t memberIndex = 0; memberIndex < memberCount; ++memberIndex)
+				{
+					const MemberInfo* memberInfo = FindMemberInfo(pointeeTypeId, memberIndex);
+
+					BlockMember& member = pushConstantBlock.members.emplace_back();
+					member.offset = (memberInfo && memberInfo->offset != InvalidIndex) ? memberInfo->offset : 0;
+					member.size = ComputeTypeSize(structType[2 + memberIndex], memberInfo);
+					if (memberInfo && memberInfo->nameInstruction)
+						member.name = DecodeString(&memberInfo->nameInstruction[3], memberInfo->nameInstruction + GetWordCount(memberInfo->nameInstruction));
+				}
+			}
+
+			return;
+		}
+
+		const IdInfo& variableInfo = GetIdInfo(variableId);
+
+		Binding& binding = m_reflection->bindings.emplace_back();
+		binding.id = variableId;
+		binding.name = std::move(name);
+		binding.bindingIndex = variableInfo.bindingIndex;
+		binding.bindingSet = variableInfo.bindingSet;
+		binding.arraySize = 1;
+		binding.size = 0;
+
+		const std::uint32_t* type = GetInstruction(pointeeTypeId, 2);
+		if (GetOpcode(type) == SpirvOp::OpTypeArray)
+		{
+			type = GetInstruction(pointeeTypeId, 4);
+			binding.arraySize = ResolveConstantValue(type[3]);
+			pointeeTypeId = type[2];
+		}
+		else if (GetOpcode(type) == SpirvOp::OpTypeRuntimeArray)
+		{
+			type = GetInstruction(pointeeTypeId, 3);
+			binding.arraySize = 0;
+			pointeeTypeId = type[2];
+		}
+
+		type = GetInstruction(pointeeTypeId, 2);
+		switch (GetOpcode(type))
+		{
+			case SpirvOp::OpTypeImage:
+				binding.type = (GetWordCount(type) >= 8 && type[7] == 2) ? BindingType::StorageImage : BindingType::SampledImage;
+				break;
+
+			case SpirvOp::OpTypeSampledImage:
+				binding.type = BindingType::CombinedImageSampler;
+				break;
+
+			case SpirvOp::OpTypeSampler:
+				binding.type = BindingType::Sampler;
+				break;
+
+			case SpirvOp::OpTypeStruct:
+			{
+				if (storageClass == SpirvStorageClass::StorageBuffer || GetIdInfo(pointeeTypeId).isBufferBlock)
+					binding.type = BindingType::StorageBuffer;
+				else
+					binding.type = BindingType::UniformBuffer;
+
+				binding.size = ComputeTypeSize(pointeeTypeId, nullptr);
+				break;
+			}
+
+			default:
+				binding.type = BindingType::Unknown;
+				break;
+		}
+	}
+
+	std::uint32_t SpirvReflector::ComputeTypeSize(std::uint32_t typeId, const MemberInfo* memberInfo) const
+	{
+		const std::uint32_t* type = GetInstruction(typeId, 2);
+		std::uint32_t wordCount = GetWordCount(type);
+
+		switch (GetOpcode(type))
+		{
+			case SpirvOp::OpTypeBool:
+				return 4;
+
+			case SpirvOp::OpTypeFloat:
+			case SpirvOp::OpTypeInt:
+				return (wordCount >= 3) ? type[2] / 8 : 0;
+
+			case SpirvOp::OpTypeVector:
+				return (wordCount >= 4) ? type[3] * ComputeTypeSize(type[2], nullptr) : 0;
+
+			case SpirvOp::OpTypeMatrix:
+			{
+				if (wordCount < 4)
+					return 0;
+
+				std::uint32_t columnCount = type[3];
+				if (!memberInfo || memberInfo->matrixStride == 0)
+					return columnCount * ComputeTypeSize(type[2], nullptr);
+
+				if (memberInfo->isRowMajor)
+				{
+					const std::uint32_t* columnType = GetInstruction(type[2], 4);
+					return columnType[3] * memberInfo->matrixStride;
+				}
+
+				return columnCount * memberInfo->matrixStride;
+			}
+
+			case SpirvOp::OpTypeArray:
+			{
+				if (wordCount < 4)
+					return 0;
+
+				std::uint32_t length = ResolveConstantValue(type[3]);
+
+				std::uint32_t arrayStride = GetIdInfo(typeId).arrayStride;
+				if (arrayStride == 0)
+					arrayStride = ComputeTypeSize(type[2], memberInfo);
+
+				return length * arrayStride;
+			}
+
+			case SpirvOp::OpTypeStruct:
+			{
+				std::uint32_t size = 0;
+				std::uint32_t offset = 0;
+				for (std::uint32_t memberIndex = 0; memberIndex < wordCount - 2; ++memberIndex)
+				{
+					const MemberInfo* structMemberInfo = FindMemberInfo(typeId, memberIndex);
+					if (structMemberInfo && structMemberInfo->offset != InvalidIndex)
+						offset = structMemberInfo->offset;
+
+					offset += ComputeTypeSize(type[2 + memberIndex], structMemberInfo);
+					size = std::max(size, offset);
+				}
+
+				return size;
+			}
+
+			// Runtime arrays don't contribute to the static size of their block
+			default:
+				return 0;
+		}
+	}
+
+	auto SpirvReflector::GetEntryPoint(std::uint32_t entryPointId) -> EntryPoint&
+	{
+		for (EntryPoint& entryPoint : m_reflection->entryPoints)
+		{
+			if (entryPoint.id == entryPointId)
+				return entryPoint;
+		}
+
+		throw std::runtime_error("invalid SPIR-V: unknown entry point %" + std::to_string(entryPointId));
+	}
+
+	auto SpirvReflector::GetIdInfo(std::uint32_t id) -> IdInfo&
+	{
+		if (id >= m_ids.size())
+			throw std::runtime_error("invalid SPIR-V: id %" + std::to_string(id) + " is out of bounds");
+
+		return m_ids[id];
+	}
+
+	auto SpirvReflector::GetIdInfo(std::uint32_t id) const -> const IdInfo&
+	{
+		if (id >= m_ids.size())
+			throw std::runtime_error("invalid SPIR-V: id %" + std::to_string(id) + " is out of bounds");
+
+		return m_ids[id];
+	}
+
+	const std::uint32_t* SpirvReflector::GetInstruction(std::uint32_t id, std::size_t minWordCount) const
+	{
+		const std::uint32_t* instruction = GetIdInfo(id).instruction;
+		if (!instruction)
+			throw std::runtime_error("invalid SPIR-V: %" + std::to_string(id) + " is not a type or constant");
+
+		if (GetWordCount(instruction) < minWordCount)
+			throw std::runtime_error("invalid SPIR-V: instruction is missing operands");
+
+		return instruction;
+	}
+
+	auto SpirvReflector::GetMemberInfo(std::uint32_t structId, std::uint32_t memberIndex) -> MemberInfo&
+	{
+		IdInfo& structInfo = GetIdInfo(structId);
+
+		// Members of a struct are chained, most recently registered first
+		for (std::uint32_t i = structInfo.firstMember; i != InvalidIndex; i = m_members[i].nextMember)
+		{
+			if (m_members[i].index == memberIndex)
+				return m_members[i];
+		}
+
+		MemberInfo& memberInfo = m_members.emplace_back();
+		memberInfo.index = memberIndex;
+		memberInfo.nextMember = structInfo.firstMember;
+
+		structInfo.firstMember = static_cast<std::uint32_t>(m_members.size() - 1);
+
+		return memberInfo;
+	}
+
+	auto SpirvReflector::FindMemberInfo(std::uint32_t structId, std::uint32_t memberIndex) const -> const MemberInfo*
+	{
+		for (std::uint32_t i = GetIdInfo(structId).firstMember; i != InvalidIndex; i = m_members[i].nextMember)
+		{
+			if (m_members[i].index == memberIndex)
+				return &m_members[i];
+		}
+
+		return nullptr;
+	}
+
+	std::string SpirvReflector::GetName(std::uint32_t id) const
+	{
+		const std::uint32_t* nameInstruction = GetIdInfo(id).nameInstruction;
+		if (!nameInstruction)
+			return {};
+
+		return DecodeString(&nameInstruction[2], nameInstruction + GetWordCount(nameInstruction));
+	}
+
+	Vector3u32 SpirvReflector::ResolveConstantVector(const std::uint32_t* constantIds) const
+	{
+		return Vector3u32(ResolveConstantValue(constantIds[0]), ResolveConstantValue(constantIds[1]), ResolveConstantValue(constantIds[2]));
+	}
+
+	std::uint32_t SpirvReflector::ResolveConstantValue(std::uint32_t constantId) const
+	{
+		const std::uint32_t* constant = GetInstruction(constantId, 4);
+
+		SpirvOp op = GetOpcode(constant);
+		if (op != SpirvOp::OpConstant && op != SpirvOp::OpSpecConstant)
+			throw std::runtime_error("invalid SPIR-V: %" + std::to_string(constantId) + " is not a scalar constant");
+
+		// Specialization constants are resolved to their default value
+		return constant[3];
+	}
+}
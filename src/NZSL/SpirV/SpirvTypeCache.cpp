@@ -0,0 +1,167 @@
+// Copyright (C) 2025 Jérôme "SirLynix" Leclercq (lynix680@gmail.com)
+// This file is part of the "Nazara Shading Language" project
+// For conditions of distribution and use, see copyright notice in Config.hpp
+
+#include <NZSL/SpirV/SpirvTypeCache.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <NazaraUtils/Hash.hpp>
+#include <cassert>
+#include <mutex>
+
+namespace nzsl
+{
+	namespace
+	{
+		template<typename T>
+		std::uint64_t ToConstantBits(T value)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+				return (value) ? 1 : 0;
+			else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, std::int32_t>)
+				return Nz::BitCast<std::uint32_t>(value);
+			else if constexpr (std::is_same_v<T, double>)
+				return Nz::BitCast<std::uint64_t>(value);
+			else if constexpr (std::is_same_v<T, std::uint32_t>)
+				return value;
+			else
+				static_assert(Nz::AlwaysFalse<T>(), "unhandled type");
+		}
+
+		// Returns no hash for types which can't be cached (depending on structs, modules or functions of the module)
+		std::optional<std::size_t> HashCacheableType(const Ast::ExpressionType& type)
+		{
+			return std::visit([](auto&& arg) -> std::optional<std::size_t>
+			{
+				using T = std::decay_t<decltype(arg)>;
+
+				if constexpr (std::is_same_v<T, Ast::NoType>)
+					return 0;
+				else if constexpr (std::is_same_v<T, Ast::PrimitiveType>)
+					return Nz::HashCombine(arg);
+				else if constexpr (std::is_same_v<T, Ast::MatrixType>)
+					return Nz::HashCombine(arg.columnCount, arg.rowCount, arg.type);
+				else if constexpr (std::is_same_v<T, Ast::SamplerType>)
+					return Nz::HashCombine(arg.dim, arg.sampledType, arg.depth);
+				else if constexpr (std::is_same_v<T, Ast::TextureType>)
+					return Nz::HashCombine(arg.accessPolicy, arg.format, arg.dim, arg.baseType);
+				else if constexpr (std::is_same_v<T, Ast::VectorType>)
+					return Nz::HashCombine(arg.componentCount, arg.type);
+				else if constexpr (std::is_same_v<T, Ast::ArrayType> || std::is_same_v<T, Ast::DynArrayType>)
+				{
+					assert(arg.containedType);
+					std::optional<std::size_t> containedHash = HashCacheableType(arg.containedType->type);
+					if (!containedHash)
+						return std::nullopt;
+
+					std::size_t h = *containedHash;
+					if constexpr (std::is_same_v<T, Ast::ArrayType>)
+						Nz::HashCombine(h, arg.length);
+
+					return h;
+				}
+				else
+					return std::nullopt;
+			}, type);
+		}
+	}
+
+	void SpirvTypeCache::Clear()
+	{
+		std::unique_lock lock(m_mutex);
+		m_constants.clear();
+		m_types.clear();
+	}
+
+	std::size_t SpirvTypeCache::GetEntryCount() const
+	{
+		std::shared_lock lock(m_mutex);
+		return m_constants.size() + m_types.size();
+	}
+
+	auto SpirvTypeCache::FindConstant(const ConstantKey& key) const -> SpirvConstantCache::ConstantPtr
+	{
+		std::shared_lock lock(m_mutex);
+
+		auto it = m_constants.find(key);
+		if (it == m_constants.end())
+			return nullptr;
+
+		return it->second;
+	}
+
+	auto SpirvTypeCache::FindType(const TypeKey& key) const -> SpirvConstantCache::TypePtr
+	{
+		std::shared_lock lock(m_mutex);
+
+		auto it = m_types.find(key);
+		if (it == m_types.end())
+			return nullptr;
+
+		return it->second;
+	}
+
+	void SpirvTypeCache::RegisterConstant(ConstantKey key, SpirvConstantCache::ConstantPtr constant)
+	{
+		assert(constant);
+
+		// If another generation registered the same constant concurrently, the first one is kept
+		std::unique_lock lock(m_mutex);
+		m_constants.emplace(std::move(key), std::move(constant));
+	}
+
+	void SpirvTypeCache::RegisterType(TypeKey key, SpirvConstantCache::TypePtr type)
+	{
+		assert(type);
+
+		std::unique_lock lock(m_mutex);
+		m_types.emplace(std::move(key), std::move(type));
+	}
+
+	auto SpirvTypeCache::BuildConstantKey(const Ast::ConstantSingleValue& value) -> std::optional<ConstantKey>
+	{
+		return std::visit([&](auto&& arg) -> std::optional<ConstantKey>
+		{
+			using T = std::decay_t<decltype(arg)>;
+
+			if constexpr (std::is_same_v<T, Ast::NoValue> || std::is_same_v<T, std::string>)
+				return std::nullopt;
+			else
+			{
+				ConstantKey key;
+				key.valueIndex = value.index();
+				key.components.fill(0);
+
+				if constexpr (IsVector_v<T>)
+				{
+					for (std::size_t i = 0; i < T::Dimensions; ++i)
+						key.components[i] = ToConstantBits(arg[i]);
+				}
+				else
+					key.components[0] = ToConstantBits(arg);
+
+				return key;
+			}
+		}, value);
+	}
+
+	auto SpirvTypeCache::BuildTypeKey(const Ast::ExpressionType& type, const std::optional<StructLayout>& blockLayout) -> std::optional<TypeKey>
+	{
+		std::optional<std::size_t> typeHash = HashCacheableType(type);
+		if (!typeHash)
+			return std::nullopt;
+
+		TypeKey key;
+		key.type = type;
+		if (std::holds_alternative<Ast::ArrayType>(type) || std::holds_alternative<Ast::DynArrayType>(type))
+			key.blockLayout = blockLayout;
+
+		key.hash = Nz::HashCombine(type.index(), *typeHash, key.blockLayout);
+
+		return key;
+	}
+
+	std::size_t SpirvTypeCache::ConstantKeyHasher::operator()(const ConstantKey& key) const
+	{
+		return Nz::HashCombine(key.valueIndex, key.components[0], key.components[1], key.components[2], key.components[3]);
+	}
+}
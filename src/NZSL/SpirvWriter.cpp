@@ -8,8 +8,7 @@
 #include <NazaraUtils/PathUtils.hpp>
 #include <NZSL/Enums.hpp>
 #include <NZSL/Parser.hpp>
-#include <NZSL/Ast/ConstantPropagationVisitor.hpp>
-#include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/PassManager.hpp>
 #include <NZSL/Ast/RecursiveVisitor.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <NZSL/Lang/LangData.hpp>
@@ -18,11 +17,13 @@
 #include <NZSL/SpirV/SpirvConstantCache.hpp>
 #include <NZSL/SpirV/SpirvData.hpp>
 #include <NZSL/SpirV/SpirvGenData.hpp>
+#include <NZSL/SpirV/SpirvOptimizer.hpp>
 #include <NZSL/SpirV/SpirvSection.hpp>
 #include <fmt/format.h>
 #include <frozen/unordered_map.h>
 #include <tsl/ordered_map.h>
 #include <tsl/ordered_set.h>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <stdexcept>
@@ -58,6 +59,7 @@ namespace nzsl
 
 			using BuiltinDecoration = tsl::ordered_map<std::uint32_t, SpirvBuiltIn>;
 			using ConstantVariables = std::unordered_map<std::size_t /*constIndex*/, SpirvVariable /*variable*/>;
+			using SpecConstantContainer = std::unordered_map<std::size_t /*constIndex*/, std::uint32_t /*id*/>;
 			using InterpolationDecoration = tsl::ordered_map<std::uint32_t, SpirvDecoration>;
 			using LocationDecoration = tsl::ordered_map<std::uint32_t, std::uint32_t>;
 			using ExtInstList = tsl::ordered_set<std::string>;
@@ -424,6 +426,31 @@ namespace nzsl
 				m_funcIndex.reset();
 			}
 
+			void Visit(Ast::DeclareOptionStatement& node) override
+			{
+				// Only options kept by the sanitizer as specialization constants are still declared at this point
+				// (their default value isn't visited as it's only used by the specialization constant declaration)
+				if (!node.optIndex)
+					return;
+
+				Ast::OptionHash optionHash = Ast::HashOption(node.optName.data());
+				if (m_writer.m_environment.specializationConstantOptions.count(optionHash) == 0)
+					return;
+
+				if (!node.defaultValue || node.defaultValue->GetType() != Ast::NodeType::ConstantValueExpression)
+					throw std::runtime_error("specialization constant " + node.optName + " has no default value");
+
+				auto& defaultValueExpr = static_cast<Ast::ConstantValueExpression&>(*node.defaultValue);
+
+				SpirvConstantCache::SpecConstant specConstant;
+				specConstant.debugName = node.optName;
+				specConstant.defaultValue = m_constantCache.BuildConstant(defaultValueExpr.value);
+				specConstant.specId = optionHash;
+
+				specConstants[*node.optIndex] = m_constantCache.Register(std::move(specConstant));
+				specConstantIds[node.optName] = optionHash;
+			}
+
 			void Visit(Ast::DeclareStructStatement& node) override
 			{
 				RecursiveVisitor::Visit(node);
@@ -581,6 +608,8 @@ namespace nzsl
 			InterpolationDecoration interpolationDecorations;
 			LocationDecoration locationDecorations;
 			StructContainer declaredStructs;
+			SpecConstantContainer specConstants;
+			std::unordered_map<std::string, std::uint32_t> specConstantIds;
 			tsl::ordered_set<SpirvCapability> spirvCapabilities;
 
 		private:
@@ -605,7 +634,7 @@ namespace nzsl
 
 		tsl::ordered_map<std::size_t, SpirvAstVisitor::FuncData> funcs;
 		tsl::ordered_map<std::string, std::uint32_t> extensionInstructionSet;
-		std::unordered_map<std::shared_ptr<const std::string>, std::uint32_t> sourceFiles;
+		std::unordered_map<SourceFileId, std::uint32_t> sourceFiles;
 		std::vector<std::uint32_t> resultIds;
 		std::uint32_t nextResultId = 1;
 		SourceLocation sourceLocation;
@@ -627,6 +656,16 @@ namespace nzsl
 
 	std::vector<std::uint32_t> SpirvWriter::Generate(const Ast::Module& module, const States& states)
 	{
+		std::vector<std::uint32_t> output;
+		Generate(module, output, states);
+
+		return output;
+	}
+
+	void SpirvWriter::Generate(const Ast::Module& module, std::vector<std::uint32_t>& output, const States& states)
+	{
+		m_specializationConstantIds.clear();
+
 		Ast::ModulePtr sanitizedModule;
 		const Ast::Module* targetModule;
 		if (!states.sanitized)
@@ -634,6 +673,7 @@ namespace nzsl
 			Ast::SanitizeVisitor::Options options = GetSanitizeOptions();
 			options.optionValues = states.optionValues;
 			options.moduleResolver = states.shaderModuleResolver;
+			options.specializationConstantOptions = m_environment.specializationConstantOptions;
 
 			sanitizedModule = Ast::Sanitize(module, options);
 			targetModule = sanitizedModule.get();
@@ -643,12 +683,15 @@ namespace nzsl
 
 		if (states.optimize)
 		{
-			sanitizedModule = Ast::PropagateConstants(*targetModule);
-			
 			Ast::DependencyCheckerVisitor::Config dependencyConfig;
 			dependencyConfig.usedShaderStages = ShaderStageType_All;
+			dependencyConfig.specializationConstantOptions = m_environment.specializationConstantOptions;
 
-			sanitizedModule = Ast::EliminateUnusedPass(*sanitizedModule, dependencyConfig);
+			// Reuse our sanitized module if we have one, so passes can work on it in place
+			if (sanitizedModule)
+				sanitizedModule = Ast::Optimize(std::move(sanitizedModule), dependencyConfig);
+			else
+				sanitizedModule = Ast::Optimize(*targetModule, dependencyConfig);
 
 			targetModule = sanitizedModule.get();
 		}
@@ -661,6 +704,8 @@ namespace nzsl
 		m_currentState = &state;
 		NAZARA_DEFER({ m_currentState = nullptr; });
 
+		state.constantTypeCache.SetTypeCache(m_environment.typeCache);
+
 		// Register all extended instruction sets
 		PreVisitor previsitor(*this, state.constantTypeCache);
 		
@@ -687,6 +732,7 @@ namespace nzsl
 		targetModule->rootNode->Visit(previsitor);
 
 		m_currentState->previsitor = &previsitor;
+		m_specializationConstantIds = previsitor.specConstantIds;
 
 		for (const std::string& extInst : previsitor.extInsts)
 			state.extensionInstructionSet[extInst] = AllocateResultId();
@@ -708,14 +754,14 @@ namespace nzsl
 
 				std::string source;
 				std::uint32_t fileId = 0;
-				if (rootLocation.file)
+				if (rootLocation.HasFile())
 				{
-					fileId = m_currentState->constantTypeCache.Register(*rootLocation.file);
-					m_currentState->sourceFiles.emplace(rootLocation.file, fileId);
+					fileId = m_currentState->constantTypeCache.Register(std::string(rootLocation.GetFilePath()));
+					m_currentState->sourceFiles.emplace(rootLocation.fileId, fileId);
 
 					if (states.debugLevel >= DebugLevel::Full)
 					{
-						std::ifstream file(Nz::Utf8Path(*rootLocation.file));
+						std::ifstream file(Nz::Utf8Path(rootLocation.GetFilePath()));
 						if (file)
 						{
 							std::string line;
@@ -814,14 +860,16 @@ namespace nzsl
 				m_currentState->debugInfo.Append(SpirvOp::OpName, func.funcId, func.name);
 		}
 
-		std::vector<std::uint32_t> ret;
-		MergeSections(ret, state.header);
-		MergeSections(ret, state.debugInfo);
-		MergeSections(ret, state.annotations);
-		MergeSections(ret, state.constants);
-		MergeSections(ret, state.instructions);
+		std::size_t moduleOffset = output.size();
+		MergeSections(output, { &state.header, &state.debugInfo, &state.annotations, &state.constants, &state.instructions });
+
+		if (m_environment.optimizeBinary)
+		{
+			std::vector<std::uint32_t> optimizedModule = SpirvOptimizer{}.Optimize(output.data() + moduleOffset, output.size() - moduleOffset);
 
-		return ret;
+			output.resize(moduleOffset);
+			output.insert(output.end(), optimizedModule.begin(), optimizedModule.end());
+		}
 	}
 
 	const SpirvVariable& SpirvWriter::GetConstantVariable(std::size_t constIndex) const
@@ -1031,15 +1079,26 @@ namespace nzsl
 		return m_currentState->constantTypeCache.GetId(*m_currentState->constantTypeCache.BuildPointerType(type, storageClass));
 	}
 
-	std::uint32_t SpirvWriter::GetSourceFileId(const std::shared_ptr<const std::string>& filepathPtr)
+	std::uint32_t SpirvWriter::GetSourceFileId(SourceFileId sourceFileId)
 	{
-		auto it = m_currentState->sourceFiles.find(filepathPtr);
+		auto it = m_currentState->sourceFiles.find(sourceFileId);
 		if (it == m_currentState->sourceFiles.end())
 			throw std::runtime_error("unknown source filepath");
 
 		return it->second;
 	}
 
+	std::optional<std::uint32_t> SpirvWriter::GetSpecConstantId(std::size_t constIndex) const
+	{
+		const auto& specConstants = m_currentState->previsitor->specConstants;
+
+		auto it = specConstants.find(constIndex);
+		if (it == specConstants.end())
+			return std::nullopt;
+
+		return it->second;
+	}
+
 	std::uint32_t SpirvWriter::GetTypeId(const SpirvConstantCache::Type& type) const
 	{
 		return m_currentState->constantTypeCache.GetId(type);
@@ -1086,12 +1145,21 @@ namespace nzsl
 		return m_currentState->constantTypeCache.Register(*m_currentState->constantTypeCache.BuildType(type));
 	}
 
-	void SpirvWriter::MergeSections(std::vector<std::uint32_t>& output, const SpirvSection& from)
+	void SpirvWriter::MergeSections(std::vector<std::uint32_t>& output, std::initializer_list<const SpirvSection*> sections)
 	{
-		const std::vector<std::uint32_t>& bytecode = from.GetBytecode();
+		// Allocate the output once so each section is only copied once, growing geometrically as modules may be appended to the same output
+		std::size_t wordCount = 0;
+		for (const SpirvSection* section : sections)
+			wordCount += section->GetBytecode().size();
 
-		std::size_t prevSize = output.size();
-		output.resize(prevSize + bytecode.size());
-		std::copy(bytecode.begin(), bytecode.end(), output.begin() + prevSize);
+		std::size_t requiredCapacity = output.size() + wordCount;
+		if (output.capacity() < requiredCapacity)
+			output.reserve(std::max(requiredCapacity, output.capacity() * 2));
+
+		for (const SpirvSection* section : sections)
+		{
+			const std::vector<std::uint32_t>& bytecode = section->GetBytecode();
+			output.insert(output.end(), bytecode.begin(), bytecode.end());
+		}
 	}
 }
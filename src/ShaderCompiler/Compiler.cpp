@@ -12,6 +12,7 @@
 #include <NZSL/Lang/Errors.hpp>
 #include <NZSL/Lexer.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/PermutationCompiler.hpp>
 #include <NZSL/SpirV/SpirvPrinter.hpp>
 #include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Serializer.hpp>
@@ -26,7 +27,9 @@
 #include <cassert>
 #include <chrono>
 #include <fstream>
+#include <map>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace nzslc
 {
@@ -40,6 +43,36 @@ namespace nzslc
 			return str.compare(str.size() - s.size(), s.size(), s.data()) == 0;
 		}
 
+		std::string_view GetGlslExtension(nzsl::ShaderStageType stageType)
+		{
+			switch (stageType)
+			{
+				case nzsl::ShaderStageType::Compute:  return "comp.glsl";
+				case nzsl::ShaderStageType::Fragment: return "frag.glsl";
+				case nzsl::ShaderStageType::Vertex:   return "vert.glsl";
+			}
+
+			throw std::runtime_error("unexpected shader stage");
+		}
+
+		nzsl::Ast::ConstantValue ToOptionValue(const std::string& optionName, const nzsl::Ast::ExpressionType& optionType, const nlohmann::ordered_json& valueDoc)
+		{
+			if (nzsl::Ast::IsPrimitiveType(optionType))
+			{
+				switch (std::get<nzsl::Ast::PrimitiveType>(optionType))
+				{
+					case nzsl::Ast::PrimitiveType::Boolean: return valueDoc.get<bool>();
+					case nzsl::Ast::PrimitiveType::Float32: return valueDoc.get<float>();
+					case nzsl::Ast::PrimitiveType::Float64: return valueDoc.get<double>();
+					case nzsl::Ast::PrimitiveType::Int32:   return valueDoc.get<std::int32_t>();
+					case nzsl::Ast::PrimitiveType::UInt32:  return valueDoc.get<std::uint32_t>();
+					case nzsl::Ast::PrimitiveType::String:  break;
+				}
+			}
+
+			throw std::runtime_error(fmt::format("option {} has type {} which cannot be given a permutation value", optionName, nzsl::Ast::ToString(optionType)));
+		}
+
 		constexpr auto s_debugLevels = frozen::make_unordered_map<frozen::string, nzsl::DebugLevel>({
 			{ "full",    nzsl::DebugLevel::Full },
 			{ "minimal", nzsl::DebugLevel::Minimal },
@@ -117,7 +150,7 @@ namespace nzslc
 				try
 				{
 					// Retrieve line
-					std::string sourceContent = ReadSourceFileContent(*errorLocation.file);
+					std::string sourceContent = ReadSourceFileContent(errorLocation.GetFilePath());
 
 					std::size_t lineStartOffset = 0;
 					if (errorLocation.startLine > 1)
@@ -169,8 +202,8 @@ namespace nzslc
 			{
 				// VS requires absolute path
 				std::filesystem::path fullPath;
-				if (errorLocation.file)
-					fullPath = std::filesystem::absolute(*errorLocation.file);
+				if (errorLocation.HasFile())
+					fullPath = std::filesystem::absolute(errorLocation.GetFilePath());
 
 				fmt::print(stderr, "{}({},{}): error {}: {}\n", Nz::PathToString(fullPath), errorLocation.startLine, errorLocation.startColumn, ToString(error.GetErrorType()), error.GetErrorMessage());
 			}
@@ -227,6 +260,13 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 			("optimize", "Optimize shader code")
 			("p,partial", "Allow partial compilation");
 
+		options.add_options("permutations")
+			("permutations", R"(Compile every combination of option values from a JSON file (ex: { "UseColor": [false, true], "Factor": [1.0, 2.0] }) for glsl and spv formats.
+Identical outputs are written once, a .permutations.json file maps each variant to its file.
+)", cxxopts::value<std::string>(), "path")
+			("permutation-prune", "Compile variants only differing by options which can't affect an output once (based on an analysis of the partially compiled shader)")
+			("permutation-workers", "Number of threads compiling permutations (0 for one per hardware thread)", cxxopts::value<unsigned int>()->default_value("0"), "count");
+
 		options.add_options("glsl output")
 			("gl-es", "Generate GLSL ES instead of GLSL", cxxopts::value<bool>()->default_value("false"))
 			("gl-version", "OpenGL version (310 being 3.1)", cxxopts::value<std::uint32_t>(), "version")
@@ -235,6 +275,7 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 			("gl-bindingmap", "Add binding support (generates a .binding.json mapping file)");
 
 		options.add_options("spirv output")
+			("spv-optimize", "Remove unused and duplicate SPIR-V types and constants and compact ids")
 			("spv-version", "SPIR-V version (110 being 1.1)", cxxopts::value<std::uint32_t>(), "version");
 
 		options.parse_positional("input");
@@ -243,66 +284,7 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		return options;
 	}
 
-	nzsl::ShaderWriter::States Compiler::BuildWriterOptions()
-	{
-		nzsl::ShaderWriter::States states;
-		states.optimize = (m_options.count("optimize") > 0);
-
-		if (m_options.count("debug-level"))
-		{
-			const std::string& debugLevelStr = m_options["debug-level"].as<std::string>();
-
-			auto it = s_debugLevels.find(frozen::string(debugLevelStr));
-			if (it == s_debugLevels.end())
-				throw cxxopts::exceptions::specification("invalid debug-level " + debugLevelStr);
-
-			states.debugLevel = it->second;
-		}
-
-		return states;
-	}
-
-	void Compiler::Compile()
-	{
-		using namespace std::literals;
-
-		// if no output path has been provided, output in the same folder as the input file
-		std::filesystem::path outputFilePath = m_outputPath;
-		if (outputFilePath.empty())
-			outputFilePath = m_inputFilePath.parent_path();
-
-		outputFilePath /= m_inputFilePath.filename();
-
-		const std::vector<std::string>& options = m_options["compile"].as<std::vector<std::string>>();
-		for (std::string_view outputType : options)
-		{
-			// TODO: Don't compile multiple times unnecessary (ex: glsl and glsl-header)
-			if (m_outputToStdout && options.size() > 1)
-				fmt::print("-- {}\n", outputType);
-
-			m_outputHeader = EndsWith(outputType, "-header");
-			if (m_outputHeader)
-				outputType.remove_suffix(7);
-
-			if (outputType == "nzsl")
-				Step("Compile to NZSL", &Compiler::CompileToNZSL, outputFilePath, *m_shaderModule);
-			else if (outputType == "nzslb")
-				Step("Compile to NZSLB", &Compiler::CompileToNZSLB, outputFilePath, *m_shaderModule);
-			else if (outputType == "spv")
-				Step("Compile to SPIR-V", &Compiler::CompileToSPV, outputFilePath, *m_shaderModule, false);
-			else if (outputType == "spv-dis")
-				Step("Compile to textual SPIR-V", &Compiler::CompileToSPV, outputFilePath, *m_shaderModule, true);
-			else if (outputType == "glsl")
-				Step("Compile to GLSL", &Compiler::CompileToGLSL, outputFilePath, *m_shaderModule);
-			else
-			{
-				fmt::print("Unknown format {}, ignoring\n", outputType);
-				continue;
-			}
-		}
-	}
-
-	void Compiler::CompileToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	nzsl::GlslWriter::Environment Compiler::BuildGlslEnvironment()
 	{
 		nzsl::GlslWriter::Environment env;
 		if (m_options.count("gl-es") > 0)
@@ -324,11 +306,15 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 			env.glMinorVersion = (version % 100) / 10;
 		}
 
+		return env;
+	}
+
+	nzsl::GlslWriter::Parameters Compiler::BuildGlslParameters(const std::filesystem::path& outputPath, const nzsl::Ast::Module& module)
+	{
 		nzsl::GlslWriter::Parameters parameters;
 		if (m_options.count("gl-bindingmap") > 0)
 		{
 			unsigned int glslBinding = 0;
-			nlohmann::ordered_json bindingArray;
 
 			nzsl::Ast::ReflectVisitor::Callbacks callbacks;
 			callbacks.onExternalDeclaration = [&](const nzsl::Ast::DeclareExternalStatement& extDecl)
@@ -346,7 +332,9 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 				{
 					if (IsPushConstantType(extVar.type.GetResultingValue()))
 					{
-						parameters.pushConstantBinding = glslBinding++;
+						if (!parameters.pushConstantBinding)
+							parameters.pushConstantBinding = glslBinding++;
+
 						continue;
 					}
 
@@ -365,36 +353,143 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 
 					bindingIndex = extVar.bindingIndex.GetResultingValue();
 
+					// Externals may declare the same binding, it's only mapped once
 					std::uint64_t binding = bindingSet << 32 | bindingIndex;
-					parameters.bindingMapping.emplace(binding, glslBinding);
-
-					nlohmann::ordered_json& bindingDoc = bindingArray.emplace_back();
-					bindingDoc["set"] = bindingSet;
-					bindingDoc["binding"] = bindingIndex;
-					bindingDoc["glsl_binding"] = glslBinding;
-
-					glslBinding++;
+					if (parameters.bindingMapping.emplace(binding, glslBinding).second)
+						glslBinding++;
 				}
 			};
 
 			nzsl::Ast::ReflectVisitor reflectVisitor;
 			reflectVisitor.Reflect(module, callbacks);
 
-			if (!bindingArray.empty())
-			{
-				nlohmann::ordered_json finalDoc;
-				finalDoc["bindings"] = std::move(bindingArray);
+			OutputGlslBindingMap(outputPath, parameters);
+		}
+
+		return parameters;
+	}
+
+	void Compiler::OutputGlslBindingMap(const std::filesystem::path& outputPath, const nzsl::GlslWriter::Parameters& parameters)
+	{
+		if (parameters.bindingMapping.empty())
+			return;
+
+		// Bindings are listed in GLSL binding order
+		std::map<unsigned int, std::uint64_t> bindingsByGlslBinding;
+		for (auto&& [binding, glslBinding] : parameters.bindingMapping)
+			bindingsByGlslBinding.emplace(glslBinding, binding);
+
+		nlohmann::ordered_json bindingArray;
+		for (auto&& [glslBinding, binding] : bindingsByGlslBinding)
+		{
+			nlohmann::ordered_json& bindingDoc = bindingArray.emplace_back();
+			bindingDoc["set"] = binding >> 32;
+			bindingDoc["binding"] = binding & 0xFFFFFFFF;
+			bindingDoc["glsl_binding"] = glslBinding;
+		}
+
+		nlohmann::ordered_json finalDoc;
+		finalDoc["bindings"] = std::move(bindingArray);
+
+		if (parameters.pushConstantBinding.has_value())
+			finalDoc["push_constant_binding"] = *parameters.pushConstantBinding;
 
-				if (parameters.pushConstantBinding.has_value())
-					finalDoc["push_constant_binding"] = *parameters.pushConstantBinding;
+		std::string bindingStr = finalDoc.dump(4);
 
-				std::string bindingStr = finalDoc.dump(4);
+		std::filesystem::path bindingOutputPath = outputPath;
+		bindingOutputPath.replace_extension("glsl.binding.json");
+		OutputFile(std::move(bindingOutputPath), bindingStr.data(), bindingStr.size(), true);
+	}
 
-				std::filesystem::path bindingOutputPath = outputPath;
-				bindingOutputPath.replace_extension("glsl.binding.json");
-				OutputFile(std::move(bindingOutputPath), bindingStr.data(), bindingStr.size(), true);
+	nzsl::SpirvWriter::Environment Compiler::BuildSpirvEnvironment()
+	{
+		nzsl::SpirvWriter::Environment env;
+		if (m_options.count("spv-version"))
+		{
+			constexpr std::uint32_t maxVersion = nzsl::SpirvMajorVersion * 100 + nzsl::SpirvMinorVersion * 10;
+
+			std::uint32_t version = m_options["spv-version"].as<std::uint32_t>();
+			if (version < 100 || version > maxVersion)
+				throw std::runtime_error(fmt::format("invalid SPIR-V version (must be between 100 and {})", maxVersion));
+
+			env.spvMajorVersion = version / 100;
+			env.spvMinorVersion = (version % 100) / 10;
+		}
+
+		env.optimizeBinary = (m_options.count("spv-optimize") > 0);
+
+		return env;
+	}
+
+	nzsl::ShaderWriter::States Compiler::BuildWriterOptions()
+	{
+		nzsl::ShaderWriter::States states;
+		states.optimize = (m_options.count("optimize") > 0);
+
+		if (m_options.count("debug-level"))
+		{
+			const std::string& debugLevelStr = m_options["debug-level"].as<std::string>();
+
+			auto it = s_debugLevels.find(frozen::string(debugLevelStr));
+			if (it == s_debugLevels.end())
+				throw cxxopts::exceptions::specification("invalid debug-level " + debugLevelStr);
+
+			states.debugLevel = it->second;
+		}
+
+		return states;
+	}
+
+	void Compiler::Compile()
+	{
+		using namespace std::literals;
+
+		// if no output path has been provided, output in the same folder as the input file
+		std::filesystem::path outputFilePath = m_outputPath;
+		if (outputFilePath.empty())
+			outputFilePath = m_inputFilePath.parent_path();
+
+		outputFilePath /= m_inputFilePath.filename();
+
+		const std::vector<std::string>& options = m_options["compile"].as<std::vector<std::string>>();
+		if (m_options.count("permutations") > 0)
+		{
+			Step("Compile permutations", &Compiler::CompilePermutations, outputFilePath, options);
+			return;
+		}
+
+		for (std::string_view outputType : options)
+		{
+			// TODO: Don't compile multiple times unnecessary (ex: glsl and glsl-header)
+			if (m_outputToStdout && options.size() > 1)
+				fmt::print("-- {}\n", outputType);
+
+			m_outputHeader = EndsWith(outputType, "-header");
+			if (m_outputHeader)
+				outputType.remove_suffix(7);
+
+			if (outputType == "nzsl")
+				Step("Compile to NZSL", &Compiler::CompileToNZSL, outputFilePath, *m_shaderModule);
+			else if (outputType == "nzslb")
+				Step("Compile to NZSLB", &Compiler::CompileToNZSLB, outputFilePath, *m_shaderModule);
+			else if (outputType == "spv")
+				Step("Compile to SPIR-V", &Compiler::CompileToSPV, outputFilePath, *m_shaderModule, false);
+			else if (outputType == "spv-dis")
+				Step("Compile to textual SPIR-V", &Compiler::CompileToSPV, outputFilePath, *m_shaderModule, true);
+			else if (outputType == "glsl")
+				Step("Compile to GLSL", &Compiler::CompileToGLSL, outputFilePath, *m_shaderModule);
+			else
+			{
+				fmt::print("Unknown format {}, ignoring\n", outputType);
+				continue;
 			}
 		}
+	}
+
+	void Compiler::CompileToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module)
+	{
+		nzsl::GlslWriter::Environment env = BuildGlslEnvironment();
+		nzsl::GlslWriter::Parameters parameters = BuildGlslParameters(outputPath, module);
 
 		nzsl::GlslWriter writer;
 		writer.SetEnv(env);
@@ -425,12 +520,7 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 			}
 
 			std::filesystem::path filePath = outputPath;
-			switch (entryType)
-			{
-				case nzsl::ShaderStageType::Compute:  filePath.replace_extension("comp.glsl"); break;
-				case nzsl::ShaderStageType::Fragment: filePath.replace_extension("frag.glsl"); break;
-				case nzsl::ShaderStageType::Vertex:   filePath.replace_extension("vert.glsl"); break;
-			}
+			filePath.replace_extension(GetGlslExtension(entryType));
 
 			OutputFile(std::move(filePath), output.code.data(), output.code.size());
 		}
@@ -474,23 +564,175 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		OutputFile(std::move(outputPath), data.data(), data.size());
 	}
 
-	void Compiler::CompileToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual)
+	void Compiler::CompilePermutations(std::filesystem::path outputPath, const std::vector<std::string>& outputTypes)
 	{
-		nzsl::SpirvWriter::Environment env;
-		if (m_options.count("spv-version"))
+		if (m_outputToStdout)
+			throw std::runtime_error("permutations cannot be output to stdout");
+
+		std::filesystem::path matrixPath = Nz::Utf8Path(m_options["permutations"].as<std::string>());
+		nlohmann::ordered_json matrixDoc = nlohmann::ordered_json::parse(ReadSourceFileContent(matrixPath));
+		if (!matrixDoc.is_object())
+			throw std::runtime_error(fmt::format("{} must contain an object associating options to their values", Nz::PathToString(matrixPath)));
+
+		std::unordered_map<std::string, nzsl::Ast::ExpressionType> optionTypes;
+		nzsl::ShaderStageTypeFlags entryTypes;
+
+		nzsl::Ast::ReflectVisitor::Callbacks callbacks;
+		callbacks.onEntryPointDeclaration = [&](nzsl::ShaderStageType shaderStage, const std::string& /*functionName*/)
 		{
-			constexpr std::uint32_t maxVersion = nzsl::SpirvMajorVersion * 100 + nzsl::SpirvMinorVersion * 10;
+			entryTypes |= shaderStage;
+		};
 
-			std::uint32_t version = m_options["spv-version"].as<std::uint32_t>();
-			if (version < 100 || version > maxVersion)
-				throw std::runtime_error(fmt::format("invalid SPIR-V version (must be between 100 and {})", maxVersion));
+		callbacks.onOptionDeclaration = [&](const nzsl::Ast::DeclareOptionStatement& optionDecl)
+		{
+			if (optionDecl.optType.IsResultingValue())
+				optionTypes.emplace(optionDecl.optName, optionDecl.optType.GetResultingValue());
+		};
 
-			env.spvMajorVersion = version / 100;
-			env.spvMinorVersion = (version % 100) / 10;
+		nzsl::Ast::ReflectVisitor reflectVisitor;
+		reflectVisitor.Reflect(*m_shaderModule, callbacks);
+
+		nzsl::PermutationCompiler::Parameters parameters;
+		parameters.states = BuildWriterOptions();
+		parameters.states.shaderModuleResolver = m_moduleResolver;
+
+		if (m_options.count("permutation-workers") > 0)
+			parameters.workerCount = m_options["permutation-workers"].as<unsigned int>();
+
+		parameters.pruneIrrelevantOptions = (m_options.count("permutation-prune") > 0);
+
+		for (const auto& [optionName, valuesDoc] : matrixDoc.items())
+		{
+			auto it = optionTypes.find(optionName);
+			if (it == optionTypes.end())
+				throw std::runtime_error(fmt::format("{} is not an option of the shader", optionName));
+
+			if (!valuesDoc.is_array() || valuesDoc.empty())
+				throw std::runtime_error(fmt::format("option {} must be given a non-empty array of values", optionName));
+
+			auto& optionValues = parameters.optionMatrix.emplace_back();
+			optionValues.optionName = optionName;
+			for (const auto& valueDoc : valuesDoc)
+				optionValues.values.push_back(ToOptionValue(optionName, it->second, valueDoc));
+		}
+
+		struct TargetOutput
+		{
+			std::string extension;
+			std::string name;
+			bool header;
+		};
+
+		std::vector<TargetOutput> targetOutputs;
+		for (std::string_view outputType : outputTypes)
+		{
+			bool header = EndsWith(outputType, "-header");
+			if (header)
+				outputType.remove_suffix(7);
+
+			if (outputType == "glsl")
+			{
+				if (entryTypes == 0)
+					throw std::runtime_error("shader has no entry function!");
+
+				// Externals depend on option values, the permutation compiler gathers bindings from every combination so that all variants share the same binding map
+				parameters.mapGlslBindings = (m_options.count("gl-bindingmap") > 0);
+
+				for (nzsl::ShaderStageType entryType : entryTypes)
+				{
+					auto& target = parameters.targets.emplace_back();
+					target.backend = nzsl::PermutationCompiler::Backend::GLSL;
+					target.shaderStage = entryType;
+					target.glslEnv = BuildGlslEnvironment();
+
+					std::string_view extension = GetGlslExtension(entryType);
+					targetOutputs.push_back({ std::string(extension), std::string(extension), header });
+				}
+			}
+			else if (outputType == "spv")
+			{
+				auto& target = parameters.targets.emplace_back();
+				target.backend = nzsl::PermutationCompiler::Backend::SPIRV;
+				target.spirvEnv = BuildSpirvEnvironment();
+
+				targetOutputs.push_back({ "spv", "spv", header });
+			}
+			else
+				fmt::print("Format {} is not supported with permutations, ignoring\n", outputType);
+		}
+
+		nzsl::PermutationCompiler permutationCompiler;
+		nzsl::PermutationCompiler::Output output = Step("Compile variants", [&] { return permutationCompiler.Compile(*m_sourceModule, parameters); });
+
+		if (parameters.mapGlslBindings)
+			OutputGlslBindingMap(outputPath, output.glslParameters);
+
+		// Identical variants share the same file, named after the hash of its content
+		std::map<std::pair<std::size_t, bool>, std::string> blobFileNames;
+		std::unordered_map<std::string, std::size_t> blobIndexByExtension;
+
+		nlohmann::ordered_json variantsDoc = nlohmann::ordered_json::array();
+		for (const nzsl::PermutationCompiler::Variant& variant : output.variants)
+		{
+			const TargetOutput& targetOutput = targetOutputs[variant.targetIndex];
+
+			std::string& blobFileName = blobFileNames[{ variant.blobIndex, targetOutput.header }];
+			if (blobFileName.empty())
+			{
+				const nzsl::PermutationCompiler::Blob& blob = output.blobs[variant.blobIndex];
+
+				// Different blobs may have the same hash, don't let them overwrite each other
+				std::string blobExtension = fmt::format("{:016x}.{}", blob.hash, targetOutput.extension);
+				for (std::size_t collisionIndex = 1;; ++collisionIndex)
+				{
+					auto [it, inserted] = blobIndexByExtension.emplace(blobExtension, variant.blobIndex);
+					if (inserted || it->second == variant.blobIndex)
+						break;
+
+					blobExtension = fmt::format("{:016x}-{}.{}", blob.hash, collisionIndex, targetOutput.extension);
+				}
+
+				std::filesystem::path blobPath = outputPath;
+				blobPath.replace_extension(blobExtension);
+
+				m_outputHeader = targetOutput.header;
+				OutputFile(blobPath, blob.data.data(), blob.data.size());
+
+				blobFileName = Nz::PathToString(blobPath.filename());
+				if (targetOutput.header)
+					blobFileName += ".h";
+			}
+
+			nlohmann::ordered_json& variantDoc = variantsDoc.emplace_back();
+			variantDoc["target"] = targetOutput.name;
+
+			nlohmann::ordered_json& optionsDoc = variantDoc["options"];
+			for (std::size_t i = 0; i < parameters.optionMatrix.size(); ++i)
+			{
+				const std::string& optionName = parameters.optionMatrix[i].optionName;
+				optionsDoc[optionName] = matrixDoc[optionName][variant.optionValueIndices[i]];
+			}
+
+			variantDoc["file"] = blobFileName;
 		}
 
+		nlohmann::ordered_json finalDoc;
+		finalDoc["variants"] = std::move(variantsDoc);
+
+		std::string permutationStr = finalDoc.dump(4);
+
+		std::filesystem::path permutationOutputPath = outputPath;
+		permutationOutputPath.replace_extension("permutations.json");
+		OutputFile(std::move(permutationOutputPath), permutationStr.data(), permutationStr.size(), true);
+
+		if (m_verbose)
+			fmt::print("{} variants ({} compiled, others don't depend on the options which differ) written to {} unique files\n", output.variants.size(), output.generatedVariantCount, blobFileNames.size());
+	}
+
+	void Compiler::CompileToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual)
+	{
 		nzsl::SpirvWriter writer;
-		writer.SetEnv(env);
+		writer.SetEnv(BuildSpirvEnvironment());
 
 		nzsl::ShaderWriter::States states = BuildWriterOptions();
 
@@ -629,6 +871,10 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 		nzsl::Ast::SanitizeVisitor::Options sanitizeOptions;
 		sanitizeOptions.partialSanitization = m_options.count("partial") > 0;
 
+		// Permutations are compiled from the source module, as sanitization gives options their default value
+		if (m_options.count("permutations") > 0)
+			m_sourceModule = m_shaderModule;
+
 		if (m_options.count("module") > 0)
 		{
 			std::shared_ptr<nzsl::FilesystemModuleResolver> resolver = std::make_shared<nzsl::FilesystemModuleResolver>();
@@ -643,17 +889,26 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 				}
 				else if (std::filesystem::is_directory(path))
 				{
-					std::string stepName = "Register module directory " + Nz::PathToString(path);
-					Step(stepName, [&] { resolver->RegisterDirectory(path); });
+					// Only modules imported by the shader need to be loaded
+					std::string stepName = "Index module directory " + Nz::PathToString(path);
+					Step(stepName, [&] { resolver->IndexDirectory(path); });
 				}
 				else
 					throw std::runtime_error(modulePath + " is not a path nor a directory");
 			}
 
+			m_moduleResolver = resolver;
 			sanitizeOptions.moduleResolver = std::move(resolver);
 		}
 
-		m_shaderModule = Step("AST processing"sv, [&] { return nzsl::Ast::Sanitize(*m_shaderModule, sanitizeOptions); });
+		m_shaderModule = Step("AST processing"sv, [&]
+		{
+			// The source module is no longer needed afterwards unless we have permutations to compile, let the sanitizer consume it
+			if (!m_sourceModule)
+				return nzsl::Ast::Sanitize(std::move(*m_shaderModule), sanitizeOptions);
+			else
+				return nzsl::Ast::Sanitize(*m_shaderModule, sanitizeOptions);
+		});
 	}
 
 	template<typename F, typename... Args>
@@ -714,8 +969,7 @@ You can also specify -header as a suffix (ex: --compile=glsl-header) to generate
 
 	nzsl::Ast::ModulePtr Compiler::Parse(std::string_view sourceContent, const std::string& filePath)
 	{
-		std::vector<nzsl::Token> tokens = nzsl::Tokenize(sourceContent, filePath);
-		return nzsl::Parse(tokens);
+		return nzsl::Parse(sourceContent, filePath);
 	}
 
 	std::vector<std::uint8_t> Compiler::ReadFileContent(const std::filesystem::path& filePath)
@@ -8,7 +8,10 @@
 #define NZSLC_COMPILER_HPP
 
 #include <NZSL/Config.hpp>
+#include <NZSL/GlslWriter.hpp>
+#include <NZSL/ModuleResolver.hpp>
 #include <NZSL/ShaderWriter.hpp>
+#include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Lang/Errors.hpp>
 #include <NZSL/Ast/Module.hpp>
 #include <cxxopts.hpp>
@@ -48,14 +51,19 @@ namespace nzslc
 			};
 
 		private:
+			nzsl::GlslWriter::Environment BuildGlslEnvironment();
+			nzsl::GlslWriter::Parameters BuildGlslParameters(const std::filesystem::path& outputPath, const nzsl::Ast::Module& module);
+			nzsl::SpirvWriter::Environment BuildSpirvEnvironment();
 			nzsl::ShaderWriter::States BuildWriterOptions();
 			void Compile();
+			void CompilePermutations(std::filesystem::path outputPath, const std::vector<std::string>& outputTypes);
 			void CompileToGLSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
 			void CompileToNZSL(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
 			void CompileToNZSLB(std::filesystem::path outputPath, const nzsl::Ast::Module& module);
 			void CompileToSPV(std::filesystem::path outputPath, const nzsl::Ast::Module& module, bool textual);
 			void PrintTime();
 			void OutputFile(std::filesystem::path filePath, const void* data, std::size_t size, bool disallowHeader = false);
+			void OutputGlslBindingMap(const std::filesystem::path& outputPath, const nzsl::GlslWriter::Parameters& parameters);
 			void OutputToStdout(std::string_view str);
 			void ReadInput();
 			void Sanitize();
@@ -82,6 +90,8 @@ namespace nzslc
 			std::vector<StepTime> m_steps;
 			LogFormat m_logFormat;
 			nzsl::Ast::ModulePtr m_shaderModule;
+			nzsl::Ast::ModulePtr m_sourceModule;
+			std::shared_ptr<nzsl::ModuleResolver> m_moduleResolver;
 			cxxopts::ParseResult& m_options;
 			bool m_profiling;
 			bool m_outputHeader;
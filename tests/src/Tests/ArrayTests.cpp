@@ -2,10 +2,34 @@
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <cctype>
 
 TEST_CASE("arrays", "[Shader]")
 {
+	SECTION("Array types")
+	{
+		nzsl::Ast::ArrayType arrayType;
+		arrayType.containedType = std::make_shared<const nzsl::Ast::ContainedType>(nzsl::Ast::ContainedType{ nzsl::Ast::PrimitiveType::Float32 });
+		arrayType.length = 4;
+
+		// Copies share their contained type
+		nzsl::Ast::ArrayType arrayCopy = arrayType;
+		CHECK(arrayCopy.containedType == arrayType.containedType);
+		CHECK(arrayCopy == arrayType);
+
+		// Giving a copy another contained type doesn't change the original
+		arrayCopy.containedType = std::make_shared<const nzsl::Ast::ContainedType>(nzsl::Ast::ContainedType{ nzsl::Ast::PrimitiveType::Int32 });
+		CHECK(arrayCopy != arrayType);
+		CHECK(arrayType.containedType->type == nzsl::Ast::ExpressionType{ nzsl::Ast::PrimitiveType::Float32 });
+
+		// Separately built contained types are compared structurally
+		nzsl::Ast::ArrayType otherArray;
+		otherArray.containedType = std::make_shared<const nzsl::Ast::ContainedType>(nzsl::Ast::ContainedType{ nzsl::Ast::PrimitiveType::Float32 });
+		otherArray.length = 4;
+		CHECK(otherArray == arrayType);
+	}
+
 	SECTION("Const array")
 	{
 		std::string_view nzslSource = R"(
@@ -203,3 +227,34 @@ fn main(input: VertIn) -> VertOut
       OpFunctionEnd)", {}, {}, true);
 	}
 }
+
+TEST_CASE("copying and comparing array types", "[.][Benchmark]")
+{
+	// alias of array[array[array[mat4[f32], 4], 4], 4]
+	nzsl::Ast::ExpressionType type = nzsl::Ast::MatrixType{ 4, 4, nzsl::Ast::PrimitiveType::Float32 };
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		nzsl::Ast::ArrayType arrayType;
+		arrayType.containedType = std::make_shared<const nzsl::Ast::ContainedType>(nzsl::Ast::ContainedType{ std::move(type) });
+		arrayType.length = 4;
+
+		type = std::move(arrayType);
+	}
+
+	nzsl::Ast::AliasType aliasType;
+	aliasType.aliasIndex = 0;
+	aliasType.targetType = std::make_shared<const nzsl::Ast::ContainedType>(nzsl::Ast::ContainedType{ std::move(type) });
+
+	nzsl::Ast::ExpressionType aliasedType = std::move(aliasType);
+	nzsl::Ast::ExpressionType copiedType = aliasedType;
+
+	BENCHMARK("copy an aliased array of arrays")
+	{
+		return nzsl::Ast::ExpressionType(aliasedType);
+	};
+
+	BENCHMARK("compare copies of an aliased array of arrays")
+	{
+		return aliasedType == copiedType;
+	};
+}
@@ -2,9 +2,12 @@
 #include <NZSL/FilesystemModuleResolver.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Ast/ConstantPropagationVisitor.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <fmt/format.h>
 #include <cctype>
 
 void ExpectOutput(nzsl::Ast::Module& shaderModule, const nzsl::Ast::SanitizeVisitor::Options& options, std::string_view expectedOptimizedResult)
@@ -388,3 +391,48 @@ fn main()
 	}
 
 }
+
+TEST_CASE("generating SPIR-V with many constants and types", "[.][Benchmark]")
+{
+	// Each struct has a distinct array size and each assignment a distinct value, so every type and constant is different
+	constexpr std::size_t StructCount = 2000;
+
+	std::string nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+)";
+
+	for (std::size_t i = 0; i < StructCount; ++i)
+	{
+		nzslSource += fmt::format(R"(
+struct Data{0}
+{{
+	values: array[f32, {1}],
+	index: i32
+}}
+)", i, i + 1);
+	}
+
+	nzslSource += R"(
+[entry(frag)]
+fn main()
+{
+)";
+
+	for (std::size_t i = 0; i < StructCount; ++i)
+		nzslSource += fmt::format("\tlet data{0}: Data{0};\n\tdata{0}.values[{0}] = {0}.5;\n\tdata{0}.index = {1};\n", i, i + StructCount);
+
+	nzslSource += "}\n";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Ast::Sanitize(*nzsl::Parse(nzslSource), nzsl::SpirvWriter::GetSanitizeOptions());
+
+	nzsl::ShaderWriter::States states;
+	states.sanitized = true;
+
+	nzsl::SpirvWriter spirvWriter;
+
+	BENCHMARK("generate SPIR-V with " + std::to_string(StructCount) + " structs and " + std::to_string(StructCount * 3) + " constants")
+	{
+		return spirvWriter.Generate(*shaderModule, states);
+	};
+}
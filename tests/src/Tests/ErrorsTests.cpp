@@ -1074,6 +1074,36 @@ fn main()
 [nzsl_version("1.0")]
 module;
 
+fn main()
+{
+	let a: array[f32, 1.5];
+}
+)"), "(7,9 -> 23): CArrayLength error: array length must a strictly positive integer, got f32");
+
+			CHECK_THROWS_WITH(Compile(R"(
+[nzsl_version("1.0")]
+module;
+
+external
+{
+	[binding(0)] tex: sampler2D[i32]
+}
+)"), "(7,20 -> 33): CSamplerUnexpectedType error: for now only f32 samplers are supported (got i32)");
+
+			CHECK_THROWS_WITH(Compile(R"(
+[nzsl_version("1.0")]
+module;
+
+external
+{
+	[binding(0)] tex: texture2D[i32, readonly]
+}
+)"), "(7,20 -> 43): CTextureUnexpectedType error: for now only f32 textures are supported (got i32)");
+
+			CHECK_THROWS_WITH(Compile(R"(
+[nzsl_version("1.0")]
+module;
+
 fn main()
 {
 	let a = vec3[f32]();
@@ -57,8 +57,7 @@ TEST_CASE("RegisterStructField", "[FieldOffsets]")
 	};
 
 	nzsl::Ast::ArrayType innerArray;
-	innerArray.containedType = std::make_unique<nzsl::Ast::ContainedType>();
-	innerArray.containedType->type = nzsl::Ast::StructType{ 0 };
+	innerArray.containedType = std::make_shared<const nzsl::Ast::ContainedType>(nzsl::Ast::ContainedType{ nzsl::Ast::StructType{ 0 } });
 	innerArray.length = 3;
 
 	nzsl::FieldOffsets fieldOffsets(nzsl::StructLayout::Std140);
@@ -1,11 +1,20 @@
 #include <Tests/ShaderUtils.hpp>
+#include <NazaraUtils/PathUtils.hpp>
+#include <NZSL/Archive.hpp>
 #include <NZSL/FilesystemModuleResolver.hpp>
 #include <NZSL/LangWriter.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/Serializer.hpp>
+#include <NZSL/Ast/AstSerializer.hpp>
+#include <NZSL/Ast/Compare.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
 #include <cctype>
+#include <chrono>
+#include <fstream>
+#include <thread>
 
 TEST_CASE("FilesystemModuleResolver", "[Shader]")
 {
@@ -220,3 +229,431 @@ fn main() -> Output
       OpReturn
       OpFunctionEnd)", {}, {}, true);
 }
+
+TEST_CASE("FilesystemModuleResolver parallel loading", "[Shader]")
+{
+	std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_parallel_modules";
+	std::filesystem::remove_all(moduleDir);
+	std::filesystem::create_directories(moduleDir / "sub");
+
+	auto WriteModule = [&](const std::filesystem::path& path, std::string_view source)
+	{
+		std::ofstream file(moduleDir / path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(source.data(), source.size());
+	};
+
+	constexpr std::size_t ModuleCount = 32;
+	for (std::size_t i = 0; i < ModuleCount; ++i)
+	{
+		WriteModule(((i % 2 == 0) ? "" : "sub/") + fmt::format("Module{}.nzsl", i), fmt::format(R"(
+[nzsl_version("1.0")]
+module Module{0};
+
+[export]
+fn GetValue{0}() -> i32
+{{
+	return {0};
+}}
+)", i));
+	}
+
+	WHEN("Loading modules on multiple threads")
+	{
+		nzsl::FilesystemModuleResolver serialResolver;
+		REQUIRE_NOTHROW(serialResolver.RegisterDirectory(moduleDir));
+
+		nzsl::FilesystemModuleResolver parallelResolver;
+		REQUIRE_NOTHROW(parallelResolver.RegisterDirectory(moduleDir, false, 4));
+
+		for (std::size_t i = 0; i < ModuleCount; ++i)
+		{
+			std::string moduleName = fmt::format("Module{}", i);
+
+			nzsl::Ast::ModulePtr serialModule = serialResolver.Resolve(moduleName);
+			nzsl::Ast::ModulePtr parallelModule = parallelResolver.Resolve(moduleName);
+			REQUIRE(serialModule);
+			REQUIRE(parallelModule);
+			CHECK(nzsl::Ast::Compare(*serialModule, *parallelModule));
+		}
+	}
+
+	WHEN("Loading a directory with invalid modules")
+	{
+		WriteModule("Broken1.nzsl", "module Broken1; fn");
+		WriteModule("sub/Broken2.nzsl", "module Broken2; fn");
+
+		std::string serialError;
+		try
+		{
+			nzsl::FilesystemModuleResolver resolver;
+			resolver.RegisterDirectory(moduleDir);
+		}
+		catch (const std::exception& e)
+		{
+			serialError = e.what();
+		}
+
+		REQUIRE_FALSE(serialError.empty());
+
+		// The same error is reported whatever the number of workers
+		for (unsigned int workerCount : { 0u, 2u, 4u, 16u })
+		{
+			nzsl::FilesystemModuleResolver resolver;
+			CHECK_THROWS_WITH(resolver.RegisterDirectory(moduleDir, false, workerCount), serialError);
+		}
+	}
+
+	std::filesystem::remove_all(moduleDir);
+}
+
+TEST_CASE("FilesystemModuleResolver lazy loading", "[Shader]")
+{
+	std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_lazy_modules";
+	std::filesystem::remove_all(moduleDir);
+	std::filesystem::create_directories(moduleDir);
+
+	auto WriteFile = [&](const std::filesystem::path& path, const void* data, std::size_t size)
+	{
+		std::ofstream file(moduleDir / path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(static_cast<const char*>(data), size);
+	};
+
+	std::string_view sourceModule = R"(
+[nzsl_version("1.0")]
+[author("Lynix"), desc("Source module")]
+module Lazy.Source;
+
+[export]
+fn GetValue() -> i32
+{
+	return 42;
+}
+)";
+	WriteFile("Source.nzsl", sourceModule.data(), sourceModule.size());
+
+	nzsl::Ast::ModulePtr binaryModule = nzsl::Parse(R"(
+[nzsl_version("1.0")]
+module Lazy.Binary;
+
+[export]
+const Value = 42;
+)");
+	{
+		nzsl::Serializer serializer;
+		nzsl::Ast::SerializeShader(serializer, *binaryModule);
+		WriteFile("Binary.nzslb", serializer.GetData().data(), serializer.GetData().size());
+	}
+
+	nzsl::Ast::ModulePtr archivedModule = nzsl::Parse(R"(
+[nzsl_version("1.0")]
+module Lazy.Archived;
+
+[export]
+const Value = 42;
+)");
+	{
+		nzsl::Serializer moduleSerializer;
+		nzsl::Ast::SerializeShader(moduleSerializer, *archivedModule);
+
+		nzsl::Archive archive;
+		archive.AddModule(archivedModule->metadata->moduleName, nzsl::ArchiveEntryKind::BinaryShaderModule, moduleSerializer.GetData().data(), moduleSerializer.GetData().size());
+
+		nzsl::Serializer archiveSerializer;
+		nzsl::SerializeArchive(archiveSerializer, archive);
+		WriteFile("Modules.nzsla", archiveSerializer.GetData().data(), archiveSerializer.GetData().size());
+	}
+
+	// Only the header of the file is read when indexing it, errors in its body are reported when it's resolved
+	std::string_view brokenModule = R"(
+[nzsl_version("1.0")]
+module Lazy.Broken;
+
+fn
+)";
+	WriteFile("Broken.nzsl", brokenModule.data(), brokenModule.size());
+
+	nzsl::FilesystemModuleResolver resolver;
+	REQUIRE_NOTHROW(resolver.IndexDirectory(moduleDir));
+
+	nzsl::Ast::ModulePtr resolvedSource = resolver.Resolve("Lazy.Source");
+	REQUIRE(resolvedSource);
+	CHECK(nzsl::Ast::Compare(*resolvedSource, *nzsl::Parse(sourceModule, Nz::PathToString(moduleDir / "Source.nzsl"))));
+	CHECK(resolver.Resolve("Lazy.Source") == resolvedSource);
+
+	nzsl::Ast::ModulePtr resolvedBinary = resolver.Resolve("Lazy.Binary");
+	REQUIRE(resolvedBinary);
+	CHECK(nzsl::Ast::Compare(*resolvedBinary, *binaryModule));
+
+	nzsl::Ast::ModulePtr resolvedArchived = resolver.Resolve("Lazy.Archived");
+	REQUIRE(resolvedArchived);
+	CHECK(nzsl::Ast::Compare(*resolvedArchived, *archivedModule));
+
+	CHECK_THROWS(resolver.Resolve("Lazy.Broken"));
+	CHECK_FALSE(resolver.Resolve("Lazy.Unknown"));
+
+	// Modules are loaded outside of the resolver lock, concurrent resolves of the same module still load it once
+	{
+		nzsl::FilesystemModuleResolver concurrentResolver;
+		REQUIRE_NOTHROW(concurrentResolver.IndexDirectory(moduleDir));
+
+		constexpr std::size_t ThreadCount = 8;
+		std::vector<nzsl::Ast::ModulePtr> resolvedModules(ThreadCount);
+		std::vector<nzsl::Ast::ModulePtr> resolvedOtherModules(ThreadCount);
+		{
+			std::vector<std::thread> threads;
+			for (std::size_t i = 0; i < ThreadCount; ++i)
+			{
+				threads.emplace_back([&, i]
+				{
+					resolvedModules[i] = concurrentResolver.Resolve("Lazy.Source");
+					resolvedOtherModules[i] = concurrentResolver.Resolve((i % 2 == 0) ? "Lazy.Binary" : "Lazy.Archived");
+				});
+			}
+
+			for (std::thread& thread : threads)
+				thread.join();
+		}
+
+		REQUIRE(resolvedModules.front());
+		for (std::size_t i = 0; i < ThreadCount; ++i)
+		{
+			CHECK(resolvedModules[i] == resolvedModules.front());
+			CHECK(resolvedOtherModules[i] == resolvedOtherModules[i % 2]);
+		}
+	}
+
+	std::filesystem::remove_all(moduleDir);
+}
+
+TEST_CASE("FilesystemModuleResolver update callbacks", "[Shader]")
+{
+	std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_callback_modules";
+	std::filesystem::remove_all(moduleDir);
+	std::filesystem::create_directories(moduleDir);
+
+	std::string_view firstVersion = R"(
+[nzsl_version("1.0")]
+module Callback;
+
+[export]
+const Value = 1;
+)";
+
+	std::string_view secondVersion = R"(
+[nzsl_version("1.0")]
+module Callback;
+
+[export]
+const Value = 2;
+)";
+
+	nzsl::FilesystemModuleResolver resolver;
+	resolver.RegisterModule(firstVersion);
+
+	// Signals are triggered once the resolver lock is released, callbacks can resolve the updated module
+	std::vector<nzsl::Ast::ModulePtr> resolvedModules;
+	resolver.OnModuleUpdated.Connect([&](nzsl::ModuleResolver* updatedResolver, const std::string& moduleName)
+	{
+		resolvedModules.push_back(updatedResolver->Resolve(moduleName));
+	});
+
+	WHEN("Registering a new version")
+	{
+		resolver.RegisterModule(secondVersion);
+
+		REQUIRE(resolvedModules.size() == 1);
+		REQUIRE(resolvedModules.front());
+		CHECK(nzsl::Ast::Compare(*resolvedModules.front(), *nzsl::Parse(secondVersion)));
+	}
+
+	WHEN("Indexing a new version")
+	{
+		std::filesystem::path modulePath = moduleDir / "Callback.nzsl";
+		{
+			std::ofstream file(modulePath, std::ios::out | std::ios::binary | std::ios::trunc);
+			file.write(secondVersion.data(), secondVersion.size());
+		}
+
+		// The indexed module is loaded by the Resolve call of the callback
+		resolver.IndexFile(modulePath);
+
+		REQUIRE(resolvedModules.size() == 1);
+		REQUIRE(resolvedModules.front());
+		CHECK(nzsl::Ast::Compare(*resolvedModules.front(), *nzsl::Parse(secondVersion, Nz::PathToString(modulePath))));
+		CHECK(resolver.Resolve("Callback") == resolvedModules.front());
+	}
+
+	std::filesystem::remove_all(moduleDir);
+}
+
+TEST_CASE("FilesystemModuleResolver watched index", "[Shader]")
+{
+	using namespace std::chrono_literals;
+
+	std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_watched_index";
+	std::filesystem::remove_all(moduleDir);
+	std::filesystem::create_directories(moduleDir);
+
+	nzsl::FilesystemModuleResolver resolver;
+	try
+	{
+		resolver.IndexDirectory(moduleDir, true);
+	}
+	catch (const std::exception& e)
+	{
+		std::filesystem::remove_all(moduleDir);
+
+		WARN(e.what());
+		return;
+	}
+
+	CHECK_FALSE(resolver.Resolve("Indexed"));
+
+	// New files are indexed from the watcher thread
+	{
+		std::string_view source = R"(
+[nzsl_version("1.0")]
+module Indexed;
+
+[export]
+const Value = 42;
+)";
+
+		std::ofstream file(moduleDir / "Indexed.nzsl", std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(source.data(), source.size());
+	}
+
+	nzsl::Ast::ModulePtr indexedModule;
+	for (auto start = std::chrono::steady_clock::now(); !indexedModule && std::chrono::steady_clock::now() - start < 10s;)
+	{
+		std::this_thread::sleep_for(10ms);
+		indexedModule = resolver.Resolve("Indexed");
+	}
+
+	CHECK(indexedModule);
+
+	std::filesystem::remove_all(moduleDir);
+}
+
+TEST_CASE("FilesystemModuleResolver hot-reload", "[Shader]")
+{
+	std::filesystem::path watchedDir = std::filesystem::temp_directory_path() / "nzsl_watched_modules";
+	std::filesystem::path moduleDir = std::filesystem::temp_directory_path() / "nzsl_reloaded_modules";
+	std::filesystem::remove_all(watchedDir);
+	std::filesystem::remove_all(moduleDir);
+	std::filesystem::create_directories(watchedDir);
+	std::filesystem::create_directories(moduleDir);
+
+	std::filesystem::path modulePath = moduleDir / "Watched.nzsl";
+	auto WriteModule = [&](std::string_view source)
+	{
+		std::ofstream file(modulePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(source.data(), source.size());
+	};
+
+	std::string_view firstVersion = R"(
+[nzsl_version("1.0")]
+module Watched;
+
+[export]
+fn GetValue() -> i32
+{
+	return 1;
+}
+
+[export]
+fn GetOtherValue() -> i32
+{
+	return 2;
+}
+)";
+	WriteModule(firstVersion);
+
+	// Watching a directory enables incremental reparsing, the module lives outside of it so that the watcher thread never reloads it
+	// and updates are triggered by registering the file again (which is what the watcher does when a file changes)
+	nzsl::FilesystemModuleResolver resolver;
+	try
+	{
+		resolver.RegisterDirectory(watchedDir, true);
+	}
+	catch (const std::exception& e)
+	{
+		std::filesystem::remove_all(watchedDir);
+		std::filesystem::remove_all(moduleDir);
+
+		WARN(e.what());
+		return;
+	}
+
+	REQUIRE_NOTHROW(resolver.RegisterFile(modulePath));
+
+	std::vector<std::vector<std::string>> updates;
+	resolver.OnModuleDeclarationsUpdated.Connect([&](nzsl::FilesystemModuleResolver* /*resolver*/, const std::string& moduleName, const std::vector<std::string>& declarations)
+	{
+		if (moduleName == "Watched")
+			updates.push_back(declarations);
+	});
+
+	auto UpdateModule = [&](std::string_view source)
+	{
+		WriteModule(source);
+
+		updates.clear();
+		REQUIRE_NOTHROW(resolver.RegisterFile(modulePath));
+		REQUIRE(updates.size() == 1);
+
+		return updates.front();
+	};
+
+	nzsl::Ast::ComparisonParams comparisonParams;
+	comparisonParams.compareSourceLoc = false;
+
+	auto FindFunction = [](const nzsl::Ast::Module& module, std::string_view functionName) -> const nzsl::Ast::Statement*
+	{
+		for (const nzsl::Ast::StatementPtr& statement : module.rootNode->statements)
+		{
+			if (statement->GetType() == nzsl::Ast::NodeType::DeclareFunctionStatement && static_cast<const nzsl::Ast::DeclareFunctionStatement&>(*statement).name == functionName)
+				return statement.get();
+		}
+
+		return nullptr;
+	};
+
+	nzsl::Ast::ModulePtr firstModule = resolver.Resolve("Watched");
+	REQUIRE(firstModule);
+	CHECK(nzsl::Ast::Compare(*firstModule, *nzsl::Parse(firstVersion), comparisonParams));
+
+	// Only the modified function is reported
+	std::string secondVersion(firstVersion);
+	secondVersion.replace(secondVersion.find("return 2;"), 9, "return 3;");
+
+	CHECK(UpdateModule(secondVersion) == std::vector<std::string>{ "GetOtherValue" });
+	CHECK(nzsl::Ast::Compare(*resolver.Resolve("Watched"), *nzsl::Parse(secondVersion), comparisonParams));
+
+	// Modules returned by Resolve are left untouched, their unchanged statements are copied
+	CHECK(nzsl::Ast::Compare(*firstModule, *nzsl::Parse(firstVersion), comparisonParams));
+	CHECK(FindFunction(*resolver.Resolve("Watched"), "GetValue") != FindFunction(*firstModule, "GetValue"));
+
+	// Added and removed declarations are reported as well
+	std::string thirdVersion(secondVersion);
+	thirdVersion.replace(thirdVersion.find("GetValue"), 8, "GetNewValue");
+
+	CHECK(UpdateModule(thirdVersion) == std::vector<std::string>{ "GetNewValue", "GetValue" });
+
+	// The third version was never resolved, the resolver hands it over to the parser which moves its unchanged statements
+	std::string fourthVersion(thirdVersion);
+	fourthVersion.replace(fourthVersion.find("return 1;"), 9, "return 4;");
+
+	CHECK(UpdateModule(fourthVersion) == std::vector<std::string>{ "GetNewValue" });
+
+	// The fourth version is handed over as well, a reparse error registers it again
+	std::string brokenVersion(fourthVersion);
+	brokenVersion.replace(brokenVersion.find("return 4;"), 9, "return *;");
+	WriteModule(brokenVersion);
+
+	CHECK_THROWS(resolver.RegisterFile(modulePath));
+	CHECK(nzsl::Ast::Compare(*resolver.Resolve("Watched"), *nzsl::Parse(fourthVersion), comparisonParams));
+
+	std::filesystem::remove_all(watchedDir);
+	std::filesystem::remove_all(moduleDir);
+}
@@ -0,0 +1,191 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/IncrementalParser.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/Ast/Compare.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("incremental parser", "[Shader]")
+{
+	std::string_view firstVersion = R"(
+[nzsl_version("1.0")]
+module;
+
+struct Data
+{
+	value: f32
+}
+
+fn Compute(value: f32) -> f32
+{
+	return value * 2.0;
+}
+
+[entry(frag)]
+fn main()
+{
+	let data: Data;
+	data.value = Compute(1.0);
+}
+)";
+
+	// Compute body changed and an empty line was inserted before it, shifting every following statement
+	std::string_view secondVersion = R"(
+[nzsl_version("1.0")]
+module;
+
+struct Data
+{
+	value: f32
+}
+
+
+fn Compute(value: f32) -> f32
+{
+	return value * 4.0;
+}
+
+[entry(frag)]
+fn main()
+{
+	let data: Data;
+	data.value = Compute(1.0);
+}
+)";
+
+	// anonymous modules get a random name on each parse
+	nzsl::Ast::ComparisonParams comparisonParams;
+	comparisonParams.compareModuleName = false;
+
+	nzsl::IncrementalParser parser;
+
+	nzsl::IncrementalParser::Result firstResult = parser.Parse(firstVersion, "incremental.nzsl");
+	CHECK(firstResult.fullReparse);
+	CHECK(firstResult.changedDeclarations == std::vector<std::string>{ "Compute", "Data", "main" });
+	CHECK(nzsl::Ast::Compare(*firstResult.module, *nzsl::Parse(firstVersion, "incremental.nzsl"), comparisonParams));
+
+	SECTION("Only changed root statements are reparsed")
+	{
+		nzsl::IncrementalParser::Result secondResult = parser.Parse(secondVersion, "incremental.nzsl");
+		CHECK_FALSE(secondResult.fullReparse);
+		CHECK(secondResult.changedDeclarations == std::vector<std::string>{ "Compute" });
+		CHECK(nzsl::Ast::Compare(*secondResult.module, *nzsl::Parse(secondVersion, "incremental.nzsl"), comparisonParams));
+
+		// Previous module is left untouched
+		CHECK(nzsl::Ast::Compare(*firstResult.module, *nzsl::Parse(firstVersion, "incremental.nzsl"), comparisonParams));
+	}
+
+	SECTION("Statements of a previous version handed over to the parser are moved")
+	{
+		// Every kind of source location of the reused statements has to be shifted
+		std::string_view richVersion = R"(
+[nzsl_version("1.0")]
+module;
+
+import Compute as ComputeAlias, * from Module;
+
+option UseColor: bool = true;
+const Factor: f32 = 2.0;
+
+[layout(std140)]
+struct Data
+{
+	[cond(UseColor)] color: vec4[f32],
+	value: array[f32, 4]
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[Data]
+}
+
+struct Output
+{
+	[location(0)] value: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: Output) -> Output
+{
+	let value = data.value[0] * Factor;
+	const if (UseColor)
+		value *= data.color.x;
+
+	[unroll]
+	for i in 0 -> 4
+	{
+		value += f32(i);
+	}
+
+	let output: Output;
+	output.value = vec4[f32](value, select(value > 0.0, 1.0, 0.0), 0.0, 1.0);
+	return output;
+}
+)";
+
+		std::string shiftedVersion(richVersion);
+		shiftedVersion.insert(shiftedVersion.find("option UseColor"), "\n\n");
+		shiftedVersion.replace(shiftedVersion.find("2.0;"), 4, "3.0;");
+
+		nzsl::IncrementalParser richParser;
+		nzsl::IncrementalParser::Result richResult = richParser.Parse(richVersion, "incremental.nzsl");
+		CHECK(richResult.fullReparse);
+
+		SECTION("When kept by the caller")
+		{
+			nzsl::IncrementalParser::Result shiftedResult = richParser.Parse(shiftedVersion, "incremental.nzsl");
+			CHECK_FALSE(shiftedResult.fullReparse);
+			CHECK(shiftedResult.changedDeclarations == std::vector<std::string>{ "Factor" });
+			CHECK(nzsl::Ast::Compare(*shiftedResult.module, *nzsl::Parse(shiftedVersion, "incremental.nzsl"), comparisonParams));
+			CHECK(nzsl::Ast::Compare(*richResult.module, *nzsl::Parse(richVersion, "incremental.nzsl"), comparisonParams));
+		}
+
+		SECTION("When handed over")
+		{
+			const nzsl::Ast::Statement* mainStatement = richResult.module->rootNode->statements.back().get();
+
+			nzsl::IncrementalParser::Result shiftedResult = richParser.Parse(std::move(richResult.module), shiftedVersion, "incremental.nzsl");
+			CHECK_FALSE(richResult.module);
+			CHECK_FALSE(shiftedResult.fullReparse);
+			CHECK(shiftedResult.changedDeclarations == std::vector<std::string>{ "Factor" });
+			CHECK(nzsl::Ast::Compare(*shiftedResult.module, *nzsl::Parse(shiftedVersion, "incremental.nzsl"), comparisonParams));
+
+			// Unchanged statements are moved instead of being copied
+			CHECK(shiftedResult.module->rootNode->statements.back().get() == mainStatement);
+		}
+	}
+
+	SECTION("Same source yields no changed declaration")
+	{
+		nzsl::IncrementalParser::Result secondResult = parser.Parse(firstVersion, "incremental.nzsl");
+		CHECK_FALSE(secondResult.fullReparse);
+		CHECK(secondResult.changedDeclarations.empty());
+		CHECK(nzsl::Ast::Compare(*secondResult.module, *firstResult.module));
+	}
+
+	SECTION("Header change triggers a full reparse")
+	{
+		std::string source(secondVersion);
+		source.replace(source.find("module;"), 7, "module Incremental;");
+
+		nzsl::IncrementalParser::Result secondResult = parser.Parse(source, "incremental.nzsl");
+		CHECK(secondResult.fullReparse);
+		CHECK(nzsl::Ast::Compare(*secondResult.module, *nzsl::Parse(source, "incremental.nzsl"), comparisonParams));
+	}
+
+	SECTION("Syntax errors are reported and leave the previous version usable")
+	{
+		std::string source(secondVersion);
+		source.replace(source.find("value * 4.0;"), 12, "value * ;");
+
+		CHECK_THROWS(parser.Parse(source, "incremental.nzsl"));
+
+		// A module handed over is only released once parsing succeeds
+		CHECK_THROWS(parser.Parse(std::move(firstResult.module), source, "incremental.nzsl"));
+		REQUIRE(firstResult.module);
+		CHECK(nzsl::Ast::Compare(*firstResult.module, *nzsl::Parse(firstVersion, "incremental.nzsl"), comparisonParams));
+
+		nzsl::IncrementalParser::Result secondResult = parser.Parse(secondVersion, "incremental.nzsl");
+		CHECK_FALSE(secondResult.fullReparse);
+		CHECK(secondResult.changedDeclarations == std::vector<std::string>{ "Compute" });
+	}
+}
@@ -1,7 +1,11 @@
 #include <Tests/ShaderUtils.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Lexer.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/Lang/Symbol.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <fmt/format.h>
 #include <cctype>
 
 TEST_CASE("lexer", "[Shader]")
@@ -60,4 +64,208 @@ Let Identifier(b) Assign Identifier(a) Semicolon
 ClosingCurlyBracket
 EndOfStream)");
 	}
+
+	SECTION("String literals")
+	{
+		std::string_view nzslSource = R"(let str = "Hello\t\"world\"\n";)";
+
+		std::vector<nzsl::Token> tokens = nzsl::Tokenize(nzslSource);
+		REQUIRE(tokens.size() == 6);
+		REQUIRE(tokens[3].type == nzsl::TokenType::StringValue);
+
+		// tokens reference the source instead of holding a copy
+		std::string_view literal = std::get<std::string_view>(tokens[3].data);
+		CHECK(literal == R"(Hello\t\"world\"\n)");
+		CHECK(literal.data() >= nzslSource.data());
+		CHECK(literal.data() + literal.size() <= nzslSource.data() + nzslSource.size());
+
+		CHECK(nzsl::UnescapeString(literal) == "Hello\t\"world\"\n");
+
+		// EscapeString writes control characters raw after their backslash, only quotes and backslashes get back their source spelling
+		std::string_view quotedSource = R"(let str = "say \"hi\" \\o/";)";
+
+		std::vector<nzsl::Token> quotedTokens = nzsl::Tokenize(quotedSource);
+		REQUIRE(quotedTokens.size() == 6);
+		REQUIRE(quotedTokens[3].type == nzsl::TokenType::StringValue);
+
+		std::string_view quotedLiteral = std::get<std::string_view>(quotedTokens[3].data);
+		CHECK(nzsl::UnescapeString(quotedLiteral) == "say \"hi\" \\o/");
+		CHECK(nzsl::EscapeString(nzsl::UnescapeString(quotedLiteral), false) == quotedLiteral);
+	}
+
+	SECTION("Pull-based lexer")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+fn main()
+{
+	let str = "hello";
+	let i = 42;
+}
+)";
+
+		std::vector<nzsl::Token> tokens = nzsl::Tokenize(nzslSource);
+
+		nzsl::Lexer lexer(nzslSource);
+		for (const nzsl::Token& token : tokens)
+		{
+			nzsl::Token pulledToken = lexer.Next();
+			CHECK(pulledToken.type == token.type);
+			CHECK(pulledToken.data == token.data);
+			CHECK(pulledToken.location.startLine == token.location.startLine);
+			CHECK(pulledToken.location.startColumn == token.location.startColumn);
+		}
+
+		// end of stream is sticky
+		CHECK(lexer.Next().type == nzsl::TokenType::EndOfStream);
+	}
+
+	SECTION("Long runs")
+	{
+		// whitespace, comments, identifiers and numbers longer than a vector register
+		std::string_view nzslSource = "                                let a_very_long_identifier_name_0123456789 = 12345678901234567; // a long line comment, with a * and a /\n"
+		                              "/* a multi-line block comment ** with stars\n and more than sixteen characters per line */ a_very_long_identifier_name_0123456789\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t;";
+
+		std::vector<nzsl::Token> tokens = nzsl::Tokenize(nzslSource);
+		CHECK(nzsl::ToString(tokens) == R"(Let Identifier(a_very_long_identifier_name_0123456789) Assign IntegerValue(12345678901234567) Semicolon
+Identifier(a_very_long_identifier_name_0123456789) Semicolon
+EndOfStream)");
+
+		REQUIRE(tokens.size() == 8);
+		CHECK(tokens[1].location.startColumn == 37);
+		CHECK(tokens[5].location.startLine == 3);
+	}
+
+	SECTION("Source file")
+	{
+		std::vector<nzsl::Token> tokens = nzsl::Tokenize("let a = 42;", "shaders/lexer_test.nzsl");
+		REQUIRE(tokens.size() == 6);
+
+		// every token of the same file shares the same registered file
+		CHECK(tokens.front().location.HasFile());
+		CHECK(tokens.front().location.GetFilePath() == "shaders/lexer_test.nzsl");
+		CHECK(tokens.front().location.fileId == tokens.back().location.fileId);
+		CHECK(nzsl::RegisterSourceFile("shaders/lexer_test.nzsl") == tokens.front().location.fileId);
+
+		// file paths have their own registry and don't end up in the symbol table
+		CHECK_FALSE(nzsl::Symbol::Find("shaders/lexer_test.nzsl").IsValid());
+
+		CHECK_FALSE(nzsl::Tokenize("let a = 42;").front().location.HasFile());
+	}
+
+	SECTION("Owning tokens")
+	{
+		// owning tokens don't depend on the source lifetime
+		std::vector<nzsl::OwningToken> tokens = nzsl::TokenizeOwning(std::string(R"(let str = "Hello\tworld"; let a = 42;)"));
+		REQUIRE(tokens.size() == 11);
+		CHECK(std::get<std::string>(tokens[1].data) == "str");
+		CHECK(std::get<long long>(tokens[8].data) == 42);
+
+		// unlike view tokens, owning tokens hold unescaped string literals
+		CHECK(std::get<std::string>(tokens[3].data) == "Hello\tworld");
+		CHECK(nzsl::ToString(tokens, false) == "Let Identifier(str) Assign StringValue(\"Hello\tworld\") Semicolon Let Identifier(a) Assign IntegerValue(42) Semicolon EndOfStream");
+
+		// the same tokens stringify the same way whether they are held as view or owning tokens
+		std::string viewSource = R"(let str = "Hello\tworld"; let a = 42;)";
+		CHECK(nzsl::ToString(nzsl::Tokenize(viewSource), false) == nzsl::ToString(tokens, false));
+
+		nzsl::Token viewToken = nzsl::ToToken(tokens[1]);
+		CHECK(std::get<std::string_view>(viewToken.data).data() == std::get<std::string>(tokens[1].data).data());
+
+		nzsl::OwningToken owningToken = nzsl::ToOwningToken(viewToken);
+		CHECK(owningToken.type == nzsl::TokenType::Identifier);
+		CHECK(std::get<std::string>(owningToken.data) == "str");
+
+		std::vector<nzsl::OwningToken> moduleTokens = nzsl::TokenizeOwning(std::string(R"(
+[nzsl_version("1.0")]
+[desc("say \"hi\"\tand a \\n")]
+module;
+
+fn main()
+{
+	let i = 42;
+}
+)"));
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(moduleTokens);
+		REQUIRE(shaderModule);
+		CHECK(shaderModule->rootNode->statements.size() == 1);
+		CHECK(shaderModule->metadata->description == "say \"hi\"\tand a \\n");
+	}
+}
+
+TEST_CASE("lexing large sources", "[.][Benchmark]")
+{
+	// Mixes the token kinds scanned in blocks (blanks, comments, identifiers and digit runs) with punctuation
+	constexpr std::size_t FunctionCount = 5000;
+
+	std::string nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+)";
+
+	for (std::size_t i = 0; i < FunctionCount; ++i)
+	{
+		nzslSource += fmt::format(R"(
+// Computes a value from its index
+/* and the previous function result */
+fn ComputeSomethingLong{0}(inputValue: vec4[f32], otherValue: f32) -> vec4[f32]
+{{
+	let intermediateResult = inputValue * {0}.123456 + vec4[f32](1.0, 2.0, 3.0, {1}.0);
+	if (otherValue >= 1024.0 && intermediateResult.x != 0.5)
+		return normalize(intermediateResult) * length(inputValue); // early exit
+
+	return intermediateResult.zyxw * 0x{0:X};
+}}
+)", i, i * 7);
+	}
+
+	std::string sizeStr = fmt::format("{:.2f}MB", nzslSource.size() / 1'000'000.0);
+
+	BENCHMARK("tokenize " + sizeStr + " of source")
+	{
+		return nzsl::Tokenize(nzslSource).size();
+	};
+
+	BENCHMARK("tokenize " + sizeStr + " of source into owning tokens")
+	{
+		return nzsl::TokenizeOwning(nzslSource).size();
+	};
+
+	BENCHMARK("lex " + sizeStr + " of source on demand")
+	{
+		nzsl::Lexer lexer(nzslSource);
+
+		std::size_t tokenCount = 0;
+		while (lexer.Next().type != nzsl::TokenType::EndOfStream)
+			tokenCount++;
+
+		return tokenCount;
+	};
+
+	// Memory held by the tokens of the whole source, identifiers and string literals longer than the small string buffer have their own allocation when owned
+	auto HeapPayloadSize = [](const std::string& str) -> std::size_t
+	{
+		const char* objectBegin = reinterpret_cast<const char*>(&str);
+		if (str.data() >= objectBegin && str.data() < objectBegin + sizeof(str))
+			return 0;
+
+		return str.capacity() + 1;
+	};
+
+	std::vector<nzsl::Token> tokens = nzsl::Tokenize(nzslSource);
+	std::size_t tokenMemory = tokens.capacity() * sizeof(nzsl::Token);
+
+	std::vector<nzsl::OwningToken> owningTokens = nzsl::TokenizeOwning(nzslSource);
+	std::size_t owningTokenMemory = owningTokens.capacity() * sizeof(nzsl::OwningToken);
+	for (const nzsl::OwningToken& token : owningTokens)
+	{
+		if (const std::string* str = std::get_if<std::string>(&token.data))
+			owningTokenMemory += HeapPayloadSize(*str);
+	}
+
+	WARN(fmt::format("{} tokens: {:.2f}MB as Token, {:.2f}MB as OwningToken", tokens.size(), tokenMemory / 1'000'000.0, owningTokenMemory / 1'000'000.0));
+	CHECK(tokenMemory < owningTokenMemory);
 }
@@ -3,9 +3,13 @@
 #include <NZSL/LangWriter.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/Ast/Compare.hpp>
+#include <NZSL/Ast/SanitizedModuleCache.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <atomic>
 #include <cctype>
+#include <thread>
 
 void RegisterModule(const std::shared_ptr<nzsl::FilesystemModuleResolver>& moduleResolver, std::string_view source)
 {
@@ -1336,3 +1340,269 @@ OpReturn
 OpFunctionEnd)");
 	}
 }
+
+TEST_CASE("Sanitized module cache", "[Shader]")
+{
+	std::string_view utilsSource = R"(
+[nzsl_version("1.0")]
+module Utils;
+
+[export]
+const Factor = 2.0;
+
+[export]
+struct Data
+{
+	value: f32
+}
+
+[export]
+fn Scale(data: Data) -> f32
+{
+	let value = data.value;
+	value *= Factor;
+	return value;
+}
+
+[export]
+fn Accumulate(value: f32) -> f32
+{
+	let result = Twice(value);
+	let total = result;
+	{
+		let result = total * Factor;
+		total = result;
+	}
+	return total;
+}
+
+fn Twice(value: f32) -> f32
+{
+	return value * 2.0;
+}
+)";
+
+	std::string_view shaderSource = R"(
+[nzsl_version("1.0")]
+module;
+
+import Accumulate, Data, Scale from Utils;
+
+[entry(frag)]
+fn main()
+{
+	let data: Data;
+	data.value = 1.0;
+	let value = Scale(data);
+	let result = Accumulate(value);
+}
+)";
+
+	auto moduleResolver = std::make_shared<nzsl::FilesystemModuleResolver>();
+	moduleResolver->RegisterModule(utilsSource);
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(shaderSource);
+
+	nzsl::Ast::SanitizeVisitor::Options sanitizeOpt;
+	sanitizeOpt.moduleResolver = moduleResolver;
+
+	nzsl::Ast::ModulePtr uncachedModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+
+	auto moduleCache = std::make_shared<nzsl::Ast::SanitizedModuleCache>(*moduleResolver);
+	sanitizeOpt.moduleCache = moduleCache;
+
+	nzsl::Ast::ModulePtr firstModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+	CHECK(moduleCache->GetEntryCount() == 1);
+	CHECK(nzsl::Ast::Compare(*firstModule, *uncachedModule));
+
+	SECTION("Sanitizing again uses the cached module")
+	{
+		nzsl::Ast::ModulePtr secondModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+		CHECK(moduleCache->GetEntryCount() == 1);
+		CHECK(nzsl::Ast::Compare(*secondModule, *uncachedModule));
+
+		secondModule = SanitizeModule(*shaderModule, sanitizeOpt);
+		ExpectNZSL(*secondModule, R"(
+	fn Scale(data: Data) -> f32
+	{
+		let value: f32 = data.value;
+		value *= Factor;
+		return value;
+	}
+)");
+	}
+
+	SECTION("Cached modules are imported without being sanitized again")
+	{
+		// Renamed variables and removed declarations can't be sanitized a second time, the cached module has to be imported as is
+		sanitizeOpt.makeVariableNameUnique = true;
+		sanitizeOpt.removeAliases = true;
+		sanitizeOpt.removeSingleConstDeclaration = true;
+
+		sanitizeOpt.moduleCache = nullptr;
+		nzsl::Ast::ModulePtr uncachedUniqueModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+
+		sanitizeOpt.moduleCache = moduleCache;
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			nzsl::Ast::ModulePtr uniqueModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+			CHECK(moduleCache->GetEntryCount() == 2);
+			CHECK(nzsl::Ast::Compare(*uniqueModule, *uncachedUniqueModule));
+		}
+
+		ExpectNZSL(*SanitizeModule(*shaderModule, sanitizeOpt), R"(
+			let result_2: f32 = total * (2.0);
+			total = result_2;
+)");
+	}
+
+	SECTION("Different options get their own entry")
+	{
+		sanitizeOpt.removeCompoundAssignments = true;
+
+		nzsl::Ast::ModulePtr secondModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+		CHECK(moduleCache->GetEntryCount() == 2);
+
+		ExpectNZSL(*secondModule, R"(
+	fn Scale(data: Data) -> f32
+	{
+		let value: f32 = data.value;
+		value = value * Factor;
+		return value;
+	}
+)");
+	}
+
+	SECTION("Options of the importing module don't affect the entry")
+	{
+		nzsl::Ast::ModulePtr optionShaderModule = nzsl::Parse(R"(
+[nzsl_version("1.0")]
+module;
+
+import Data, Scale from Utils;
+
+option Multiplier: f32 = 1.0;
+
+[entry(frag)]
+fn main()
+{
+	let data: Data;
+	data.value = Multiplier;
+	let value = Scale(data);
+}
+)");
+
+		sanitizeOpt.optionValues[nzsl::Ast::HashOption("Multiplier")] = 2.0f;
+		nzsl::Ast::ModulePtr firstOptionModule = nzsl::Ast::Sanitize(*optionShaderModule, sanitizeOpt);
+		CHECK(moduleCache->GetEntryCount() == 1);
+
+		sanitizeOpt.optionValues[nzsl::Ast::HashOption("Multiplier")] = 3.0f;
+		nzsl::Ast::ModulePtr secondOptionModule = nzsl::Ast::Sanitize(*optionShaderModule, sanitizeOpt);
+		CHECK(moduleCache->GetEntryCount() == 1);
+
+		sanitizeOpt.moduleCache = nullptr;
+		nzsl::Ast::ModulePtr uncachedOptionModule = nzsl::Ast::Sanitize(*optionShaderModule, sanitizeOpt);
+		CHECK(nzsl::Ast::Compare(*secondOptionModule, *uncachedOptionModule));
+	}
+
+	SECTION("Updating the module invalidates its entries")
+	{
+		std::string updatedSource(utilsSource);
+		updatedSource.replace(updatedSource.find("2.0"), 3, "4.0");
+
+		// Entries are removed when the resolver signals the update, even if the previous module is still alive
+		nzsl::Ast::ModulePtr previousUtilsModule = moduleResolver->Resolve("Utils");
+
+		moduleResolver->RegisterModule(updatedSource);
+		CHECK(moduleCache->GetEntryCount() == 0);
+
+		nzsl::Ast::ModulePtr secondModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+		CHECK(moduleCache->GetEntryCount() == 1);
+
+		ExpectNZSL(*secondModule, R"(
+	const Factor: f32 = 4.0;
+)");
+	}
+
+	SECTION("Entries don't keep their module alive")
+	{
+		std::weak_ptr<nzsl::Ast::Module> utilsModule = moduleResolver->Resolve("Utils");
+		REQUIRE_FALSE(utilsModule.expired());
+
+		moduleResolver->RegisterModule(utilsSource);
+		CHECK(utilsModule.expired());
+		CHECK(moduleCache->GetEntryCount() == 0);
+	}
+
+	SECTION("Modules can be updated while other threads sanitize")
+	{
+		std::atomic_bool failed = false;
+		std::vector<std::thread> threads;
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&]
+			{
+				try
+				{
+					for (std::size_t j = 0; j < 10; ++j)
+						nzsl::Ast::Sanitize(*shaderModule, sanitizeOpt);
+				}
+				catch (const std::exception&)
+				{
+					failed = true;
+				}
+			});
+		}
+
+		for (std::size_t i = 0; i < 10; ++i)
+			moduleResolver->RegisterModule(utilsSource);
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		CHECK_FALSE(failed);
+		CHECK(moduleCache->GetEntryCount() <= 1);
+	}
+
+	SECTION("Modules importing other modules are not cached")
+	{
+		moduleResolver->RegisterModule(R"(
+[nzsl_version("1.0")]
+module Wrapper;
+
+import Data, Scale from Utils;
+
+[export]
+fn ScaleTwice(value: f32) -> f32
+{
+	let data: Data;
+	data.value = value;
+	return Scale(data) * Scale(data);
+}
+)");
+
+		nzsl::Ast::ModulePtr wrapperShaderModule = nzsl::Parse(R"(
+[nzsl_version("1.0")]
+module;
+
+import ScaleTwice from Wrapper;
+
+[entry(frag)]
+fn main()
+{
+	let value = ScaleTwice(1.0);
+}
+)");
+
+		sanitizeOpt.moduleCache = nullptr;
+		nzsl::Ast::ModulePtr uncachedWrapperModule = nzsl::Ast::Sanitize(*wrapperShaderModule, sanitizeOpt);
+
+		sanitizeOpt.moduleCache = moduleCache;
+		for (std::size_t i = 0; i < 2; ++i)
+		{
+			nzsl::Ast::ModulePtr wrapperModule = nzsl::Ast::Sanitize(*wrapperShaderModule, sanitizeOpt);
+			CHECK(moduleCache->GetEntryCount() == 1);
+			CHECK(nzsl::Ast::Compare(*wrapperModule, *uncachedWrapperModule));
+		}
+	}
+}
@@ -55,4 +55,29 @@ TEST_CASE("Standalone compiler", "[NZSLC]")
 		CheckHeaderMatch("test_files/Shader.nzslb");
 		CheckHeaderMatch("test_files/Shader.spv");
 	}
+
+	WHEN("Compiling permutations")
+	{
+		REQUIRE(std::filesystem::exists("../resources/Permutations.nzsl"));
+
+		auto Cleanup = []
+		{
+			std::filesystem::remove_all("test_files");
+		};
+
+		Cleanup();
+
+		Nz::CallOnExit cleanupOnExit(std::move(Cleanup));
+
+		// Only variants using the texture declare its binding, it still has to be part of the binding map
+		ExecuteCommand("./nzslc --compile=glsl --gl-bindingmap --permutations=../resources/Permutations.json -o test_files ../resources/Permutations.nzsl");
+		CheckFileMatch("../resources/Permutations.glsl.binding.json", "test_files/Permutations.glsl.binding.json");
+		CHECK(std::filesystem::exists("test_files/Permutations.permutations.json"));
+
+		std::filesystem::remove_all("test_files");
+
+		ExecuteCommand("./nzslc --compile=glsl --gl-bindingmap --permutations=../resources/Permutations.json --permutation-prune -o test_files ../resources/Permutations.nzsl");
+		CheckFileMatch("../resources/Permutations.glsl.binding.json", "test_files/Permutations.glsl.binding.json");
+		CHECK(std::filesystem::exists("test_files/Permutations.permutations.json"));
+	}
 }
@@ -1,8 +1,10 @@
 #include <Tests/ShaderUtils.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/Ast/Compare.hpp>
 #include <NZSL/Ast/ConstantPropagationVisitor.hpp>
 #include <NZSL/Ast/EliminateUnusedPassVisitor.hpp>
+#include <NZSL/Ast/PassManager.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <cctype>
@@ -12,9 +14,17 @@ void PropagateConstantAndExpect(std::string_view sourceCode, std::string_view ex
 	nzsl::Ast::ModulePtr shaderModule;
 	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
 	shaderModule = SanitizeModule(*shaderModule);
-	REQUIRE_NOTHROW(shaderModule = nzsl::Ast::PropagateConstants(*shaderModule));
 
-	ExpectNZSL(*shaderModule, expectedOptimizedResult);
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::PropagateConstants(*shaderModule));
+
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// In-place propagation should give the same result
+	nzsl::Ast::ConstantPropagationVisitor propagationVisitor;
+	REQUIRE_NOTHROW(propagationVisitor.ProcessInPlace(*shaderModule));
+
+	CHECK(nzsl::Ast::Compare(*shaderModule, *optimizedModule));
 }
 
 void EliminateUnusedAndExpect(std::string_view sourceCode, std::string_view expectedOptimizedResult)
@@ -25,9 +35,19 @@ void EliminateUnusedAndExpect(std::string_view sourceCode, std::string_view expe
 	nzsl::Ast::ModulePtr shaderModule;
 	REQUIRE_NOTHROW(shaderModule = nzsl::Parse(sourceCode));
 	shaderModule = SanitizeModule(*shaderModule);
-	REQUIRE_NOTHROW(shaderModule = nzsl::Ast::EliminateUnusedPass(*shaderModule, depConfig));
 
-	ExpectNZSL(*shaderModule, expectedOptimizedResult);
+	nzsl::Ast::ModulePtr optimizedModule;
+	REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::EliminateUnusedPass(*shaderModule, depConfig));
+
+	ExpectNZSL(*optimizedModule, expectedOptimizedResult);
+
+	// In-place elimination should give the same result
+	nzsl::Ast::UnusedEliminationPass eliminationPass;
+	const nzsl::Ast::Module& moduleRef = *shaderModule;
+	nzsl::Ast::PassManager::Context context(moduleRef, std::move(shaderModule), depConfig);
+	REQUIRE_NOTHROW(eliminationPass.Run(context));
+
+	CHECK(nzsl::Ast::Compare(context.GetModule(), *optimizedModule));
 }
 
 TEST_CASE("optimizations", "[Shader]")
@@ -443,4 +463,95 @@ fn main() -> Output
 	return output;
 })");
 	}
+
+	WHEN("eliminating unused code with options")
+	{
+		// Options are part of the module interface and are kept even if unused
+		EliminateUnusedAndExpect(R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = false;
+option Scale: f32 = 1.0;
+
+fn unusedFunction() -> f32
+{
+	return Scale;
+}
+
+[entry(frag)]
+fn main()
+{
+	let value = unusedFunction();
+})", R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = false;
+option Scale: f32 = 1.0;
+[entry(frag)]
+fn main()
+{
+
+})");
+	}
+
+	WHEN("optimizing a module we own")
+	{
+		nzsl::Ast::ModulePtr shaderModule;
+		REQUIRE_NOTHROW(shaderModule = nzsl::Parse(R"(
+[nzsl_version("1.0")]
+module;
+
+fn unusedFunction() -> f32
+{
+	return 1.0;
+}
+
+struct Output
+{
+	[location(0)] value: f32
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	output.value = 2.0 * 21.0;
+	return output;
+}
+)"));
+		shaderModule = SanitizeModule(*shaderModule);
+
+		// Passes work on the module in place, the entry function node isn't copied
+		const nzsl::Ast::Statement* entryFunction = shaderModule->rootNode->statements.back().get();
+
+		nzsl::Ast::DependencyCheckerVisitor::Config depConfig;
+		depConfig.usedShaderStages = nzsl::ShaderStageType_All;
+
+		nzsl::Ast::ModulePtr optimizedModule;
+		REQUIRE_NOTHROW(optimizedModule = nzsl::Ast::Optimize(std::move(shaderModule), depConfig));
+
+		CHECK(optimizedModule->rootNode->statements.back().get() == entryFunction);
+
+		ExpectNZSL(*optimizedModule, R"(
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	output.value = 42.0;
+	return output;
+}
+)");
+
+		// A module which is also referenced elsewhere is left untouched, passes work on a copy
+		nzsl::Ast::ModulePtr sharedModule = optimizedModule;
+
+		nzsl::Ast::ModulePtr reoptimizedModule;
+		REQUIRE_NOTHROW(reoptimizedModule = nzsl::Ast::Optimize(std::move(sharedModule), depConfig));
+
+		CHECK(reoptimizedModule != optimizedModule);
+		CHECK(reoptimizedModule->rootNode->statements.back().get() != entryFunction);
+		CHECK(optimizedModule->rootNode->statements.back().get() == entryFunction);
+	}
 }
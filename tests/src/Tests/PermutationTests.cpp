@@ -0,0 +1,434 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/GlslWriter.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/PermutationCompiler.hpp>
+#include <NZSL/ShaderBuilder.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/Ast/OptionRelevanceVisitor.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+
+TEST_CASE("permutation compiler", "[Shader]")
+{
+	using namespace nzsl::Ast::Literals;
+
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = false;
+option Unused: bool = false;
+option Factor: f32 = 1.0;
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	const if (UseColor)
+		output.color = vec4[f32](1.0, 0.0, 0.0, 1.0) * Factor;
+	else
+		output.color = vec4[f32](0.0, 0.0, 0.0, 1.0) * Factor;
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(sourceCode);
+
+	nzsl::PermutationCompiler::Parameters parameters;
+	parameters.pruneIrrelevantOptions = true;
+	parameters.states.optimize = true;
+	parameters.optionMatrix = {
+		{ "UseColor", { false, true } },
+		{ "Unused", { false, true } },
+		{ "Factor", { 1.f, 2.f } }
+	};
+
+	auto& glslTarget = parameters.targets.emplace_back();
+	glslTarget.backend = nzsl::PermutationCompiler::Backend::GLSL;
+	glslTarget.shaderStage = nzsl::ShaderStageType::Fragment;
+
+	auto& spirvTarget = parameters.targets.emplace_back();
+	spirvTarget.backend = nzsl::PermutationCompiler::Backend::SPIRV;
+
+	REQUIRE(nzsl::PermutationCompiler::GetCombinationCount(parameters.optionMatrix) == 8);
+
+	for (unsigned int workerCount : { 1u, 4u })
+	{
+		parameters.workerCount = workerCount;
+
+		nzsl::PermutationCompiler compiler;
+		nzsl::PermutationCompiler::Output output = compiler.Compile(*shaderModule, parameters);
+
+		// Unused option doesn't change the output and isn't compiled
+		REQUIRE(output.variants.size() == 16);
+		CHECK(output.generatedVariantCount == 8);
+		CHECK(output.blobs.size() == 8);
+
+		for (std::size_t i = 0; i < output.variants.size(); ++i)
+		{
+			const auto& variant = output.variants[i];
+			CHECK(variant.targetIndex == i % 2);
+			REQUIRE(variant.optionValueIndices.size() == 3);
+
+			std::unordered_map<nzsl::Ast::OptionHash, nzsl::Ast::ConstantValue> optionValues;
+			for (std::size_t j = 0; j < parameters.optionMatrix.size(); ++j)
+				optionValues[nzsl::Ast::HashOption(std::string_view(parameters.optionMatrix[j].optionName))] = parameters.optionMatrix[j].values[variant.optionValueIndices[j]];
+
+			nzsl::ShaderWriter::States states;
+			states.optimize = true;
+			states.optionValues = optionValues;
+
+			const auto& blobData = output.blobs[variant.blobIndex].data;
+			if (variant.targetIndex == 0)
+			{
+				nzsl::GlslWriter glslWriter;
+				std::string code = glslWriter.Generate(nzsl::ShaderStageType::Fragment, *shaderModule, {}, states).code;
+				CHECK(std::string(blobData.begin(), blobData.end()) == code);
+			}
+			else
+			{
+				nzsl::SpirvWriter spirvWriter;
+				std::vector<std::uint32_t> spirv = spirvWriter.Generate(*shaderModule, states);
+				REQUIRE(blobData.size() == spirv.size() * sizeof(std::uint32_t));
+				CHECK(std::memcmp(blobData.data(), spirv.data(), blobData.size()) == 0);
+			}
+		}
+
+		// Variants only differing by the unused option share their blobs
+		CHECK(output.variants[0].optionValueIndices == std::vector<std::size_t>{ 0, 0, 0 });
+		CHECK(output.variants[4].optionValueIndices == std::vector<std::size_t>{ 0, 1, 0 });
+		CHECK(output.variants[0].blobIndex == output.variants[4].blobIndex);
+		CHECK(output.variants[1].blobIndex == output.variants[5].blobIndex);
+		CHECK(output.variants[0].blobIndex != output.variants[2].blobIndex);
+	}
+
+	WHEN("A variant fails to compile")
+	{
+		parameters.optionMatrix[2].values.push_back(std::int32_t(2));
+		parameters.workerCount = 4;
+
+		nzsl::PermutationCompiler compiler;
+		CHECK_THROWS(compiler.Compile(*shaderModule, parameters));
+	}
+}
+
+TEST_CASE("permutation binding map", "[Shader]")
+{
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseTexture: bool = false;
+
+[layout(std140)]
+struct Data
+{
+	color: vec4[f32]
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[Data]
+}
+
+[cond(UseTexture)]
+external
+{
+	[set(1), binding(0)] tex: sampler2D[f32]
+}
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	output.color = data.color;
+	const if (UseTexture)
+		output.color *= tex.Sample(vec2[f32](0.0, 0.0));
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(sourceCode);
+
+	nzsl::PermutationCompiler::Parameters parameters;
+	parameters.mapGlslBindings = true;
+	parameters.optionMatrix = {
+		{ "UseTexture", { false, true } }
+	};
+
+	auto& glslTarget = parameters.targets.emplace_back();
+	glslTarget.backend = nzsl::PermutationCompiler::Backend::GLSL;
+	glslTarget.shaderStage = nzsl::ShaderStageType::Fragment;
+
+	for (unsigned int workerCount : { 1u, 4u })
+	{
+		parameters.workerCount = workerCount;
+
+		nzsl::PermutationCompiler compiler;
+		nzsl::PermutationCompiler::Output output = compiler.Compile(*shaderModule, parameters);
+
+		// Bindings of every combination are mapped, in combination order
+		CHECK(output.glslParameters.bindingMapping == std::unordered_map<std::uint64_t, unsigned int>{ { 0, 0 }, { 1ull << 32, 1 } });
+		CHECK_FALSE(output.glslParameters.pushConstantBinding.has_value());
+
+		REQUIRE(output.variants.size() == 2);
+		for (const auto& variant : output.variants)
+		{
+			nzsl::ShaderWriter::States states;
+			states.optionValues[nzsl::Ast::HashOption("UseTexture")] = parameters.optionMatrix[0].values[variant.optionValueIndices[0]];
+
+			nzsl::GlslWriter glslWriter;
+			std::string code = glslWriter.Generate(nzsl::ShaderStageType::Fragment, *shaderModule, output.glslParameters, states).code;
+
+			const auto& blobData = output.blobs[variant.blobIndex].data;
+			CHECK(std::string(blobData.begin(), blobData.end()) == code);
+		}
+	}
+}
+
+TEST_CASE("permutation specialization constants", "[Shader]")
+{
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = false;
+option Factor: f32 = 1.0;
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let output: Output;
+	const if (UseColor)
+		output.color = vec4[f32](1.0, 0.0, 0.0, 1.0) * Factor;
+	else
+		output.color = vec4[f32](0.0, 0.0, 0.0, 1.0) * Factor;
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(sourceCode);
+
+	nzsl::PermutationCompiler::Parameters parameters;
+	parameters.optionMatrix = {
+		{ "UseColor", { false, true } }
+	};
+
+	// Same backend with and without specialization constants, each must be sanitized for its own environment
+	auto& specializedTarget = parameters.targets.emplace_back();
+	specializedTarget.backend = nzsl::PermutationCompiler::Backend::SPIRV;
+	specializedTarget.spirvEnv.specializationConstantOptions.insert(nzsl::Ast::HashOption("Factor"));
+
+	auto& constantTarget = parameters.targets.emplace_back();
+	constantTarget.backend = nzsl::PermutationCompiler::Backend::SPIRV;
+
+	for (unsigned int workerCount : { 1u, 4u })
+	{
+		parameters.workerCount = workerCount;
+
+		nzsl::PermutationCompiler compiler;
+		nzsl::PermutationCompiler::Output output = compiler.Compile(*shaderModule, parameters);
+
+		REQUIRE(output.variants.size() == 4);
+		for (const auto& variant : output.variants)
+		{
+			nzsl::ShaderWriter::States states;
+			states.optionValues[nzsl::Ast::HashOption("UseColor")] = parameters.optionMatrix[0].values[variant.optionValueIndices[0]];
+
+			nzsl::SpirvWriter spirvWriter;
+			spirvWriter.SetEnv(parameters.targets[variant.targetIndex].spirvEnv);
+
+			std::vector<std::uint32_t> spirv = spirvWriter.Generate(*shaderModule, states);
+			CHECK(spirvWriter.GetSpecializationConstantIds().empty() == (variant.targetIndex != 0));
+
+			const auto& blobData = output.blobs[variant.blobIndex].data;
+			REQUIRE(blobData.size() == spirv.size() * sizeof(std::uint32_t));
+			CHECK(std::memcmp(blobData.data(), spirv.data(), blobData.size()) == 0);
+		}
+
+		CHECK(output.variants[0].blobIndex != output.variants[1].blobIndex);
+	}
+}
+
+TEST_CASE("option relevance", "[Shader]")
+{
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+option VertexOnly: bool = false;
+option FragmentOnly: bool = false;
+option ThroughConst: f32 = 1.0;
+option FunctionCond: bool = false;
+option MemberCond: bool = false;
+option Unused: bool = false;
+
+const Scale = ThroughConst * 2.0;
+
+struct VertOut
+{
+	[builtin(position)] position: vec4[f32],
+	[cond(MemberCond), location(0)] color: vec4[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[cond(FunctionCond)]
+fn GetColor() -> vec4[f32]
+{
+	return vec4[f32](1.0, 1.0, 1.0, 1.0);
+}
+
+[cond(!FunctionCond)]
+fn GetColor() -> vec4[f32]
+{
+	return vec4[f32](0.0, 0.0, 0.0, 1.0);
+}
+
+fn NeverCalled() -> f32
+{
+	const if (Unused)
+		return 1.0;
+	else
+		return 0.0;
+}
+
+[entry(vert)]
+fn main() -> VertOut
+{
+	let output: VertOut;
+	output.position = vec4[f32](0.0, 0.0, 0.0, 1.0) * const_select(VertexOnly, 2.0, 1.0);
+	return output;
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let output: FragOut;
+	output.color = GetColor() * Scale;
+	const if (FragmentOnly)
+		output.color *= 0.5;
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(sourceCode);
+
+	nzsl::Ast::SanitizeVisitor::Options sanitizeOptions;
+	sanitizeOptions.partialSanitization = true;
+
+	nzsl::Ast::ModulePtr partialModule = nzsl::Ast::Sanitize(*shaderModule, sanitizeOptions);
+	nzsl::Ast::OptionRelevanceVisitor::Result optionRelevance = nzsl::Ast::AnalyzeOptionRelevance(*partialModule);
+
+	auto GetOptionNames = [&](const Nz::Bitset<>& options)
+	{
+		std::vector<std::string> optionNames;
+		for (std::size_t optionIndex : options.IterBits())
+			optionNames.push_back(optionRelevance.options[optionIndex]);
+
+		return optionNames;
+	};
+
+	REQUIRE(optionRelevance.options.size() == 6);
+	REQUIRE(optionRelevance.entryPoints.size() == 2);
+
+	CHECK(optionRelevance.entryPoints[0].stage == nzsl::ShaderStageType::Vertex);
+	CHECK(GetOptionNames(optionRelevance.entryPoints[0].relevantOptions) == std::vector<std::string>{ "VertexOnly", "MemberCond" });
+
+	CHECK(optionRelevance.entryPoints[1].stage == nzsl::ShaderStageType::Fragment);
+	CHECK(GetOptionNames(optionRelevance.entryPoints[1].relevantOptions) == std::vector<std::string>{ "FragmentOnly", "ThroughConst", "FunctionCond" });
+
+	CHECK(GetOptionNames(optionRelevance.GetRelevantOptions(nzsl::ShaderStageType_All)) == std::vector<std::string>{ "VertexOnly", "FragmentOnly", "ThroughConst", "FunctionCond", "MemberCond" });
+	CHECK(GetOptionNames(optionRelevance.referencedOptions) == std::vector<std::string>{ "VertexOnly", "FragmentOnly", "ThroughConst", "FunctionCond", "MemberCond", "Unused" });
+
+	WHEN("An entry point stage isn't resolved")
+	{
+		for (auto& statement : partialModule->rootNode->statements)
+		{
+			if (statement->GetType() != nzsl::Ast::NodeType::DeclareFunctionStatement)
+				continue;
+
+			auto& func = static_cast<nzsl::Ast::DeclareFunctionStatement&>(*statement);
+			if (func.entryStage.IsResultingValue() && func.entryStage.GetResultingValue() == nzsl::ShaderStageType::Fragment)
+			{
+				nzsl::Ast::ExpressionPtr entryStage = nzsl::ShaderBuilder::Identifier("EntryStage");
+				func.entryStage = std::move(entryStage);
+			}
+		}
+
+		optionRelevance = nzsl::Ast::AnalyzeOptionRelevance(*partialModule);
+
+		REQUIRE(optionRelevance.entryPoints.size() == 2);
+		CHECK(optionRelevance.entryPoints[1].functionName == "main");
+		CHECK_FALSE(optionRelevance.entryPoints[1].stage.has_value());
+
+		// It can be an entry point of any stage
+		CHECK(GetOptionNames(optionRelevance.GetRelevantOptions(nzsl::ShaderStageType::Vertex)) == std::vector<std::string>{ "VertexOnly", "FragmentOnly", "ThroughConst", "FunctionCond", "MemberCond" });
+		CHECK(GetOptionNames(optionRelevance.GetRelevantOptions(nzsl::ShaderStageType::Compute)) == std::vector<std::string>{ "FragmentOnly", "ThroughConst", "FunctionCond" });
+	}
+
+	WHEN("Compiling permutations of each stage")
+	{
+		nzsl::PermutationCompiler::Parameters parameters;
+		parameters.pruneIrrelevantOptions = true;
+		parameters.states.optimize = true;
+		parameters.optionMatrix = {
+			{ "VertexOnly", { false, true } },
+			{ "FragmentOnly", { false, true } },
+			{ "FunctionCond", { false, true } },
+			{ "Unused", { false, true } }
+		};
+
+		auto& vertexTarget = parameters.targets.emplace_back();
+		vertexTarget.backend = nzsl::PermutationCompiler::Backend::GLSL;
+		vertexTarget.shaderStage = nzsl::ShaderStageType::Vertex;
+
+		auto& fragmentTarget = parameters.targets.emplace_back();
+		fragmentTarget.backend = nzsl::PermutationCompiler::Backend::GLSL;
+		fragmentTarget.shaderStage = nzsl::ShaderStageType::Fragment;
+
+		nzsl::PermutationCompiler compiler;
+		nzsl::PermutationCompiler::Output output = compiler.Compile(*shaderModule, parameters);
+
+		REQUIRE(output.variants.size() == 32);
+		CHECK(output.generatedVariantCount == 2 + 4);
+		CHECK(output.blobs.size() == 6);
+
+		for (const auto& variant : output.variants)
+		{
+			nzsl::ShaderWriter::States states;
+			states.optimize = true;
+			for (std::size_t i = 0; i < parameters.optionMatrix.size(); ++i)
+				states.optionValues[nzsl::Ast::HashOption(std::string_view(parameters.optionMatrix[i].optionName))] = parameters.optionMatrix[i].values[variant.optionValueIndices[i]];
+
+			nzsl::GlslWriter glslWriter;
+			std::string code = glslWriter.Generate(parameters.targets[variant.targetIndex].shaderStage, *shaderModule, {}, states).code;
+
+			const auto& blobData = output.blobs[variant.blobIndex].data;
+			CHECK(std::string(blobData.begin(), blobData.end()) == code);
+		}
+	}
+}
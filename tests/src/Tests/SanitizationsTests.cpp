@@ -1,10 +1,13 @@
 #include <Tests/ShaderUtils.hpp>
 #include <NazaraUtils/Algorithm.hpp>
+#include <NZSL/LangWriter.hpp>
 #include <NZSL/Serializer.hpp>
 #include <NZSL/ShaderBuilder.hpp>
 #include <NZSL/Parser.hpp>
 #include <NZSL/Ast/SanitizeVisitor.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <fmt/format.h>
 #include <array>
 #include <cctype>
 #include <string>
@@ -592,3 +595,341 @@ fn main()
 
 	}
 }
+
+TEST_CASE("consuming sanitization", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseColor: bool = true;
+
+struct ColorData
+{
+	color: vec4[f32],
+	factor: f32
+}
+
+alias Data = ColorData;
+
+external
+{
+	[set(0), binding(0)] data: uniform[Data]
+}
+
+[cond(UseColor)]
+fn GetColor() -> vec4[f32]
+{
+	return data.color * data.factor;
+}
+
+[cond(!UseColor)]
+fn GetColor() -> vec4[f32]
+{
+	return vec4[f32](data.factor, data.factor, data.factor, 1.0);
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let output: FragOut;
+	output.color = GetColor();
+	for i in 0 -> 4
+	{
+		output.color.x += f32(i);
+	}
+
+	const if (UseColor)
+	{
+		output.color *= 2.0;
+	}
+
+	return output;
+}
+)";
+
+	nzsl::Ast::SanitizeVisitor::Options options;
+	options.reduceLoopsToWhile = true;
+	options.removeAliases = true;
+	options.removeCompoundAssignments = true;
+
+	WHEN("Sanitizing completely")
+	{
+		nzsl::Ast::ModulePtr sanitizedModule = nzsl::Ast::Sanitize(*nzsl::Parse(nzslSource), options);
+		nzsl::Ast::ModulePtr consumedModule = nzsl::Ast::Sanitize(std::move(*nzsl::Parse(nzslSource)), options);
+
+		nzsl::LangWriter langWriter;
+		CHECK(langWriter.Generate(*consumedModule) == langWriter.Generate(*sanitizedModule));
+	}
+
+	WHEN("Sanitizing partially")
+	{
+		options.partialSanitization = true;
+
+		nzsl::Ast::ModulePtr sanitizedModule = nzsl::Ast::Sanitize(*nzsl::Parse(nzslSource), options);
+		nzsl::Ast::ModulePtr consumedModule = nzsl::Ast::Sanitize(std::move(*nzsl::Parse(nzslSource)), options);
+
+		nzsl::LangWriter langWriter;
+		CHECK(langWriter.Generate(*consumedModule) == langWriter.Generate(*sanitizedModule));
+	}
+
+	WHEN("Moving nodes out of the input")
+	{
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+		auto& entryFunction = static_cast<nzsl::Ast::DeclareFunctionStatement&>(*shaderModule->rootNode->statements.back());
+		const nzsl::Ast::Statement* outputDeclaration = entryFunction.statements.front().get();
+
+		nzsl::Ast::ModulePtr consumedModule = nzsl::Ast::Sanitize(std::move(*shaderModule), options);
+
+		// Declarations which don't have to be transformed are reused instead of being copied
+		auto& sanitizedEntryFunction = static_cast<nzsl::Ast::DeclareFunctionStatement&>(*consumedModule->rootNode->statements.back());
+		CHECK(sanitizedEntryFunction.statements.front().get() == outputDeclaration);
+	}
+}
+
+TEST_CASE("specializing partially sanitized modules", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseTexture: bool = false;
+option Factor: f32 = 1.0;
+
+[layout(std140)]
+struct Data
+{
+	color: vec4[f32]
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[Data]
+}
+
+[cond(UseTexture)]
+external
+{
+	[set(0), binding(1)] tex: sampler2D[f32]
+}
+
+[cond(UseTexture)]
+fn GetColor(uv: vec2[f32]) -> vec4[f32]
+{
+	return tex.Sample(uv) * data.color;
+}
+
+[cond(!UseTexture)]
+fn GetColor(uv: vec2[f32]) -> vec4[f32]
+{
+	return data.color;
+}
+
+struct FragIn
+{
+	[location(0)] uv: vec2[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: FragIn) -> FragOut
+{
+	let output: FragOut;
+	output.color = GetColor(input.uv) * Factor;
+	const if (UseTexture)
+	{
+		output.color.w = 1.0;
+	}
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::Ast::SanitizeVisitor::Options partialOptions;
+	partialOptions.partialSanitization = true;
+
+	nzsl::Ast::ModulePtr partialModule = nzsl::Ast::Sanitize(*shaderModule, partialOptions);
+
+	nzsl::LangWriter langWriter;
+	for (bool useTexture : { false, true })
+	{
+		for (float factor : { 1.f, 2.f })
+		{
+			INFO("UseTexture: " << useTexture << ", Factor: " << factor);
+
+			std::unordered_map<nzsl::Ast::OptionHash, nzsl::Ast::ConstantValue> optionValues;
+			optionValues[nzsl::Ast::HashOption("UseTexture")] = useTexture;
+			optionValues[nzsl::Ast::HashOption("Factor")] = factor;
+
+			nzsl::Ast::SanitizeVisitor::Options options;
+			options.optionValues = optionValues;
+
+			nzsl::Ast::ModulePtr sanitizedModule = nzsl::Ast::Sanitize(*shaderModule, options);
+			nzsl::Ast::ModulePtr specializedModule = nzsl::Ast::Specialize(*partialModule, optionValues);
+
+			CHECK(langWriter.Generate(*specializedModule) == langWriter.Generate(*sanitizedModule));
+		}
+	}
+}
+
+TEST_CASE("specializing partially sanitized modules with renamed fields", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option Factor: f32 = 1.0;
+
+struct FragIn
+{
+	[builtin(frag_coord)] sample: vec4[f32],
+	[location(0)] uv: vec2[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: FragIn) -> FragOut
+{
+	let color = input.sample * 2.0;
+	let output: FragOut;
+	output.color = color * Factor + vec4[f32](input.uv, 0.0, 1.0);
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::Ast::SanitizeVisitor::Options partialOptions;
+	partialOptions.partialSanitization = true;
+	partialOptions.useIdentifierAccessesForStructs = true;
+
+	nzsl::Ast::ModulePtr partialModule = nzsl::Ast::Sanitize(*shaderModule, partialOptions);
+
+	// Field accesses copied from the partially sanitized module have to use the sanitized field names
+	nzsl::Ast::SanitizeVisitor::Options options;
+	options.useIdentifierAccessesForStructs = true;
+	options.identifierSanitizer = [](std::string& identifier, nzsl::Ast::IdentifierScope /*scope*/)
+	{
+		if (identifier != "sample")
+			return false;
+
+		identifier += '_';
+		return true;
+	};
+
+	std::unordered_map<nzsl::Ast::OptionHash, nzsl::Ast::ConstantValue> optionValues;
+	optionValues[nzsl::Ast::HashOption("Factor")] = 2.f;
+
+	options.optionValues = optionValues;
+
+	nzsl::Ast::ModulePtr sanitizedModule = nzsl::Ast::Sanitize(*shaderModule, options);
+	nzsl::Ast::ModulePtr specializedModule = nzsl::Ast::Specialize(*partialModule, optionValues, options);
+
+	nzsl::LangWriter langWriter;
+	std::string specializedOutput = langWriter.Generate(*specializedModule);
+	CHECK(specializedOutput == langWriter.Generate(*sanitizedModule));
+	CHECK(specializedOutput.find("input.sample_") != std::string::npos);
+}
+
+TEST_CASE("sanitizing large modules", "[.][Benchmark]")
+{
+	// Every declaration references the previous ones, so identifier lookups dominate
+	constexpr std::size_t DeclarationCount = 4000;
+
+	std::string nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+)";
+
+	for (std::size_t i = 0; i < DeclarationCount; ++i)
+	{
+		nzslSource += fmt::format(R"(
+const Value{0}: i32 = {0};
+
+fn Compute{0}(value: i32) -> i32
+{{
+	let result = value + Value{0};
+	{{
+		let result = result * Value{1};
+		return result + Value{1};
+	}}
+}}
+)", i, i / 2);
+	}
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	BENCHMARK("sanitize " + std::to_string(DeclarationCount * 2) + " declarations")
+	{
+		return nzsl::Ast::Sanitize(*shaderModule);
+	};
+}
+
+TEST_CASE("specializing large modules", "[.][Benchmark]")
+{
+	// Only a small part of each function depends on options, as in most shaders with many permutations
+	constexpr std::size_t FunctionCount = 2000;
+
+	std::string nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseFactor: bool = false;
+option Factor: f32 = 1.0;
+)";
+
+	for (std::size_t i = 0; i < FunctionCount; ++i)
+	{
+		nzslSource += fmt::format(R"(
+fn Compute{0}(value: vec4[f32]) -> vec4[f32]
+{{
+	let result = value * {0}.0 + vec4[f32](1.0, 2.0, 3.0, 4.0);
+	result = normalize(result) * dot(result.xyz, value.zyx);
+	const if (UseFactor)
+		result *= Factor;
+
+	return result;
+}}
+)", i);
+	}
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::Ast::SanitizeVisitor::Options partialOptions;
+	partialOptions.partialSanitization = true;
+
+	nzsl::Ast::ModulePtr partialModule = nzsl::Ast::Sanitize(*shaderModule, partialOptions);
+
+	std::unordered_map<nzsl::Ast::OptionHash, nzsl::Ast::ConstantValue> optionValues;
+	optionValues[nzsl::Ast::HashOption("UseFactor")] = true;
+	optionValues[nzsl::Ast::HashOption("Factor")] = 2.f;
+
+	nzsl::Ast::SanitizeVisitor::Options options;
+	options.optionValues = optionValues;
+
+	BENCHMARK("sanitize " + std::to_string(FunctionCount) + " functions")
+	{
+		return nzsl::Ast::Sanitize(*shaderModule, options);
+	};
+
+	BENCHMARK("specialize " + std::to_string(FunctionCount) + " partially sanitized functions")
+	{
+		return nzsl::Ast::Specialize(*partialModule, optionValues);
+	};
+}
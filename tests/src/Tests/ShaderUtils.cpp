@@ -2,6 +2,7 @@
 #include <NZSL/GlslWriter.hpp>
 #include <NZSL/LangWriter.hpp>
 #include <NZSL/Parser.hpp>
+#include <NZSL/SpirV/SpirvOptimizer.hpp>
 #include <NZSL/SpirV/SpirvPrinter.hpp>
 #include <NZSL/SpirvWriter.hpp>
 #include <NZSL/Ast/AstSerializer.hpp>
@@ -414,6 +415,7 @@ void ExpectSPIRV(const nzsl::Ast::Module& shaderModule, std::string_view expecte
 			});
 
 			REQUIRE(spirvTools.Validate(spirv));
+			REQUIRE(spirvTools.Validate(nzsl::SpirvOptimizer{}.Optimize(spirv)));
 		}
 	}
 }
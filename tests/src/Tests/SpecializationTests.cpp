@@ -0,0 +1,123 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirV/SpirvPrinter.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+TEST_CASE("specialization constants", "[Shader]")
+{
+	using namespace nzsl::Ast::Literals;
+
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+option UseScale: bool = false;
+option Scale: f32 = 1.0;
+option SampleCount: u32 = u32(4);
+
+[entry(frag)]
+fn main()
+{
+	let value = const_select(UseScale, Scale, 1.0);
+	value *= f32(SampleCount);
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(sourceCode);
+
+	nzsl::SpirvWriter::Environment env;
+	env.specializationConstantOptions = { "UseScale"_opt, "Scale"_opt };
+
+	nzsl::SpirvWriter spirvWriter;
+	spirvWriter.SetEnv(env);
+
+	nzsl::ShaderWriter::States states;
+	states.debugLevel = nzsl::DebugLevel::Minimal;
+	states.optionValues["Scale"_opt] = 2.f;
+
+	std::vector<std::uint32_t> spirv = spirvWriter.Generate(*shaderModule, states);
+
+	nzsl::SpirvPrinter::Settings printerSettings;
+	printerSettings.printHeader = false;
+
+	std::string output = nzsl::SpirvPrinter{}.Print(spirv.data(), spirv.size(), printerSettings);
+
+	// Options selected as specialization constants are decorated with their hash, their value becomes the default one
+	CHECK(output.find(fmt::format("Decoration(SpecId) {}", "UseScale"_opt)) != std::string::npos);
+	CHECK(output.find(fmt::format("Decoration(SpecId) {}", "Scale"_opt)) != std::string::npos);
+	CHECK(output.find("OpSpecConstantFalse") != std::string::npos);
+	CHECK(output.find("OpSpecConstant %") != std::string::npos);
+	CHECK(output.find("OpConstantFalse") == std::string::npos);
+	CHECK(output.find("OpSelect") != std::string::npos);
+
+	// Other options are still resolved at compile time
+	CHECK(output.find("SampleCount") == std::string::npos);
+
+	const auto& specIds = spirvWriter.GetSpecializationConstantIds();
+	CHECK(specIds.size() == 2);
+	CHECK(specIds.at("UseScale") == "UseScale"_opt);
+	CHECK(specIds.at("Scale") == "Scale"_opt);
+
+	SECTION("Specialization constants are kept by optimization passes")
+	{
+		nzsl::ShaderWriter::States optimizedStates = states;
+		optimizedStates.optimize = true;
+
+		std::vector<std::uint32_t> optimizedSpirv = spirvWriter.Generate(*shaderModule, optimizedStates);
+		std::string optimizedOutput = nzsl::SpirvPrinter{}.Print(optimizedSpirv.data(), optimizedSpirv.size(), printerSettings);
+
+		CHECK(optimizedOutput.find(fmt::format("Decoration(SpecId) {}", "UseScale"_opt)) != std::string::npos);
+		CHECK(optimizedOutput.find(fmt::format("Decoration(SpecId) {}", "Scale"_opt)) != std::string::npos);
+		CHECK(optimizedOutput.find("OpSpecConstantFalse") != std::string::npos);
+		CHECK(optimizedOutput.find("OpSelect") != std::string::npos);
+		CHECK(spirvWriter.GetSpecializationConstantIds().size() == 2);
+	}
+
+	SECTION("Specialization constants can't be used in constant expressions")
+	{
+		std::string_view constSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option Scale: f32 = 1.0;
+
+const DoubleScale = Scale * 2.0;
+
+[entry(frag)]
+fn main()
+{
+	let value = DoubleScale;
+}
+)";
+
+		nzsl::Ast::ModulePtr constModule = nzsl::Parse(constSource);
+		CHECK_THROWS(spirvWriter.Generate(*constModule, states));
+	}
+
+	SECTION("Only scalar options can be specialization constants")
+	{
+		std::string_view vecSource = R"(
+[nzsl_version("1.0")]
+module;
+
+option Color: vec3[f32] = vec3[f32](1.0, 1.0, 1.0);
+
+[entry(frag)]
+fn main()
+{
+	let value = Color;
+}
+)";
+
+		nzsl::SpirvWriter::Environment vecEnv;
+		vecEnv.specializationConstantOptions = { "Color"_opt };
+
+		nzsl::SpirvWriter vecWriter;
+		vecWriter.SetEnv(vecEnv);
+
+		nzsl::Ast::ModulePtr vecModule = nzsl::Parse(vecSource);
+		CHECK_THROWS_WITH(vecWriter.Generate(*vecModule), "(5,1 -> 51): COptionSpecializationUnexpectedType error: option Color cannot be a specialization constant (only scalars are supported, got vec3[f32])");
+	}
+}
@@ -0,0 +1,191 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/SpirV/SpirvData.hpp>
+#include <NZSL/SpirV/SpirvDecoder.hpp>
+#include <NZSL/SpirV/SpirvPrinter.hpp>
+#include <NZSL/SpirV/SpirvSection.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <fmt/format.h>
+
+namespace
+{
+	class OperandCollector : public nzsl::SpirvDecoder
+	{
+		public:
+			struct Operand
+			{
+				nzsl::SpirvOperandKind kind;
+				std::vector<std::uint32_t> words;
+			};
+
+			std::vector<std::vector<Operand>> Collect(const std::vector<std::uint32_t>& spirv)
+			{
+				m_instructions.clear();
+				Decode(spirv.data(), spirv.size());
+
+				return std::move(m_instructions);
+			}
+
+		private:
+			bool HandleOpcode(const nzsl::SpirvInstruction& instruction, std::uint32_t /*wordCount*/) override
+			{
+				auto& operands = m_instructions.emplace_back();
+				ForEachOperand(instruction, [&](const nzsl::SpirvOperand& operand, const std::uint32_t* words, std::size_t wordCount)
+				{
+					operands.push_back({ operand.kind, std::vector<std::uint32_t>(words, words + wordCount) });
+				});
+
+				return true;
+			}
+
+			std::vector<std::vector<Operand>> m_instructions;
+	};
+
+	// Walks every operand without storing them, to measure decoding throughput
+	class OperandCounter : public nzsl::SpirvDecoder
+	{
+		public:
+			std::size_t Count(const std::vector<std::uint32_t>& spirv)
+			{
+				m_operandCount = 0;
+				Decode(spirv.data(), spirv.size());
+
+				return m_operandCount;
+			}
+
+		private:
+			bool HandleOpcode(const nzsl::SpirvInstruction& instruction, std::uint32_t /*wordCount*/) override
+			{
+				ForEachOperand(instruction, [&](const nzsl::SpirvOperand& /*operand*/, const std::uint32_t* /*words*/, std::size_t /*wordCount*/)
+				{
+					m_operandCount++;
+				});
+
+				return true;
+			}
+
+			std::size_t m_operandCount;
+	};
+}
+
+TEST_CASE("SPIR-V decoder", "[Shader]")
+{
+	using OperandKind = nzsl::SpirvOperandKind;
+
+	WHEN("Looking for instructions")
+	{
+		for (nzsl::SpirvOp op : { nzsl::SpirvOp::OpNop, nzsl::SpirvOp::OpCapability, nzsl::SpirvOp::OpImageSampleExplicitLod, nzsl::SpirvOp::OpDecorateString })
+		{
+			const nzsl::SpirvInstruction* instruction = nzsl::GetSpirvInstruction(static_cast<std::uint16_t>(op));
+			REQUIRE(instruction);
+			CHECK(instruction->op == op);
+		}
+
+		CHECK(nzsl::GetSpirvInstruction(13) == nullptr);
+		CHECK(nzsl::GetSpirvInstruction(0xFFFF) == nullptr);
+
+		const nzsl::SpirvGlslStd450Instruction* extInstruction = nzsl::GetSpirvGlslStd450Instruction(static_cast<std::uint16_t>(nzsl::SpirvGlslStd450Op::Sqrt));
+		REQUIRE(extInstruction);
+		CHECK(extInstruction->op == nzsl::SpirvGlslStd450Op::Sqrt);
+	}
+
+	WHEN("Iterating over operands")
+	{
+		nzsl::SpirvSection instructions;
+		instructions.Append(nzsl::SpirvOp::OpName, 1, "main");
+		instructions.Append(nzsl::SpirvOp::OpDecorate, 2, nzsl::SpirvDecoration::SpecId, 42);
+		instructions.Append(nzsl::SpirvOp::OpLoad, 3, 4, 5, nzsl::SpirvMemoryAccess::Aligned, 16);
+		instructions.Append(nzsl::SpirvOp::OpImageSampleExplicitLod, 6, 7, 8, 9, nzsl::SpirvImageOperands::Lod, 10);
+
+		std::vector<std::uint32_t> spirv = { nzsl::SpirvMagicNumber, nzsl::MakeSpirvVersion(1, 0), 0, 11, 0 };
+		spirv.insert(spirv.end(), instructions.GetBytecode().begin(), instructions.GetBytecode().end());
+
+		auto decodedInstructions = OperandCollector{}.Collect(spirv);
+		REQUIRE(decodedInstructions.size() == 4);
+
+		auto CheckOperands = [](const std::vector<OperandCollector::Operand>& operands, std::initializer_list<OperandKind> expectedKinds)
+		{
+			REQUIRE(operands.size() == expectedKinds.size());
+
+			std::size_t i = 0;
+			for (OperandKind kind : expectedKinds)
+				CHECK(operands[i++].kind == kind);
+		};
+
+		CheckOperands(decodedInstructions[0], { OperandKind::IdRef, OperandKind::LiteralString });
+		CHECK(decodedInstructions[0][1].words.size() == 2); //< "main" and its null terminator
+
+		CheckOperands(decodedInstructions[1], { OperandKind::IdRef, OperandKind::Decoration, OperandKind::LiteralInteger });
+		CHECK(decodedInstructions[1][2].words == std::vector<std::uint32_t>{ 42 });
+
+		CheckOperands(decodedInstructions[2], { OperandKind::IdResultType, OperandKind::IdResult, OperandKind::IdRef, OperandKind::MemoryAccess, OperandKind::LiteralInteger });
+		CHECK(decodedInstructions[2][4].words == std::vector<std::uint32_t>{ 16 });
+
+		CheckOperands(decodedInstructions[3], { OperandKind::IdResultType, OperandKind::IdResult, OperandKind::IdRef, OperandKind::IdRef, OperandKind::ImageOperands, OperandKind::IdRef });
+		CHECK(decodedInstructions[3][5].words == std::vector<std::uint32_t>{ 10 });
+	}
+}
+
+TEST_CASE("SPIR-V decoding performance", "[.][Benchmark]")
+{
+	constexpr std::size_t FunctionCount = 200;
+
+	std::string nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+)";
+
+	for (std::size_t i = 0; i < FunctionCount; ++i)
+	{
+		nzslSource += fmt::format(R"(
+fn Compute{0}(value: vec4[f32]) -> vec4[f32]
+{{
+	let result = value * {0}.5 + vec4[f32](1.0, 2.0, 3.0, {0}.0);
+	return normalize(result) * length(value);
+}}
+)", i);
+	}
+
+	nzslSource += R"(
+[entry(frag)]
+fn main() -> FragOut
+{
+	let value = vec4[f32](0.0, 0.0, 0.0, 0.0);
+)";
+
+	for (std::size_t i = 0; i < FunctionCount; ++i)
+		nzslSource += fmt::format("\tvalue = Compute{0}(value);\n", i);
+
+	nzslSource += R"(
+	let output: FragOut;
+	output.color = value;
+	return output;
+}
+)";
+
+	nzsl::ShaderWriter::States states;
+	states.debugLevel = nzsl::DebugLevel::Minimal;
+
+	nzsl::SpirvWriter spirvWriter;
+	std::vector<std::uint32_t> spirv = spirvWriter.Generate(*nzsl::Parse(nzslSource), states);
+
+	// Divide the size by the mean time to get the throughput
+	std::string sizeStr = fmt::format("{:.2f}MB", spirv.size() * sizeof(std::uint32_t) / 1'000'000.0);
+
+	BENCHMARK("decode " + sizeStr + " of SPIR-V")
+	{
+		return OperandCounter{}.Count(spirv);
+	};
+
+	BENCHMARK("print " + sizeStr + " of SPIR-V")
+	{
+		return nzsl::SpirvPrinter{}.Print(spirv);
+	};
+}
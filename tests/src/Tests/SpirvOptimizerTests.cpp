@@ -0,0 +1,163 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NazaraUtils/Algorithm.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/SpirV/SpirvData.hpp>
+#include <NZSL/SpirV/SpirvOptimizer.hpp>
+#include <NZSL/SpirV/SpirvPrinter.hpp>
+#include <NZSL/SpirV/SpirvSection.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+	std::vector<std::uint32_t> BuildModule(std::uint32_t bound, const nzsl::SpirvSection& instructions)
+	{
+		std::vector<std::uint32_t> spirv = { nzsl::SpirvMagicNumber, nzsl::MakeSpirvVersion(1, 0), 0, bound, 0 };
+
+		const std::vector<std::uint32_t>& bytecode = instructions.GetBytecode();
+		spirv.insert(spirv.end(), bytecode.begin(), bytecode.end());
+
+		return spirv;
+	}
+}
+
+TEST_CASE("SPIR-V optimizer", "[Shader]")
+{
+	std::uint32_t one = Nz::BitCast<std::uint32_t>(1.f);
+
+	nzsl::SpirvSection instructions;
+	instructions.Append(nzsl::SpirvOp::OpCapability, nzsl::SpirvCapability::Shader);
+	instructions.Append(nzsl::SpirvOp::OpMemoryModel, nzsl::SpirvAddressingModel::Logical, nzsl::SpirvMemoryModel::GLSL450);
+	instructions.Append(nzsl::SpirvOp::OpEntryPoint, nzsl::SpirvExecutionModel::Fragment, 9, "main");
+	instructions.Append(nzsl::SpirvOp::OpExecutionMode, 9, nzsl::SpirvExecutionMode::OriginUpperLeft);
+	instructions.Append(nzsl::SpirvOp::OpName, 5, "Unused");
+	instructions.Append(nzsl::SpirvOp::OpName, 9, "main");
+	instructions.Append(nzsl::SpirvOp::OpTypeFloat, 1, 32);
+	instructions.Append(nzsl::SpirvOp::OpTypeFloat, 2, 32);
+	instructions.Append(nzsl::SpirvOp::OpConstant, 1, 3, one);
+	instructions.Append(nzsl::SpirvOp::OpConstant, 2, 4, one);
+	instructions.Append(nzsl::SpirvOp::OpTypeInt, 5, 32, 1);
+	instructions.Append(nzsl::SpirvOp::OpTypeVoid, 6);
+	instructions.Append(nzsl::SpirvOp::OpTypeFunction, 6, 7);
+	instructions.Append(nzsl::SpirvOp::OpTypePointer, 8, nzsl::SpirvStorageClass::Function, 2);
+	instructions.Append(nzsl::SpirvOp::OpFunction, 6, 9, nzsl::SpirvFunctionControl(0), 7);
+	instructions.Append(nzsl::SpirvOp::OpLabel, 10);
+	instructions.Append(nzsl::SpirvOp::OpVariable, 8, 11, nzsl::SpirvStorageClass::Function, 4);
+	instructions.Append(nzsl::SpirvOp::OpReturn);
+	instructions.Append(nzsl::SpirvOp::OpFunctionEnd);
+
+	std::vector<std::uint32_t> spirv = BuildModule(12, instructions);
+
+	nzsl::SpirvOptimizer optimizer;
+
+	WHEN("Using every optimization")
+	{
+		// %2 and %4 are merged into %1 and %3, %5 is removed with its name and ids are renumbered by order of appearance
+		nzsl::SpirvSection expectedInstructions;
+		expectedInstructions.Append(nzsl::SpirvOp::OpCapability, nzsl::SpirvCapability::Shader);
+		expectedInstructions.Append(nzsl::SpirvOp::OpMemoryModel, nzsl::SpirvAddressingModel::Logical, nzsl::SpirvMemoryModel::GLSL450);
+		expectedInstructions.Append(nzsl::SpirvOp::OpEntryPoint, nzsl::SpirvExecutionModel::Fragment, 1, "main");
+		expectedInstructions.Append(nzsl::SpirvOp::OpExecutionMode, 1, nzsl::SpirvExecutionMode::OriginUpperLeft);
+		expectedInstructions.Append(nzsl::SpirvOp::OpName, 1, "main");
+		expectedInstructions.Append(nzsl::SpirvOp::OpTypeFloat, 2, 32);
+		expectedInstructions.Append(nzsl::SpirvOp::OpConstant, 2, 3, one);
+		expectedInstructions.Append(nzsl::SpirvOp::OpTypeVoid, 4);
+		expectedInstructions.Append(nzsl::SpirvOp::OpTypeFunction, 4, 5);
+		expectedInstructions.Append(nzsl::SpirvOp::OpTypePointer, 6, nzsl::SpirvStorageClass::Function, 2);
+		expectedInstructions.Append(nzsl::SpirvOp::OpFunction, 4, 1, nzsl::SpirvFunctionControl(0), 5);
+		expectedInstructions.Append(nzsl::SpirvOp::OpLabel, 7);
+		expectedInstructions.Append(nzsl::SpirvOp::OpVariable, 6, 8, nzsl::SpirvStorageClass::Function, 3);
+		expectedInstructions.Append(nzsl::SpirvOp::OpReturn);
+		expectedInstructions.Append(nzsl::SpirvOp::OpFunctionEnd);
+
+		CHECK(optimizer.Optimize(spirv) == BuildModule(9, expectedInstructions));
+	}
+
+	WHEN("Only removing unused ids")
+	{
+		nzsl::SpirvOptimizer::Settings settings;
+		settings.compactIds = false;
+		settings.mergeDuplicates = false;
+
+		std::vector<std::uint32_t> optimizedSpirv = optimizer.Optimize(spirv, settings);
+
+		// Without merging, %3 (and thus %1) are unused like %5 and its name, the bound isn't changed
+		CHECK(optimizedSpirv[3] == 12);
+		CHECK(optimizedSpirv.size() == spirv.size() - 3 - 4 - 4 - 4);
+	}
+
+	WHEN("Disabling every optimization")
+	{
+		nzsl::SpirvOptimizer::Settings settings;
+		settings.compactIds = false;
+		settings.mergeDuplicates = false;
+		settings.removeUnused = false;
+
+		CHECK(optimizer.Optimize(spirv, settings) == spirv);
+	}
+
+	WHEN("Optimizing writer output")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std140)]
+struct Data
+{
+	color: vec4[f32],
+	count: i32
+}
+
+external
+{
+	[binding(0)] data: uniform[Data]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+fn Scale(value: vec4[f32], factor: f32) -> vec4[f32]
+{
+	return value * factor;
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let color = vec4[f32](1.0, 1.0, 1.0, 1.0);
+	for i in 0 -> data.count
+		color = Scale(color, 0.5);
+
+	let output: FragOut;
+	if (data.count > 2)
+		output.color = color * data.color;
+	else
+		output.color = color;
+
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+		nzsl::SpirvWriter::Environment env;
+		env.optimizeBinary = true;
+
+		nzsl::SpirvWriter spirvWriter;
+		std::vector<std::uint32_t> reference = spirvWriter.Generate(*shaderModule);
+
+		spirvWriter.SetEnv(env);
+		std::vector<std::uint32_t> optimizedSpirv = spirvWriter.Generate(*shaderModule);
+
+		CHECK(optimizedSpirv == optimizer.Optimize(reference));
+		CHECK(optimizedSpirv.size() <= reference.size());
+		CHECK(optimizedSpirv[3] <= reference[3]); //< bound
+
+		// Optimizing an optimized module doesn't change it
+		CHECK(optimizer.Optimize(optimizedSpirv) == optimizedSpirv);
+		CHECK_NOTHROW(nzsl::SpirvPrinter{}.Print(optimizedSpirv));
+	}
+}
@@ -0,0 +1,304 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/SpirV/SpirvReflector.hpp>
+#include <NZSL/SpirV/SpirvSection.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+TEST_CASE("SPIR-V reflection", "[Shader]")
+{
+	using BindingType = nzsl::SpirvReflector::BindingType;
+
+	nzsl::SpirvReflector reflector;
+
+	WHEN("Reflecting a graphics module")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std140)]
+struct Data
+{
+	color: vec4[f32],
+	transform: mat4[f32],
+	factors: array[f32, 3]
+}
+
+[layout(std430)]
+struct Lights
+{
+	count: u32,
+	values: dyn_array[vec4[f32]]
+}
+
+[layout(std140)]
+struct Constants
+{
+	offset: vec2[f32],
+	scale: f32
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[Data],
+	[set(0), binding(1)] textures: array[sampler2D[f32], 4],
+	[set(1), binding(0)] lights: storage[Lights],
+	constants: push_constant[Constants]
+}
+
+struct VertIn
+{
+	[location(0)] position: vec3[f32],
+	[location(1)] uv: vec2[f32],
+	[location(2)] index: i32
+}
+
+struct VertOut
+{
+	[location(0)] uv: vec2[f32],
+	[builtin(position)] position: vec4[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(vert)]
+fn vertMain(input: VertIn) -> VertOut
+{
+	let output: VertOut;
+	output.uv = input.uv * constants.scale + constants.offset;
+	output.position = data.transform * vec4[f32](input.position, 1.0);
+	return output;
+}
+
+[entry(frag)]
+fn fragMain(input: VertOut) -> FragOut
+{
+	let output: FragOut;
+	output.color = textures[0].Sample(input.uv) * data.color * lights.values[lights.count - u32(1)];
+	return output;
+}
+)";
+
+		nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+		nzsl::SpirvWriter::Environment env;
+		env.spvMajorVersion = 1;
+		env.spvMinorVersion = 3;
+
+		nzsl::SpirvWriter spirvWriter;
+		spirvWriter.SetEnv(env);
+
+		auto reflection = reflector.Reflect(spirvWriter.Generate(*shaderModule));
+
+		REQUIRE(reflection.bindings.size() == 3);
+
+		auto FindBinding = [&](std::string_view name) -> const nzsl::SpirvReflector::Binding&
+		{
+			for (const auto& binding : reflection.bindings)
+			{
+				if (binding.name == name)
+					return binding;
+			}
+
+			FAIL("binding " << name << " not found");
+			throw std::runtime_error("unreachable");
+		};
+
+		const auto& dataBinding = FindBinding("data");
+		CHECK(dataBinding.type == BindingType::UniformBuffer);
+		CHECK(dataBinding.bindingSet == 0);
+		CHECK(dataBinding.bindingIndex == 0);
+		CHECK(dataBinding.arraySize == 1);
+		CHECK(dataBinding.size == 16 + 64 + 3 * 16);
+
+		const auto& texturesBinding = FindBinding("textures");
+		CHECK(texturesBinding.type == BindingType::CombinedImageSampler);
+		CHECK(texturesBinding.bindingSet == 0);
+		CHECK(texturesBinding.bindingIndex == 1);
+		CHECK(texturesBinding.arraySize == 4);
+		CHECK(texturesBinding.size == 0);
+
+		const auto& lightsBinding = FindBinding("lights");
+		CHECK(lightsBinding.type == BindingType::StorageBuffer);
+		CHECK(lightsBinding.bindingSet == 1);
+		CHECK(lightsBinding.bindingIndex == 0);
+		CHECK(lightsBinding.size == 16); //< runtime array is not part of the static size
+
+		REQUIRE(reflection.pushConstantBlocks.size() == 1);
+		const auto& pushConstantBlock = reflection.pushConstantBlocks.front();
+		CHECK(pushConstantBlock.name == "constants");
+		CHECK(pushConstantBlock.size == 12);
+		REQUIRE(pushConstantBlock.members.size() == 2);
+		CHECK(pushConstantBlock.members[0].name == "offset");
+		CHECK(pushConstantBlock.members[0].offset == 0);
+		CHECK(pushConstantBlock.members[0].size == 8);
+		CHECK(pushConstantBlock.members[1].name == "scale");
+		CHECK(pushConstantBlock.members[1].offset == 8);
+		CHECK(pushConstantBlock.members[1].size == 4);
+
+		REQUIRE(reflection.entryPoints.size() == 2);
+
+		const auto& vertEntry = reflection.entryPoints[0];
+		CHECK(vertEntry.name == "vertMain");
+		CHECK(vertEntry.executionModel == nzsl::SpirvExecutionModel::Vertex);
+		CHECK_FALSE(vertEntry.localSize);
+		REQUIRE(vertEntry.inputs.size() == 3);
+		CHECK(vertEntry.inputs[0].location == 0u);
+		CHECK(vertEntry.inputs[0].componentType == nzsl::Ast::PrimitiveType::Float32);
+		CHECK(vertEntry.inputs[0].componentCount == 3);
+		CHECK(vertEntry.inputs[2].location == 2u);
+		CHECK(vertEntry.inputs[2].componentType == nzsl::Ast::PrimitiveType::Int32);
+		CHECK(vertEntry.inputs[2].componentCount == 1);
+		REQUIRE(vertEntry.outputs.size() == 2);
+		CHECK(vertEntry.outputs[0].location == 0u);
+		CHECK(vertEntry.outputs[1].builtin == nzsl::SpirvBuiltIn::Position);
+		CHECK_FALSE(vertEntry.outputs[1].location);
+
+		const auto& fragEntry = reflection.entryPoints[1];
+		CHECK(fragEntry.name == "fragMain");
+		CHECK(fragEntry.executionModel == nzsl::SpirvExecutionModel::Fragment);
+		CHECK(std::find(fragEntry.executionModes.begin(), fragEntry.executionModes.end(), nzsl::SpirvExecutionMode::OriginUpperLeft) != fragEntry.executionModes.end());
+		REQUIRE(fragEntry.outputs.size() == 1);
+		CHECK(fragEntry.outputs[0].location == 0u);
+		CHECK(fragEntry.outputs[0].componentType == nzsl::Ast::PrimitiveType::Float32);
+		CHECK(fragEntry.outputs[0].componentCount == 4);
+	}
+
+	WHEN("Reflecting a compute module")
+	{
+		std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[auto_binding]
+external
+{
+	output_tex: texture2D[f32, writeonly, rgba8]
+}
+
+struct Input
+{
+	[builtin(global_invocation_indices)] indices: vec3[u32]
+}
+
+[entry(compute)]
+[workgroup(32, 16, 2)]
+fn main(input: Input)
+{
+	output_tex.Write(vec2[i32](input.indices.xy), vec4[f32](1.0, 1.0, 1.0, 1.0));
+}
+)";
+
+		nzsl::SpirvWriter spirvWriter;
+		auto reflection = reflector.Reflect(spirvWriter.Generate(*nzsl::Parse(nzslSource)));
+
+		REQUIRE(reflection.bindings.size() == 1);
+		CHECK(reflection.bindings[0].name == "output_tex");
+		CHECK(reflection.bindings[0].type == BindingType::StorageImage);
+
+		REQUIRE(reflection.entryPoints.size() == 1);
+		const auto& entryPoint = reflection.entryPoints[0];
+		CHECK(entryPoint.executionModel == nzsl::SpirvExecutionModel::GLCompute);
+		REQUIRE(entryPoint.localSize);
+		CHECK(*entryPoint.localSize == nzsl::Vector3u32(32, 16, 2));
+		REQUIRE(entryPoint.inputs.size() == 1);
+		CHECK(entryPoint.inputs[0].builtin == nzsl::SpirvBuiltIn::GlobalInvocationId);
+		CHECK(entryPoint.inputs[0].componentType == nzsl::Ast::PrimitiveType::UInt32);
+		CHECK(entryPoint.inputs[0].componentCount == 3);
+	}
+
+	WHEN("Reflecting a workgroup size builtin")
+	{
+		nzsl::SpirvSection instructions;
+		instructions.Append(nzsl::SpirvOp::OpCapability, nzsl::SpirvCapability::Shader);
+		instructions.Append(nzsl::SpirvOp::OpMemoryModel, nzsl::SpirvAddressingModel::Logical, nzsl::SpirvMemoryModel::GLSL450);
+		instructions.Append(nzsl::SpirvOp::OpEntryPoint, nzsl::SpirvExecutionModel::GLCompute, 1, "main");
+		instructions.Append(nzsl::SpirvOp::OpExecutionMode, 1, nzsl::SpirvExecutionMode::LocalSize, 1, 1, 1);
+		instructions.Append(nzsl::SpirvOp::OpDecorate, 6, nzsl::SpirvDecoration::BuiltIn, nzsl::SpirvBuiltIn::WorkgroupSize);
+		instructions.Append(nzsl::SpirvOp::OpDecorate, 4, nzsl::SpirvDecoration::SpecId, 0);
+		instructions.Append(nzsl::SpirvOp::OpTypeInt, 2, 32, 0);
+		instructions.Append(nzsl::SpirvOp::OpTypeVector, 3, 2, 3);
+		instructions.Append(nzsl::SpirvOp::OpSpecConstant, 2, 4, 64);
+		instructions.Append(nzsl::SpirvOp::OpConstant, 2, 5, 1);
+		instructions.Append(nzsl::SpirvOp::OpSpecConstantComposite, 3, 6, 4, 5, 5);
+
+		std::vector<std::uint32_t> spirv = { nzsl::SpirvMagicNumber, nzsl::MakeSpirvVersion(1, 0), 0, 7, 0 };
+		spirv.insert(spirv.end(), instructions.GetBytecode().begin(), instructions.GetBytecode().end());
+
+		auto reflection = reflector.Reflect(spirv);
+
+		REQUIRE(reflection.entryPoints.size() == 1);
+		REQUIRE(reflection.entryPoints[0].localSize);
+		CHECK(*reflection.entryPoints[0].localSize == nzsl::Vector3u32(64, 1, 1));
+	}
+
+	WHEN("Reflecting an invalid module")
+	{
+		std::vector<std::uint32_t> spirv = { nzsl::SpirvMagicNumber, nzsl::MakeSpirvVersion(1, 0), 0, 2, 0 };
+
+		nzsl::SpirvSection instructions;
+		instructions.Append(nzsl::SpirvOp::OpName, 5, "OutOfBounds");
+		spirv.insert(spirv.end(), instructions.GetBytecode().begin(), instructions.GetBytecode().end());
+
+		CHECK_THROWS_WITH(reflector.Reflect(spirv), "invalid SPIR-V: id %5 is out of bounds");
+	}
+}
+
+TEST_CASE("SPIR-V reflection performance", "[.][Benchmark]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std140)]
+struct Data
+{
+	color: vec4[f32],
+	transform: mat4[f32]
+}
+
+external
+{
+	[set(0), binding(0)] data: uniform[Data],
+	[set(0), binding(1)] tex: sampler2D[f32]
+}
+
+struct FragIn
+{
+	[location(0)] uv: vec2[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main(input: FragIn) -> FragOut
+{
+	let output: FragOut;
+	output.color = data.transform * tex.Sample(input.uv) * data.color;
+
+	return output;
+}
+)";
+
+	nzsl::ShaderWriter::States states;
+	states.debugLevel = nzsl::DebugLevel::Minimal;
+
+	nzsl::SpirvWriter spirvWriter;
+	std::vector<std::uint32_t> spirv = spirvWriter.Generate(*nzsl::Parse(nzslSource), states);
+
+	// The same reflector is reused, as its scratch tables are kept between calls
+	nzsl::SpirvReflector reflector;
+
+	BENCHMARK("reflect a fragment shader")
+	{
+		return reflector.Reflect(spirv);
+	};
+}
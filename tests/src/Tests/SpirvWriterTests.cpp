@@ -0,0 +1,216 @@
+#include <Tests/ShaderUtils.hpp>
+#include <NZSL/Parser.hpp>
+#include <NZSL/SpirvWriter.hpp>
+#include <NZSL/Ast/SanitizeVisitor.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <algorithm>
+
+TEST_CASE("SPIR-V generation into an existing buffer", "[Shader]")
+{
+	std::string_view nzslSource = R"(
+[nzsl_version("1.0")]
+module;
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> FragOut
+{
+	let output: FragOut;
+	output.color = vec4[f32](1.0, 0.5, 0.25, 1.0);
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(nzslSource);
+
+	nzsl::SpirvWriter spirvWriter;
+	std::vector<std::uint32_t> spirv = spirvWriter.Generate(*shaderModule);
+
+	// Generated words are appended to the buffer, keeping its previous content
+	std::vector<std::uint32_t> buffer = { 0xDEADBEEF };
+	spirvWriter.Generate(*shaderModule, buffer);
+
+	REQUIRE(buffer.size() == spirv.size() + 1);
+	CHECK(buffer.front() == 0xDEADBEEF);
+	CHECK(std::equal(spirv.begin(), spirv.end(), buffer.begin() + 1));
+
+	// Reusing the buffer storage
+	buffer.clear();
+	spirvWriter.Generate(*shaderModule, buffer);
+	CHECK(buffer == spirv);
+}
+
+TEST_CASE("SPIR-V type cache", "[Shader]")
+{
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std140)]
+struct UniformData
+{
+	values: array[f32, 4],
+	transform: mat4[f32]
+}
+
+[layout(std430)]
+struct StorageData
+{
+	values: array[f32, 4]
+}
+
+external
+{
+	[set(0), binding(0)] uniformData: uniform[UniformData],
+	[set(0), binding(1)] storageData: storage[StorageData],
+	[set(0), binding(2)] tex: sampler2D[f32]
+}
+
+struct Output
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(frag)]
+fn main() -> Output
+{
+	let values: array[f32, 4];
+	values[0] = 0.0;
+	values[1] = -0.0;
+	values[3] = uniformData.values[0];
+	storageData.values[1] = values[1] + uniformData.values[2];
+
+	let output: Output;
+	output.color = uniformData.transform * tex.Sample(vec2[f32](0.5, -0.5)) * values[3];
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Parse(sourceCode);
+
+	nzsl::ShaderWriter::States states;
+	states.optimize = true;
+
+	nzsl::SpirvWriter referenceWriter;
+	std::vector<std::uint32_t> referenceSpirv = referenceWriter.Generate(*shaderModule, states);
+
+	nzsl::SpirvWriter::Environment env;
+	env.typeCache = std::make_shared<nzsl::SpirvTypeCache>();
+
+	// Cached descriptions must give the same result as freshly built ones, including array strides depending on the block layout
+	for (std::size_t i = 0; i < 2; ++i)
+	{
+		nzsl::SpirvWriter spirvWriter;
+		spirvWriter.SetEnv(env);
+
+		CHECK(spirvWriter.Generate(*shaderModule, states) == referenceSpirv);
+		CHECK(env.typeCache->GetEntryCount() > 0);
+	}
+
+	env.typeCache->Clear();
+	CHECK(env.typeCache->GetEntryCount() == 0);
+}
+
+TEST_CASE("generating SPIR-V with a shared type cache", "[.][Benchmark]")
+{
+	std::string_view sourceCode = R"(
+[nzsl_version("1.0")]
+module;
+
+[layout(std140)]
+struct ViewerData
+{
+	projectionMatrix: mat4[f32],
+	viewMatrix: mat4[f32],
+	eyePosition: vec3[f32]
+}
+
+[layout(std140)]
+struct InstanceData
+{
+	worldMatrix: mat4[f32],
+	colors: array[vec4[f32], 4]
+}
+
+external
+{
+	[set(0), binding(0)] viewerData: uniform[ViewerData],
+	[set(1), binding(0)] instanceData: uniform[InstanceData],
+	[set(1), binding(1)] albedo: sampler2D[f32]
+}
+
+struct VertIn
+{
+	[location(0)] position: vec3[f32],
+	[location(1)] normal: vec3[f32],
+	[location(2)] uv: vec2[f32]
+}
+
+struct VertOut
+{
+	[builtin(position)] position: vec4[f32],
+	[location(0)] normal: vec3[f32],
+	[location(1)] uv: vec2[f32],
+	[location(2)] worldPos: vec3[f32]
+}
+
+struct FragOut
+{
+	[location(0)] color: vec4[f32]
+}
+
+[entry(vert)]
+fn vertMain(input: VertIn) -> VertOut
+{
+	let worldPos = instanceData.worldMatrix * vec4[f32](input.position, 1.0);
+
+	let output: VertOut;
+	output.position = viewerData.projectionMatrix * viewerData.viewMatrix * worldPos;
+	output.normal = input.normal;
+	output.uv = input.uv;
+	output.worldPos = worldPos.xyz;
+
+	return output;
+}
+
+[entry(frag)]
+fn fragMain(input: VertOut) -> FragOut
+{
+	let eyeDir = normalize(viewerData.eyePosition - input.worldPos);
+	let lightFactor = max(dot(normalize(input.normal), eyeDir), 0.0);
+
+	let output: FragOut;
+	output.color = albedo.Sample(input.uv) * instanceData.colors[0] * lightFactor;
+
+	return output;
+}
+)";
+
+	nzsl::Ast::ModulePtr shaderModule = nzsl::Ast::Sanitize(*nzsl::Parse(sourceCode), nzsl::SpirvWriter::GetSanitizeOptions());
+
+	nzsl::ShaderWriter::States states;
+	states.sanitized = true;
+
+	BENCHMARK("generate without a type cache")
+	{
+		nzsl::SpirvWriter spirvWriter;
+		return spirvWriter.Generate(*shaderModule, states);
+	};
+
+	nzsl::SpirvWriter::Environment env;
+	env.typeCache = std::make_shared<nzsl::SpirvTypeCache>();
+
+	BENCHMARK("generate with a shared type cache")
+	{
+		nzsl::SpirvWriter spirvWriter;
+		spirvWriter.SetEnv(env);
+
+		return spirvWriter.Generate(*shaderModule, states);
+	};
+}
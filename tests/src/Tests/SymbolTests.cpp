@@ -0,0 +1,85 @@
+#include <NZSL/Lang/Symbol.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+TEST_CASE("symbols", "[Shader]")
+{
+	SECTION("Interning")
+	{
+		std::string name = "interned_symbol_test";
+
+		nzsl::Symbol first(name);
+		CHECK(first.IsValid());
+		CHECK(first.GetName() == name);
+		CHECK(first.GetName().data() != name.data()); //< name is stored by the symbol table
+
+		nzsl::Symbol second(std::string("interned_") + "symbol_test");
+		CHECK(first == second);
+		CHECK(first.GetId() == second.GetId());
+		CHECK(first.GetName().data() == second.GetName().data());
+
+		CHECK(nzsl::Symbol("other_interned_symbol_test") != first);
+
+		std::unordered_set<nzsl::Symbol> symbols = { first, second };
+		CHECK(symbols.size() == 1);
+	}
+
+	SECTION("Lookup")
+	{
+		CHECK_FALSE(nzsl::Symbol::Find("never_interned_symbol_test").IsValid());
+		CHECK_FALSE(nzsl::Symbol{}.IsValid());
+
+		nzsl::Symbol symbol("looked_up_symbol_test");
+		CHECK(nzsl::Symbol::Find("looked_up_symbol_test") == symbol);
+
+		CHECK(nzsl::Symbol::FromId(symbol.GetId()) == symbol);
+		CHECK_FALSE(nzsl::Symbol::FromId(nzsl::Symbol::InvalidId).IsValid());
+	}
+
+	SECTION("Lookup from multiple threads")
+	{
+		constexpr std::size_t NameCount = 1000;
+		constexpr std::size_t ThreadCount = 4;
+
+		// Every thread interns the same names in a different order, they must agree on their ids
+		std::vector<std::vector<std::uint32_t>> threadIds(ThreadCount, std::vector<std::uint32_t>(NameCount));
+
+		std::vector<std::thread> threads;
+		for (std::size_t threadIndex = 0; threadIndex < ThreadCount; ++threadIndex)
+		{
+			threads.emplace_back([&, threadIndex]
+			{
+				for (std::size_t i = 0; i < NameCount; ++i)
+				{
+					std::size_t nameIndex = (i + threadIndex * NameCount / ThreadCount) % NameCount;
+					std::string name = "threaded_symbol_test_" + std::to_string(nameIndex);
+
+					nzsl::Symbol symbol(name);
+					threadIds[threadIndex][nameIndex] = symbol.GetId();
+
+					// Second lookups are served by the thread cache
+					if (nzsl::Symbol::Find(name) != symbol || nzsl::Symbol(name) != symbol || nzsl::Symbol::FromId(symbol.GetId()).GetName() != name)
+						threadIds[threadIndex][nameIndex] = nzsl::Symbol::InvalidId;
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		for (std::size_t i = 0; i < NameCount; ++i)
+		{
+			std::string name = "threaded_symbol_test_" + std::to_string(i);
+
+			nzsl::Symbol symbol = nzsl::Symbol::Find(name);
+			REQUIRE(symbol.IsValid());
+			CHECK(nzsl::Symbol::FromId(symbol.GetId()).GetName() == name);
+
+			for (std::size_t threadIndex = 0; threadIndex < ThreadCount; ++threadIndex)
+				CHECK(threadIds[threadIndex][i] == symbol.GetId());
+		}
+	}
+}
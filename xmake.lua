@@ -114,6 +114,10 @@ target("nzsl", function ()
 		add_defines("NZSL_EFSW")
 	end
 
+	if is_plat("linux", "bsd") then
+		add_syslinks("pthread")
+	end
+
 	on_load(function (target)
 		if target:kind() == "static" then
 			target:add("defines", "NZSL_STATIC", { public = true })
@@ -429,6 +429,34 @@ namespace Nz
 
 namespace nzsl
 {
+	constexpr std::uint16_t InvalidInstructionIndex = 0xFFFF;
+
+	template<typename T, std::size_t N>
+	constexpr std::size_t GetMaxOpcode(const std::array<T, N>& instructions)
+	{
+		std::size_t maxOpcode = 0;
+		for (const T& instruction : instructions)
+			maxOpcode = std::max(maxOpcode, static_cast<std::size_t>(instruction.op));
+
+		return maxOpcode;
+	}
+
+	// Maps every opcode to its index in the instruction array (or InvalidInstructionIndex), for a direct lookup
+	template<std::size_t MaxOpcode, typename T, std::size_t N>
+	constexpr std::array<std::uint16_t, MaxOpcode + 1> BuildInstructionIndices(const std::array<T, N>& instructions)
+	{
+		static_assert(N < InvalidInstructionIndex);
+
+		std::array<std::uint16_t, MaxOpcode + 1> indices = {};
+		for (std::uint16_t& index : indices)
+			index = InvalidInstructionIndex;
+
+		for (std::size_t i = 0; i < N; ++i)
+			indices[static_cast<std::size_t>(instructions[i].op)] = static_cast<std::uint16_t>(i);
+
+		return indices;
+	}
+
 	static constexpr std::array<SpirvOperand, ]] .. #operands .. [[> s_operands = {
 		{
 ]])
@@ -449,7 +477,7 @@ namespace nzsl
 
 	for _, grammarData in pairs(grammars) do
 		sourceFile:write([[
-	static std::array<Spirv]] .. grammarData.Prefix .. [[Instruction, ]] .. grammarData.InstructionCount .. [[> s_instructions]] .. grammarData.Prefix .. [[ = {
+	static constexpr std::array<Spirv]] .. grammarData.Prefix .. [[Instruction, ]] .. grammarData.InstructionCount .. [[> s_instructions]] .. grammarData.Prefix .. [[ = {
 		{
 ]])
 
@@ -474,6 +502,8 @@ namespace nzsl
 		}
 	};
 
+	static constexpr auto s_instructionIndices]] .. grammarData.Prefix .. [[ = BuildInstructionIndices<GetMaxOpcode(s_instructions]] .. grammarData.Prefix .. [[)>(s_instructions]] .. grammarData.Prefix .. [[);
+
 ]])
 	end
 
@@ -520,11 +550,14 @@ namespace nzsl
 
 	const Spirv]] .. grammarData.Prefix .. [[Instruction* GetSpirv]] .. grammarData.Prefix .. [[Instruction(std::uint16_t op)
 	{
-		auto it = std::lower_bound(std::begin(s_instructions]] .. grammarData.Prefix .. [[), std::end(s_instructions]] .. grammarData.Prefix .. [[), op, [](const Spirv]] .. grammarData.Prefix .. [[Instruction& inst, std::uint16_t op) { return std::uint16_t(inst.op) < op; });
-		if (it != std::end(s_instructions]] .. grammarData.Prefix .. [[) && std::uint16_t(it->op) == op)
-			return &*it;
-		else
+		if (op >= s_instructionIndices]] .. grammarData.Prefix .. [[.size())
+			return nullptr;
+
+		std::uint16_t index = s_instructionIndices]] .. grammarData.Prefix .. [[[op];
+		if (index == InvalidInstructionIndex)
 			return nullptr;
+
+		return &s_instructions]] .. grammarData.Prefix .. [[[index];
 	}
 ]])
 	end